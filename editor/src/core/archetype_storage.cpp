@@ -0,0 +1,317 @@
+#include "core/archetype_storage.hpp"
+#include "core/derived_data_cache.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+static inline std::uint32_t align_up(std::uint32_t value, std::uint32_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+KArchetypeStorage::KArchetypeStorage() { clear(); }
+
+ecs::Entity KArchetypeStorage::create()
+{
+    ecs::Entity entity = 0;
+    if (!m_free_entities.empty())
+    {
+        entity = m_free_entities.back();
+        m_free_entities.pop_back();
+    }
+    else
+    {
+        entity = static_cast<ecs::Entity>(m_locations.size());
+        m_locations.emplace_back();
+    }
+
+    // Every entity starts out in the archetype without components
+    _push_row(0, entity);
+    m_entity_count++;
+    return entity;
+}
+
+void KArchetypeStorage::destroy(ecs::Entity entity)
+{
+    if (!is_alive(entity))
+        return;
+
+    _pop_row(entity);
+    m_locations[entity].alive = false;
+    m_free_entities.push_back(entity);
+    m_entity_count--;
+}
+
+bool KArchetypeStorage::is_alive(ecs::Entity entity) const
+{
+    return entity < m_locations.size() && m_locations[entity].alive;
+}
+
+void* KArchetypeStorage::add(
+    ecs::Entity entity, std::uint64_t type, std::uint32_t size, const void* value
+)
+{
+    if (!is_alive(entity))
+        return nullptr;
+
+    auto size_it = m_type_sizes.emplace(type, size).first;
+    assert(size_it->second == size && "ArchetypeStorage::add() -> a type changed its size");
+    (void)size_it;
+
+    std::uint32_t index = m_locations[entity].archetype;
+    std::uint32_t column = _find_column(m_archetypes[index], type);
+    if (column == ~0u)
+    {
+        auto edge = m_archetypes[index].add_edges.find(type);
+        std::uint32_t target = 0;
+        if (edge != m_archetypes[index].add_edges.end())
+            target = edge->second;
+        else
+        {
+            std::vector<std::uint64_t> types = m_archetypes[index].types;
+            types.insert(std::lower_bound(types.begin(), types.end(), type), type);
+            target = _get_archetype(types);
+            m_archetypes[index].add_edges.emplace(type, target);
+            m_archetypes[target].remove_edges.emplace(type, index);
+        }
+
+        _move(entity, target);
+        index = target;
+        column = _find_column(m_archetypes[index], type);
+    }
+
+    std::uint8_t* cell = _cell(m_archetypes[index], m_locations[entity], column);
+    if (value != nullptr)
+        std::memcpy(cell, value, size);
+    else
+        std::memset(cell, 0, size);
+    return cell;
+}
+
+void KArchetypeStorage::remove(ecs::Entity entity, std::uint64_t type)
+{
+    if (!is_alive(entity))
+        return;
+
+    std::uint32_t index = m_locations[entity].archetype;
+    if (_find_column(m_archetypes[index], type) == ~0u)
+        return;
+
+    auto edge = m_archetypes[index].remove_edges.find(type);
+    std::uint32_t target = 0;
+    if (edge != m_archetypes[index].remove_edges.end())
+        target = edge->second;
+    else
+    {
+        std::vector<std::uint64_t> types = m_archetypes[index].types;
+        types.erase(std::lower_bound(types.begin(), types.end(), type));
+        target = _get_archetype(types);
+        m_archetypes[index].remove_edges.emplace(type, target);
+        m_archetypes[target].add_edges.emplace(type, index);
+    }
+    _move(entity, target);
+}
+
+void* KArchetypeStorage::get(ecs::Entity entity, std::uint64_t type)
+{
+    if (!is_alive(entity))
+        return nullptr;
+
+    const KEntityLocation& location = m_locations[entity];
+    const KArchetype& archetype = m_archetypes[location.archetype];
+    std::uint32_t column = _find_column(archetype, type);
+    return column != ~0u ? _cell(archetype, location, column) : nullptr;
+}
+
+KArchetypeStats KArchetypeStorage::get_stats() const
+{
+    KArchetypeStats stats = {};
+    stats.entity_count = m_entity_count;
+    stats.archetype_count = m_archetypes.size();
+    stats.table_bytes = m_locations.capacity() * sizeof(KEntityLocation) +
+                        m_free_entities.capacity() * sizeof(ecs::Entity) +
+                        m_archetypes.capacity() * sizeof(KArchetype);
+
+    for (const KArchetype& archetype : m_archetypes)
+    {
+        std::uint64_t row_size = sizeof(ecs::Entity);
+        for (const KArchetypeColumn& column : archetype.columns)
+            row_size += column.size;
+
+        stats.chunk_count += archetype.chunks.size();
+        for (const KChunk& chunk : archetype.chunks)
+            stats.component_bytes += chunk.count * row_size;
+        stats.table_bytes += archetype.columns.capacity() * sizeof(KArchetypeColumn) +
+                             archetype.types.capacity() * sizeof(std::uint64_t) +
+                             archetype.chunks.capacity() * sizeof(KChunk);
+    }
+    stats.chunk_bytes = static_cast<std::uint64_t>(stats.chunk_count) * archetype_chunk_size;
+    return stats;
+}
+
+void KArchetypeStorage::clear()
+{
+    m_archetypes.clear();
+    m_archetype_indices.clear();
+    m_type_sizes.clear();
+    m_queries.clear();
+    m_locations.clear();
+    m_free_entities.clear();
+    m_entity_count = 0;
+
+    _get_archetype({});
+}
+
+std::uint32_t KArchetypeStorage::_get_archetype(const std::vector<std::uint64_t>& types)
+{
+    auto it = m_archetype_indices.find(types);
+    if (it != m_archetype_indices.end())
+        return it->second;
+
+    KArchetype archetype = {};
+    archetype.types = types;
+    std::uint32_t row_size = sizeof(ecs::Entity);
+    for (std::uint64_t type : types)
+    {
+        KArchetypeColumn column = {};
+        column.type = type;
+        column.size = m_type_sizes[type];
+        row_size += column.size;
+        archetype.columns.push_back(column);
+    }
+
+    // As many rows as fit once every column starts aligned
+    archetype.capacity = std::max(archetype_chunk_size / row_size, 1u);
+    for (;; archetype.capacity--)
+    {
+        std::uint32_t offset = archetype.capacity * static_cast<std::uint32_t>(sizeof(ecs::Entity));
+        for (KArchetypeColumn& column : archetype.columns)
+        {
+            column.offset = align_up(offset, archetype_column_alignment);
+            offset = column.offset + archetype.capacity * column.size;
+        }
+        if (offset <= archetype_chunk_size || archetype.capacity == 1)
+            break;
+    }
+
+    std::uint32_t index = static_cast<std::uint32_t>(m_archetypes.size());
+    m_archetypes.push_back(std::move(archetype));
+    m_archetype_indices.emplace(types, index);
+    return index;
+}
+
+std::uint32_t KArchetypeStorage::_find_column(const KArchetype& archetype, std::uint64_t type) const
+{
+    auto it = std::lower_bound(archetype.types.begin(), archetype.types.end(), type);
+    if (it == archetype.types.end() || *it != type)
+        return ~0u;
+    return static_cast<std::uint32_t>(it - archetype.types.begin());
+}
+
+const std::vector<std::uint32_t>& KArchetypeStorage::_match(
+    const std::vector<std::uint64_t>& types
+)
+{
+    KContentHasher hasher = {};
+    hasher.update(types.data(), types.size() * sizeof(std::uint64_t));
+    KQuery& query = m_queries[hasher.finish()];
+    if (query.types != types)
+        query = {types, {}, 0};
+
+    if (query.matched_count == m_archetypes.size())
+        return query.archetypes;
+
+    std::vector<std::uint64_t> sorted = types;
+    std::sort(sorted.begin(), sorted.end());
+    for (std::size_t i = query.matched_count; i < m_archetypes.size(); i++)
+    {
+        const std::vector<std::uint64_t>& archetype_types = m_archetypes[i].types;
+        if (std::includes(
+                archetype_types.begin(), archetype_types.end(), sorted.begin(), sorted.end()
+            ))
+            query.archetypes.push_back(static_cast<std::uint32_t>(i));
+    }
+    query.matched_count = m_archetypes.size();
+    return query.archetypes;
+}
+
+void KArchetypeStorage::_push_row(std::uint32_t index, ecs::Entity entity)
+{
+    KArchetype& archetype = m_archetypes[index];
+    if (archetype.chunks.empty() || archetype.chunks.back().count == archetype.capacity)
+    {
+        KChunk chunk = {};
+        chunk.data = std::make_unique_for_overwrite<std::uint8_t[]>(archetype_chunk_size);
+        archetype.chunks.push_back(std::move(chunk));
+    }
+
+    KChunk& chunk = archetype.chunks.back();
+    reinterpret_cast<ecs::Entity*>(chunk.data.get())[chunk.count] = entity;
+
+    KEntityLocation& location = m_locations[entity];
+    location.archetype = index;
+    location.chunk = static_cast<std::uint32_t>(archetype.chunks.size() - 1);
+    location.row = chunk.count++;
+    location.alive = true;
+}
+
+void KArchetypeStorage::_pop_row(ecs::Entity entity)
+{
+    // The archetype's last row fills the hole, only the last chunk is ever partly filled
+    const KEntityLocation location = m_locations[entity];
+    KArchetype& archetype = m_archetypes[location.archetype];
+    KChunk& last_chunk = archetype.chunks.back();
+    KEntityLocation last = location;
+    last.chunk = static_cast<std::uint32_t>(archetype.chunks.size() - 1);
+    last.row = last_chunk.count - 1;
+
+    if (last.chunk != location.chunk || last.row != location.row)
+    {
+        ecs::Entity moved = reinterpret_cast<ecs::Entity*>(last_chunk.data.get())[last.row];
+        reinterpret_cast<ecs::Entity*>(archetype.chunks[location.chunk].data.get())[location.row] =
+            moved;
+        for (std::uint32_t column = 0; column < archetype.columns.size(); column++)
+        {
+            std::memcpy(
+                _cell(archetype, location, column), _cell(archetype, last, column),
+                archetype.columns[column].size
+            );
+        }
+        m_locations[moved].chunk = location.chunk;
+        m_locations[moved].row = location.row;
+    }
+
+    if (--last_chunk.count == 0)
+        archetype.chunks.pop_back();
+}
+
+void KArchetypeStorage::_move(ecs::Entity entity, std::uint32_t target)
+{
+    const KEntityLocation source = m_locations[entity];
+    _push_row(target, entity);
+    const KEntityLocation destination = m_locations[entity];
+
+    // Both column lists are sorted by type, the ones they share are copied and new ones zeroed
+    const KArchetype& from = m_archetypes[source.archetype];
+    const KArchetype& to = m_archetypes[target];
+    std::uint32_t from_column = 0;
+    for (std::uint32_t to_column = 0; to_column < to.columns.size(); to_column++)
+    {
+        while (from_column < from.columns.size() &&
+               from.columns[from_column].type < to.columns[to_column].type)
+            from_column++;
+
+        std::uint8_t* cell = _cell(to, destination, to_column);
+        if (from_column < from.columns.size() &&
+            from.columns[from_column].type == to.columns[to_column].type)
+            std::memcpy(cell, _cell(from, source, from_column), to.columns[to_column].size);
+        else
+            std::memset(cell, 0, to.columns[to_column].size);
+    }
+
+    // Popped from where it was, which the entity's location no longer points at
+    m_locations[entity] = source;
+    _pop_row(entity);
+    m_locations[entity] = destination;
+}
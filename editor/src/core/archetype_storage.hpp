@@ -0,0 +1,201 @@
+#ifndef __KRYOS_EDITOR_CORE_ARCHETYPE_STORAGE_HPP__
+#define __KRYOS_EDITOR_CORE_ARCHETYPE_STORAGE_HPP__
+
+#include <kryos/scene/entity.hpp>
+#include <kryos/serialization/reflection.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+constexpr std::uint32_t archetype_chunk_size = 16 * 1024;
+constexpr std::uint32_t archetype_column_alignment = 16;
+
+struct KArchetypeStats
+{
+    std::size_t entity_count = 0;
+    std::size_t archetype_count = 0;
+    std::size_t chunk_count = 0;
+    // Every chunk's full size, whether its rows are used or not
+    std::uint64_t chunk_bytes = 0;
+    std::uint64_t component_bytes = 0;
+    // Entity locations and the archetypes' bookkeeping
+    std::uint64_t table_bytes = 0;
+};
+
+// Entities with the same set of components share fixed size chunks, one column per component
+// packed back to back, so a query walks every matching chunk linearly instead of looking each
+// component up in its own pool. Adding or removing a component moves the entity's row to the
+// archetype with the new set. Components are moved around as bytes, only trivially copyable
+// components can be stored. Entity ids are the storage's own, not the registry's
+class KArchetypeStorage
+{
+  public:
+    KArchetypeStorage();
+    ~KArchetypeStorage() = default;
+
+    inline std::size_t get_entity_count() const { return m_entity_count; }
+
+    ecs::Entity create();
+    void destroy(ecs::Entity entity);
+    bool is_alive(ecs::Entity entity) const;
+
+    // The component is zeroed when value is null, an existing component is overwritten
+    void* add(ecs::Entity entity, std::uint64_t type, std::uint32_t size, const void* value);
+    void remove(ecs::Entity entity, std::uint64_t type);
+    void* get(ecs::Entity entity, std::uint64_t type);
+
+    template<typename _Component>
+    inline _Component* add(ecs::Entity entity, const _Component& value = {})
+    {
+        static_assert(
+            std::is_trivially_copyable_v<_Component>, "archetype components are moved as bytes"
+        );
+        return static_cast<_Component*>(
+            add(entity, KTypeId::create<_Component>().get_id(), sizeof(_Component), &value)
+        );
+    }
+
+    template<typename _Component>
+    inline void remove(ecs::Entity entity)
+    {
+        remove(entity, KTypeId::create<_Component>().get_id());
+    }
+
+    template<typename _Component>
+    inline _Component* get(ecs::Entity entity)
+    {
+        return static_cast<_Component*>(get(entity, KTypeId::create<_Component>().get_id()));
+    }
+
+    // Calls callback(count, entities, columns) for every chunk that has all of the types, with
+    // columns in the order of types. The callback must not add or remove components
+    template<typename _Callback>
+    void each_chunk(const std::vector<std::uint64_t>& types, _Callback&& callback)
+    {
+        std::vector<std::uint8_t*> columns = std::vector<std::uint8_t*>(types.size(), nullptr);
+        for (std::uint32_t index : _match(types))
+        {
+            KArchetype& archetype = m_archetypes[index];
+            std::vector<std::uint32_t> offsets = std::vector<std::uint32_t>(types.size(), 0);
+            for (std::size_t i = 0; i < types.size(); i++)
+                offsets[i] = archetype.columns[_find_column(archetype, types[i])].offset;
+
+            for (KChunk& chunk : archetype.chunks)
+            {
+                for (std::size_t i = 0; i < types.size(); i++)
+                    columns[i] = chunk.data.get() + offsets[i];
+                callback(
+                    chunk.count, reinterpret_cast<const ecs::Entity*>(chunk.data.get()),
+                    columns.data()
+                );
+            }
+        }
+    }
+
+    // Calls callback(entity, components&...) for every entity that has all of the components
+    template<typename... _Components, typename _Callback>
+    void each(_Callback&& callback)
+    {
+        static const std::vector<std::uint64_t> types = {
+            KTypeId::create<_Components>().get_id()...
+        };
+        each_chunk(
+            types,
+            [&](std::uint32_t count, const ecs::Entity* entities, std::uint8_t* const* columns)
+            {
+                _each_row<_Components...>(
+                    count, entities, columns, callback, std::index_sequence_for<_Components...>{}
+                );
+            }
+        );
+    }
+
+    KArchetypeStats get_stats() const;
+    void clear();
+
+  private:
+    struct KArchetypeColumn
+    {
+        std::uint64_t type = 0;
+        std::uint32_t size = 0;
+        std::uint32_t offset = 0;
+    };
+
+    struct KChunk
+    {
+        // Starts with the rows' entities, the columns follow
+        std::unique_ptr<std::uint8_t[]> data = {};
+        std::uint32_t count = 0;
+    };
+
+    struct KArchetype
+    {
+        // Sorted, columns are in the same order
+        std::vector<std::uint64_t> types = {};
+        std::vector<KArchetypeColumn> columns = {};
+        std::uint32_t capacity = 0;
+        std::vector<KChunk> chunks = {};
+        // Archetypes one component away, so moving an entity doesn't look its new set up
+        std::unordered_map<std::uint64_t, std::uint32_t> add_edges = {};
+        std::unordered_map<std::uint64_t, std::uint32_t> remove_edges = {};
+    };
+
+    struct KEntityLocation
+    {
+        std::uint32_t archetype = 0;
+        std::uint32_t chunk = 0;
+        std::uint32_t row = 0;
+        bool alive = false;
+    };
+
+    struct KQuery
+    {
+        std::vector<std::uint64_t> types = {};
+        std::vector<std::uint32_t> archetypes = {};
+        // Archetypes are never removed, only the ones added since need to be matched
+        std::size_t matched_count = 0;
+    };
+
+    template<typename... _Components, typename _Callback, std::size_t... _Indices>
+    static inline void _each_row(
+        std::uint32_t count, const ecs::Entity* entities, std::uint8_t* const* columns,
+        _Callback& callback, std::index_sequence<_Indices...>
+    )
+    {
+        for (std::uint32_t row = 0; row < count; row++)
+            callback(entities[row], reinterpret_cast<_Components*>(columns[_Indices])[row]...);
+    }
+
+    std::uint32_t _get_archetype(const std::vector<std::uint64_t>& types);
+    std::uint32_t _find_column(const KArchetype& archetype, std::uint64_t type) const;
+    const std::vector<std::uint32_t>& _match(const std::vector<std::uint64_t>& types);
+    void _push_row(std::uint32_t archetype, ecs::Entity entity);
+    void _pop_row(ecs::Entity entity);
+    void _move(ecs::Entity entity, std::uint32_t archetype);
+    inline std::uint8_t* _cell(
+        const KArchetype& archetype, const KEntityLocation& location, std::uint32_t column
+    ) const
+    {
+        const KArchetypeColumn& archetype_column = archetype.columns[column];
+        return archetype.chunks[location.chunk].data.get() + archetype_column.offset +
+               static_cast<std::size_t>(location.row) * archetype_column.size;
+    }
+
+  private:
+    std::vector<KArchetype> m_archetypes = {};
+    std::map<std::vector<std::uint64_t>, std::uint32_t> m_archetype_indices = {};
+    std::unordered_map<std::uint64_t, std::uint32_t> m_type_sizes = {};
+    std::unordered_map<std::uint64_t, KQuery> m_queries = {};
+
+    std::vector<KEntityLocation> m_locations = {};
+    std::vector<ecs::Entity> m_free_entities = {};
+    std::size_t m_entity_count = 0;
+};
+
+#endif
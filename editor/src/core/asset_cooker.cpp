@@ -0,0 +1,179 @@
+#include "core/asset_cooker.hpp"
+#include "core/asset_index.hpp"
+#include "core/project.hpp"
+
+#include <kryos/core/debug.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <filesystem>
+#include <thread>
+
+KLAssetCooker* KLAssetCooker::m_Instance = nullptr;
+
+KLAssetCooker::KLAssetCooker()
+{
+    assert(
+        m_Instance == nullptr && "AssetCooker::AssetCooker() -> cannot created multiple asset "
+                                 "cooker application layers"
+    );
+
+    m_Instance = this;
+}
+
+KLAssetCooker::~KLAssetCooker() { _wait_for_batch(); }
+
+void KLAssetCooker::on_update()
+{
+    const std::string& root_path = KLProject::get()->get_root_path();
+    if (root_path != m_root_path)
+        _open(root_path);
+
+    if (m_batch_running && m_batch_remaining.load(std::memory_order_acquire) == 0)
+        _finish_batch();
+
+    // Only finished scans are looked at, a partial one would make every mesh it hasn't reached
+    // yet look deleted
+    KLAssetIndex* asset_index = KLAssetIndex::get();
+    if (m_batch_running || !m_cache.is_open() || asset_index->scanning() ||
+        asset_index->get_version() == m_index_version)
+        return;
+
+    m_index_version = asset_index->get_version();
+    _start_batch();
+}
+
+void KLAssetCooker::_open(const std::string& root_path)
+{
+    _wait_for_batch();
+    m_batch.clear();
+    m_batch_running = false;
+    m_cooked.clear();
+    m_index_version = 0;
+    m_cache.close();
+
+    m_root_path = root_path;
+    if (m_root_path.empty())
+        return;
+
+    const char* shared_directory = std::getenv("KRYOS_DERIVED_DATA_PATH");
+    std::string directory = shared_directory != nullptr && shared_directory[0] != '\0'
+                                ? std::string(shared_directory)
+                                : m_root_path + "/.kryos/derived_data";
+    m_cache.open(directory, default_cache_size);
+}
+
+void KLAssetCooker::_wait_for_batch()
+{
+    // Jobs reference the batch, it can't be dropped while they are still running
+    while (m_batch_running && m_batch_remaining.load(std::memory_order_acquire) > 0)
+        std::this_thread::yield();
+}
+
+void KLAssetCooker::_start_batch()
+{
+    std::shared_ptr<const KAssetSnapshot> snapshot = KLAssetIndex::get()->get_snapshot();
+    if (snapshot == nullptr)
+        return;
+
+    m_batch.clear();
+    for (const KAssetEntry& entry : snapshot->entries)
+    {
+        std::string extension = std::filesystem::path(entry.path).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        bool mesh = entry.type == KEAssetType_Model && extension == ".obj";
+        bool texture =
+            entry.type == KEAssetType_Texture && (extension == ".png" || extension == ".tga");
+        if (!mesh && !texture)
+            continue;
+
+        auto it = m_cooked.find(entry.path);
+        if (it != m_cooked.end() && it->second.size == entry.size &&
+            it->second.modified_time == entry.modified_time)
+            continue;
+
+        KCookJob job = {};
+        job.path = entry.path;
+        job.size = entry.size;
+        job.modified_time = entry.modified_time;
+        job.texture = texture;
+        m_batch.push_back(std::move(job));
+    }
+
+    if (m_batch.empty())
+        return;
+
+    if (m_workers == nullptr)
+        m_workers = std::make_unique<KWorkerPool>();
+
+    m_batch_running = true;
+    m_batch_start = std::chrono::steady_clock::now();
+    m_batch_remaining.store(m_batch.size(), std::memory_order_release);
+
+    // Batches are usually many small files, textures are parallel across files rather than
+    // across their blocks
+    std::filesystem::path root = std::filesystem::path(m_root_path);
+    for (std::size_t i = 0; i < m_batch.size(); i++)
+    {
+        m_workers->push(
+            [this, i, root]()
+            {
+                KCookJob& job = m_batch[i];
+                std::filesystem::path filename = root / ".kryos/cooked" / job.path;
+                if (job.texture)
+                    job.succeeded = KTextureCooker::cook_file(
+                        (root / job.path).string(), filename.replace_extension(".ktex").string(),
+                        m_texture_settings, &job.texture_stats, &m_cache
+                    );
+                else
+                    job.succeeded = KMeshCooker::cook_file(
+                        (root / job.path).string(), filename.replace_extension(".kmesh").string(),
+                        m_settings, &job.stats, &m_cache
+                    );
+                m_batch_remaining.fetch_sub(1, std::memory_order_acq_rel);
+            }
+        );
+    }
+}
+
+void KLAssetCooker::_finish_batch()
+{
+    std::size_t cooked = 0;
+    std::size_t cached = 0;
+    for (const KCookJob& job : m_batch)
+    {
+        if (!job.succeeded)
+        {
+            KLDebug::log(
+                "AssetCooker::_finish_batch() -> failed to cook '" + job.path + "'",
+                KEDebugType_Warning
+            );
+            continue;
+        }
+
+        if (job.texture && job.texture_stats.psnr < min_texture_psnr)
+            KLDebug::log(
+                "AssetCooker::_finish_batch() -> '" + job.path + "' lost a lot of quality when " +
+                    "compressed (" + std::to_string(job.texture_stats.psnr) + "dB PSNR)",
+                KEDebugType_Warning
+            );
+
+        m_cooked[job.path] = KCookedSource{job.size, job.modified_time};
+        cached += job.stats.cache_hit || job.texture_stats.cache_hit ? 1 : 0;
+        cooked++;
+    }
+
+    m_batch.clear();
+    m_batch_running = false;
+    m_cooked_count += cooked;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    m_last_batch_time = std::chrono::duration<double, std::milli>(now - m_batch_start).count();
+
+    if (cooked > 0)
+        KLDebug::log(
+            "Cooked " + std::to_string(cooked) + " assets (" + std::to_string(cached) +
+                " from the derived data cache) in " + std::to_string(m_last_batch_time) + "ms",
+            KEDebugType_Message
+        );
+}
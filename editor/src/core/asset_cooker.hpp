@@ -0,0 +1,93 @@
+#ifndef __KRYOS_EDITOR_CORE_ASSET_COOKER_HPP__
+#define __KRYOS_EDITOR_CORE_ASSET_COOKER_HPP__
+
+#include "core/derived_data_cache.hpp"
+#include "core/mesh_cooker.hpp"
+#include "core/texture_cooker.hpp"
+#include "core/worker_pool.hpp"
+
+#include <kryos/core/application_layer.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Keeps the cooked versions of the project's source meshes and textures up to date. Whenever the
+// asset index publishes a finished scan, every source whose size or modified time changed is
+// cooked on a worker pool through the derived data cache, so opening a project only parses what
+// actually changed.
+// The cache lives in <root>/.kryos/derived_data unless KRYOS_DERIVED_DATA_PATH points at a
+// directory shared between projects
+class KLAssetCooker : public KIApplicationLayer
+{
+  public:
+    inline static KLAssetCooker* get() { return m_Instance; }
+    static constexpr std::uint64_t default_cache_size = 2048ull * 1024 * 1024;
+    // Textures cooked below this are still used but reported
+    static constexpr float min_texture_psnr = 30.0f;
+
+  public:
+    KLAssetCooker();
+    virtual ~KLAssetCooker() override;
+
+    inline const KDerivedDataCache& get_cache() const { return m_cache; }
+    inline std::size_t get_cooked_count() const { return m_cooked_count; }
+    inline std::size_t get_pending_count() const
+    {
+        return m_batch_remaining.load(std::memory_order_acquire);
+    }
+    // Milliseconds the last batch took from being queued to finishing
+    inline double get_last_batch_time() const { return m_last_batch_time; }
+
+    virtual void on_update() override;
+
+  private:
+    struct KCookJob
+    {
+        std::string path = {};
+        std::uint64_t size = 0;
+        std::int64_t modified_time = 0;
+        bool texture = false;
+        KCookStats stats = {};
+        KTextureCookStats texture_stats = {};
+        bool succeeded = false;
+    };
+
+    struct KCookedSource
+    {
+        std::uint64_t size = 0;
+        std::int64_t modified_time = 0;
+    };
+
+    static KLAssetCooker* m_Instance;
+
+  private:
+    void _open(const std::string& root_path);
+    void _wait_for_batch();
+    void _start_batch();
+    void _finish_batch();
+
+  private:
+    std::string m_root_path = {};
+    KDerivedDataCache m_cache = {};
+    KMeshCookSettings m_settings = {};
+    KTextureCookSettings m_texture_settings = {};
+    std::unique_ptr<KWorkerPool> m_workers = nullptr;
+
+    std::uint64_t m_index_version = 0;
+    // Relative path of every source last cooked successfully
+    std::unordered_map<std::string, KCookedSource> m_cooked = {};
+
+    std::vector<KCookJob> m_batch = {};
+    std::atomic<std::size_t> m_batch_remaining = 0;
+    bool m_batch_running = false;
+    std::chrono::steady_clock::time_point m_batch_start = {};
+
+    std::size_t m_cooked_count = 0;
+    double m_last_batch_time = 0.0;
+};
+
+#endif
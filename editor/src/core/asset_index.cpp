@@ -0,0 +1,427 @@
+#include "core/asset_index.hpp"
+#include "core/project.hpp"
+
+#include <kryos/core/debug.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+static constexpr std::uint32_t asset_index_magic = 0x5849414b; // "KAIX"
+// Bumped when an extension maps to a different type, cached entries keep the type they had
+static constexpr std::uint32_t asset_index_version = 2;
+
+template<typename _Type>
+static void write_value(std::ofstream& file, const _Type& value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(_Type));
+}
+
+static void write_string(std::ofstream& file, const std::string& value)
+{
+    write_value(file, static_cast<std::uint32_t>(value.size()));
+    file.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+template<typename _Type>
+static bool read_value(std::ifstream& file, _Type& value)
+{
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(_Type)));
+}
+
+static bool read_string(std::ifstream& file, std::string& value)
+{
+    std::uint32_t size = 0;
+    if (!read_value(file, size) || size > 4096)
+        return false;
+
+    value.resize(size);
+    return static_cast<bool>(file.read(value.data(), static_cast<std::streamsize>(size)));
+}
+
+KLAssetIndex* KLAssetIndex::m_Instance = nullptr;
+
+KEAssetType KLAssetIndex::type_from_extension(const std::string& extension)
+{
+    static const std::unordered_map<std::string, KEAssetType> types = {
+        {".kryosproject", KEAssetType_Project},
+        {".oproject", KEAssetType_Project},
+        {".oscene", KEAssetType_Scene},
+        {".obj", KEAssetType_Model},
+        {".fbx", KEAssetType_Model},
+        {".gltf", KEAssetType_Model},
+        {".glb", KEAssetType_Model},
+        {".dae", KEAssetType_Model},
+        {".png", KEAssetType_Texture},
+        {".jpg", KEAssetType_Texture},
+        {".jpeg", KEAssetType_Texture},
+        {".tga", KEAssetType_Texture},
+        {".bmp", KEAssetType_Texture},
+        {".hdr", KEAssetType_Texture},
+        {".glsl", KEAssetType_Shader},
+        {".vert", KEAssetType_Shader},
+        {".frag", KEAssetType_Shader},
+        {".wav", KEAssetType_Audio},
+        {".ogg", KEAssetType_Audio},
+        {".mp3", KEAssetType_Audio},
+        {".ttf", KEAssetType_Font},
+        {".otf", KEAssetType_Font},
+        {".kprefab", KEAssetType_Prefab},
+    };
+
+    std::string lower = extension;
+    std::transform(
+        lower.begin(), lower.end(), lower.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); }
+    );
+
+    auto it = types.find(lower);
+    if (it == types.end())
+        return KEAssetType_Unknown;
+    return it->second;
+}
+
+const char* KLAssetIndex::get_type_name(KEAssetType type)
+{
+    switch (type)
+    {
+    case KEAssetType_Directory:
+        return "Directory";
+    case KEAssetType_Project:
+        return "Project";
+    case KEAssetType_Scene:
+        return "Scene";
+    case KEAssetType_Model:
+        return "Model";
+    case KEAssetType_Texture:
+        return "Texture";
+    case KEAssetType_Shader:
+        return "Shader";
+    case KEAssetType_Audio:
+        return "Audio";
+    case KEAssetType_Font:
+        return "Font";
+    case KEAssetType_Prefab:
+        return "Prefab";
+    default:
+        return "Unknown";
+    }
+}
+
+KLAssetIndex::KLAssetIndex()
+{
+    assert(
+        m_Instance == nullptr && "AssetIndex::AssetIndex() -> cannot created multiple asset "
+                                 "index application layers"
+    );
+
+    m_Instance = this;
+}
+
+KLAssetIndex::~KLAssetIndex() { _stop_scan(); }
+
+std::shared_ptr<const KAssetSnapshot> KLAssetIndex::get_snapshot() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_snapshot;
+}
+
+void KLAssetIndex::on_update()
+{
+    // Logging isn't done from the scan thread
+    if (m_save_failed.exchange(false))
+        KLDebug::log(
+            "AssetIndex::on_update() -> failed to write asset index '" +
+                _index_filename(m_root_path) + "'",
+            KEDebugType_Warning
+        );
+
+    const std::string& root_path = KLProject::get()->get_root_path();
+    if (root_path != m_root_path)
+        _open(root_path);
+    else if (m_rescan_queued && !m_scanning)
+        rescan();
+}
+
+void KLAssetIndex::rescan(const std::vector<std::string>& changed_paths)
+{
+    if (m_root_path.empty())
+        return;
+
+    for (const std::string& path : changed_paths)
+    {
+        std::size_t separator = path.find_last_of('/');
+        m_dirty_directories.insert(
+            separator == std::string::npos ? "" : path.substr(0, separator)
+        );
+    }
+
+    // Restarting would throw away the progress of the running scan, so queue it up instead
+    if (m_scanning)
+    {
+        m_rescan_queued = true;
+        return;
+    }
+
+    _stop_scan();
+
+    std::unordered_set<std::string> dirty_directories = {};
+    dirty_directories.swap(m_dirty_directories);
+    m_rescan_queued = false;
+
+    m_scanning = true;
+    m_scanned_count = 0;
+    m_thread = std::thread(
+        &KLAssetIndex::_scan, this, m_root_path, get_snapshot(), std::move(dirty_directories)
+    );
+}
+
+void KLAssetIndex::_open(const std::string& root_path)
+{
+    _stop_scan();
+    _publish(nullptr);
+    m_dirty_directories.clear();
+    m_rescan_queued = false;
+
+    // The persisted index is loaded by the scan itself so opening never waits on the disk
+    m_root_path = root_path;
+    rescan();
+}
+
+void KLAssetIndex::_stop_scan()
+{
+    if (!m_thread.joinable())
+        return;
+
+    m_cancel = true;
+    m_thread.join();
+    m_cancel = false;
+    m_scanning = false;
+}
+
+void KLAssetIndex::_publish(std::shared_ptr<const KAssetSnapshot> snapshot)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_snapshot = std::move(snapshot);
+    m_version++;
+}
+
+void KLAssetIndex::_scan(
+    std::string root_path, std::shared_ptr<const KAssetSnapshot> previous,
+    std::unordered_set<std::string> dirty_directories
+)
+{
+    namespace fs = std::filesystem;
+
+    std::string index_filename = _index_filename(root_path);
+    if (previous == nullptr)
+    {
+        previous = _load(index_filename);
+        if (previous != nullptr)
+            _publish(previous);
+    }
+
+    std::unordered_map<std::string, const KAssetDirectory*> previous_directories = {};
+    if (previous != nullptr)
+    {
+        previous_directories.reserve(previous->directories.size());
+        for (const KAssetDirectory& directory : previous->directories)
+            previous_directories.emplace(directory.path, &directory);
+    }
+
+    std::shared_ptr<KAssetSnapshot> snapshot = std::make_shared<KAssetSnapshot>();
+    if (previous != nullptr)
+    {
+        snapshot->entries.reserve(previous->entries.size());
+        snapshot->directories.reserve(previous->directories.size());
+    }
+
+    std::vector<std::string> stack = {""};
+    while (!stack.empty())
+    {
+        if (m_cancel)
+            return;
+
+        std::string relative_path = std::move(stack.back());
+        stack.pop_back();
+
+        std::error_code error = {};
+        fs::path absolute_path = fs::path(root_path) / relative_path;
+        fs::file_time_type directory_time = fs::last_write_time(absolute_path, error);
+        if (error)
+            continue;
+
+        KAssetDirectory directory = {};
+        directory.path = relative_path;
+        directory.modified_time = directory_time.time_since_epoch().count();
+        directory.first_entry = static_cast<std::uint32_t>(snapshot->entries.size());
+
+        // A directory's modified time only changes when entries are added, removed or renamed,
+        // edits to a file's contents are reported by the file watcher as dirty directories
+        auto it = previous_directories.find(relative_path);
+        if (it != previous_directories.end() &&
+            it->second->modified_time == directory.modified_time &&
+            dirty_directories.count(relative_path) == 0)
+        {
+            auto first = previous->entries.begin() + it->second->first_entry;
+            snapshot->entries.insert(
+                snapshot->entries.end(), first, first + it->second->entry_count
+            );
+        }
+        else
+        {
+            fs::directory_iterator iterator = fs::directory_iterator(
+                absolute_path, fs::directory_options::skip_permission_denied, error
+            );
+            for (; !error && iterator != fs::directory_iterator(); iterator.increment(error))
+            {
+                std::string name = iterator->path().filename().string();
+                // Hidden files, which includes the persisted index itself
+                if (name.empty() || name[0] == '.')
+                    continue;
+
+                KAssetEntry entry = {};
+                entry.path = relative_path.empty() ? name : relative_path + "/" + name;
+                entry.name_offset = static_cast<std::uint32_t>(entry.path.size() - name.size());
+
+                std::error_code entry_error = {};
+                if (iterator->is_directory(entry_error))
+                    entry.type = KEAssetType_Directory;
+                else
+                {
+                    entry.type = type_from_extension(iterator->path().extension().string());
+                    entry.size = iterator->file_size(entry_error);
+                }
+                entry.modified_time =
+                    iterator->last_write_time(entry_error).time_since_epoch().count();
+
+                snapshot->entries.push_back(std::move(entry));
+            }
+
+            std::sort(
+                snapshot->entries.begin() + directory.first_entry, snapshot->entries.end(),
+                [](const KAssetEntry& lhs, const KAssetEntry& rhs)
+                {
+                    bool lhs_directory = lhs.type == KEAssetType_Directory;
+                    bool rhs_directory = rhs.type == KEAssetType_Directory;
+                    if (lhs_directory != rhs_directory)
+                        return lhs_directory;
+                    return lhs.path < rhs.path;
+                }
+            );
+        }
+
+        directory.entry_count =
+            static_cast<std::uint32_t>(snapshot->entries.size() - directory.first_entry);
+        for (std::size_t i = directory.first_entry; i < snapshot->entries.size(); i++)
+        {
+            if (snapshot->entries[i].type == KEAssetType_Directory)
+                stack.push_back(snapshot->entries[i].path);
+        }
+
+        snapshot->directories.push_back(std::move(directory));
+        m_scanned_count = snapshot->entries.size();
+    }
+
+    _publish(snapshot);
+    m_save_failed = !_save(index_filename, *snapshot);
+    m_scanning = false;
+}
+
+std::string KLAssetIndex::_index_filename(const std::string& root_path) const
+{
+    return (std::filesystem::path(root_path) / ".kryos" / "asset_index").string();
+}
+
+std::shared_ptr<const KAssetSnapshot> KLAssetIndex::_load(const std::string& filename) const
+{
+    std::ifstream file = std::ifstream(filename, std::ios::binary);
+    if (!file.is_open())
+        return nullptr;
+
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    std::uint32_t directory_count = 0;
+    std::uint32_t entry_count = 0;
+    if (!read_value(file, magic) || !read_value(file, version) ||
+        !read_value(file, directory_count) || !read_value(file, entry_count) ||
+        magic != asset_index_magic || version != asset_index_version)
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<KAssetSnapshot> snapshot = std::make_shared<KAssetSnapshot>();
+    snapshot->directories.resize(directory_count);
+    snapshot->entries.resize(entry_count);
+
+    for (KAssetDirectory& directory : snapshot->directories)
+    {
+        if (!read_string(file, directory.path) || !read_value(file, directory.modified_time) ||
+            !read_value(file, directory.first_entry) || !read_value(file, directory.entry_count) ||
+            static_cast<std::uint64_t>(directory.first_entry) + directory.entry_count > entry_count)
+        {
+            return nullptr;
+        }
+    }
+
+    for (KAssetEntry& entry : snapshot->entries)
+    {
+        std::uint8_t type = 0;
+        if (!read_string(file, entry.path) || !read_value(file, entry.name_offset) ||
+            !read_value(file, entry.size) || !read_value(file, entry.modified_time) ||
+            !read_value(file, type) || entry.name_offset > entry.path.size() ||
+            type >= KEAssetType_Count)
+        {
+            return nullptr;
+        }
+
+        entry.type = static_cast<KEAssetType>(type);
+    }
+
+    return snapshot;
+}
+
+bool KLAssetIndex::_save(const std::string& filename, const KAssetSnapshot& snapshot) const
+{
+    std::error_code error = {};
+    std::filesystem::create_directories(std::filesystem::path(filename).parent_path(), error);
+
+    // Written next to the index and renamed over it so a crash never leaves a half written file
+    std::string temporary_filename = filename + ".tmp";
+    {
+        std::ofstream file = std::ofstream(temporary_filename, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+
+        write_value(file, asset_index_magic);
+        write_value(file, asset_index_version);
+        write_value(file, static_cast<std::uint32_t>(snapshot.directories.size()));
+        write_value(file, static_cast<std::uint32_t>(snapshot.entries.size()));
+
+        for (const KAssetDirectory& directory : snapshot.directories)
+        {
+            write_string(file, directory.path);
+            write_value(file, directory.modified_time);
+            write_value(file, directory.first_entry);
+            write_value(file, directory.entry_count);
+        }
+
+        for (const KAssetEntry& entry : snapshot.entries)
+        {
+            write_string(file, entry.path);
+            write_value(file, entry.name_offset);
+            write_value(file, entry.size);
+            write_value(file, entry.modified_time);
+            write_value(file, static_cast<std::uint8_t>(entry.type));
+        }
+
+        if (!file.good())
+            return false;
+    }
+
+    std::filesystem::rename(temporary_filename, filename, error);
+    return !error;
+}
@@ -0,0 +1,114 @@
+#ifndef __KRYOS_EDITOR_CORE_ASSET_INDEX_HPP__
+#define __KRYOS_EDITOR_CORE_ASSET_INDEX_HPP__
+
+#include <kryos/core/application_layer.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+enum KEAssetType : std::uint8_t
+{
+    KEAssetType_Unknown,
+    KEAssetType_Directory,
+    KEAssetType_Project,
+    KEAssetType_Scene,
+    KEAssetType_Model,
+    KEAssetType_Texture,
+    KEAssetType_Shader,
+    KEAssetType_Audio,
+    KEAssetType_Font,
+    KEAssetType_Prefab,
+    KEAssetType_Count,
+};
+
+struct KAssetEntry
+{
+    // Relative to the project root, always separated by '/'
+    std::string path = {};
+    std::uint32_t name_offset = 0;
+    std::uint64_t size = 0;
+    std::int64_t modified_time = 0;
+    KEAssetType type = KEAssetType_Unknown;
+
+    inline const char* get_name() const { return path.c_str() + name_offset; }
+};
+
+// The entries of a directory (files and subdirectories) are stored next to each other, so a
+// directory whose modified time hasn't changed can be copied over from the last scan as a range
+struct KAssetDirectory
+{
+    std::string path = {};
+    std::int64_t modified_time = 0;
+    std::uint32_t first_entry = 0;
+    std::uint32_t entry_count = 0;
+};
+
+struct KAssetSnapshot
+{
+    std::vector<KAssetEntry> entries = {};
+    std::vector<KAssetDirectory> directories = {};
+};
+
+// Index of every file under the project root. Scans run on a background thread and publish an
+// immutable snapshot when done, the last snapshot is persisted in the project so reopening it
+// only has to revisit directories whose modified time changed since
+class KLAssetIndex : public KIApplicationLayer
+{
+  public:
+    inline static KLAssetIndex* get() { return m_Instance; }
+    static KEAssetType type_from_extension(const std::string& extension);
+    static const char* get_type_name(KEAssetType type);
+
+  public:
+    KLAssetIndex();
+    virtual ~KLAssetIndex() override;
+
+    inline bool scanning() const { return m_scanning; }
+    inline std::size_t get_scanned_count() const { return m_scanned_count; }
+    inline std::uint64_t get_version() const { return m_version; }
+    std::shared_ptr<const KAssetSnapshot> get_snapshot() const;
+
+    virtual void on_update() override;
+
+    // Paths are relative to the project root, their directories are relisted even when their
+    // modified time didn't change so edited files get their size and time updated
+    void rescan(const std::vector<std::string>& changed_paths = {});
+
+  private:
+    static KLAssetIndex* m_Instance;
+
+  private:
+    void _open(const std::string& root_path);
+    void _stop_scan();
+    void _publish(std::shared_ptr<const KAssetSnapshot> snapshot);
+    void _scan(
+        std::string root_path, std::shared_ptr<const KAssetSnapshot> previous,
+        std::unordered_set<std::string> dirty_directories
+    );
+    std::string _index_filename(const std::string& root_path) const;
+    std::shared_ptr<const KAssetSnapshot> _load(const std::string& filename) const;
+    bool _save(const std::string& filename, const KAssetSnapshot& snapshot) const;
+
+  private:
+    std::string m_root_path = {};
+    std::unordered_set<std::string> m_dirty_directories = {};
+    bool m_rescan_queued = false;
+
+    mutable std::mutex m_mutex = {};
+    std::shared_ptr<const KAssetSnapshot> m_snapshot = nullptr;
+    std::atomic<std::uint64_t> m_version = 0;
+
+    std::thread m_thread = {};
+    std::atomic<bool> m_scanning = false;
+    std::atomic<bool> m_cancel = false;
+    std::atomic<std::size_t> m_scanned_count = 0;
+    std::atomic<bool> m_save_failed = false;
+};
+
+#endif
@@ -0,0 +1,409 @@
+#include "core/asset_residency.hpp"
+#include "core/project.hpp"
+#include "core/render_worker.hpp"
+#include "core/scene_changes.hpp"
+
+#include <kryos/core/debug.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <filesystem>
+#include <thread>
+
+KLAssetResidency* KLAssetResidency::m_Instance = nullptr;
+
+KAssetRef::KAssetRef(KResidentAsset* asset) : m_asset(asset)
+{
+    if (m_asset != nullptr)
+        KLAssetResidency::get()->_retain(m_asset);
+}
+
+KAssetRef::~KAssetRef() { reset(); }
+
+KAssetRef::KAssetRef(const KAssetRef& other) : KAssetRef(other.m_asset) {}
+
+KAssetRef& KAssetRef::operator=(const KAssetRef& other)
+{
+    if (this != &other)
+    {
+        // Retained before the release so assigning a reference to itself never evicts
+        KResidentAsset* asset = other.m_asset;
+        if (asset != nullptr)
+            KLAssetResidency::get()->_retain(asset);
+        reset();
+        m_asset = asset;
+    }
+    return *this;
+}
+
+KAssetRef::KAssetRef(KAssetRef&& other) noexcept : m_asset(other.m_asset)
+{
+    other.m_asset = nullptr;
+}
+
+KAssetRef& KAssetRef::operator=(KAssetRef&& other) noexcept
+{
+    if (this != &other)
+    {
+        reset();
+        m_asset = other.m_asset;
+        other.m_asset = nullptr;
+    }
+    return *this;
+}
+
+void KAssetRef::reset()
+{
+    // References outliving the layer have nothing left to release
+    if (m_asset != nullptr && KLAssetResidency::get() != nullptr)
+        KLAssetResidency::get()->_release(m_asset);
+    m_asset = nullptr;
+}
+
+KLAssetResidency::KLAssetResidency()
+{
+    assert(
+        m_Instance == nullptr && "AssetResidency::AssetResidency() -> cannot created multiple "
+                                 "asset residency application layers"
+    );
+
+    m_Instance = this;
+}
+
+KLAssetResidency::~KLAssetResidency()
+{
+    _wait();
+    for (auto& [path, asset] : m_assets)
+        _unload(*asset);
+    m_Instance = nullptr;
+}
+
+KResidencyTypeStats KLAssetResidency::get_type_stats(KEAssetType type) const
+{
+    KResidencyTypeStats stats = {};
+    for (const auto& [path, asset] : m_assets)
+    {
+        if (asset->type != type)
+            continue;
+
+        stats.asset_count++;
+        stats.referenced_count += asset->ref_count > 0 ? 1 : 0;
+        stats.loading_count += asset->load_pending ? 1 : 0;
+        stats.cpu_bytes += asset->cpu_bytes;
+        stats.gpu_bytes += asset->gpu_bytes;
+    }
+    return stats;
+}
+
+void KLAssetResidency::set_budget(std::uint64_t cpu_budget, std::uint64_t gpu_budget)
+{
+    m_cpu_budget = cpu_budget;
+    m_gpu_budget = gpu_budget;
+}
+
+KAssetRef KLAssetResidency::acquire(const std::string& path)
+{
+    auto it = m_assets.find(path);
+    if (it != m_assets.end())
+    {
+        KResidentAsset& asset = *it->second;
+        // Failed loads are retried once nothing held on to them, the source may have been cooked
+        // since
+        if (asset.state == KEResidencyState_Failed && asset.ref_count == 0 && !asset.load_pending)
+        {
+            asset.state = KEResidencyState_Loading;
+            _start_load(asset);
+        }
+        return KAssetRef(&asset);
+    }
+
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    KEAssetType type = KLAssetIndex::type_from_extension(extension);
+    bool mesh = type == KEAssetType_Model && extension == ".obj";
+    bool texture = type == KEAssetType_Texture && (extension == ".png" || extension == ".tga");
+    if (!mesh && !texture)
+        return KAssetRef();
+
+    std::unique_ptr<KResidentAsset> asset = std::make_unique<KResidentAsset>();
+    asset->path = path;
+    asset->type = type;
+
+    KResidentAsset* resident_asset = asset.get();
+    m_assets[path] = std::move(asset);
+    _start_load(*resident_asset);
+    return KAssetRef(resident_asset);
+}
+
+void KLAssetResidency::on_update()
+{
+    const std::string& root_path = KLProject::get()->get_root_path();
+    if (root_path != m_root_path)
+        _open(root_path);
+
+    // Hot reloaded sources get recooked, so every resident asset may be stale
+    std::uint64_t asset_version = KLSceneChanges::get()->get_asset_version();
+    if (asset_version != m_asset_version)
+    {
+        m_asset_version = asset_version;
+        _reload_all();
+    }
+
+    // Loads finish in the order they were started so a burst of requests streams in evenly
+    std::uint64_t uploaded = 0;
+    std::size_t finished = 0;
+    for (; finished < m_loads.size(); finished++)
+    {
+        KLoadJob& job = *m_loads[finished];
+        if (!job.done.load(std::memory_order_acquire) ||
+            (finished > 0 && uploaded >= upload_bytes_per_frame))
+            break;
+
+        _finish_load(job);
+        uploaded += job.asset->gpu_bytes;
+    }
+    m_loads.erase(m_loads.begin(), m_loads.begin() + static_cast<std::ptrdiff_t>(finished));
+
+    _evict();
+}
+
+void KLAssetResidency::_retain(KResidentAsset* asset)
+{
+    if (asset->ref_count++ == 0 && asset->in_lru)
+    {
+        m_lru.erase(asset->lru);
+        asset->in_lru = false;
+    }
+}
+
+void KLAssetResidency::_release(KResidentAsset* asset)
+{
+    assert(asset->ref_count > 0 && "AssetResidency::_release() -> asset is not referenced");
+
+    // Eviction waits for the next update, an asset dropped and acquired again within a frame
+    // doesn't have to stream back in
+    if (--asset->ref_count == 0)
+    {
+        m_lru.push_front(asset);
+        asset->lru = m_lru.begin();
+        asset->in_lru = true;
+    }
+}
+
+void KLAssetResidency::_open(const std::string& root_path)
+{
+    m_root_path = root_path;
+    m_evicted.clear();
+    _reload_all();
+
+    // Referenced assets of the previous project must not linger when the new one doesn't have
+    // them, they fail instead
+    for (auto& [path, asset] : m_assets)
+    {
+        _unload(*asset);
+        asset->state = KEResidencyState_Loading;
+    }
+}
+
+void KLAssetResidency::_start_load(KResidentAsset& asset)
+{
+    if (asset.load_pending || m_root_path.empty())
+    {
+        if (m_root_path.empty())
+            asset.state = KEResidencyState_Failed;
+        return;
+    }
+
+    std::filesystem::path filename = std::filesystem::path(m_root_path) / ".kryos/cooked";
+    filename /= asset.path;
+    filename.replace_extension(asset.type == KEAssetType_Model ? ".kmesh" : ".ktex");
+
+    std::unique_ptr<KLoadJob> job = std::make_unique<KLoadJob>();
+    job->asset = &asset;
+    job->filename = filename.string();
+    asset.load_pending = true;
+
+    if (m_evicted.erase(asset.path) > 0)
+        m_reload_count++;
+
+    if (m_workers == nullptr)
+        m_workers = std::make_unique<KWorkerPool>(2);
+
+    KLoadJob* load_job = job.get();
+    bool mesh = asset.type == KEAssetType_Model;
+    m_workers->push(
+        [load_job, mesh]()
+        {
+            const std::uint8_t* data = nullptr;
+            std::size_t size = 0;
+            if (mesh)
+            {
+                load_job->mesh = std::make_unique<KCookedMesh>();
+                load_job->succeeded = load_job->mesh->open(load_job->filename);
+                if (load_job->succeeded)
+                {
+                    data = reinterpret_cast<const std::uint8_t*>(&load_job->mesh->get_header());
+                    size = load_job->mesh->get_mapped_size();
+                }
+            }
+            else
+            {
+                load_job->texture = std::make_unique<KCookedTexture>();
+                load_job->succeeded = load_job->texture->open(load_job->filename);
+                if (load_job->succeeded)
+                {
+                    data = reinterpret_cast<const std::uint8_t*>(&load_job->texture->get_header());
+                    size = load_job->texture->get_mapped_size();
+                }
+            }
+
+            // Touching every page here moves the disk reads off the main thread, the upload then
+            // only copies memory
+            std::uint8_t sum = 0;
+            for (std::size_t offset = 0; offset < size; offset += 4096)
+                sum += data[offset];
+            load_job->page_sum = sum;
+
+            load_job->done.store(true, std::memory_order_release);
+        }
+    );
+    m_loads.push_back(std::move(job));
+}
+
+void KLAssetResidency::_finish_load(KLoadJob& job)
+{
+    KResidentAsset& asset = *job.asset;
+    asset.load_pending = false;
+    m_load_count++;
+
+    if (!job.succeeded)
+    {
+        // A stale copy is better than nothing until the source cooks again
+        if (asset.state != KEResidencyState_Resident)
+            asset.state = KEResidencyState_Failed;
+        return;
+    }
+
+    // Reloads replace the old data only once the new data is ready
+    _unload(asset);
+
+    if (job.mesh != nullptr)
+    {
+        const KMeshFileHeader& header = job.mesh->get_header();
+        asset.mesh_buffers = job.mesh->upload();
+        asset.gpu_bytes = static_cast<std::uint64_t>(header.vertex_count) * sizeof(KPackedVertex) +
+                          static_cast<std::uint64_t>(header.index_count) * header.index_size;
+        asset.cpu_bytes = job.mesh->get_mapped_size();
+        asset.mesh = std::move(job.mesh);
+    }
+    else
+    {
+        const KTextureFileHeader& header = job.texture->get_header();
+        asset.texture = job.texture->upload();
+        asset.texture_width = header.width;
+        asset.texture_height = header.height;
+        for (std::uint32_t mip = 0; mip < header.mip_count; mip++)
+            asset.gpu_bytes += header.mips[mip].size;
+        job.texture->close();
+    }
+
+    asset.state = KEResidencyState_Resident;
+    m_cpu_bytes += asset.cpu_bytes;
+    m_gpu_bytes += asset.gpu_bytes;
+}
+
+void KLAssetResidency::_unload(KResidentAsset& asset)
+{
+    if (asset.mesh_buffers.vertex_array != 0)
+    {
+        glDeleteVertexArrays(1, &asset.mesh_buffers.vertex_array);
+        glDeleteBuffers(1, &asset.mesh_buffers.vertex_buffer);
+        glDeleteBuffers(1, &asset.mesh_buffers.index_buffer);
+    }
+    if (asset.texture != 0)
+        glDeleteTextures(1, &asset.texture);
+
+    m_cpu_bytes -= asset.cpu_bytes;
+    m_gpu_bytes -= asset.gpu_bytes;
+    asset.mesh = nullptr;
+    asset.mesh_buffers = {};
+    asset.texture = 0;
+    asset.cpu_bytes = 0;
+    asset.gpu_bytes = 0;
+}
+
+void KLAssetResidency::_evict()
+{
+    auto over_budget = [this]()
+    { return m_cpu_bytes > m_cpu_budget || m_gpu_bytes > m_gpu_budget; };
+
+    auto it = m_lru.end();
+    bool drained = false;
+    while (over_budget() && it != m_lru.begin())
+    {
+        --it;
+        KResidentAsset* asset = *it;
+        // Loading jobs still point at the asset
+        if (asset->load_pending)
+            continue;
+
+        // Frames recorded on the render worker can still point at what's unloaded here
+        if (!drained)
+        {
+            KRenderWorker::drain_all();
+            drained = true;
+        }
+
+        it = m_lru.erase(it);
+        _unload(*asset);
+        m_evicted.insert(asset->path);
+        m_eviction_count++;
+        m_assets.erase(asset->path);
+    }
+
+    bool was_over_budget = m_over_budget;
+    m_over_budget = over_budget();
+    if (m_over_budget && !was_over_budget)
+        KLDebug::log(
+            "AssetResidency::_evict() -> referenced assets need " +
+                std::to_string(m_cpu_bytes / 1024) + " KiB of memory and " +
+                std::to_string(m_gpu_bytes / 1024) + " KiB of video memory, more than the " +
+                "budget allows",
+            KEDebugType_Warning
+        );
+}
+
+void KLAssetResidency::_reload_all()
+{
+    // Jobs already running would finish with the old files, they are waited for and ignored
+    _wait();
+    KRenderWorker::drain_all();
+    for (std::unique_ptr<KLoadJob>& job : m_loads)
+        job->asset->load_pending = false;
+    m_loads.clear();
+
+    for (auto it = m_assets.begin(); it != m_assets.end();)
+    {
+        KResidentAsset& asset = *it->second;
+        if (asset.ref_count > 0)
+        {
+            _start_load(asset);
+            ++it;
+            continue;
+        }
+
+        if (asset.in_lru)
+            m_lru.erase(asset.lru);
+        _unload(asset);
+        it = m_assets.erase(it);
+    }
+}
+
+void KLAssetResidency::_wait()
+{
+    for (std::unique_ptr<KLoadJob>& job : m_loads)
+    {
+        while (!job->done.load(std::memory_order_acquire))
+            std::this_thread::yield();
+    }
+}
@@ -0,0 +1,183 @@
+#ifndef __KRYOS_EDITOR_CORE_ASSET_RESIDENCY_HPP__
+#define __KRYOS_EDITOR_CORE_ASSET_RESIDENCY_HPP__
+
+#include "core/asset_index.hpp"
+#include "core/cooked_mesh.hpp"
+#include "core/cooked_texture.hpp"
+#include "core/worker_pool.hpp"
+
+#include <kryos/core/application_layer.hpp>
+
+#include <glad/glad.h>
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+enum KEResidencyState
+{
+    KEResidencyState_Loading,
+    KEResidencyState_Resident,
+    KEResidencyState_Failed,
+};
+
+struct KResidentAsset
+{
+    // Relative to the project root, same as the asset index
+    std::string path = {};
+    KEAssetType type = KEAssetType_Unknown;
+    KEResidencyState state = KEResidencyState_Loading;
+    std::size_t ref_count = 0;
+    bool load_pending = false;
+
+    std::uint64_t cpu_bytes = 0;
+    std::uint64_t gpu_bytes = 0;
+
+    // Meshes keep their mapping so the vertices can still be read on the CPU, textures drop it
+    // once uploaded
+    std::unique_ptr<KCookedMesh> mesh = nullptr;
+    KCookedMeshBuffers mesh_buffers = {};
+    GLuint texture = 0;
+    std::uint32_t texture_width = 0;
+    std::uint32_t texture_height = 0;
+
+    // Position in the eviction order while nothing references the asset
+    std::list<KResidentAsset*>::iterator lru = {};
+    bool in_lru = false;
+};
+
+struct KResidencyTypeStats
+{
+    std::size_t asset_count = 0;
+    std::size_t referenced_count = 0;
+    std::size_t loading_count = 0;
+    std::uint64_t cpu_bytes = 0;
+    std::uint64_t gpu_bytes = 0;
+};
+
+// Counted reference to a cooked asset kept resident by KLAssetResidency. The asset is never
+// evicted while a reference to it exists, it may still be streaming in though. Only meant to be
+// used from the main thread
+class KAssetRef
+{
+  public:
+    KAssetRef() = default;
+    ~KAssetRef();
+
+    KAssetRef(const KAssetRef& other);
+    KAssetRef& operator=(const KAssetRef& other);
+    KAssetRef(KAssetRef&& other) noexcept;
+    KAssetRef& operator=(KAssetRef&& other) noexcept;
+
+    inline bool is_valid() const { return m_asset != nullptr; }
+    inline bool is_resident() const
+    {
+        return m_asset != nullptr && m_asset->state == KEResidencyState_Resident;
+    }
+    inline const KResidentAsset* get() const { return m_asset; }
+
+    void reset();
+
+  private:
+    friend class KLAssetResidency;
+    explicit KAssetRef(KResidentAsset* asset);
+
+  private:
+    KResidentAsset* m_asset = nullptr;
+};
+
+// Keeps the cooked meshes and textures that are referenced through KAssetRef loaded, within a CPU
+// and a GPU memory budget. Assets are mapped and paged in on a worker pool and uploaded on the
+// main thread a few at a time. Once nothing references an asset it stays loaded until the budget
+// is exceeded, then the least recently used unreferenced assets are evicted first and stream back
+// in if they are acquired again
+class KLAssetResidency : public KIApplicationLayer
+{
+  public:
+    inline static KLAssetResidency* get() { return m_Instance; }
+    static constexpr std::uint64_t default_cpu_budget = 256ull * 1024 * 1024;
+    static constexpr std::uint64_t default_gpu_budget = 512ull * 1024 * 1024;
+    // Uploads past this in one frame wait for the next one, at least one asset is always uploaded
+    static constexpr std::uint64_t upload_bytes_per_frame = 32ull * 1024 * 1024;
+
+  public:
+    KLAssetResidency();
+    virtual ~KLAssetResidency() override;
+
+    inline std::uint64_t get_cpu_budget() const { return m_cpu_budget; }
+    inline std::uint64_t get_gpu_budget() const { return m_gpu_budget; }
+    inline std::uint64_t get_cpu_bytes() const { return m_cpu_bytes; }
+    inline std::uint64_t get_gpu_bytes() const { return m_gpu_bytes; }
+    inline std::size_t get_asset_count() const { return m_assets.size(); }
+    inline std::size_t get_loading_count() const { return m_loads.size(); }
+    inline std::size_t get_load_count() const { return m_load_count; }
+    // Loads of assets that had been evicted before
+    inline std::size_t get_reload_count() const { return m_reload_count; }
+    inline std::size_t get_eviction_count() const { return m_eviction_count; }
+    // Referenced assets alone don't fit in the budget, nothing more can be evicted
+    inline bool is_over_budget() const { return m_over_budget; }
+    KResidencyTypeStats get_type_stats(KEAssetType type) const;
+
+    void set_budget(std::uint64_t cpu_budget, std::uint64_t gpu_budget);
+
+    // Only models and textures the asset cooker handles can be made resident, anything else
+    // returns an empty reference
+    KAssetRef acquire(const std::string& path);
+
+    virtual void on_update() override;
+
+  private:
+    struct KLoadJob
+    {
+        KResidentAsset* asset = nullptr;
+        std::string filename = {};
+        std::unique_ptr<KCookedMesh> mesh = nullptr;
+        std::unique_ptr<KCookedTexture> texture = nullptr;
+        bool succeeded = false;
+        // Keeps the page touching loop from being optimized out
+        std::uint8_t page_sum = 0;
+        std::atomic<bool> done = false;
+    };
+
+    static KLAssetResidency* m_Instance;
+    friend class KAssetRef;
+
+  private:
+    void _retain(KResidentAsset* asset);
+    void _release(KResidentAsset* asset);
+
+    void _open(const std::string& root_path);
+    void _start_load(KResidentAsset& asset);
+    void _finish_load(KLoadJob& job);
+    void _unload(KResidentAsset& asset);
+    void _evict();
+    void _reload_all();
+    void _wait();
+
+  private:
+    std::string m_root_path = {};
+    std::uint64_t m_cpu_budget = default_cpu_budget;
+    std::uint64_t m_gpu_budget = default_gpu_budget;
+    std::unique_ptr<KWorkerPool> m_workers = nullptr;
+
+    std::unordered_map<std::string, std::unique_ptr<KResidentAsset>> m_assets = {};
+    // Unreferenced assets, most recently released first
+    std::list<KResidentAsset*> m_lru = {};
+    std::vector<std::unique_ptr<KLoadJob>> m_loads = {};
+    std::unordered_set<std::string> m_evicted = {};
+    std::uint64_t m_asset_version = 0;
+
+    std::uint64_t m_cpu_bytes = 0;
+    std::uint64_t m_gpu_bytes = 0;
+    std::size_t m_load_count = 0;
+    std::size_t m_reload_count = 0;
+    std::size_t m_eviction_count = 0;
+    bool m_over_budget = false;
+};
+
+#endif
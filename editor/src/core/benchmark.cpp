@@ -0,0 +1,1697 @@
+#include "core/benchmark.hpp"
+#include "core/archetype_storage.hpp"
+#include "core/asset_residency.hpp"
+#include "core/component_columns.hpp"
+#include "core/editor_entities.hpp"
+#include "core/framebuffer_pool.hpp"
+#include "core/mapped_file.hpp"
+#include "core/member_tables.hpp"
+#include "core/pool_compaction.hpp"
+#include "core/prefabs.hpp"
+#include "core/project.hpp"
+#include "core/registry_snapshot.hpp"
+#include "core/scene_changes.hpp"
+#include "core/scene_file.hpp"
+#include "core/scene_query.hpp"
+#include "core/scene_renderer.hpp"
+#include "core/spatial_index.hpp"
+#include "core/system_graph.hpp"
+#include "utils/transform.hpp"
+
+#include <kryos/core/debug.hpp>
+#include <kryos/renderer/window.hpp>
+#include <kryos/scene/components.hpp>
+#include <kryos/scene/entity.hpp>
+#include <kryos/serialization/reflection.hpp>
+#include <kryos/serialization/serialization.hpp>
+
+#include <glad/glad.h>
+
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <limits>
+#include <memory>
+#include <random>
+#include <set>
+#include <thread>
+#include <unordered_set>
+
+typedef void (*KBenchmarkFunction)(KScene* scene, int passes, KBenchmarkReport& report);
+
+struct KBenchmarkEntry
+{
+    const char* name = nullptr;
+    const char* description = nullptr;
+    // Entities generated into the benchmark's scene unless --entities is given, 0 for benchmarks
+    // that never read the scene
+    std::size_t entity_count = 0;
+    // Chance out of 100 of a generated entity having a mesh renderer and a camera
+    int mesh_percent = 60;
+    int camera_percent = 1;
+    KBenchmarkFunction function = nullptr;
+};
+
+static std::string format_arguments(const char* format, va_list arguments)
+{
+    va_list size_arguments;
+    va_copy(size_arguments, arguments);
+    int size = std::vsnprintf(nullptr, 0, format, size_arguments);
+    va_end(size_arguments);
+    if (size <= 0)
+        return {};
+
+    std::vector<char> buffer = std::vector<char>(static_cast<std::size_t>(size) + 1);
+    std::vsnprintf(buffer.data(), buffer.size(), format, arguments);
+    return std::string(buffer.data(), static_cast<std::size_t>(size));
+}
+
+static std::string format_string(const char* format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    std::string result = format_arguments(format, arguments);
+    va_end(arguments);
+    return result;
+}
+
+// Serializing a scene is mostly this walk, the benchmark compares it against walking the member
+// tables. Both read a byte of every member they visit so neither can be optimized away
+static void walk_member_sets(
+    KLReflectionRegistry* reflection, const std::set<KMemberInfo>& members, std::byte* object,
+    std::uint64_t& sum, std::size_t& count
+)
+{
+    for (const KMemberInfo& member : members)
+    {
+        if (member.variable.get_pointer_count() > 2 ||
+            member.variable.get_flags() & KEVariableFlag_Const ||
+            member.flags & KEMemberInfoEditorFlag_Hide)
+            continue;
+
+        std::byte* value = object + member.offset;
+        sum += static_cast<std::uint8_t>(*value);
+        count++;
+        if (!member.variable.is_pointer() && !member.variable.is_array() &&
+            reflection->type_contains_members(member.variable.get_type().get_id()))
+            walk_member_sets(
+                reflection, reflection->get_members(member.variable.get_type()), value, sum, count
+            );
+    }
+}
+
+static void benchmark_reflection(KScene* scene, int passes, KBenchmarkReport& report)
+{
+    ecs::Registry& registry = scene->get_registry();
+    KLReflectionRegistry* reflection = KIApplication::get_layer<KLReflectionRegistry>();
+    KLMemberTables* tables = KLMemberTables::get();
+
+    std::vector<ecs::ObjectPool*> pools = {};
+    for (ecs::ObjectPool* pool : registry.get_pools())
+    {
+        if (tables->find(pool->get_type_hash()) != KLMemberTables::null_table)
+            pools.push_back(pool);
+    }
+
+    std::uint64_t set_sum = 0;
+    std::uint64_t table_sum = 0;
+    std::size_t component_count = 0;
+    std::size_t member_count = 0;
+    for (int pass = 0; pass < passes; pass++)
+    {
+        set_sum = 0;
+        member_count = 0;
+        report.time(
+            "member sets",
+            [&]()
+            {
+                for (ecs::Entity entity : registry.get_entities())
+                {
+                    if (entity == ECS_ENTITY_DESTROYED)
+                        continue;
+
+                    for (ecs::ObjectPool* pool : pools)
+                    {
+                        std::byte* object =
+                            reinterpret_cast<std::byte*>(pool->get_entitys_object(entity));
+                        if (object != nullptr)
+                            walk_member_sets(
+                                reflection,
+                                reflection->get_members(KTypeId(pool->get_type_hash())), object,
+                                set_sum, member_count
+                            );
+                    }
+                }
+            }
+        );
+
+        table_sum = 0;
+        component_count = 0;
+        report.time(
+            "member tables",
+            [&]()
+            {
+                for (ecs::Entity entity : registry.get_entities())
+                {
+                    if (entity == ECS_ENTITY_DESTROYED)
+                        continue;
+
+                    for (ecs::ObjectPool* pool : pools)
+                    {
+                        std::byte* object =
+                            reinterpret_cast<std::byte*>(pool->get_entitys_object(entity));
+                        if (object == nullptr)
+                            continue;
+
+                        component_count++;
+                        tables->walk(
+                            tables->find(pool->get_type_hash()), object,
+                            [&](const KMemberEntry&, std::byte* value)
+                            { table_sum += static_cast<std::uint8_t>(*value); }
+                        );
+                    }
+                }
+            }
+        );
+    }
+
+    report.add_detail("%zu components, %zu members", component_count, member_count);
+    if (set_sum != table_sum)
+        report.fail("member tables visited different members than the member sets");
+}
+
+static void benchmark_columns(KScene* scene, int passes, KBenchmarkReport& report)
+{
+    ecs::Registry& registry = scene->get_registry();
+    KLMemberTables* tables = KLMemberTables::get();
+    std::vector<ecs::Entity> entities = registry.get_entities();
+
+    for (std::uint64_t type : KComponentColumns::get_copyable_types(registry))
+    {
+        ecs::ObjectPool* pool = nullptr;
+        for (ecs::ObjectPool* registry_pool : registry.get_pools())
+        {
+            if (registry_pool->get_type_hash() == type)
+                pool = registry_pool;
+        }
+
+        const std::string& name = pool->get_name();
+        std::vector<std::uint8_t> columns = {};
+        std::vector<std::uint8_t> fields = {};
+        std::vector<KColumnStats> stats = {};
+        bool read = true;
+        for (int pass = 0; pass < passes; pass++)
+        {
+            // What the serializer does today, every member copied on its own
+            fields.clear();
+            report.time(
+                name + " member by member",
+                [&]()
+                {
+                    for (ecs::Entity entity : entities)
+                    {
+                        if (entity == ECS_ENTITY_DESTROYED)
+                            continue;
+
+                        std::byte* object =
+                            reinterpret_cast<std::byte*>(pool->get_entitys_object(entity));
+                        if (object == nullptr)
+                            continue;
+
+                        tables->walk(
+                            tables->find(type), object,
+                            [&](const KMemberEntry& entry, std::byte* member)
+                            {
+                                if (entry.flags & KEMemberEntryFlag_Nested)
+                                    return;
+                                std::size_t size =
+                                    static_cast<std::size_t>(entry.type_size) *
+                                    std::max<std::uint32_t>(entry.array_size, 1);
+                                const std::uint8_t* bytes =
+                                    reinterpret_cast<const std::uint8_t*>(member);
+                                fields.insert(fields.end(), bytes, bytes + size);
+                            }
+                        );
+                    }
+                }
+            );
+
+            stats.clear();
+            report.time(
+                name + " column write",
+                [&]() { KComponentColumns::write(registry, entities, {type}, columns, &stats); }
+            );
+            report.time(
+                name + " column read",
+                [&]() { read &= KComponentColumns::read(entities, columns.data(), columns.size()); }
+            );
+        }
+
+        if (!read || stats.empty())
+        {
+            report.fail("%s columns didn't read back", name.c_str());
+            continue;
+        }
+
+        // Bytes per millisecond to gigabytes per second
+        auto throughput = [&](const std::string& label)
+        {
+            double time = report.get_time(name + label);
+            return time > 0.0 ? static_cast<double>(stats.front().size) / time / 1.0e6 : 0.0;
+        };
+        report.add_detail(
+            "%s %zu components (%.1f KiB) member by member %.2f GB/s, column write %.2f GB/s, "
+            "column read %.2f GB/s",
+            name.c_str(), stats.front().count, static_cast<double>(stats.front().size) / 1024.0,
+            throughput(" member by member"), throughput(" column write"),
+            throughput(" column read")
+        );
+    }
+}
+
+static void benchmark_snapshot(KScene* scene, int passes, KBenchmarkReport& report)
+{
+    std::string yaml_filename =
+        (std::filesystem::temp_directory_path() / "benchmark.snapshot.oscene").string();
+
+    KRegistrySnapshot snapshot = {};
+    bool restored = true;
+    for (int pass = 0; pass < passes; pass++)
+    {
+        report.time("capture", [&]() { snapshot.capture(scene); });
+        report.time("restore", [&]() { restored &= snapshot.restore(); });
+
+        // Stopping without a snapshot would mean saving the scene on Play and loading it back
+        report.time(
+            "yaml save", [&]() { KLProject::get()->serialize_scene(scene, yaml_filename); }
+        );
+        std::filesystem::remove(yaml_filename + prefab_instances_extension);
+    }
+    std::filesystem::remove(yaml_filename);
+
+    report.add_detail(
+        "%zu entities (%.1f KiB columns, %zu reflected components)", snapshot.get_entity_count(),
+        static_cast<double>(snapshot.get_column_size()) / 1024.0, snapshot.get_reflected_count()
+    );
+    if (!restored)
+        report.fail("snapshot didn't restore");
+}
+
+static void benchmark_prefabs(KScene* scene, int, KBenchmarkReport& report)
+{
+    KLEditorEntities* editor_entities = KLEditorEntities::get();
+    KLSceneChanges* changes = KLSceneChanges::get();
+    KLPrefabs* prefabs = KLPrefabs::get();
+
+    // Every generated entity has a transform, the first one becomes the prefab
+    ecs::Entity source = ECS_ENTITY_DESTROYED;
+    for (ecs::Entity entity : scene->get_registry().get_entities())
+    {
+        if (entity != ECS_ENTITY_DESTROYED)
+        {
+            source = entity;
+            break;
+        }
+    }
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::string prefab_filename =
+        (directory / (std::string("benchmark") + prefab_extension)).string();
+    std::string full_filename = (directory / "benchmark.full.oscene").string();
+    std::string shared_filename = (directory / "benchmark.prefabs.oscene").string();
+    if (source == ECS_ENTITY_DESTROYED || !prefabs->create(scene, source, prefab_filename))
+    {
+        report.fail("failed to create the benchmark prefab");
+        return;
+    }
+
+    // Half of the instances are moved, the other half keep every one of the prefab's values
+    constexpr int instance_count = 10000;
+    const std::uint64_t transform_type = KTypeId::create<KCTransform>().get_id();
+    std::vector<ecs::Entity> instances = {};
+    instances.reserve(instance_count);
+    for (int i = 0; i < instance_count; i++)
+    {
+        ecs::Entity instance = prefabs->instantiate(scene, prefab_filename);
+        if (i % 2 == 0)
+            KEntity(instance).get_component<KCTransform>()->position.x += static_cast<float>(i);
+        instances.push_back(instance);
+    }
+    changes->mark_pool_mutated(transform_type);
+
+    report.time("override pass", [&]() { prefabs->sync(scene); });
+    KPrefabMemoryStats stats = prefabs->get_memory_stats(scene);
+
+    // Without the prefab layer in between, every instance is written with all of its components
+    editor_entities->detach(scene);
+    bool saved = KSerialization::serialize(full_filename, scene);
+    editor_entities->attach(scene);
+    saved &= KLProject::get()->serialize_scene(scene, shared_filename);
+
+    std::error_code error = {};
+    std::uintmax_t full_size = std::filesystem::file_size(full_filename, error);
+    std::uintmax_t shared_size = std::filesystem::file_size(shared_filename, error) +
+                                 std::filesystem::file_size(
+                                     shared_filename + prefab_instances_extension, error
+                                 );
+
+    // Scaling the source is an edit to a field no instance overrides, every instance takes it
+    KEntity(source).get_component<KCTransform>()->scale *= 2.0f;
+    changes->mark_pool_mutated(transform_type);
+    bool applied = false;
+    report.time("apply", [&]() { applied = prefabs->apply(scene, source); });
+    applied &= KEntity(instances.back()).get_component<KCTransform>()->scale ==
+               KEntity(source).get_component<KCTransform>()->scale;
+
+    std::filesystem::remove(prefab_filename);
+    std::filesystem::remove(full_filename);
+    std::filesystem::remove(shared_filename);
+    std::filesystem::remove(shared_filename + prefab_instances_extension);
+
+    report.add_detail(
+        "%zu instances with %zu overrides, %.1f KiB as full copies, %.1f KiB shared, scene file "
+        "%.1f KiB full, %.1f KiB with prefabs",
+        stats.instance_count, stats.override_count,
+        static_cast<double>(stats.full_bytes) / 1024.0,
+        static_cast<double>(stats.shared_bytes) / 1024.0, static_cast<double>(full_size) / 1024.0,
+        static_cast<double>(shared_size) / 1024.0
+    );
+    if (!saved || error)
+        report.fail("failed to save the scene");
+    if (!applied)
+        report.fail("applying the prefab didn't reach its instances");
+}
+
+static void benchmark_archetypes(KScene* scene, int passes, KBenchmarkReport& report)
+{
+    ecs::Registry& registry = scene->get_registry();
+    constexpr int churn_count = 10000;
+
+    // The generated entities are copied into archetype storage, so both sides hold the same
+    // components
+    KArchetypeStorage storage = {};
+    std::size_t entity_count = 0;
+    std::size_t mesh_count = 0;
+    for (ecs::Entity entity : registry.get_entities())
+    {
+        if (entity == ECS_ENTITY_DESTROYED)
+            continue;
+
+        ecs::Entity archetype_entity = storage.create();
+        storage.add<KCTransform>(archetype_entity, *KEntity(entity).get_component<KCTransform>());
+        if (KEntity(entity).get_component<KCMeshRenderer>() != nullptr)
+        {
+            storage.add<KCMeshRenderer>(archetype_entity);
+            mesh_count++;
+        }
+        entity_count++;
+    }
+
+    // Generated positions aren't whole numbers, the order the sides are walked in can change the
+    // last bits of the sums so they're compared within a tolerance of the largest position
+    double pool_sum = 0.0;
+    double archetype_sum = 0.0;
+    for (int pass = 0; pass < passes; pass++)
+    {
+        pool_sum = 0.0;
+        report.time(
+            "iterating pools",
+            [&]()
+            {
+                auto view = ecs::View<KCTransform, KCMeshRenderer>(&registry);
+                for (ecs::Entity entity : registry.get_entities())
+                {
+                    if (entity != ECS_ENTITY_DESTROYED && view.has_required(entity))
+                        pool_sum += KEntity(entity).get_component<KCTransform>()->position.x;
+                }
+            }
+        );
+
+        archetype_sum = 0.0;
+        report.time(
+            "iterating archetypes",
+            [&]()
+            {
+                storage.each<KCTransform, KCMeshRenderer>(
+                    [&](ecs::Entity, KCTransform& transform, KCMeshRenderer&)
+                    { archetype_sum += transform.position.x; }
+                );
+            }
+        );
+    }
+
+    // Taken before the churn, which leaves both sides with holes
+    KArchetypeStats stats = storage.get_stats();
+    std::uint64_t pool_bytes = static_cast<std::uint64_t>(entity_count) * sizeof(KCTransform) +
+                               static_cast<std::uint64_t>(mesh_count) * sizeof(KCMeshRenderer);
+
+    // Entities come and go with their components on both sides, the registry can't remove a
+    // single component so moving entities between archetypes is only timed on its own
+    report.time(
+        "churn pools",
+        [&]()
+        {
+            for (int i = 0; i < churn_count; i++)
+            {
+                KEntity entity = KEntity(true);
+                entity.add_component<KCTransform>();
+                entity.add_component<KCMeshRenderer>();
+                entity.destroy();
+            }
+        }
+    );
+    report.time(
+        "churn archetypes",
+        [&]()
+        {
+            for (int i = 0; i < churn_count; i++)
+            {
+                ecs::Entity entity = storage.create();
+                storage.add<KCTransform>(entity);
+                storage.add<KCMeshRenderer>(entity);
+                storage.destroy(entity);
+            }
+        }
+    );
+
+    const std::uint64_t camera_type = KTypeId::create<KCCamera>().get_id();
+    report.time(
+        "component adds and removes",
+        [&]()
+        {
+            for (int i = 0; i < churn_count; i++)
+            {
+                ecs::Entity entity = static_cast<ecs::Entity>(i);
+                storage.add(entity, camera_type, sizeof(KCCamera), nullptr);
+                storage.remove(entity, camera_type);
+            }
+        }
+    );
+    KLSceneChanges::get()->mark_structure_changed();
+
+    report.add_detail(
+        "%zu entities, %d created and destroyed, %d component moves, %.1f KiB in %zu chunks of "
+        "%zu archetypes (%.1f KiB used, %.1f KiB tables) against at least %.1f KiB of pool "
+        "components",
+        entity_count, churn_count, churn_count, static_cast<double>(stats.chunk_bytes) / 1024.0,
+        stats.chunk_count, stats.archetype_count,
+        static_cast<double>(stats.component_bytes) / 1024.0,
+        static_cast<double>(stats.table_bytes) / 1024.0, static_cast<double>(pool_bytes) / 1024.0
+    );
+    if (std::abs(pool_sum - archetype_sum) > 1e-9 * static_cast<double>(entity_count) * 500.0)
+        report.fail("archetype iteration doesn't match the pools");
+}
+
+static void benchmark_queries(KScene* scene, int passes, KBenchmarkReport& report)
+{
+    ecs::Registry& registry = scene->get_registry();
+    KLSceneChanges* changes = KLSceneChanges::get();
+    constexpr std::size_t added_count = 100;
+
+    KSceneQuery query = KSceneQuery::create<KCTransform, KCMeshRenderer>();
+    report.time("first scan", [&]() { query.update(scene); });
+
+    // Both sides read every match's transform, so only finding the matches differs. Positions
+    // aren't whole numbers, the sums are compared within a tolerance of the largest position
+    std::size_t view_matches = 0;
+    std::size_t query_matches = 0;
+    double view_sum = 0.0;
+    double query_sum = 0.0;
+    std::size_t cached_rescan_count = query.get_rescan_count();
+    for (int pass = 0; pass < passes; pass++)
+    {
+        view_matches = 0;
+        view_sum = 0.0;
+        report.time(
+            "view",
+            [&]()
+            {
+                auto view = ecs::View<KCTransform, KCMeshRenderer>(&registry);
+                for (ecs::Entity entity : registry.get_entities())
+                {
+                    if (entity != ECS_ENTITY_DESTROYED && view.has_required(entity))
+                    {
+                        view_sum += KEntity(entity).get_component<KCTransform>()->position.x;
+                        view_matches++;
+                    }
+                }
+            }
+        );
+
+        query_matches = 0;
+        query_sum = 0.0;
+        report.time(
+            "cached query",
+            [&]()
+            {
+                for (ecs::Entity entity : query.update(scene))
+                {
+                    query_sum += KEntity(entity).get_component<KCTransform>()->position.x;
+                    query_matches++;
+                }
+            }
+        );
+    }
+    bool cached = query.get_rescan_count() == cached_rescan_count;
+
+    // Components added through the editor are replayed into the query instead of rescanning
+    std::size_t added = 0;
+    for (ecs::Entity entity : registry.get_entities())
+    {
+        if (added == added_count)
+            break;
+        if (entity == ECS_ENTITY_DESTROYED ||
+            KEntity(entity).get_component<KCMeshRenderer>() != nullptr)
+            continue;
+
+        KEntity(entity).add_component<KCMeshRenderer>();
+        changes->mark_component_added(entity, KTypeId::create<KCMeshRenderer>().get_id());
+        added++;
+    }
+    std::size_t rescan_count = query.get_rescan_count();
+    std::size_t updated_matches = 0;
+    report.time("replay", [&]() { updated_matches = query.update(scene).size(); });
+    bool replayed = query.get_rescan_count() == rescan_count;
+
+    // A destroyed match is replayed out of the query as well
+    bool destroy_replayed = true;
+    if (!query.get_entities().empty())
+    {
+        ecs::Entity destroyed = query.get_entities().front();
+        KEntity(destroyed).destroy();
+        changes->mark_entity_destroyed(destroyed);
+        rescan_count = query.get_rescan_count();
+        destroy_replayed = query.update(scene).size() == updated_matches - 1 &&
+                           query.get_rescan_count() == rescan_count;
+    }
+
+    report.add_detail(
+        "%zu of %zu entities matched, %zu components added and replayed", query_matches,
+        registry.get_entities().size(), added
+    );
+    if (view_matches != query_matches ||
+        std::abs(view_sum - query_sum) > 1e-9 * static_cast<double>(query_matches) * 500.0)
+        report.fail("query doesn't match the view");
+    if (!cached)
+        report.fail("query rescanned the registry when nothing changed");
+    if (updated_matches != query_matches + added || !replayed)
+        report.fail("added components weren't replayed into the query");
+    if (!destroy_replayed)
+        report.fail("destroyed entity wasn't replayed out of the query");
+}
+
+static void benchmark_compaction(KScene* scene, int passes, KBenchmarkReport& report)
+{
+    ecs::Registry& registry = scene->get_registry();
+    KLSceneChanges* changes = KLSceneChanges::get();
+
+    // A long session in miniature: half of the generated entities are deleted at random and as
+    // many are created again, which reuses their ids in a different order than the pools hold
+    // them in
+    std::vector<ecs::Entity> entities = {};
+    for (ecs::Entity entity : registry.get_entities())
+    {
+        if (entity != ECS_ENTITY_DESTROYED)
+            entities.push_back(entity);
+    }
+    std::mt19937 random = std::mt19937(static_cast<std::uint32_t>(entities.size()));
+    std::shuffle(entities.begin(), entities.end(), random);
+    std::size_t churn_count = entities.size() / 2;
+    for (std::size_t i = 0; i < churn_count; i++)
+        KEntity(entities[i]).destroy();
+    for (std::size_t i = 0; i < churn_count; i++)
+    {
+        KEntity entity = KEntity(true);
+        entity.add_component<KCTransform>()->position.x = static_cast<float>(i);
+    }
+    changes->mark_structure_changed();
+
+    const std::uint64_t transform_type = KTypeId::create<KCTransform>().get_id();
+    auto transform_fragmentation = [&]()
+    {
+        KRegistryFragmentation fragmentation = KLPoolCompaction::measure(scene);
+        for (const KPoolFragmentation& pool : fragmentation.pools)
+        {
+            if (pool.type == transform_type)
+                return pool;
+        }
+        return KPoolFragmentation{};
+    };
+
+    // Systems walk the entities in order and look their components up in the pools. Both walks
+    // add the positions up in entity order, so compacting mustn't change the sum at all
+    auto iterate = [&](const std::string& label)
+    {
+        double sum = 0.0;
+        for (int pass = 0; pass < passes; pass++)
+        {
+            sum = 0.0;
+            report.time(
+                label,
+                [&]()
+                {
+                    for (ecs::ObjectPool* pool : registry.get_pools())
+                    {
+                        if (pool->get_type_hash() != transform_type)
+                            continue;
+
+                        for (ecs::Entity entity : registry.get_entities())
+                        {
+                            if (entity == ECS_ENTITY_DESTROYED)
+                                continue;
+
+                            KCTransform* transform =
+                                static_cast<KCTransform*>(pool->get_entitys_object(entity));
+                            if (transform != nullptr)
+                                sum += transform->position.x;
+                        }
+                    }
+                }
+            );
+        }
+        return sum;
+    };
+
+    KPoolFragmentation before = transform_fragmentation();
+    double sum_before = iterate("iterating before");
+
+    KRegistrySnapshot snapshot = {};
+    report.time("capture", [&]() { snapshot.capture(scene); });
+    bool rebuilt = false;
+    report.time(
+        "rebuild", [&]() { rebuilt = snapshot.get_skipped_types().empty() && snapshot.rebuild(); }
+    );
+    changes->mark_structure_changed();
+
+    KPoolFragmentation after = transform_fragmentation();
+    double sum_after = iterate("iterating after");
+
+    report.add_detail(
+        "%zu of %zu entities recreated, transforms %zu live in %zu slots with %zu holes and %zu "
+        "out of order before, %zu slots and %zu out of order after",
+        churn_count, entities.size(), before.live_count, before.slot_count, before.hole_count,
+        before.order_breaks, after.slot_count, after.order_breaks
+    );
+    if (!rebuilt)
+        report.fail("the registry couldn't be rebuilt");
+    else if (sum_before != sum_after || snapshot.get_moved_count() > 0)
+        report.fail("compacting changed the transforms");
+}
+
+// The systems run over synthetic columns rather than the scene, so the benchmark gets none
+static void benchmark_systems(KScene*, int passes, KBenchmarkReport& report)
+{
+    // Synthetic columns, declared as component types only so the graph sees their accesses
+    struct KBenchmarkPosition {};
+    struct KBenchmarkVelocity {};
+    struct KBenchmarkBounds {};
+    struct KBenchmarkSpin {};
+
+    constexpr std::size_t entity_count = 1000000;
+    constexpr std::size_t grain = 16384;
+    const std::uint64_t position_type = KTypeId::create<KBenchmarkPosition>().get_id();
+    const std::uint64_t velocity_type = KTypeId::create<KBenchmarkVelocity>().get_id();
+    const std::uint64_t bounds_type = KTypeId::create<KBenchmarkBounds>().get_id();
+    const std::uint64_t spin_type = KTypeId::create<KBenchmarkSpin>().get_id();
+
+    std::vector<glm::vec3> positions = {};
+    std::vector<glm::vec3> velocities = {};
+    std::vector<glm::vec3> bounds = {};
+    std::vector<glm::vec3> spins = {};
+
+    // Integrate and Damp conflict over velocities, Bounds waits for Integrate, Spin runs
+    // alongside all of them
+    KSystemGraph graph = {};
+    graph.add(
+        {"Integrate",
+         {velocity_type},
+         {position_type},
+         [&](KSystemContext& context)
+         {
+             context.parallel_for(
+                 entity_count, grain,
+                 [&](std::size_t begin, std::size_t end)
+                 {
+                     for (std::size_t i = begin; i < end; i++)
+                         positions[i] += velocities[i] * context.delta_time;
+                 }
+             );
+         }}
+    );
+    graph.add(
+        {"Damp",
+         {},
+         {velocity_type},
+         [&](KSystemContext& context)
+         {
+             context.parallel_for(
+                 entity_count, grain,
+                 [&](std::size_t begin, std::size_t end)
+                 {
+                     for (std::size_t i = begin; i < end; i++)
+                         velocities[i] *= std::exp(-0.5f * context.delta_time);
+                 }
+             );
+         }}
+    );
+    graph.add(
+        {"Bounds",
+         {position_type},
+         {bounds_type},
+         [&](KSystemContext& context)
+         {
+             context.parallel_for(
+                 entity_count, grain,
+                 [&](std::size_t begin, std::size_t end)
+                 {
+                     for (std::size_t i = begin; i < end; i++)
+                         bounds[i] = glm::abs(positions[i]) + glm::vec3(glm::length(positions[i]));
+                 }
+             );
+         }}
+    );
+    graph.add(
+        {"Spin",
+         {},
+         {spin_type},
+         [&](KSystemContext& context)
+         {
+             context.parallel_for(
+                 entity_count, grain,
+                 [&](std::size_t begin, std::size_t end)
+                 {
+                     for (std::size_t i = begin; i < end; i++)
+                     {
+                         float angle = context.delta_time * static_cast<float>(i % 7);
+                         float sine = std::sin(angle);
+                         float cosine = std::cos(angle);
+                         glm::vec3 spin = spins[i];
+                         spins[i] = glm::normalize(glm::vec3(
+                             cosine * spin.x - sine * spin.z, spin.y,
+                             sine * spin.x + cosine * spin.z
+                         ));
+                     }
+                 }
+             );
+         }}
+    );
+
+    // One thread runs the graph serially on the caller, the way the systems ran before
+    std::string speedups = {};
+    double serial_checksum = 0.0;
+    for (std::size_t thread_count : {1, 2, 4, 8, 16, 32})
+    {
+        positions.assign(entity_count, glm::vec3(0.0f));
+        velocities.assign(entity_count, glm::vec3(1.0f, 2.0f, 3.0f));
+        bounds.assign(entity_count, glm::vec3(0.0f));
+        spins.assign(entity_count, glm::vec3(1.0f, 0.0f, 0.0f));
+
+        std::unique_ptr<KJobScheduler> scheduler = {};
+        if (thread_count > 1)
+            scheduler = std::make_unique<KJobScheduler>(thread_count - 1);
+
+        // The graph times its own frames
+        std::string label =
+            thread_count == 1 ? std::string("serial") : format_string("%zu threads", thread_count);
+        for (int pass = 0; pass < passes; pass++)
+        {
+            graph.run(nullptr, 1.0f / 60.0f, scheduler.get());
+            report.add_time(label, graph.get_last_time());
+        }
+
+        double checksum = 0.0;
+        for (std::size_t i = 0; i < entity_count; i++)
+            checksum += bounds[i].x + spins[i].x;
+        if (thread_count == 1)
+        {
+            serial_checksum = checksum;
+            continue;
+        }
+        if (checksum != serial_checksum)
+            report.fail("systems on %zu threads didn't match the serial run", thread_count);
+
+        std::size_t parallel_count = 0;
+        for (const KSystemTiming& timing : graph.get_timings())
+            parallel_count += timing.parallel_count > 0 ? 1 : 0;
+        speedups += format_string(
+            ", %zu threads %.2fx with %zu systems in parallel", thread_count,
+            report.get_time("serial") / report.get_time(label), parallel_count
+        );
+    }
+
+    report.add_detail(
+        "%zu systems over %zu entities%s", graph.get_systems().size(), entity_count,
+        speedups.c_str()
+    );
+}
+
+// Walks the KCParent chain apart from the spatial index, to check the world matrices it builds
+static glm::mat4 chain_world_matrix(ecs::Entity entity, const KMemberEntry* parent_member)
+{
+    glm::mat4 world = glm::mat4(1.0f);
+    for (int depth = 0; entity != ECS_ENTITY_DESTROYED && depth < max_parent_depth; depth++)
+    {
+        KEntity handle = KEntity(entity);
+        KCTransform* transform = handle.get_component<KCTransform>();
+        if (transform != nullptr)
+            world = TransformHelper::model_matrix(*transform) * world;
+
+        KCParent* parent = handle.get_component<KCParent>();
+        ecs::Entity next = ECS_ENTITY_DESTROYED;
+        if (parent != nullptr && parent_member != nullptr)
+        {
+            std::memcpy(
+                &next, reinterpret_cast<std::byte*>(parent) + parent_member->offset,
+                sizeof(ecs::Entity)
+            );
+        }
+        entity = next != entity ? next : ECS_ENTITY_DESTROYED;
+    }
+    return world;
+}
+
+static void benchmark_spatial(KScene* scene, int passes, KBenchmarkReport& report)
+{
+    ecs::Registry& registry = scene->get_registry();
+    KLSpatialIndex* spatial_index = KLSpatialIndex::get();
+    KLSceneChanges* changes = KLSceneChanges::get();
+    const std::uint64_t transform_type = KTypeId::create<KCTransform>().get_id();
+    constexpr int ray_grid = 32;
+    constexpr int checked_rays = 16;
+    constexpr std::size_t move_stride = 100;
+
+    // The index syncs against the active scene on its update, the first one builds the tree
+    report.time("build", [&]() { spatial_index->on_update(); });
+    std::size_t proxy_count = spatial_index->get_bvh().get_proxy_count();
+
+    // The same bounds the index gives every mesh renderer, to check its answers against: the
+    // model's bounds moved by the world matrix of the entity and its parents
+    const KMemberEntry* parent_member =
+        KLMemberTables::get()->find_entity_member(KTypeId::create<KCParent>().get_id());
+    auto world_bounds = [&](ecs::Entity entity)
+    {
+        KModelHandle model = KEntity(entity).get_component<KCMeshRenderer>()->model;
+        return KAabb::transform(
+            spatial_index->get_model_bounds(model), chain_world_matrix(entity, parent_member)
+        );
+    };
+
+    std::vector<std::pair<ecs::Entity, KAabb>> bounds = {};
+    bounds.reserve(proxy_count);
+    for (ecs::Entity entity : registry.get_entities())
+    {
+        KCMeshRenderer* mesh_renderer = entity != ECS_ENTITY_DESTROYED
+                                            ? KEntity(entity).get_component<KCMeshRenderer>()
+                                            : nullptr;
+        if (mesh_renderer == nullptr || mesh_renderer->model == nullptr ||
+            KEntity(entity).get_component<KCTransform>() == nullptr)
+            continue;
+
+        bounds.push_back({entity, world_bounds(entity)});
+    }
+
+    // The generator spreads entities over 1000 by 1000 units, the camera looks over them from
+    // one side the way the editor camera starts out
+    glm::mat4 view_projection =
+        glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 2000.0f) *
+        glm::lookAt(glm::vec3(0.0f, 100.0f, -700.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    KFrustum frustum = KFrustum::from_matrix(view_projection);
+    std::vector<ecs::Entity> visible = {};
+    for (int pass = 0; pass < passes; pass++)
+        report.time("culling", [&]() { spatial_index->query(frustum, visible); });
+
+    // The tree holds fat bounds, so culling may keep a few extra entities but never drops one
+    std::set<ecs::Entity> visible_set = std::set<ecs::Entity>(visible.begin(), visible.end());
+    std::size_t tight_visible = 0;
+    bool culled_visible = false;
+    for (const auto& [entity, aabb] : bounds)
+    {
+        if (frustum.test(aabb) == KEFrustumResult_Outside)
+            continue;
+        tight_visible++;
+        culled_visible |= visible_set.find(entity) == visible_set.end();
+    }
+
+    // Straight down onto a grid over the scene, like clicking around the viewport from above
+    auto ray_origin = [](int ray)
+    {
+        float x = -500.0f + 1000.0f * (static_cast<float>(ray % ray_grid) + 0.5f) / ray_grid;
+        float z = -500.0f + 1000.0f * (static_cast<float>(ray / ray_grid) + 0.5f) / ray_grid;
+        return glm::vec3(x, 200.0f, z);
+    };
+    const glm::vec3 ray_direction = glm::vec3(0.0f, -1.0f, 0.0f);
+    std::vector<ecs::Entity> picked = std::vector<ecs::Entity>(ray_grid * ray_grid);
+    for (int pass = 0; pass < passes; pass++)
+    {
+        report.time(
+            "picking",
+            [&]()
+            {
+                for (int ray = 0; ray < ray_grid * ray_grid; ray++)
+                    picked[ray] = spatial_index->raycast(ray_origin(ray), ray_direction);
+            }
+        );
+    }
+
+    // A brute force walk over every entity finds the same distance for a handful of the rays,
+    // ties between entities are allowed to pick either
+    glm::vec3 inverse_direction = glm::vec3(1.0f) / ray_direction;
+    bool picked_wrong = false;
+    std::size_t hit_count = 0;
+    for (int ray = 0; ray < ray_grid * ray_grid; ray++)
+        hit_count += picked[ray] != ECS_ENTITY_DESTROYED ? 1 : 0;
+    for (int check = 0; check < checked_rays; check++)
+    {
+        int ray = check * (ray_grid * ray_grid / checked_rays);
+        float closest = std::numeric_limits<float>::max();
+        float picked_distance = std::numeric_limits<float>::max();
+        for (const auto& [entity, aabb] : bounds)
+        {
+            float t_enter = 0.0f;
+            if (!aabb.raycast(
+                    ray_origin(ray), inverse_direction, std::numeric_limits<float>::max(), t_enter
+                ))
+                continue;
+
+            closest = std::min(closest, t_enter);
+            if (entity == picked[ray])
+                picked_distance = t_enter;
+        }
+        picked_wrong |= picked_distance != closest;
+    }
+
+    // One in a hundred renderers moves each pass, further than the fat bounds' margin so every
+    // one of them is reinserted. Every renderer below a moved one in its chain of parents moves
+    // with it and has to be refit as well, nothing else may be
+    std::unordered_set<ecs::Entity> moved = {};
+    for (std::size_t i = 0; i < bounds.size(); i += move_stride)
+        moved.insert(bounds[i].first);
+
+    std::size_t expected_refits = 0;
+    for (const auto& [entity, aabb] : bounds)
+    {
+        ecs::Entity ancestor = entity;
+        for (int depth = 0; ancestor != ECS_ENTITY_DESTROYED && depth < max_parent_depth; depth++)
+        {
+            if (moved.contains(ancestor))
+            {
+                expected_refits++;
+                break;
+            }
+
+            KCParent* parent = KEntity(ancestor).get_component<KCParent>();
+            ecs::Entity next = ECS_ENTITY_DESTROYED;
+            if (parent != nullptr && parent_member != nullptr)
+            {
+                std::memcpy(
+                    &next, reinterpret_cast<std::byte*>(parent) + parent_member->offset,
+                    sizeof(ecs::Entity)
+                );
+            }
+            ancestor = next != ancestor ? next : ECS_ENTITY_DESTROYED;
+        }
+    }
+
+    std::size_t reinserts_before = spatial_index->get_bvh().get_reinsert_count();
+    std::size_t full_syncs_before = spatial_index->get_full_sync_count();
+    bool refit_missed = false;
+    for (int pass = 0; pass < passes; pass++)
+    {
+        float offset = pass % 2 == 0 ? 1.0f : -1.0f;
+        for (ecs::Entity entity : moved)
+        {
+            KEntity(entity).get_component<KCTransform>()->position.x += offset;
+            changes->mark_entity_mutated(entity, transform_type);
+        }
+
+        report.time("refit", [&]() { spatial_index->on_update(); });
+        refit_missed |= spatial_index->get_last_refit_count() != expected_refits;
+    }
+    std::size_t reinsert_count = spatial_index->get_bvh().get_reinsert_count() - reinserts_before;
+    bool full_refit = spatial_index->get_full_sync_count() != full_syncs_before;
+
+    // Whatever wasn't refit still has to match where its entity is now
+    bool stale_bounds = false;
+    for (const auto& [entity, aabb] : bounds)
+    {
+        const KAabb* indexed = spatial_index->find_bounds(entity);
+        KAabb expected = world_bounds(entity);
+        stale_bounds |= indexed == nullptr || glm::length(indexed->min - expected.min) > 1e-3f ||
+                        glm::length(indexed->max - expected.max) > 1e-3f;
+    }
+
+    report.add_detail(
+        "%zu proxies in a tree %d high, %zu culled to %zu visible (%zu by their tight bounds), "
+        "%d rays picked %zu entities, %zu moved a pass refitting %zu with %zu reinserts over %d "
+        "passes",
+        proxy_count, spatial_index->get_bvh().get_height(), bounds.size(), visible.size(),
+        tight_visible, ray_grid * ray_grid, hit_count, moved.size(), expected_refits,
+        reinsert_count, passes
+    );
+    if (proxy_count != bounds.size())
+        report.fail("the index holds %zu of %zu mesh renderers", proxy_count, bounds.size());
+    if (culled_visible)
+        report.fail("culling dropped visible entities");
+    if (picked_wrong)
+        report.fail("picking didn't find the closest entity");
+    if (refit_missed)
+        report.fail("refitting didn't update exactly the moved entities and their children");
+    if (full_refit)
+        report.fail("moving entities one by one walked every renderer");
+    if (stale_bounds)
+        report.fail("the index kept bounds that don't match the entities");
+}
+
+static void benchmark_batching(KScene* scene, int passes, KBenchmarkReport& report)
+{
+    constexpr int width = 1280;
+    constexpr int height = 720;
+    KFramebufferPool framebuffer_pool = KFramebufferPool(1);
+    if (!framebuffer_pool.acquire(width, height, 0.0f))
+    {
+        report.fail("couldn't create a %dx%d framebuffer", width, height);
+        return;
+    }
+
+    // The index syncs against the active scene on its update, the renderer culls through it
+    KLSpatialIndex::get()->on_update();
+
+    // Looking over the generated entities from one side the way the editor camera starts out
+    KCCamera camera = {};
+    camera.position = glm::vec3(0.0f, 100.0f, -700.0f);
+    camera.forward = glm::normalize(-camera.position);
+    camera.up = glm::vec3(0.0f, 1.0f, 0.0f);
+    camera.clear_color = glm::vec4(0.1f, 0.1f, 0.1f, 1.0f);
+    camera.projection_type = CameraProjection_Perspective;
+
+    // Waiting on the GPU makes the time cover the whole scene pass rather than just submission
+    KSceneRenderer renderer = {};
+    for (int pass = 0; pass < passes; pass++)
+    {
+        report.time(
+            "render",
+            [&]()
+            {
+                renderer.render(
+                    scene, camera, framebuffer_pool.get_framebuffer(), glm::ivec2(width, height)
+                );
+                glFinish();
+            }
+        );
+    }
+    GLenum error = glGetError();
+
+    // Counted from the scene rather than the render queue: without batching every visible mesh
+    // renderer takes a draw per mesh, with it every model is drawn once per mesh. Mesh LODs
+    // aren't generated here, so all instances of a model are drawn at the same level
+    std::set<KModelHandle> models = {};
+    std::size_t unbatched = 0;
+    for (ecs::Entity entity : renderer.get_visible_entities())
+    {
+        KCMeshRenderer* mesh_renderer = KEntity(entity).get_component<KCMeshRenderer>();
+        if (mesh_renderer == nullptr || mesh_renderer->model == nullptr)
+            continue;
+
+        unbatched += mesh_renderer->model->meshes.size();
+        models.insert(mesh_renderer->model);
+    }
+    std::size_t expected = 0;
+    for (KModelHandle model : models)
+        expected += model->meshes.size();
+
+    report.add_detail(
+        "%zu visible, %zu draws issued for %zu models (%zu expected, %zu without batching), "
+        "%zu triangles",
+        renderer.get_visible_entities().size(), renderer.get_draw_calls(), models.size(),
+        expected, unbatched, renderer.get_triangle_count()
+    );
+    if (renderer.get_draw_calls() != expected)
+    {
+        report.fail(
+            "the renderer issued %zu draws, %zu expected", renderer.get_draw_calls(), expected
+        );
+    }
+    if (error != GL_NO_ERROR)
+        report.fail("drawing raised GL error 0x%x", error);
+}
+
+// Resizes a pooled framebuffer the way dragging a dock splitter does at 60 frames a second: within
+// a bucket, across bucket boundaries and then held still, which is the only time it may reallocate
+static void benchmark_framebuffer(KScene*, int passes, KBenchmarkReport& report)
+{
+    constexpr int bucket_size = 256;
+    constexpr float settle_time = 0.25f;
+    constexpr float frame_time = 1.0f / 60.0f;
+    const int settle_frames = static_cast<int>(std::lround(settle_time / frame_time));
+
+    for (int pass = 0; pass < passes && report.get_succeeded(); pass++)
+    {
+        KFramebufferPool pool = KFramebufferPool(bucket_size, settle_time);
+        std::size_t frames = 0;
+        bool acquired = true;
+        bool fitted = true;
+        bool exact = true;
+
+        // Every viewport has to fit the framebuffer with the requested aspect, and be the
+        // requested size whenever that fits
+        auto acquire = [&](int width, int height)
+        {
+            acquired &= pool.acquire(width, height, frame_time);
+            const glm::ivec2& size = pool.get_size();
+            const glm::ivec2& viewport_size = pool.get_viewport_size();
+            float aspect =
+                static_cast<float>(viewport_size.x) / static_cast<float>(viewport_size.y);
+            float requested_aspect = static_cast<float>(width) / static_cast<float>(height);
+
+            fitted &= viewport_size.x <= size.x && viewport_size.y <= size.y &&
+                      std::abs(aspect - requested_aspect) < 0.02f;
+            if (width <= size.x && height <= size.y)
+                exact &= viewport_size.x == width && viewport_size.y == height;
+            frames++;
+        };
+        auto expect = [&](const char* step, std::size_t allocation_count)
+        {
+            if (pool.get_allocation_count() != allocation_count)
+            {
+                report.fail(
+                    "%s: %zu allocations, %zu expected", step, pool.get_allocation_count(),
+                    allocation_count
+                );
+            }
+        };
+
+        report.time(
+            "resize",
+            [&]()
+            {
+                acquire(500, 260);
+                expect("first acquire", 1);
+
+                for (int width = 500; width >= 260; width -= 7)
+                    acquire(width, 760 - width);
+                expect("dragging within a bucket", 1);
+
+                // The size changes every frame, so it never settles and is drawn scaled down
+                for (int width = 500; width < 900; width += 7)
+                    acquire(width, 400);
+                expect("dragging across buckets", 1);
+
+                for (int frame = 0; frame < settle_frames; frame++)
+                    acquire(900, 400);
+                expect("holding for less than the settle time", 1);
+
+                for (int frame = 0; frame < 2; frame++)
+                    acquire(900, 400);
+                expect("holding past the settle time", 2);
+
+                // Most of the grown framebuffer is unused at this size, so it's shrunk once settled
+                for (int frame = 0; frame < settle_frames + 2; frame++)
+                    acquire(200, 200);
+                expect("shrinking", 3);
+            }
+        );
+
+        if (pass == 0)
+        {
+            report.add_detail(
+                "%zu frames, %zu allocations, %dx%d framebuffer for %dx%d", frames,
+                pool.get_allocation_count(), pool.get_size().x, pool.get_size().y,
+                pool.get_viewport_size().x, pool.get_viewport_size().y
+            );
+        }
+        if (!acquired)
+            report.fail("a framebuffer couldn't be allocated");
+        if (!fitted)
+            report.fail("a viewport didn't fit its framebuffer or lost its aspect");
+        if (!exact)
+            report.fail("a viewport that fits wasn't the requested size");
+
+        pool.release();
+        if (pool.get_framebuffer() != 0 || pool.get_texture() != 0)
+            report.fail("releasing kept the framebuffer");
+    }
+
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR)
+        report.fail("resizing raised GL error 0x%x", error);
+}
+
+// Source paths, relative to the project root, of every model and texture the asset cooker wrote
+static std::vector<std::string> cooked_sources(const std::filesystem::path& root_path)
+{
+    std::vector<std::string> paths = {};
+    std::filesystem::path cooked_path = root_path / ".kryos/cooked";
+    std::error_code error = {};
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(cooked_path, error))
+    {
+        std::filesystem::path relative_path = entry.path().lexically_relative(cooked_path);
+        std::vector<const char*> source_extensions = {};
+        if (relative_path.extension() == ".kmesh")
+            source_extensions = {".obj"};
+        else if (relative_path.extension() == ".ktex")
+            source_extensions = {".png", ".tga"};
+
+        for (const char* source_extension : source_extensions)
+        {
+            std::filesystem::path source_path = relative_path;
+            source_path.replace_extension(source_extension);
+            if (std::filesystem::exists(root_path / source_path, error))
+            {
+                paths.push_back(source_path.generic_string());
+                break;
+            }
+        }
+    }
+
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+// Streams the project's cooked assets in, then shrinks the budget below what they need: while
+// they're referenced nothing may be evicted and the layer has to report being over budget, once
+// released they have to be evicted down to the budget and count as reloads when acquired again
+static void benchmark_residency(KScene*, int passes, KBenchmarkReport& report)
+{
+    KLAssetResidency* residency = KLAssetResidency::get();
+    std::vector<std::string> paths = cooked_sources(KLProject::get()->get_root_path());
+    if (paths.empty())
+    {
+        report.fail("the project has no cooked models or textures, cook it first");
+        return;
+    }
+
+    auto stream_in = [&](std::vector<KAssetRef>& assets)
+    {
+        for (const std::string& path : paths)
+            assets.push_back(residency->acquire(path));
+        while (residency->get_loading_count() > 0)
+        {
+            residency->on_update();
+            std::this_thread::yield();
+        }
+    };
+    auto count_resident = [](const std::vector<KAssetRef>& assets)
+    {
+        return static_cast<std::size_t>(std::count_if(
+            assets.begin(), assets.end(), [](const KAssetRef& asset) { return asset.is_resident(); }
+        ));
+    };
+
+    // Opens the project's cooked assets
+    residency->on_update();
+
+    std::uint64_t cpu_bytes = 0;
+    std::uint64_t gpu_bytes = 0;
+    for (int pass = 0; pass < passes; pass++)
+    {
+        // Whatever an earlier pass left loaded is evicted, so every pass streams everything in
+        residency->set_budget(0, 0);
+        residency->on_update();
+        residency->set_budget(
+            KLAssetResidency::default_cpu_budget, KLAssetResidency::default_gpu_budget
+        );
+
+        std::vector<KAssetRef> assets = {};
+        report.time("stream in", [&]() { stream_in(assets); });
+        cpu_bytes = residency->get_cpu_bytes();
+        gpu_bytes = residency->get_gpu_bytes();
+
+        std::size_t resident = count_resident(assets);
+        if (resident != paths.size())
+        {
+            report.fail("%zu of %zu assets didn't load", paths.size() - resident, paths.size());
+            return;
+        }
+    }
+
+    // Exactly what the assets need fits
+    residency->set_budget(cpu_bytes, gpu_bytes);
+    std::vector<KAssetRef> assets = {};
+    stream_in(assets);
+    residency->on_update();
+    if (residency->is_over_budget())
+        report.fail("the assets don't fit in a budget of exactly their size");
+
+    // Referenced assets are never evicted, the layer can only report that they don't fit
+    std::uint64_t cpu_budget = cpu_bytes / 2;
+    std::uint64_t gpu_budget = gpu_bytes / 2;
+    std::size_t eviction_count = residency->get_eviction_count();
+    residency->set_budget(cpu_budget, gpu_budget);
+    residency->on_update();
+    if (!residency->is_over_budget())
+        report.fail("referenced assets over the budget weren't reported");
+    if (residency->get_eviction_count() != eviction_count || count_resident(assets) != paths.size())
+        report.fail("referenced assets were evicted");
+
+    assets.clear();
+    residency->on_update();
+    std::size_t evicted = residency->get_eviction_count() - eviction_count;
+    if (residency->is_over_budget() || residency->get_cpu_bytes() > cpu_budget ||
+        residency->get_gpu_bytes() > gpu_budget)
+    {
+        report.fail("released assets weren't evicted down to the budget");
+    }
+
+    std::size_t reload_count = residency->get_reload_count();
+    residency->set_budget(cpu_bytes, gpu_bytes);
+    stream_in(assets);
+    std::size_t reloaded = residency->get_reload_count() - reload_count;
+    if (evicted == 0 || reloaded != evicted)
+        report.fail("%zu assets were evicted and %zu reloaded", evicted, reloaded);
+
+    constexpr double mebibyte = 1024.0 * 1024.0;
+    report.add_detail(
+        "%zu assets, %.1f MiB memory, %.1f MiB video memory, %zu evicted at half of it",
+        paths.size(), static_cast<double>(cpu_bytes) / mebibyte,
+        static_cast<double>(gpu_bytes) / mebibyte, evicted
+    );
+
+    assets.clear();
+    residency->set_budget(
+        KLAssetResidency::default_cpu_budget, KLAssetResidency::default_gpu_budget
+    );
+}
+
+// Entities are always created in the active scene, so every new scene is made the active one
+static KScene* push_scene(const std::string& name)
+{
+    KLSceneManager* scene_manager = KIApplication::get_layer<KLSceneManager>();
+    scene_manager->set_active(scene_manager->push(name));
+    return scene_manager->get_active_scene();
+}
+
+static bool files_match(const std::string& a, const std::string& b)
+{
+    KMappedFile file_a = {};
+    KMappedFile file_b = {};
+    if (!file_a.open(a, 0, "Benchmark::files_match()") ||
+        !file_b.open(b, 0, "Benchmark::files_match()"))
+        return false;
+
+    return file_a.get_size() == file_b.get_size() &&
+           (file_a.get_size() == 0 ||
+            std::memcmp(file_a.get_data(), file_b.get_data(), file_a.get_size()) == 0);
+}
+
+static void benchmark_serialize(KScene* scene, int passes, KBenchmarkReport& report)
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::string yaml_filename = (directory / "benchmark.serialize.oscene").string();
+    std::string table_filename = (directory / "benchmark.serialize.kscene").string();
+    std::string reloaded_filename = (directory / "benchmark.serialize.reloaded.kscene").string();
+
+    std::string unsupported_type = {};
+    if (!KSceneFile::can_write(scene, unsupported_type))
+    {
+        report.fail("%s can't be written through the member tables", unsupported_type.c_str());
+        return;
+    }
+
+    bool saved = true;
+    for (int pass = 0; pass < passes; pass++)
+    {
+        report.time(
+            "yaml save", [&]() { saved &= KSerialization::serialize(yaml_filename, scene); }
+        );
+        report.time("table save", [&]() { saved &= KSceneFile::write(scene, table_filename); });
+    }
+
+    // The editor only ever hands KSerialization a fresh scene to load into, so every pass gets
+    // one. The scene file replaces whatever the scene holds, one scene does for all of its passes
+    bool loaded = true;
+    for (int pass = 0; pass < passes; pass++)
+    {
+        KScene* yaml_scene = push_scene("benchmark serialize yaml " + std::to_string(pass));
+        report.time(
+            "yaml load",
+            [&]() { loaded &= KSerialization::deserialize(yaml_filename, yaml_scene); }
+        );
+    }
+    KScene* table_scene = push_scene("benchmark serialize tables");
+    for (int pass = 0; pass < passes; pass++)
+    {
+        report.time(
+            "table load", [&]() { loaded &= KSceneFile::read(table_scene, table_filename); }
+        );
+    }
+
+    // Entity references are written as indices into the file, so a scene loaded into a fresh
+    // registry saves to the same bytes whatever ids its entities got
+    KScene* check_scene = push_scene("benchmark serialize check");
+    bool round_trip = saved && loaded && KSceneFile::read(check_scene, table_filename) &&
+                      KSceneFile::write(check_scene, reloaded_filename) &&
+                      files_match(table_filename, reloaded_filename);
+
+    std::error_code error = {};
+    report.add_detail(
+        "%zu entities, %.1f KiB as yaml, %.1f KiB through the member tables",
+        scene->get_registry().get_entities().size(),
+        static_cast<double>(std::filesystem::file_size(yaml_filename, error)) / 1024.0,
+        static_cast<double>(std::filesystem::file_size(table_filename, error)) / 1024.0
+    );
+    std::filesystem::remove(yaml_filename, error);
+    std::filesystem::remove(table_filename, error);
+    std::filesystem::remove(reloaded_filename, error);
+
+    if (!saved || !loaded)
+        report.fail("the scene couldn't be saved and loaded");
+    else if (!round_trip)
+        report.fail("the loaded scene doesn't save to the same file");
+}
+
+static const KBenchmarkEntry benchmarks[] = {
+    {"reflection", "walks every reflected member through the member sets and the member tables",
+     100000, 60, 1, benchmark_reflection},
+    {"columns", "copies every trivially copyable component type member by member and as columns",
+     100000, 60, 1, benchmark_columns},
+    {"snapshot", "captures and restores the registry for play mode against saving the scene",
+     100000, 60, 1, benchmark_snapshot},
+    {"prefabs", "instantiates a prefab 10000 times and compares full copies against shared data",
+     10000, 60, 1, benchmark_prefabs},
+    {"archetypes", "iterates, creates and destroys entities in pools and in archetype storage",
+     100000, 50, 1, benchmark_archetypes},
+    {"queries", "finds the rendered entities with a view and with a cached scene query",
+     1000000, 1, 1, benchmark_queries},
+    {"compaction", "churns half of the entities and iterates the pools before and after compacting",
+     100000, 60, 1, benchmark_compaction},
+    {"spatial", "builds the spatial index, culls and picks through it and refits 1% of it a pass",
+     1000000, 100, 1, benchmark_spatial},
+    {"batching", "draws the scene with the scene renderer and counts the draws it issued", 100000,
+     60, 1, benchmark_batching},
+    {"framebuffer", "drags a pooled framebuffer across size buckets and counts its allocations", 0,
+     0, 0, benchmark_framebuffer},
+    {"residency", "streams the cooked assets in and evicts them within half of what they need",
+     0, 0, 0, benchmark_residency},
+    {"serialize", "saves and loads the scene as yaml and through the member tables", 100000, 0,
+     0, benchmark_serialize},
+    {"systems", "runs a synthetic system graph over a million entities on 1 to 32 threads", 0, 60,
+     1, benchmark_systems},
+};
+
+static const KBenchmarkEntry* find_benchmark(const std::string& name)
+{
+    for (const KBenchmarkEntry& benchmark : benchmarks)
+    {
+        if (name == benchmark.name)
+            return &benchmark;
+    }
+    return nullptr;
+}
+
+void KBenchmarkReport::add_time(const std::string& label, double time)
+{
+    for (std::pair<std::string, double>& entry : m_times)
+    {
+        if (entry.first == label)
+        {
+            entry.second = std::min(entry.second, time);
+            return;
+        }
+    }
+    m_times.emplace_back(label, time);
+}
+
+double KBenchmarkReport::get_time(const std::string& label) const
+{
+    for (const std::pair<std::string, double>& entry : m_times)
+    {
+        if (entry.first == label)
+            return entry.second;
+    }
+    return 0.0;
+}
+
+void KBenchmarkReport::add_detail(const char* format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    m_details.push_back(format_arguments(format, arguments));
+    va_end(arguments);
+}
+
+void KBenchmarkReport::fail(const char* format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    m_failures.push_back(format_arguments(format, arguments));
+    va_end(arguments);
+}
+
+bool KBenchmarkReport::print() const
+{
+    std::string line = m_name + ":";
+    const char* separator = " ";
+    for (const std::string& detail : m_details)
+    {
+        line += separator + detail;
+        separator = ", ";
+    }
+    for (const auto& [label, time] : m_times)
+    {
+        line += separator + format_string("%s %.3fms", label.c_str(), time);
+        separator = ", ";
+    }
+    std::printf("%s\n", line.c_str());
+
+    for (const std::string& failure : m_failures)
+        std::fprintf(stderr, "%s: %s\n", m_name.c_str(), failure.c_str());
+    return m_failures.empty();
+}
+
+int KBenchmarkApp::run_benchmark(const KCommandLine& command_line)
+{
+    KBenchmarkSettings settings = {};
+    settings.project_filename = command_line.get("project");
+    settings.names = command_line.get_positionals();
+    settings.passes = std::max(command_line.get_int("passes", settings.passes), 1);
+
+    int entity_count = command_line.get_int("entities", 0);
+    // Seeds are 64 bit, more than get_int() holds
+    std::string seed = command_line.get("seed", "0");
+    char* seed_end = nullptr;
+    settings.seed = std::strtoull(seed.c_str(), &seed_end, 0);
+
+    // `all` runs every benchmark in the order they're listed
+    if (settings.names.size() == 1 && settings.names[0] == "all")
+    {
+        settings.names.clear();
+        for (const KBenchmarkEntry& benchmark : benchmarks)
+            settings.names.push_back(benchmark.name);
+    }
+
+    bool known = !settings.names.empty();
+    for (const std::string& name : settings.names)
+        known &= find_benchmark(name) != nullptr;
+
+    if (settings.project_filename.empty() || !known || entity_count < 0 || *seed_end != '\0')
+    {
+        std::fprintf(
+            stderr, "usage: Kryos benchmark <name> [<name> ...] --project <file.kryosproject> "
+                    "[--entities <count>] [--seed <seed>] [--passes <count>]\n"
+                    "benchmarks (or all):\n"
+        );
+        for (const KBenchmarkEntry& benchmark : benchmarks)
+        {
+            if (benchmark.entity_count == 0)
+                std::fprintf(stderr, "  %-12s %s\n", benchmark.name, benchmark.description);
+            else
+            {
+                std::fprintf(
+                    stderr, "  %-12s %s, %zu entities\n", benchmark.name, benchmark.description,
+                    benchmark.entity_count
+                );
+            }
+        }
+        return 1;
+    }
+    settings.entity_count = static_cast<std::size_t>(entity_count);
+
+#if defined(GLFW_PLATFORM_NULL)
+    // Nothing is drawn, the window only exists because every application has one
+    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
+
+    KBenchmarkApp* app = new KBenchmarkApp(&settings);
+    app->run();
+    delete app;
+
+    return settings.succeeded ? 0 : 1;
+}
+
+KBenchmarkApp::KBenchmarkApp(KBenchmarkSettings* settings)
+{
+    KLWindow* window = get_application_layer<KLWindow>();
+    glfwHideWindow(window->get_internal());
+
+    KLDebug* debug = get_application_layer<KLDebug>();
+    debug->set_serialize(false);
+
+    push_layer<KLMemberTables>();
+    push_layer<KLProject>();
+    push_layer<KLEditorEntities>();
+    push_layer<KLSceneChanges>();
+    push_layer<KLPrefabs>();
+    push_layer<KLSpatialIndex>();
+    push_layer<KLAssetResidency>();
+    push_layer<KLBenchmark>(settings);
+}
+
+KLBenchmark::KLBenchmark(KBenchmarkSettings* settings) : m_settings(settings)
+{
+    if (!KLProject::get()->load(m_settings->project_filename))
+    {
+        std::fprintf(
+            stderr, "failed to load project '%s'\n", m_settings->project_filename.c_str()
+        );
+        m_settings->succeeded = false;
+        _finish();
+    }
+}
+
+void KLBenchmark::on_update()
+{
+    if (m_finished)
+        return;
+
+    // Run on the first update, once the member tables have been built
+    for (const std::string& name : m_settings->names)
+    {
+        const KBenchmarkEntry* benchmark = find_benchmark(name);
+
+        KSceneGeneratorSettings generator = {};
+        generator.entity_count = benchmark->entity_count;
+        if (benchmark->entity_count > 0 && m_settings->entity_count > 0)
+            generator.entity_count = m_settings->entity_count;
+        generator.seed = m_settings->seed;
+        generator.mesh_percent = benchmark->mesh_percent;
+        generator.camera_percent = benchmark->camera_percent;
+
+        KBenchmarkReport report = KBenchmarkReport(name);
+        benchmark->function(_create_scene(name, generator), m_settings->passes, report);
+        m_settings->succeeded &= report.print();
+    }
+    _finish();
+}
+
+KScene* KLBenchmark::_create_scene(
+    const std::string& name, const KSceneGeneratorSettings& generator
+)
+{
+    KScene* scene = push_scene("benchmark " + name);
+    if (generator.entity_count > 0)
+        KSceneGenerator(generator).generate(scene);
+    return scene;
+}
+
+void KLBenchmark::_finish()
+{
+    m_finished = true;
+    glfwSetWindowShouldClose(KIApplication::get_layer<KLWindow>()->get_internal(), GLFW_TRUE);
+}
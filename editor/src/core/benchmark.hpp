@@ -0,0 +1,99 @@
+#ifndef __KRYOS_EDITOR_CORE_BENCHMARK_HPP__
+#define __KRYOS_EDITOR_CORE_BENCHMARK_HPP__
+
+#include "core/command_line.hpp"
+#include "core/scene_generator.hpp"
+
+#include <kryos/core/application.hpp>
+#include <kryos/scene/scene_manager.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct KBenchmarkSettings
+{
+    std::string project_filename = {};
+    // Benchmarks to run, in the order they were given
+    std::vector<std::string> names = {};
+    // Entities every benchmark's scene is generated with, 0 keeps each benchmark's own count
+    std::size_t entity_count = 0;
+    std::uint64_t seed = 0;
+    int passes = 5;
+
+    bool succeeded = true;
+};
+
+// Collects what one benchmark measured and prints it as a single line. Timings under the same
+// label keep the fastest of the passes, a failed check is printed to stderr and fails the run
+class KBenchmarkReport
+{
+  public:
+    KBenchmarkReport(const std::string& name) : m_name(name) {}
+    ~KBenchmarkReport() = default;
+
+    inline const std::string& get_name() const { return m_name; }
+    inline bool get_succeeded() const { return m_failures.empty(); }
+
+    // Times one pass of the function under the label, returns the pass's time in milliseconds
+    template<typename _Function>
+    double time(const std::string& label, _Function&& function)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        function();
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        double time = std::chrono::duration<double, std::milli>(end - start).count();
+        add_time(label, time);
+        return time;
+    }
+    void add_time(const std::string& label, double time);
+    // 0 when nothing was timed under the label
+    double get_time(const std::string& label) const;
+
+    // Counts, sizes and ratios, printed ahead of the timings
+    void add_detail(const char* format, ...);
+    void fail(const char* format, ...);
+
+    // Returns whether every check passed
+    bool print() const;
+
+  private:
+    std::string m_name = {};
+    std::vector<std::string> m_details = {};
+    std::vector<std::pair<std::string, double>> m_times = {};
+    std::vector<std::string> m_failures = {};
+};
+
+// `Kryos benchmark <name> ...` runs the editor's benchmarks in an application without the editor
+// workspace. Every benchmark gets a scene of its own filled by the scene generator, so results
+// don't depend on whatever scene is at hand and no project scene is ever touched
+class KBenchmarkApp final : public KIApplication
+{
+  public:
+    static int run_benchmark(const KCommandLine& command_line);
+
+  public:
+    KBenchmarkApp(KBenchmarkSettings* settings);
+    virtual ~KBenchmarkApp() override = default;
+};
+
+class KLBenchmark final : public KIApplicationLayer
+{
+  public:
+    KLBenchmark(KBenchmarkSettings* settings);
+    virtual ~KLBenchmark() override = default;
+
+    virtual void on_update() override;
+
+  private:
+    KScene* _create_scene(const std::string& name, const KSceneGeneratorSettings& generator);
+    void _finish();
+
+  private:
+    KBenchmarkSettings* m_settings = nullptr;
+    bool m_finished = false;
+};
+
+#endif
@@ -0,0 +1,565 @@
+#include "core/block_compression.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static constexpr int block_pixels = 16;
+
+// Returns the summed squared distance of every pixel to its nearest palette entry and writes the
+// entry's index. Channels are split into arrays of 16 floats, the palette is interleaved
+static float select_nearest(
+    const float* const* channels, int channel_count, const float* palette, int palette_count,
+    std::uint8_t* indices
+)
+{
+#if defined(__SSE2__)
+    __m128 total = _mm_setzero_ps();
+    for (int i = 0; i < block_pixels; i += 4)
+    {
+        __m128 values[3] = {};
+        for (int channel = 0; channel < channel_count; channel++)
+            values[channel] = _mm_loadu_ps(channels[channel] + i);
+
+        __m128 best = _mm_set1_ps(FLT_MAX);
+        __m128 best_index = _mm_setzero_ps();
+        for (int entry = 0; entry < palette_count; entry++)
+        {
+            __m128 distance = _mm_setzero_ps();
+            for (int channel = 0; channel < channel_count; channel++)
+            {
+                __m128 difference = _mm_sub_ps(
+                    values[channel], _mm_set1_ps(palette[entry * channel_count + channel])
+                );
+                distance = _mm_add_ps(distance, _mm_mul_ps(difference, difference));
+            }
+
+            // Strictly closer, so ties keep the lower index like the scalar path
+            __m128 closer = _mm_cmplt_ps(distance, best);
+            best = _mm_min_ps(distance, best);
+            best_index = _mm_or_ps(
+                _mm_and_ps(closer, _mm_set1_ps(static_cast<float>(entry))),
+                _mm_andnot_ps(closer, best_index)
+            );
+        }
+
+        total = _mm_add_ps(total, best);
+        alignas(16) std::int32_t lanes[4] = {};
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_cvttps_epi32(best_index));
+        for (int lane = 0; lane < 4; lane++)
+            indices[i + lane] = static_cast<std::uint8_t>(lanes[lane]);
+    }
+
+    alignas(16) float sums[4] = {};
+    _mm_store_ps(sums, total);
+    return sums[0] + sums[1] + sums[2] + sums[3];
+#else
+    float total = 0.0f;
+    for (int i = 0; i < block_pixels; i++)
+    {
+        float best = FLT_MAX;
+        for (int entry = 0; entry < palette_count; entry++)
+        {
+            float distance = 0.0f;
+            for (int channel = 0; channel < channel_count; channel++)
+            {
+                float difference = channels[channel][i] - palette[entry * channel_count + channel];
+                distance += difference * difference;
+            }
+
+            if (distance < best)
+            {
+                best = distance;
+                indices[i] = static_cast<std::uint8_t>(entry);
+            }
+        }
+        total += best;
+    }
+    return total;
+#endif
+}
+
+static std::uint16_t pack_565(const float* color)
+{
+    auto quantize = [](float value, float max) -> std::uint32_t
+    { return static_cast<std::uint32_t>(std::clamp(value * max / 255.0f + 0.5f, 0.0f, max)); };
+
+    return static_cast<std::uint16_t>(
+        (quantize(color[0], 31.0f) << 11) | (quantize(color[1], 63.0f) << 5) |
+        quantize(color[2], 31.0f)
+    );
+}
+
+static void unpack_565(std::uint16_t color, std::uint32_t* rgb)
+{
+    std::uint32_t r = (color >> 11) & 31;
+    std::uint32_t g = (color >> 5) & 63;
+    std::uint32_t b = color & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+// Four color palette of two packed endpoints, the way BC1 decodes it when color0 > color1
+static void color_palette(std::uint16_t color0, std::uint16_t color1, std::uint32_t palette[4][3])
+{
+    unpack_565(color0, palette[0]);
+    unpack_565(color1, palette[1]);
+    for (int channel = 0; channel < 3; channel++)
+    {
+        palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+        palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+    }
+}
+
+static float evaluate_endpoints(
+    const float* const* channels, std::uint16_t color0, std::uint16_t color1,
+    std::uint8_t* indices
+)
+{
+    std::uint32_t palette[4][3] = {};
+    color_palette(color0, color1, palette);
+
+    float palette_values[4 * 3] = {};
+    for (int entry = 0; entry < 4; entry++)
+    {
+        for (int channel = 0; channel < 3; channel++)
+            palette_values[entry * 3 + channel] = static_cast<float>(palette[entry][channel]);
+    }
+    return select_nearest(channels, 3, palette_values, 4, indices);
+}
+
+static void encode_color(const std::uint8_t* rgba, std::uint8_t* block)
+{
+    float r[block_pixels] = {};
+    float g[block_pixels] = {};
+    float b[block_pixels] = {};
+    const float* channels[3] = {r, g, b};
+
+    float mean[3] = {};
+    for (int i = 0; i < block_pixels; i++)
+    {
+        r[i] = rgba[i * 4];
+        g[i] = rgba[i * 4 + 1];
+        b[i] = rgba[i * 4 + 2];
+        mean[0] += r[i];
+        mean[1] += g[i];
+        mean[2] += b[i];
+    }
+    for (float& value : mean)
+        value /= static_cast<float>(block_pixels);
+
+    // Principal axis of the colors through power iteration on their covariance
+    float covariance[6] = {};
+    float min[3] = {255.0f, 255.0f, 255.0f};
+    float max[3] = {};
+    for (int i = 0; i < block_pixels; i++)
+    {
+        float d[3] = {r[i] - mean[0], g[i] - mean[1], b[i] - mean[2]};
+        covariance[0] += d[0] * d[0];
+        covariance[1] += d[0] * d[1];
+        covariance[2] += d[0] * d[2];
+        covariance[3] += d[1] * d[1];
+        covariance[4] += d[1] * d[2];
+        covariance[5] += d[2] * d[2];
+        for (int channel = 0; channel < 3; channel++)
+        {
+            min[channel] = std::min(min[channel], channels[channel][i]);
+            max[channel] = std::max(max[channel], channels[channel][i]);
+        }
+    }
+
+    float axis[3] = {max[0] - min[0], max[1] - min[1], max[2] - min[2]};
+    for (int iteration = 0; iteration < 4; iteration++)
+    {
+        float next[3] = {
+            covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+            covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+            covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2],
+        };
+        float largest = std::max({std::abs(next[0]), std::abs(next[1]), std::abs(next[2])});
+        if (largest <= 0.0f)
+            break;
+        for (int channel = 0; channel < 3; channel++)
+            axis[channel] = next[channel] / largest;
+    }
+
+    float endpoints[2][3] = {};
+    float axis_length = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    if (axis_length > 0.0f)
+    {
+        float t_min = FLT_MAX;
+        float t_max = -FLT_MAX;
+        for (int i = 0; i < block_pixels; i++)
+        {
+            float t = (r[i] - mean[0]) * axis[0] + (g[i] - mean[1]) * axis[1] +
+                      (b[i] - mean[2]) * axis[2];
+            t_min = std::min(t_min, t);
+            t_max = std::max(t_max, t);
+        }
+
+        // Pulled in a little, the extremes are rarely worth an exact match at the cost of the
+        // colors in between
+        float inset = (t_max - t_min) / 16.0f;
+        t_min = (t_min + inset) / axis_length;
+        t_max = (t_max - inset) / axis_length;
+        for (int channel = 0; channel < 3; channel++)
+        {
+            endpoints[0][channel] = mean[channel] + axis[channel] * t_max;
+            endpoints[1][channel] = mean[channel] + axis[channel] * t_min;
+        }
+    }
+    else
+    {
+        std::memcpy(endpoints[0], mean, sizeof(mean));
+        std::memcpy(endpoints[1], mean, sizeof(mean));
+    }
+
+    std::uint16_t color0 = pack_565(endpoints[0]);
+    std::uint16_t color1 = pack_565(endpoints[1]);
+    std::uint8_t indices[block_pixels] = {};
+    float error = evaluate_endpoints(channels, color0, color1, indices);
+
+    // Least squares endpoints for the chosen indices, kept only when they lower the error
+    static constexpr float weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+    for (int iteration = 0; iteration < 2 && error > 0.0f; iteration++)
+    {
+        float aa = 0.0f;
+        float ab = 0.0f;
+        float bb = 0.0f;
+        float ax[3] = {};
+        float bx[3] = {};
+        for (int i = 0; i < block_pixels; i++)
+        {
+            float a = weights[indices[i]];
+            float b_weight = 1.0f - a;
+            aa += a * a;
+            ab += a * b_weight;
+            bb += b_weight * b_weight;
+            for (int channel = 0; channel < 3; channel++)
+            {
+                ax[channel] += a * channels[channel][i];
+                bx[channel] += b_weight * channels[channel][i];
+            }
+        }
+
+        float determinant = aa * bb - ab * ab;
+        if (std::abs(determinant) < 1e-6f)
+            break;
+
+        float fitted[2][3] = {};
+        for (int channel = 0; channel < 3; channel++)
+        {
+            fitted[0][channel] = (bb * ax[channel] - ab * bx[channel]) / determinant;
+            fitted[1][channel] = (aa * bx[channel] - ab * ax[channel]) / determinant;
+        }
+
+        std::uint16_t fitted0 = pack_565(fitted[0]);
+        std::uint16_t fitted1 = pack_565(fitted[1]);
+        std::uint8_t fitted_indices[block_pixels] = {};
+        float fitted_error = evaluate_endpoints(channels, fitted0, fitted1, fitted_indices);
+        if (fitted_error >= error)
+            break;
+
+        color0 = fitted0;
+        color1 = fitted1;
+        error = fitted_error;
+        std::memcpy(indices, fitted_indices, sizeof(indices));
+    }
+
+    // color0 > color1 selects the four color mode, swapping the endpoints swaps index 0 with 1
+    // and 2 with 3
+    if (color0 < color1)
+    {
+        std::swap(color0, color1);
+        for (std::uint8_t& index : indices)
+            index ^= 1;
+    }
+    else if (color0 == color1)
+        std::memset(indices, 0, sizeof(indices));
+
+    std::uint32_t packed = 0;
+    for (int i = 0; i < block_pixels; i++)
+        packed |= static_cast<std::uint32_t>(indices[i]) << (i * 2);
+
+    block[0] = static_cast<std::uint8_t>(color0 & 0xff);
+    block[1] = static_cast<std::uint8_t>(color0 >> 8);
+    block[2] = static_cast<std::uint8_t>(color1 & 0xff);
+    block[3] = static_cast<std::uint8_t>(color1 >> 8);
+    std::memcpy(block + 4, &packed, sizeof(packed));
+}
+
+// Eight entry palette of a single channel block, interpolated across six entries when
+// value0 > value1, otherwise across four with 0 and 255 as the last two
+static void single_channel_palette(std::uint32_t value0, std::uint32_t value1, float* palette)
+{
+    palette[0] = static_cast<float>(value0);
+    palette[1] = static_cast<float>(value1);
+    if (value0 > value1)
+    {
+        for (std::uint32_t i = 1; i < 7; i++)
+            palette[i + 1] = static_cast<float>(((7 - i) * value0 + i * value1) / 7);
+    }
+    else
+    {
+        for (std::uint32_t i = 1; i < 5; i++)
+            palette[i + 1] = static_cast<float>(((5 - i) * value0 + i * value1) / 5);
+        palette[6] = 0.0f;
+        palette[7] = 255.0f;
+    }
+}
+
+std::size_t KBlockCompression::get_block_size(KETextureFormat format)
+{
+    switch (format)
+    {
+    case KETextureFormat_BC1:
+        return 8;
+    case KETextureFormat_BC3:
+    case KETextureFormat_BC5:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+std::size_t KBlockCompression::get_mip_size(
+    KETextureFormat format, std::uint32_t width, std::uint32_t height
+)
+{
+    std::size_t block_size = get_block_size(format);
+    if (block_size == 0)
+        return static_cast<std::size_t>(width) * height * 4;
+    return static_cast<std::size_t>(get_block_count(width)) * get_block_count(height) * block_size;
+}
+
+void KBlockCompression::encode_bc1(const std::uint8_t* rgba, std::uint8_t* block)
+{
+    encode_color(rgba, block);
+}
+
+void KBlockCompression::encode_bc3(const std::uint8_t* rgba, std::uint8_t* block)
+{
+    encode_bc4(rgba + 3, 4, block);
+    encode_color(rgba, block + 8);
+}
+
+void KBlockCompression::encode_bc5(const std::uint8_t* rgba, std::uint8_t* block)
+{
+    encode_bc4(rgba, 4, block);
+    encode_bc4(rgba + 1, 4, block + 8);
+}
+
+void KBlockCompression::encode_bc4(
+    const std::uint8_t* values, std::size_t stride, std::uint8_t* block
+)
+{
+    float samples[block_pixels] = {};
+    const float* channels[1] = {samples};
+    std::uint32_t min = 255;
+    std::uint32_t max = 0;
+    // Range of the values that the four entry mode can't represent exactly with 0 and 255
+    std::uint32_t inner_min = 255;
+    std::uint32_t inner_max = 0;
+    for (int i = 0; i < block_pixels; i++)
+    {
+        std::uint32_t value = values[i * stride];
+        samples[i] = static_cast<float>(value);
+        min = std::min(min, value);
+        max = std::max(max, value);
+        if (value != 0 && value != 255)
+        {
+            inner_min = std::min(inner_min, value);
+            inner_max = std::max(inner_max, value);
+        }
+    }
+
+    std::uint32_t value0 = max;
+    std::uint32_t value1 = min;
+    std::uint8_t indices[block_pixels] = {};
+    if (min != max)
+    {
+        float palette[8] = {};
+        single_channel_palette(max, min, palette);
+        float error = select_nearest(channels, 1, palette, 8, indices);
+
+        // Blocks touching 0 or 255 can spend the interpolated entries on the values in between
+        if (inner_min <= inner_max && (min == 0 || max == 255))
+        {
+            std::uint8_t inner_indices[block_pixels] = {};
+            single_channel_palette(inner_min, inner_max, palette);
+            float inner_error = select_nearest(channels, 1, palette, 8, inner_indices);
+            if (inner_error < error)
+            {
+                value0 = inner_min;
+                value1 = inner_max;
+                std::memcpy(indices, inner_indices, sizeof(indices));
+            }
+        }
+    }
+
+    std::uint64_t packed = 0;
+    for (int i = 0; i < block_pixels; i++)
+        packed |= static_cast<std::uint64_t>(indices[i]) << (i * 3);
+
+    block[0] = static_cast<std::uint8_t>(value0);
+    block[1] = static_cast<std::uint8_t>(value1);
+    for (int i = 0; i < 6; i++)
+        block[2 + i] = static_cast<std::uint8_t>((packed >> (i * 8)) & 0xff);
+}
+
+void KBlockCompression::decode_bc1(const std::uint8_t* block, std::uint8_t* rgba, bool four_colors)
+{
+    std::uint16_t color0 = static_cast<std::uint16_t>(block[0] | (block[1] << 8));
+    std::uint16_t color1 = static_cast<std::uint16_t>(block[2] | (block[3] << 8));
+    std::uint32_t packed = 0;
+    std::memcpy(&packed, block + 4, sizeof(packed));
+
+    std::uint32_t palette[4][4] = {};
+    unpack_565(color0, palette[0]);
+    unpack_565(color1, palette[1]);
+    palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+    for (int channel = 0; channel < 3; channel++)
+    {
+        if (four_colors || color0 > color1)
+        {
+            palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+            palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+        }
+        else
+            palette[2][channel] = (palette[0][channel] + palette[1][channel]) / 2;
+    }
+    if (!four_colors && color0 <= color1)
+        palette[3][3] = 0;
+
+    for (int i = 0; i < block_pixels; i++)
+    {
+        std::uint32_t index = (packed >> (i * 2)) & 3;
+        for (int channel = 0; channel < 4; channel++)
+            rgba[i * 4 + channel] = static_cast<std::uint8_t>(palette[index][channel]);
+    }
+}
+
+void KBlockCompression::decode_bc3(const std::uint8_t* block, std::uint8_t* rgba)
+{
+    decode_bc1(block + 8, rgba, true);
+    decode_bc4(block, rgba + 3, 4);
+}
+
+void KBlockCompression::decode_bc5(const std::uint8_t* block, std::uint8_t* rgba)
+{
+    decode_bc4(block, rgba, 4);
+    decode_bc4(block + 8, rgba + 1, 4);
+    for (int i = 0; i < block_pixels; i++)
+    {
+        rgba[i * 4 + 2] = 0;
+        rgba[i * 4 + 3] = 255;
+    }
+}
+
+void KBlockCompression::decode_bc4(
+    const std::uint8_t* block, std::uint8_t* values, std::size_t stride
+)
+{
+    float palette[8] = {};
+    single_channel_palette(block[0], block[1], palette);
+
+    std::uint64_t packed = 0;
+    for (int i = 0; i < 6; i++)
+        packed |= static_cast<std::uint64_t>(block[2 + i]) << (i * 8);
+
+    for (int i = 0; i < block_pixels; i++)
+        values[i * stride] = static_cast<std::uint8_t>(palette[(packed >> (i * 3)) & 7]);
+}
+
+void KBlockCompression::encode_rows(
+    KETextureFormat format, const std::uint8_t* rgba, std::uint32_t width, std::uint32_t height,
+    std::uint32_t first_row, std::uint32_t row_count, std::uint8_t* output
+)
+{
+    std::size_t block_size = get_block_size(format);
+    std::uint32_t blocks_x = get_block_count(width);
+    std::uint32_t blocks_y = get_block_count(height);
+
+    std::uint8_t pixels[block_pixels * 4] = {};
+    for (std::uint32_t block_y = first_row; block_y < std::min(first_row + row_count, blocks_y);
+         block_y++)
+    {
+        for (std::uint32_t block_x = 0; block_x < blocks_x; block_x++)
+        {
+            for (std::uint32_t y = 0; y < block_dimension; y++)
+            {
+                std::uint32_t source_y = std::min(block_y * block_dimension + y, height - 1);
+                for (std::uint32_t x = 0; x < block_dimension; x++)
+                {
+                    std::uint32_t source_x = std::min(block_x * block_dimension + x, width - 1);
+                    std::memcpy(
+                        pixels + (y * block_dimension + x) * 4,
+                        rgba + (static_cast<std::size_t>(source_y) * width + source_x) * 4, 4
+                    );
+                }
+            }
+
+            std::uint8_t* block =
+                output + (static_cast<std::size_t>(block_y) * blocks_x + block_x) * block_size;
+            if (format == KETextureFormat_BC1)
+                encode_bc1(pixels, block);
+            else if (format == KETextureFormat_BC3)
+                encode_bc3(pixels, block);
+            else if (format == KETextureFormat_BC5)
+                encode_bc5(pixels, block);
+        }
+    }
+}
+
+void KBlockCompression::decode_image(
+    KETextureFormat format, const std::uint8_t* data, std::uint32_t width, std::uint32_t height,
+    std::uint8_t* rgba
+)
+{
+    std::size_t block_size = get_block_size(format);
+    if (block_size == 0)
+    {
+        std::memcpy(rgba, data, static_cast<std::size_t>(width) * height * 4);
+        return;
+    }
+
+    std::uint32_t blocks_x = get_block_count(width);
+    std::uint32_t blocks_y = get_block_count(height);
+    std::uint8_t pixels[block_pixels * 4] = {};
+    for (std::uint32_t block_y = 0; block_y < blocks_y; block_y++)
+    {
+        for (std::uint32_t block_x = 0; block_x < blocks_x; block_x++)
+        {
+            const std::uint8_t* block =
+                data + (static_cast<std::size_t>(block_y) * blocks_x + block_x) * block_size;
+            if (format == KETextureFormat_BC1)
+                decode_bc1(block, pixels);
+            else if (format == KETextureFormat_BC3)
+                decode_bc3(block, pixels);
+            else
+                decode_bc5(block, pixels);
+
+            // Only the pixels inside the image are written back
+            for (std::uint32_t y = 0; y < block_dimension; y++)
+            {
+                std::uint32_t target_y = block_y * block_dimension + y;
+                for (std::uint32_t x = 0; x < block_dimension; x++)
+                {
+                    std::uint32_t target_x = block_x * block_dimension + x;
+                    if (target_x >= width || target_y >= height)
+                        continue;
+                    std::memcpy(
+                        rgba + (static_cast<std::size_t>(target_y) * width + target_x) * 4,
+                        pixels + (y * block_dimension + x) * 4, 4
+                    );
+                }
+            }
+        }
+    }
+}
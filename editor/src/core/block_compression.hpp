@@ -0,0 +1,51 @@
+#ifndef __KRYOS_EDITOR_CORE_BLOCK_COMPRESSION_HPP__
+#define __KRYOS_EDITOR_CORE_BLOCK_COMPRESSION_HPP__
+
+#include "core/texture_format.hpp"
+
+#include <cstdint>
+
+// BC1, BC3 and BC5 block encoders and decoders. Every block covers 4x4 pixels, given as 16 RGBA8
+// pixels row by row. Color endpoints are fitted along the block's principal axis and refined
+// with a least squares pass, the nearest palette entry search runs four pixels at a time with
+// SSE2 where it's available
+struct KBlockCompression
+{
+    static constexpr std::uint32_t block_dimension = 4;
+
+    // 0 for formats that aren't block compressed
+    static std::size_t get_block_size(KETextureFormat format);
+    static std::size_t get_mip_size(
+        KETextureFormat format, std::uint32_t width, std::uint32_t height
+    );
+    inline static std::uint32_t get_block_count(std::uint32_t size)
+    {
+        return (size + block_dimension - 1) / block_dimension;
+    }
+
+    static void encode_bc1(const std::uint8_t* rgba, std::uint8_t* block);
+    static void encode_bc3(const std::uint8_t* rgba, std::uint8_t* block);
+    static void encode_bc5(const std::uint8_t* rgba, std::uint8_t* block);
+    // Single channel, the 16 values are read every stride bytes
+    static void encode_bc4(const std::uint8_t* values, std::size_t stride, std::uint8_t* block);
+
+    // BC1 blocks inside BC3 always decode with four colors
+    static void decode_bc1(const std::uint8_t* block, std::uint8_t* rgba, bool four_colors = false);
+    static void decode_bc3(const std::uint8_t* block, std::uint8_t* rgba);
+    static void decode_bc5(const std::uint8_t* block, std::uint8_t* rgba);
+    static void decode_bc4(const std::uint8_t* block, std::uint8_t* values, std::size_t stride);
+
+    // Encodes the block rows [first_row, first_row + row_count) of an RGBA8 image into output,
+    // which points at the start of the whole mip. Blocks past the edges repeat the edge pixels
+    static void encode_rows(
+        KETextureFormat format, const std::uint8_t* rgba, std::uint32_t width,
+        std::uint32_t height, std::uint32_t first_row, std::uint32_t row_count,
+        std::uint8_t* output
+    );
+    static void decode_image(
+        KETextureFormat format, const std::uint8_t* data, std::uint32_t width,
+        std::uint32_t height, std::uint8_t* rgba
+    );
+};
+
+#endif
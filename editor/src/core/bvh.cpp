@@ -0,0 +1,339 @@
+#include "core/bvh.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+bool KAabb::raycast(
+    const glm::vec3& origin, const glm::vec3& inverse_direction, float max_distance,
+    float& t_enter
+) const
+{
+    glm::vec3 t1 = (min - origin) * inverse_direction;
+    glm::vec3 t2 = (max - origin) * inverse_direction;
+    glm::vec3 t_min = glm::min(t1, t2);
+    glm::vec3 t_max = glm::max(t1, t2);
+
+    float enter = std::max({t_min.x, t_min.y, t_min.z, 0.0f});
+    float exit = std::min({t_max.x, t_max.y, t_max.z, max_distance});
+    if (enter > exit)
+        return false;
+
+    t_enter = enter;
+    return true;
+}
+
+KAabb KAabb::transform(const KAabb& aabb, const glm::mat4& matrix)
+{
+    // Each axis of the matrix stretches the extents by its absolute value (Arvo)
+    glm::vec3 center = glm::vec3(matrix * glm::vec4(aabb.get_center(), 1.0f));
+    glm::vec3 extents = aabb.get_extents();
+    glm::vec3 world_extents = glm::abs(glm::vec3(matrix[0])) * extents.x +
+                              glm::abs(glm::vec3(matrix[1])) * extents.y +
+                              glm::abs(glm::vec3(matrix[2])) * extents.z;
+    return KAabb{center - world_extents, center + world_extents};
+}
+
+KFrustum KFrustum::from_matrix(const glm::mat4& m)
+{
+    // Gribb/Hartmann extraction, glm matrices are column major so rows are gathered across columns
+    glm::vec4 rows[4] = {};
+    for (int i = 0; i < 4; i++)
+        rows[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+
+    KFrustum frustum = {};
+    frustum.planes[0] = rows[3] + rows[0];
+    frustum.planes[1] = rows[3] - rows[0];
+    frustum.planes[2] = rows[3] + rows[1];
+    frustum.planes[3] = rows[3] - rows[1];
+    frustum.planes[4] = rows[3] + rows[2];
+    frustum.planes[5] = rows[3] - rows[2];
+
+    for (glm::vec4& plane : frustum.planes)
+    {
+        float length = glm::length(glm::vec3(plane.x, plane.y, plane.z));
+        if (length > 0.0f)
+            plane = plane / length;
+    }
+
+    return frustum;
+}
+
+KEFrustumResult KFrustum::test(const KAabb& aabb) const
+{
+    glm::vec3 center = aabb.get_center();
+    glm::vec3 extents = aabb.get_extents();
+
+    KEFrustumResult result = KEFrustumResult_Inside;
+    for (const glm::vec4& plane : planes)
+    {
+        glm::vec3 normal = glm::vec3(plane.x, plane.y, plane.z);
+        float distance = glm::dot(normal, center) + plane.w;
+        float radius = glm::dot(extents, glm::abs(normal));
+
+        if (distance + radius < 0.0f)
+            return KEFrustumResult_Outside;
+        if (distance - radius < 0.0f)
+            result = KEFrustumResult_Intersects;
+    }
+
+    return result;
+}
+
+KDynamicBvh::KDynamicBvh(float margin) : m_margin(margin) {}
+
+std::int32_t KDynamicBvh::get_height() const
+{
+    if (m_root == null_node)
+        return 0;
+    return m_nodes[m_root].height;
+}
+
+std::int32_t KDynamicBvh::create_proxy(const KAabb& aabb, std::uint64_t user_data)
+{
+    std::int32_t proxy = _allocate_node();
+    m_nodes[proxy].aabb = _fatten(aabb);
+    m_nodes[proxy].user_data = user_data;
+    m_nodes[proxy].height = 0;
+
+    _insert_leaf(proxy);
+    m_proxy_count++;
+    return proxy;
+}
+
+void KDynamicBvh::destroy_proxy(std::int32_t proxy)
+{
+    assert(m_nodes[proxy].is_leaf() && "DynamicBvh::destroy_proxy() -> node is not a proxy");
+
+    _remove_leaf(proxy);
+    _free_node(proxy);
+    m_proxy_count--;
+}
+
+bool KDynamicBvh::move_proxy(std::int32_t proxy, const KAabb& aabb)
+{
+    if (m_nodes[proxy].aabb.contains(aabb))
+        return false;
+
+    _remove_leaf(proxy);
+    m_nodes[proxy].aabb = _fatten(aabb);
+    _insert_leaf(proxy);
+
+    m_reinsert_count++;
+    return true;
+}
+
+void KDynamicBvh::clear()
+{
+    m_nodes.clear();
+    m_root = null_node;
+    m_free_list = null_node;
+    m_proxy_count = 0;
+}
+
+std::int32_t KDynamicBvh::_allocate_node()
+{
+    if (m_free_list == null_node)
+    {
+        m_nodes.emplace_back();
+        return static_cast<std::int32_t>(m_nodes.size() - 1);
+    }
+
+    std::int32_t index = m_free_list;
+    m_free_list = m_nodes[index].parent;
+    m_nodes[index] = KNode{};
+    return index;
+}
+
+void KDynamicBvh::_free_node(std::int32_t index)
+{
+    m_nodes[index].parent = m_free_list;
+    m_nodes[index].child1 = null_node;
+    m_nodes[index].child2 = null_node;
+    m_nodes[index].height = -1;
+    m_free_list = index;
+}
+
+KAabb KDynamicBvh::_fatten(const KAabb& aabb) const
+{
+    glm::vec3 padding = (aabb.max - aabb.min) * m_margin + glm::vec3(0.01f);
+    return KAabb{aabb.min - padding, aabb.max + padding};
+}
+
+void KDynamicBvh::_insert_leaf(std::int32_t leaf)
+{
+    if (m_root == null_node)
+    {
+        m_root = leaf;
+        m_nodes[leaf].parent = null_node;
+        return;
+    }
+
+    // Walk down picking the child with the lowest surface area heuristic cost
+    KAabb leaf_aabb = m_nodes[leaf].aabb;
+    std::int32_t index = m_root;
+    while (!m_nodes[index].is_leaf())
+    {
+        const KNode& node = m_nodes[index];
+        float area = node.aabb.get_surface_area();
+        float combined_area = KAabb::merge(node.aabb, leaf_aabb).get_surface_area();
+
+        float cost = 2.0f * combined_area;
+        float inheritance_cost = 2.0f * (combined_area - area);
+
+        auto descend_cost = [&](std::int32_t child) -> float
+        {
+            const KNode& child_node = m_nodes[child];
+            float merged_area = KAabb::merge(child_node.aabb, leaf_aabb).get_surface_area();
+            if (child_node.is_leaf())
+                return merged_area + inheritance_cost;
+            return merged_area - child_node.aabb.get_surface_area() + inheritance_cost;
+        };
+
+        float cost1 = descend_cost(node.child1);
+        float cost2 = descend_cost(node.child2);
+        if (cost < cost1 && cost < cost2)
+            break;
+
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    std::int32_t sibling = index;
+    std::int32_t old_parent = m_nodes[sibling].parent;
+    std::int32_t new_parent = _allocate_node();
+
+    m_nodes[new_parent].parent = old_parent;
+    m_nodes[new_parent].aabb = KAabb::merge(leaf_aabb, m_nodes[sibling].aabb);
+    m_nodes[new_parent].height = m_nodes[sibling].height + 1;
+    m_nodes[new_parent].child1 = sibling;
+    m_nodes[new_parent].child2 = leaf;
+    m_nodes[sibling].parent = new_parent;
+    m_nodes[leaf].parent = new_parent;
+
+    if (old_parent != null_node)
+    {
+        if (m_nodes[old_parent].child1 == sibling)
+            m_nodes[old_parent].child1 = new_parent;
+        else
+            m_nodes[old_parent].child2 = new_parent;
+    }
+    else
+        m_root = new_parent;
+
+    _refit_ancestors(m_nodes[leaf].parent);
+}
+
+void KDynamicBvh::_remove_leaf(std::int32_t leaf)
+{
+    if (leaf == m_root)
+    {
+        m_root = null_node;
+        return;
+    }
+
+    std::int32_t parent = m_nodes[leaf].parent;
+    std::int32_t grand_parent = m_nodes[parent].parent;
+    std::int32_t sibling =
+        m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+    if (grand_parent != null_node)
+    {
+        if (m_nodes[grand_parent].child1 == parent)
+            m_nodes[grand_parent].child1 = sibling;
+        else
+            m_nodes[grand_parent].child2 = sibling;
+        m_nodes[sibling].parent = grand_parent;
+        _free_node(parent);
+
+        _refit_ancestors(grand_parent);
+    }
+    else
+    {
+        m_root = sibling;
+        m_nodes[sibling].parent = null_node;
+        _free_node(parent);
+    }
+}
+
+void KDynamicBvh::_refit_ancestors(std::int32_t index)
+{
+    while (index != null_node)
+    {
+        index = _balance(index);
+
+        KNode& node = m_nodes[index];
+        const KNode& child1 = m_nodes[node.child1];
+        const KNode& child2 = m_nodes[node.child2];
+        node.height = 1 + std::max(child1.height, child2.height);
+        node.aabb = KAabb::merge(child1.aabb, child2.aabb);
+
+        index = node.parent;
+    }
+}
+
+std::int32_t KDynamicBvh::_balance(std::int32_t index_a)
+{
+    KNode& a = m_nodes[index_a];
+    if (a.is_leaf() || a.height < 2)
+        return index_a;
+
+    std::int32_t index_b = a.child1;
+    std::int32_t index_c = a.child2;
+    KNode& b = m_nodes[index_b];
+    KNode& c = m_nodes[index_c];
+    std::int32_t balance = c.height - b.height;
+
+    // Rotate whichever child is too tall up into a's place
+    auto rotate_up = [&](std::int32_t index_up, KNode& up, KNode& other, bool up_is_child1)
+    {
+        std::int32_t index_f = up.child1;
+        std::int32_t index_g = up.child2;
+        KNode& f = m_nodes[index_f];
+        KNode& g = m_nodes[index_g];
+
+        up.child1 = index_a;
+        up.parent = a.parent;
+        a.parent = index_up;
+
+        if (up.parent != null_node)
+        {
+            if (m_nodes[up.parent].child1 == index_a)
+                m_nodes[up.parent].child1 = index_up;
+            else
+                m_nodes[up.parent].child2 = index_up;
+        }
+        else
+            m_root = index_up;
+
+        // The taller grandchild stays with the rotated node, the shorter one moves down to a
+        std::int32_t index_keep = f.height > g.height ? index_f : index_g;
+        std::int32_t index_move = f.height > g.height ? index_g : index_f;
+        KNode& keep = m_nodes[index_keep];
+        KNode& move = m_nodes[index_move];
+
+        up.child2 = index_keep;
+        if (up_is_child1)
+            a.child1 = index_move;
+        else
+            a.child2 = index_move;
+        move.parent = index_a;
+
+        a.aabb = KAabb::merge(other.aabb, move.aabb);
+        a.height = 1 + std::max(other.height, move.height);
+        up.aabb = KAabb::merge(a.aabb, keep.aabb);
+        up.height = 1 + std::max(a.height, keep.height);
+    };
+
+    if (balance > 1)
+    {
+        rotate_up(index_c, c, b, false);
+        return index_c;
+    }
+
+    if (balance < -1)
+    {
+        rotate_up(index_b, b, c, true);
+        return index_b;
+    }
+
+    return index_a;
+}
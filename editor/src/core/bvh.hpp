@@ -0,0 +1,197 @@
+#ifndef __KRYOS_EDITOR_CORE_BVH_HPP__
+#define __KRYOS_EDITOR_CORE_BVH_HPP__
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+struct KAabb
+{
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+
+    inline glm::vec3 get_center() const { return (min + max) * 0.5f; }
+    inline glm::vec3 get_extents() const { return (max - min) * 0.5f; }
+
+    inline float get_surface_area() const
+    {
+        glm::vec3 size = max - min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    inline bool contains(const KAabb& other) const
+    {
+        return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+               max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+    }
+
+    inline static KAabb merge(const KAabb& a, const KAabb& b)
+    {
+        return KAabb{glm::min(a.min, b.min), glm::max(a.max, b.max)};
+    }
+
+    // Bounds of the box's eight corners after the affine matrix, never smaller than the box
+    // rotated into place
+    static KAabb transform(const KAabb& aabb, const glm::mat4& matrix);
+
+    // Slab test, inverse_direction is 1 / direction so it can be shared between many boxes.
+    // Writes the entry distance to t_enter and returns false when the ray misses
+    bool raycast(
+        const glm::vec3& origin, const glm::vec3& inverse_direction, float max_distance,
+        float& t_enter
+    ) const;
+};
+
+enum KEFrustumResult
+{
+    KEFrustumResult_Outside,
+    KEFrustumResult_Intersects,
+    KEFrustumResult_Inside,
+};
+
+// Six planes (left, right, bottom, top, near, far) extracted from a view projection matrix, each
+// plane's normal points into the frustum
+struct KFrustum
+{
+    glm::vec4 planes[6] = {};
+
+    static KFrustum from_matrix(const glm::mat4& view_projection);
+    KEFrustumResult test(const KAabb& aabb) const;
+};
+
+// Dynamic bounding volume hierarchy of fattened AABBs. Leaves only get reinserted when the
+// object's tight bounds leave its fat bounds, so objects moving a little each frame are cheap to
+// keep up to date. The tree is kept balanced with AVL style rotations
+class KDynamicBvh
+{
+  public:
+    static constexpr std::int32_t null_node = -1;
+
+  public:
+    KDynamicBvh(float margin = 0.1f);
+    ~KDynamicBvh() = default;
+
+    inline std::size_t get_proxy_count() const { return m_proxy_count; }
+    inline std::size_t get_reinsert_count() const { return m_reinsert_count; }
+    inline std::uint64_t get_user_data(std::int32_t proxy) const
+    {
+        return m_nodes[proxy].user_data;
+    }
+    inline const KAabb& get_fat_aabb(std::int32_t proxy) const { return m_nodes[proxy].aabb; }
+    std::int32_t get_height() const;
+
+    std::int32_t create_proxy(const KAabb& aabb, std::uint64_t user_data);
+    void destroy_proxy(std::int32_t proxy);
+    // Returns true when the proxy had to be reinserted into the tree
+    bool move_proxy(std::int32_t proxy, const KAabb& aabb);
+    void clear();
+
+    // Calls callback(user_data) for every proxy that is at least partially inside the frustum
+    template<typename _Callback>
+    void query(const KFrustum& frustum, _Callback&& callback) const
+    {
+        if (m_root == null_node)
+            return;
+
+        m_stack.clear();
+        m_stack.push_back({m_root, false});
+        while (!m_stack.empty())
+        {
+            auto [index, inside] = m_stack.back();
+            m_stack.pop_back();
+
+            const KNode& node = m_nodes[index];
+            if (!inside)
+            {
+                KEFrustumResult result = frustum.test(node.aabb);
+                if (result == KEFrustumResult_Outside)
+                    continue;
+                // Whole subtree is visible, no need to test any of its children
+                inside = result == KEFrustumResult_Inside;
+            }
+
+            if (node.is_leaf())
+                callback(node.user_data);
+            else
+            {
+                m_stack.push_back({node.child1, inside});
+                m_stack.push_back({node.child2, inside});
+            }
+        }
+    }
+
+    // Calls callback(user_data, t_enter) for every fat AABB the ray hits closer than
+    // max_distance. The callback returns the new max distance so closer hits can clip the search
+    template<typename _Callback>
+    void raycast(
+        const glm::vec3& origin, const glm::vec3& direction, float max_distance,
+        _Callback&& callback
+    ) const
+    {
+        if (m_root == null_node)
+            return;
+
+        glm::vec3 inverse_direction = glm::vec3(1.0f) / direction;
+
+        m_stack.clear();
+        m_stack.push_back({m_root, false});
+        while (!m_stack.empty())
+        {
+            std::int32_t index = m_stack.back().index;
+            m_stack.pop_back();
+
+            const KNode& node = m_nodes[index];
+            float t_enter = 0.0f;
+            if (!node.aabb.raycast(origin, inverse_direction, max_distance, t_enter))
+                continue;
+
+            if (node.is_leaf())
+                max_distance = callback(node.user_data, t_enter);
+            else
+            {
+                m_stack.push_back({node.child1, false});
+                m_stack.push_back({node.child2, false});
+            }
+        }
+    }
+
+  private:
+    struct KNode
+    {
+        KAabb aabb = {};
+        std::uint64_t user_data = 0;
+        // Parent when in the tree, next free node when in the free list
+        std::int32_t parent = null_node;
+        std::int32_t child1 = null_node;
+        std::int32_t child2 = null_node;
+        std::int32_t height = -1;
+
+        inline bool is_leaf() const { return child1 == null_node; }
+    };
+
+    struct KStackEntry
+    {
+        std::int32_t index = null_node;
+        bool inside = false;
+    };
+
+    std::int32_t _allocate_node();
+    void _free_node(std::int32_t index);
+    KAabb _fatten(const KAabb& aabb) const;
+    void _insert_leaf(std::int32_t leaf);
+    void _remove_leaf(std::int32_t leaf);
+    void _refit_ancestors(std::int32_t index);
+    std::int32_t _balance(std::int32_t index);
+
+  private:
+    std::vector<KNode> m_nodes = {};
+    std::int32_t m_root = null_node;
+    std::int32_t m_free_list = null_node;
+    std::size_t m_proxy_count = 0;
+    std::size_t m_reinsert_count = 0;
+    float m_margin = 0.1f;
+
+    mutable std::vector<KStackEntry> m_stack = {};
+};
+
+#endif
@@ -0,0 +1,64 @@
+#include "core/command_line.hpp"
+
+KCommandLine::KCommandLine(
+    int argc, char** argv, const std::unordered_set<std::string>& value_options
+)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg.starts_with("--"))
+        {
+            std::string option = arg.substr(2);
+            std::vector<std::string>& values = m_options[option];
+            if (value_options.contains(option) && i + 1 < argc)
+            {
+                values.push_back(argv[i + 1]);
+                i++;
+            }
+        }
+        else if (m_command.empty() && m_options.empty())
+            m_command = arg;
+        else
+            m_positionals.push_back(arg);
+    }
+}
+
+bool KCommandLine::has(const std::string& option) const
+{
+    return m_options.contains(option);
+}
+
+std::string KCommandLine::get(const std::string& option, const std::string& fallback) const
+{
+    auto it = m_options.find(option);
+    if (it == m_options.end() || it->second.empty())
+        return fallback;
+    return it->second.back();
+}
+
+int KCommandLine::get_int(const std::string& option, int fallback) const
+{
+    std::string value = get(option);
+    if (value.empty())
+        return fallback;
+
+    try
+    {
+        return std::stoi(value);
+    }
+    catch (const std::exception&)
+    {
+        return fallback;
+    }
+}
+
+const std::vector<std::string>& KCommandLine::get_all(const std::string& option) const
+{
+    static const std::vector<std::string> empty = {};
+
+    auto it = m_options.find(option);
+    if (it == m_options.end())
+        return empty;
+    return it->second;
+}
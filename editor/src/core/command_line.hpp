@@ -0,0 +1,33 @@
+#ifndef __KRYOS_EDITOR_CORE_COMMAND_LINE_HPP__
+#define __KRYOS_EDITOR_CORE_COMMAND_LINE_HPP__
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Parses `Kryos <command> --option value --flag ...`. Only the options in value_options take the
+// argument after them as their value, any other option is a flag, so a flag never swallows a
+// positional. Options can be given multiple times, the last value wins for get() while get_all()
+// returns every value in order
+class KCommandLine
+{
+  public:
+    KCommandLine(int argc, char** argv, const std::unordered_set<std::string>& value_options);
+    ~KCommandLine() = default;
+
+    inline const std::string& get_command() const { return m_command; }
+    inline const std::vector<std::string>& get_positionals() const { return m_positionals; }
+
+    bool has(const std::string& option) const;
+    std::string get(const std::string& option, const std::string& fallback = "") const;
+    int get_int(const std::string& option, int fallback) const;
+    const std::vector<std::string>& get_all(const std::string& option) const;
+
+  private:
+    std::string m_command = {};
+    std::vector<std::string> m_positionals = {};
+    std::unordered_map<std::string, std::vector<std::string>> m_options = {};
+};
+
+#endif
@@ -0,0 +1,387 @@
+#include "core/component_columns.hpp"
+#include "core/derived_data_cache.hpp"
+#include "core/member_tables.hpp"
+#include "core/scene_changes.hpp"
+
+#include <kryos/core/application.hpp>
+#include <kryos/core/debug.hpp>
+#include <kryos/scene/components.hpp>
+#include <kryos/serialization/reflection.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+
+// Engine components, their reflected layout alone can miss members that aren't reflected
+template<typename... _Components>
+static std::unordered_map<std::uint64_t, bool> compile_time_copyable()
+{
+    return {
+        {KTypeId::create<_Components>().get_id(), std::is_trivially_copyable_v<_Components>}...
+    };
+}
+
+template<typename... _Types>
+static std::unordered_set<std::uint64_t> plain_types()
+{
+    static_assert((std::is_trivially_copyable_v<_Types> && ...), "plain types are copied as bytes");
+    return {KTypeId::create<_Types>().get_id()...};
+}
+
+static bool layout_is_copyable(std::uint64_t type_id, int depth)
+{
+    if (KComponentColumns::is_plain_type(type_id))
+        return true;
+
+    // Nested a few levels deep at most, a type that refers back to itself is never copyable
+    KLMemberTables* tables = KLMemberTables::get();
+    std::uint32_t table = tables->find(type_id);
+    if (table == KLMemberTables::null_table || depth > 8)
+        return false;
+
+    if (!KComponentColumns::is_fully_reflected(type_id))
+        return false;
+
+    const KMemberTable& member_table = tables->get_table(table);
+    for (const KMemberEntry* entry = tables->begin(member_table);
+         entry != tables->end(member_table); entry++)
+    {
+        // Pointers would be written out as addresses, containers own heap memory
+        KEMemberEntryFlags owning =
+            KEMemberEntryFlag_Pointer | KEMemberEntryFlag_StdVector | KEMemberEntryFlag_StdArray;
+        if (entry->flags & owning)
+            return false;
+        if (!layout_is_copyable(entry->type_id, depth + 1))
+            return false;
+    }
+    return true;
+}
+
+static void hash_layout(KContentHasher& hasher, std::uint64_t type_id)
+{
+    KLMemberTables* tables = KLMemberTables::get();
+    std::uint32_t table = tables->find(type_id);
+    if (table == KLMemberTables::null_table)
+        return;
+
+    // Names and sizes rather than type ids, type ids differ between builds
+    const KMemberTable& member_table = tables->get_table(table);
+    for (const KMemberEntry* entry = tables->begin(member_table);
+         entry != tables->end(member_table); entry++)
+    {
+        hasher.update(std::string(tables->get_string(entry->name)));
+        hasher.update(static_cast<std::uint64_t>(entry->offset));
+        hasher.update(static_cast<std::uint64_t>(entry->type_size));
+        hasher.update(static_cast<std::uint64_t>(entry->array_size));
+        if (entry->flags & KEMemberEntryFlag_Nested)
+            hash_layout(hasher, entry->type_id);
+    }
+}
+
+static std::size_t align_up(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+bool KComponentColumns::is_plain_type(std::uint64_t type_id)
+{
+    static const std::unordered_set<std::uint64_t> plain = plain_types<
+        bool, char, std::int8_t, std::uint8_t, std::int16_t, std::uint16_t, std::int32_t,
+        std::uint32_t, std::int64_t, std::uint64_t, float, double, glm::vec2, glm::vec3,
+        glm::vec4, glm::ivec2, glm::ivec3, glm::ivec4, glm::uvec2, glm::uvec3, glm::uvec4,
+        glm::quat, glm::mat3, glm::mat4>();
+
+    return plain.contains(type_id);
+}
+
+bool KComponentColumns::is_fully_reflected(std::uint64_t type_id)
+{
+    KLMemberTables* tables = KLMemberTables::get();
+    std::uint32_t table = tables->find(type_id);
+    if (table == KLMemberTables::null_table)
+        return false;
+
+    // Padding never reaches the size of a pointer, the entries are sorted by offset
+    KLReflectionRegistry* reflection = KIApplication::get_layer<KLReflectionRegistry>();
+    const std::uint32_t max_padding = sizeof(void*);
+    const KMemberTable& member_table = tables->get_table(table);
+    std::uint32_t end = 0;
+    for (const KMemberEntry* entry = tables->begin(member_table);
+         entry != tables->end(member_table); entry++)
+    {
+        if (entry->offset >= end + max_padding)
+            return false;
+
+        std::uint32_t size = static_cast<std::uint32_t>(
+            entry->flags & KEMemberEntryFlag_Pointer
+                ? sizeof(void*)
+                : reflection->get_type_info(KTypeId(entry->type_id)).size
+        );
+        if (entry->flags & KEMemberEntryFlag_Array)
+            size *= entry->array_size;
+        end = std::max(end, entry->offset + size);
+    }
+
+    return reflection->get_type_info(KTypeId(type_id)).size < end + max_padding;
+}
+
+bool KComponentColumns::is_trivially_copyable(std::uint64_t type_id)
+{
+    static const std::unordered_map<std::uint64_t, bool> engine_components =
+        compile_time_copyable<KCTransform, KCCamera, KCMeshRenderer, KCName, KCTag, KCParent>();
+
+    auto it = engine_components.find(type_id);
+    if (it != engine_components.end() && !it->second)
+        return false;
+
+    return KLMemberTables::get()->find(type_id) != KLMemberTables::null_table &&
+           layout_is_copyable(type_id, 0);
+}
+
+std::uint64_t KComponentColumns::get_layout_hash(std::uint64_t type_id)
+{
+    if (KLMemberTables::get()->find(type_id) == KLMemberTables::null_table)
+        return 0;
+
+    KLReflectionRegistry* reflection = KIApplication::get_layer<KLReflectionRegistry>();
+    KContentHasher hasher = {};
+    hasher.update(static_cast<std::uint64_t>(reflection->get_type_info(KTypeId(type_id)).size));
+    hash_layout(hasher, type_id);
+    return hasher.finish();
+}
+
+std::vector<std::uint64_t> KComponentColumns::get_copyable_types(ecs::Registry& registry)
+{
+    std::vector<std::uint64_t> types = {};
+    for (ecs::ObjectPool* pool : registry.get_pools())
+    {
+        if (is_trivially_copyable(pool->get_type_hash()))
+            types.push_back(pool->get_type_hash());
+    }
+    return types;
+}
+
+void KComponentColumns::write(
+    ecs::Registry& registry, const std::vector<ecs::Entity>& entities,
+    const std::vector<std::uint64_t>& types, std::vector<std::uint8_t>& output,
+    std::vector<KColumnStats>* stats
+)
+{
+    KLReflectionRegistry* reflection = KIApplication::get_layer<KLReflectionRegistry>();
+
+    std::vector<ecs::ObjectPool*> pools = {};
+    for (std::uint64_t type : types)
+    {
+        if (!is_trivially_copyable(type))
+            continue;
+
+        for (ecs::ObjectPool* pool : registry.get_pools())
+        {
+            if (pool->get_type_hash() == type)
+            {
+                pools.push_back(pool);
+                break;
+            }
+        }
+    }
+
+    // Counted first so every column can be written straight to its final place
+    std::vector<KColumnHeader> columns = std::vector<KColumnHeader>(pools.size());
+    std::vector<std::vector<std::uint32_t>> indices =
+        std::vector<std::vector<std::uint32_t>>(pools.size());
+    std::string names = {};
+    for (std::size_t i = 0; i < pools.size(); i++)
+    {
+        for (std::size_t entity = 0; entity < entities.size(); entity++)
+        {
+            if (entities[entity] != ECS_ENTITY_DESTROYED &&
+                pools[i]->get_entitys_object(entities[entity]) != nullptr)
+                indices[i].push_back(static_cast<std::uint32_t>(entity));
+        }
+
+        // Named the way the reader looks types up
+        const KTypeInfo& info = reflection->get_type_info(KTypeId(pools[i]->get_type_hash()));
+        const std::string& name = info.name;
+        columns[i].layout_hash = get_layout_hash(pools[i]->get_type_hash());
+        columns[i].component_size = static_cast<std::uint32_t>(info.size);
+        columns[i].count = static_cast<std::uint32_t>(indices[i].size());
+        columns[i].name_offset = static_cast<std::uint32_t>(names.size());
+        columns[i].name_length = static_cast<std::uint32_t>(name.size());
+        names += name;
+    }
+
+    std::size_t offset = sizeof(KColumnFileHeader) + columns.size() * sizeof(KColumnHeader);
+    std::size_t names_offset = offset;
+    offset += names.size();
+    for (KColumnHeader& column : columns)
+    {
+        column.name_offset += static_cast<std::uint32_t>(names_offset);
+        column.entity_offset = align_up(offset, column_file_alignment);
+        column.data_offset = align_up(
+            column.entity_offset + column.count * sizeof(std::uint32_t), column_file_alignment
+        );
+        offset =
+            column.data_offset + static_cast<std::size_t>(column.count) * column.component_size;
+    }
+
+    output.assign(offset, 0);
+    KColumnFileHeader header = {};
+    header.column_count = static_cast<std::uint32_t>(columns.size());
+    header.entity_count = static_cast<std::uint32_t>(entities.size());
+    std::memcpy(output.data(), &header, sizeof(header));
+    std::memcpy(
+        output.data() + sizeof(header), columns.data(), columns.size() * sizeof(KColumnHeader)
+    );
+    std::memcpy(output.data() + names_offset, names.data(), names.size());
+
+    for (std::size_t i = 0; i < pools.size(); i++)
+    {
+        const KColumnHeader& column = columns[i];
+        if (!indices[i].empty())
+            std::memcpy(
+                output.data() + column.entity_offset, indices[i].data(),
+                indices[i].size() * sizeof(std::uint32_t)
+            );
+
+        std::uint8_t* data = output.data() + column.data_offset;
+        for (std::uint32_t entity : indices[i])
+        {
+            const void* component = pools[i]->get_entitys_object(entities[entity]);
+            std::memcpy(data, component, column.component_size);
+            data += column.component_size;
+        }
+
+        if (stats != nullptr)
+        {
+            KColumnStats column_stats = {};
+            column_stats.name = std::string(
+                names.data() + (column.name_offset - names_offset), column.name_length
+            );
+            column_stats.count = column.count;
+            column_stats.size = static_cast<std::uint64_t>(column.count) * column.component_size;
+            stats->push_back(column_stats);
+        }
+    }
+}
+
+bool KComponentColumns::read(
+    const std::vector<ecs::Entity>& entities, const std::uint8_t* data, std::size_t size
+)
+{
+    KLReflectionRegistry* reflection = KIApplication::get_layer<KLReflectionRegistry>();
+
+    KColumnFileHeader header = {};
+    if (size < sizeof(header))
+    {
+        KLDebug::log("ComponentColumns::read() -> data is truncated", KEDebugType_Error);
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != column_file_magic || header.version != column_file_version ||
+        header.entity_count > entities.size() ||
+        sizeof(header) + static_cast<std::size_t>(header.column_count) * sizeof(KColumnHeader) >
+            size)
+    {
+        KLDebug::log(
+            "ComponentColumns::read() -> data is not component columns of this version or refers "
+            "to more entities than given",
+            KEDebugType_Error
+        );
+        return false;
+    }
+
+    std::vector<KColumnHeader> columns = std::vector<KColumnHeader>(header.column_count);
+    std::memcpy(columns.data(), data + sizeof(header), columns.size() * sizeof(KColumnHeader));
+
+    // Everything is validated before the first component is touched
+    std::vector<std::uint64_t> types = std::vector<std::uint64_t>(columns.size(), 0);
+    for (std::size_t i = 0; i < columns.size(); i++)
+    {
+        const KColumnHeader& column = columns[i];
+        std::uint64_t entity_size =
+            static_cast<std::uint64_t>(column.count) * sizeof(std::uint32_t);
+        std::uint64_t data_size = static_cast<std::uint64_t>(column.count) * column.component_size;
+        if (static_cast<std::uint64_t>(column.name_offset) + column.name_length > size ||
+            column.entity_offset > size || entity_size > size - column.entity_offset ||
+            column.data_offset > size || data_size > size - column.data_offset ||
+            column.entity_offset % alignof(std::uint32_t) != 0)
+        {
+            KLDebug::log("ComponentColumns::read() -> column is out of bounds", KEDebugType_Error);
+            return false;
+        }
+
+        std::string name = std::string(
+            reinterpret_cast<const char*>(data + column.name_offset), column.name_length
+        );
+        for (const auto& [type, info] : reflection->get_all_type_infos())
+        {
+            if (info.name == name)
+            {
+                types[i] = type;
+                break;
+            }
+        }
+
+        if (types[i] == 0 || !is_trivially_copyable(types[i]) ||
+            get_layout_hash(types[i]) != column.layout_hash ||
+            reflection->get_type_info(KTypeId(types[i])).size != column.component_size)
+        {
+            KLDebug::log(
+                "ComponentColumns::read() -> component '" + name +
+                    "' is unknown or its layout changed since it was written",
+                KEDebugType_Error
+            );
+            return false;
+        }
+
+        const std::uint32_t* indices =
+            reinterpret_cast<const std::uint32_t*>(data + column.entity_offset);
+        for (std::uint32_t entity = 0; entity < column.count; entity++)
+        {
+            if (indices[entity] >= header.entity_count ||
+                entities[indices[entity]] == ECS_ENTITY_DESTROYED)
+            {
+                KLDebug::log(
+                    "ComponentColumns::read() -> column refers to a missing entity",
+                    KEDebugType_Error
+                );
+                return false;
+            }
+        }
+    }
+
+    bool added = false;
+    for (std::size_t i = 0; i < columns.size(); i++)
+    {
+        const KColumnHeader& column = columns[i];
+        const std::uint32_t* indices =
+            reinterpret_cast<const std::uint32_t*>(data + column.entity_offset);
+        const std::uint8_t* components = data + column.data_offset;
+        for (std::uint32_t entity = 0; entity < column.count; entity++)
+        {
+            KEntity target = KEntity(entities[indices[entity]]);
+            void* component = target.get_component(types[i]);
+            if (component == nullptr)
+            {
+                target.add_component(reflection, types[i]);
+                component = target.get_component(types[i]);
+                added = true;
+            }
+
+            std::memcpy(
+                component, components + static_cast<std::size_t>(entity) * column.component_size,
+                column.component_size
+            );
+        }
+
+        KLSceneChanges::get()->mark_pool_mutated(types[i]);
+    }
+
+    if (added)
+        KLSceneChanges::get()->mark_structure_changed();
+    return true;
+}
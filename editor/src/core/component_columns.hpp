@@ -0,0 +1,77 @@
+#ifndef __KRYOS_EDITOR_CORE_COMPONENT_COLUMNS_HPP__
+#define __KRYOS_EDITOR_CORE_COMPONENT_COLUMNS_HPP__
+
+#include <kryos/scene/entity.hpp>
+#include <kryos/scene/scene_manager.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr std::uint32_t column_file_magic = 0x4c4f434b; // "KCOL"
+constexpr std::uint32_t column_file_version = 1;
+constexpr std::uint32_t column_file_alignment = 16;
+
+struct KColumnFileHeader
+{
+    std::uint32_t magic = column_file_magic;
+    std::uint32_t version = column_file_version;
+    std::uint32_t column_count = 0;
+    // Entities the columns index into, the reader must pass at least as many
+    std::uint32_t entity_count = 0;
+};
+
+// One pool's components, count entity indices followed by count components packed back to back.
+// The type is looked up by name, the layout hash guards against the component having changed
+struct KColumnHeader
+{
+    std::uint64_t layout_hash = 0;
+    std::uint32_t component_size = 0;
+    std::uint32_t count = 0;
+    std::uint32_t name_offset = 0;
+    std::uint32_t name_length = 0;
+    std::uint64_t entity_offset = 0;
+    std::uint64_t data_offset = 0;
+};
+static_assert(sizeof(KColumnHeader) == 40, "column headers are written as is");
+
+struct KColumnStats
+{
+    std::string name = {};
+    std::size_t count = 0;
+    std::uint64_t size = 0;
+};
+
+// Writes and reads whole component pools as raw bytes for components whose reflected layout is
+// trivially copyable, one memcpy per component instead of one per member. Engine components are
+// checked with std::is_trivially_copyable at compile time on top of their reflected layout, any
+// other component is trusted on its reflected layout alone
+struct KComponentColumns
+{
+    // Primitives and glm types, the only member types a copyable layout can be made of
+    static bool is_plain_type(std::uint64_t type_id);
+    // Whether the reflected members cover the whole type apart from padding, bytes that no member
+    // accounts for could belong to an unreflected member that isn't safe to copy as bytes
+    static bool is_fully_reflected(std::uint64_t type_id);
+    static bool is_trivially_copyable(std::uint64_t type_id);
+    // Hash of the member names, offsets and sizes, 0 when the type has no reflected members
+    static std::uint64_t get_layout_hash(std::uint64_t type_id);
+    // Types of the registry's pools that can be written as columns
+    static std::vector<std::uint64_t> get_copyable_types(ecs::Registry& registry);
+
+    // Entities are referred to by their index in entities, components of other entities are left
+    // out. Types that aren't trivially copyable are skipped
+    static void write(
+        ecs::Registry& registry, const std::vector<ecs::Entity>& entities,
+        const std::vector<std::uint64_t>& types, std::vector<std::uint8_t>& output,
+        std::vector<KColumnStats>* stats = nullptr
+    );
+    // Components missing on an entity are added first. Fails without touching the registry when
+    // the data is malformed, a type is unknown or its layout changed
+    static bool read(
+        const std::vector<ecs::Entity>& entities, const std::uint8_t* data, std::size_t size
+    );
+};
+
+#endif
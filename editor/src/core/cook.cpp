@@ -0,0 +1,499 @@
+#include "core/cook.hpp"
+#include "core/block_compression.hpp"
+#include "core/cooked_mesh.hpp"
+#include "core/cooked_texture.hpp"
+#include "core/derived_data_cache.hpp"
+#include "core/mesh_cooker.hpp"
+#include "core/texture_cooker.hpp"
+#include "core/worker_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <latch>
+#include <vector>
+
+// MiB
+static constexpr int default_cache_size = 2048;
+
+struct KCookJob
+{
+    std::string source_filename = {};
+    std::string filename = {};
+    bool texture = false;
+    KCookStats stats = {};
+    KTextureCookStats texture_stats = {};
+    double time = 0.0;
+    bool succeeded = false;
+};
+
+static double milliseconds_since(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Quantized corners of a triangle, rotated so the smallest comes first, which keeps the winding
+using KQuantizedTriangle = std::array<std::uint16_t, 9>;
+
+static void add_triangle(
+    std::vector<KQuantizedTriangle>& triangles, const std::array<std::uint16_t, 3>* corners
+)
+{
+    std::size_t first = 0;
+    for (std::size_t i = 1; i < 3; i++)
+    {
+        if (corners[i] < corners[first])
+            first = i;
+    }
+
+    KQuantizedTriangle& triangle = triangles.emplace_back();
+    for (std::size_t i = 0; i < 3; i++)
+        std::memcpy(&triangle[i * 3], corners[(first + i) % 3].data(), 3 * sizeof(std::uint16_t));
+}
+
+// LOD 0 of the cooked mesh has to hold the source's triangles. The source is quantized inside the
+// file's bounds the same way the cooker does it, so a faithful file matches bit for bit whatever
+// order the optimizer left the triangles and vertices in
+static bool verify_mesh(const KSourceMesh& source, const KCookedMesh& cooked)
+{
+    const KMeshFileHeader& header = cooked.get_header();
+    if (header.lods[0].index_count != source.indices.size() || source.indices.size() % 3 != 0)
+        return false;
+
+    glm::vec3 bounds_min =
+        glm::vec3(header.bounds_min[0], header.bounds_min[1], header.bounds_min[2]);
+    glm::vec3 extent =
+        glm::vec3(header.bounds_max[0], header.bounds_max[1], header.bounds_max[2]) - bounds_min;
+
+    std::vector<KQuantizedTriangle> expected = {};
+    std::vector<KQuantizedTriangle> actual = {};
+    expected.reserve(source.indices.size() / 3);
+    actual.reserve(source.indices.size() / 3);
+    std::array<std::uint16_t, 3> corners[3] = {};
+    for (std::size_t i = 0; i < source.indices.size(); i += 3)
+    {
+        for (std::size_t corner = 0; corner < 3; corner++)
+        {
+            const glm::vec3& position = source.positions[source.indices[i + corner]];
+            for (int axis = 0; axis < 3; axis++)
+            {
+                float t = extent[axis] > 0.0f ? (position[axis] - bounds_min[axis]) / extent[axis]
+                                              : 0.0f;
+                corners[corner][axis] =
+                    static_cast<std::uint16_t>(std::lround(std::clamp(t, 0.0f, 1.0f) * 65535.0f));
+            }
+        }
+        add_triangle(expected, corners);
+
+        for (std::size_t corner = 0; corner < 3; corner++)
+        {
+            std::uint32_t vertex = cooked.get_index(header.lods[0].first_index + i + corner);
+            if (vertex >= header.vertex_count)
+                return false;
+            std::memcpy(
+                corners[corner].data(), cooked.get_vertices()[vertex].position,
+                3 * sizeof(std::uint16_t)
+            );
+        }
+        add_triangle(actual, corners);
+    }
+
+    std::sort(expected.begin(), expected.end());
+    std::sort(actual.begin(), actual.end());
+    return expected == actual;
+}
+
+// Mip 0 of the cooked texture has to decode to the quality the cooker measured when it encoded
+// it, anything else means the file doesn't hold what was encoded
+static bool verify_texture(const KSourceImage& source, const KCookedTexture& cooked)
+{
+    const KTextureFileHeader& header = cooked.get_header();
+    if (header.width != source.width || header.height != source.height ||
+        source.pixels.size() != static_cast<std::size_t>(source.width) * source.height * 4)
+        return false;
+
+    // Rows are stored bottom up
+    std::size_t row_size = static_cast<std::size_t>(source.width) * 4;
+    std::vector<std::uint8_t> expected = std::vector<std::uint8_t>(source.pixels.size());
+    for (std::uint32_t y = 0; y < source.height; y++)
+    {
+        std::memcpy(
+            expected.data() + (source.height - 1 - y) * row_size,
+            source.pixels.data() + y * row_size, row_size
+        );
+    }
+
+    KETextureFormat format = static_cast<KETextureFormat>(header.format);
+    std::vector<std::uint8_t> decoded = std::vector<std::uint8_t>(source.pixels.size());
+    KBlockCompression::decode_image(
+        format, cooked.get_mip_data(0), source.width, source.height, decoded.data()
+    );
+    float psnr = KTextureCooker::compute_psnr(
+        expected.data(), decoded.data(), static_cast<std::size_t>(source.width) * source.height,
+        KTextureCooker::get_channel_mask(format)
+    );
+    return std::abs(psnr - header.psnr) < 0.01f;
+}
+
+// Returns how many cooked files failed their round trip against the source
+static std::size_t benchmark(const std::vector<KCookJob>& jobs, int iterations)
+{
+    std::size_t mismatch_count = 0;
+    std::size_t verified_count = 0;
+    double source_time = 0.0;
+    double cooked_time = 0.0;
+    std::size_t source_memory = 0;
+    std::size_t cooked_memory = 0;
+    // Keeps the touched data alive so the loops can't be optimized away
+    float checksum = 0.0f;
+
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        for (const KCookJob& job : jobs)
+        {
+            if (!job.succeeded)
+                continue;
+
+            if (job.texture)
+            {
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                KSourceImage source = {};
+                ImageLoader::load(job.source_filename, source);
+                source_time += milliseconds_since(start);
+                if (!source.pixels.empty())
+                    checksum += static_cast<float>(source.pixels.back());
+
+                start = std::chrono::steady_clock::now();
+                KCookedTexture cooked = {};
+                if (cooked.open(job.filename))
+                {
+                    const std::uint8_t* blocks = cooked.get_mip_data(0);
+                    std::uint32_t sum = 0;
+                    for (std::uint64_t i = 0; i < cooked.get_header().mips[0].size; i++)
+                        sum += blocks[i];
+                    checksum += static_cast<float>(sum & 0xff);
+                }
+                cooked_time += milliseconds_since(start);
+
+                if (iteration == 0)
+                {
+                    source_memory += source.get_memory_size();
+                    cooked_memory += cooked.get_mapped_size();
+
+                    verified_count++;
+                    if (!cooked.is_open() || !verify_texture(source, cooked))
+                    {
+                        std::fprintf(
+                            stderr, "'%s' doesn't round trip to '%s'\n", job.filename.c_str(),
+                            job.source_filename.c_str()
+                        );
+                        mismatch_count++;
+                    }
+                }
+                continue;
+            }
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            KSourceMesh source = {};
+            ObjLoader::load(job.source_filename, source);
+            source_time += milliseconds_since(start);
+            if (!source.positions.empty())
+                checksum += source.positions.back().x;
+
+            // Reading every vertex and index makes the mapped pages count, not just the mmap call
+            start = std::chrono::steady_clock::now();
+            KCookedMesh cooked = {};
+            if (cooked.open(job.filename))
+            {
+                const KMeshFileHeader& header = cooked.get_header();
+                const KPackedVertex* vertices = cooked.get_vertices();
+                std::uint32_t sum = 0;
+                for (std::uint32_t i = 0; i < header.vertex_count; i++)
+                    sum += vertices[i].position[0];
+                for (std::uint32_t i = 0; i < header.index_count; i++)
+                    sum += cooked.get_index(i);
+                checksum += static_cast<float>(sum & 0xff);
+            }
+            cooked_time += milliseconds_since(start);
+
+            if (iteration == 0)
+            {
+                source_memory += source.get_memory_size();
+                cooked_memory += cooked.get_mapped_size();
+
+                verified_count++;
+                if (!cooked.is_open() || !verify_mesh(source, cooked))
+                {
+                    std::fprintf(
+                        stderr, "'%s' doesn't round trip to '%s'\n", job.filename.c_str(),
+                        job.source_filename.c_str()
+                    );
+                    mismatch_count++;
+                }
+            }
+        }
+    }
+
+    double count = static_cast<double>(std::max(iterations, 1));
+    std::printf(
+        "benchmark (%i iterations, checksum %g):\n"
+        "  source: %.3fms per pass, %.2fMiB resident\n"
+        "  cooked: %.3fms per pass, %.2fMiB mapped\n"
+        "  %.1fx faster, %.1fx smaller\n",
+        iterations, static_cast<double>(checksum), source_time / count,
+        static_cast<double>(source_memory) / (1024.0 * 1024.0), cooked_time / count,
+        static_cast<double>(cooked_memory) / (1024.0 * 1024.0),
+        cooked_time > 0.0 ? source_time / cooked_time : 0.0,
+        cooked_memory > 0 ? static_cast<double>(source_memory) / static_cast<double>(cooked_memory)
+                          : 0.0
+    );
+    std::printf(
+        "round trip: %zu of %zu assets match their source\n", verified_count - mismatch_count,
+        verified_count
+    );
+    return mismatch_count;
+}
+
+int KCookCommand::run(const KCommandLine& command_line)
+{
+    std::string input_directory = command_line.get("input");
+    if (input_directory.empty() || !std::filesystem::is_directory(input_directory))
+    {
+        std::fprintf(
+            stderr, "usage: Kryos cook --input <directory> [--output <directory>] "
+                    "[--cache <directory>] [--cache-size <MiB>] [--no-cache] [--no-optimize] "
+                    "[--lods <count>] [--texture-format <bc1|bc3|bc5|rgba8>] [--no-mipmaps] "
+                    "[--min-psnr <dB>] [--threads <count>] [--benchmark] "
+                    "[--iterations <count>]\n"
+        );
+        return 1;
+    }
+
+    std::filesystem::path input = std::filesystem::path(input_directory);
+    std::filesystem::path output =
+        std::filesystem::path(command_line.get("output", (input / ".kryos/cooked").string()));
+
+    KMeshCookSettings settings = {};
+    settings.optimize_vertex_cache = !command_line.has("no-optimize");
+    settings.optimize_overdraw = !command_line.has("no-optimize");
+    int lod_count = command_line.get_int("lods", static_cast<int>(settings.lod_count));
+    settings.lod_count = static_cast<std::uint32_t>(std::max(lod_count, 1));
+
+    KTextureCookSettings texture_settings = {};
+    texture_settings.generate_mipmaps = !command_line.has("no-mipmaps");
+    std::string texture_format = command_line.get("texture-format");
+    if (texture_format == "bc1")
+        texture_settings.format = KETextureFormat_BC1;
+    else if (texture_format == "bc3")
+        texture_settings.format = KETextureFormat_BC3;
+    else if (texture_format == "bc5")
+        texture_settings.format = KETextureFormat_BC5;
+    else if (texture_format == "rgba8")
+        texture_settings.format = KETextureFormat_RGBA8;
+    else if (!texture_format.empty())
+    {
+        std::fprintf(stderr, "unknown texture format '%s'\n", texture_format.c_str());
+        return 1;
+    }
+    float min_psnr = static_cast<float>(command_line.get_int("min-psnr", 0));
+
+    KDerivedDataCache cache = {};
+    if (!command_line.has("no-cache"))
+    {
+        std::string cache_directory =
+            command_line.get("cache", (input / ".kryos/derived_data").string());
+        std::uint64_t cache_size = static_cast<std::uint64_t>(
+            std::max(command_line.get_int("cache-size", default_cache_size), 1)
+        );
+        cache.open(cache_directory, cache_size * 1024 * 1024);
+    }
+
+    std::vector<KCookJob> jobs = {};
+    std::error_code error = {};
+    for (auto it = std::filesystem::recursive_directory_iterator(input, error);
+         it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+    {
+        if (error)
+            break;
+
+        // Skips the output directory and anything else hidden
+        if (it->path().filename().string().starts_with("."))
+        {
+            if (it->is_directory())
+                it.disable_recursion_pending();
+            continue;
+        }
+
+        std::string extension = it->path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        bool texture = extension == ".png" || extension == ".tga";
+        if (!it->is_regular_file() || (extension != ".obj" && !texture))
+            continue;
+
+        std::filesystem::path relative = std::filesystem::relative(it->path(), input);
+        KCookJob job = {};
+        job.source_filename = it->path().string();
+        job.filename =
+            (output / relative).replace_extension(texture ? ".ktex" : ".kmesh").string();
+        job.texture = texture;
+        jobs.push_back(job);
+    }
+
+    std::sort(
+        jobs.begin(), jobs.end(),
+        [](const KCookJob& lhs, const KCookJob& rhs)
+        { return lhs.source_filename < rhs.source_filename; }
+    );
+
+    // Every job writes only to its own slot, the latch is the only synchronisation needed
+    int threads = std::max(command_line.get_int("threads", 0), 0);
+    std::size_t thread_count = static_cast<std::size_t>(threads);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    {
+        KWorkerPool pool = KWorkerPool(thread_count);
+
+        // Files are cooked in parallel first, textures split their blocks between the threads
+        // the files leave idle
+        std::size_t texture_count = static_cast<std::size_t>(std::count_if(
+            jobs.begin(), jobs.end(), [](const KCookJob& job) { return job.texture; }
+        ));
+        std::size_t spare_threads = pool.get_thread_count() / std::max<std::size_t>(jobs.size(), 1);
+        texture_settings.thread_count = static_cast<std::uint32_t>(
+            texture_count > 0 ? std::max<std::size_t>(spare_threads, 1) : 1
+        );
+
+        std::latch done = std::latch(static_cast<std::ptrdiff_t>(jobs.size()));
+        for (KCookJob& job : jobs)
+        {
+            pool.push(
+                [&job, &done, &settings, &texture_settings, &cache]()
+                {
+                    std::chrono::steady_clock::time_point job_start =
+                        std::chrono::steady_clock::now();
+                    KDerivedDataCache* job_cache = cache.is_open() ? &cache : nullptr;
+                    if (job.texture)
+                        job.succeeded = KTextureCooker::cook_file(
+                            job.source_filename, job.filename, texture_settings,
+                            &job.texture_stats, job_cache
+                        );
+                    else
+                        job.succeeded = KMeshCooker::cook_file(
+                            job.source_filename, job.filename, settings, &job.stats, job_cache
+                        );
+                    job.time = milliseconds_since(job_start);
+                    done.count_down();
+                }
+            );
+        }
+        done.wait();
+    }
+    double total_time = milliseconds_since(start);
+
+    std::size_t failed = 0;
+    std::size_t simplified_triangles = 0;
+    double simplify_time = 0.0;
+    std::size_t encoded_pixels = 0;
+    double encode_time = 0.0;
+    for (const KCookJob& job : jobs)
+    {
+        if (!job.succeeded)
+        {
+            std::fprintf(stderr, "failed to cook '%s'\n", job.source_filename.c_str());
+            failed++;
+            continue;
+        }
+
+        if (job.texture)
+        {
+            const KTextureCookStats& stats = job.texture_stats;
+            std::printf(
+                "%s: %s %ux%u, %u mips, psnr %.2fdB, %zu -> %zu bytes%s, %.3fms\n",
+                job.filename.c_str(), KTextureCooker::get_format_name(stats.format), stats.width,
+                stats.height, stats.mip_count, static_cast<double>(stats.psnr),
+                stats.source_memory, stats.cooked_size, stats.cache_hit ? ", cached" : "",
+                job.time
+            );
+
+            // Quality gate for catching encoder regressions
+            if (stats.psnr < min_psnr)
+            {
+                std::fprintf(
+                    stderr, "'%s' is below the minimum psnr of %.2fdB\n",
+                    job.source_filename.c_str(), static_cast<double>(min_psnr)
+                );
+                failed++;
+            }
+
+            encoded_pixels += stats.encoded_pixels;
+            encode_time += stats.encode_time;
+            continue;
+        }
+
+        std::string lods = {};
+        for (std::uint32_t i = 0; i < job.stats.lod_count; i++)
+            lods += (i > 0 ? " / " : "") + std::to_string(job.stats.lod_triangle_counts[i]);
+        std::printf("%s: lod triangles %s\n", job.filename.c_str(), lods.c_str());
+
+        simplified_triangles += job.stats.simplified_triangles;
+        simplify_time += job.stats.simplify_time;
+
+        if (job.stats.cache_hit)
+        {
+            std::printf(
+                "%s: %u vertices, %u indices, %zu bytes, cached, %.3fms\n", job.filename.c_str(),
+                job.stats.vertex_count, job.stats.index_count, job.stats.cooked_size, job.time
+            );
+            continue;
+        }
+
+        std::printf(
+            "%s: %u vertices, %u indices, %zu -> %zu bytes, acmr %.3f -> %.3f, %.3fms\n",
+            job.filename.c_str(), job.stats.vertex_count, job.stats.index_count,
+            job.stats.source_memory, job.stats.cooked_size, job.stats.acmr_before,
+            job.stats.acmr_after, job.time
+        );
+    }
+
+    std::printf(
+        "cooked %zu of %zu assets in %.3fms\n", jobs.size() - failed, jobs.size(), total_time
+    );
+
+    // Summed over the workers, so this is the throughput of a single thread
+    if (simplify_time > 0.0)
+        std::printf(
+            "simplified %zu triangles in %.3fms (%.2fM triangles/s per thread)\n",
+            simplified_triangles, simplify_time,
+            static_cast<double>(simplified_triangles) / simplify_time / 1000.0
+        );
+
+    if (encode_time > 0.0)
+        std::printf(
+            "encoded %zu pixels in %.3fms (%.2fM pixels/s with %u threads per texture)\n",
+            encoded_pixels, encode_time, static_cast<double>(encoded_pixels) / encode_time / 1000.0,
+            texture_settings.thread_count
+        );
+
+    if (cache.is_open())
+    {
+        KDerivedDataStats stats = cache.get_stats();
+        std::printf(
+            "derived data: %zu hits, %zu misses (%.1f%% hit rate), %.2fMiB saved, %zu entries, "
+            "%.2f / %.2fMiB, %zu evicted\n",
+            stats.hit_count, stats.miss_count, stats.get_hit_rate() * 100.0f,
+            static_cast<double>(stats.bytes_saved) / (1024.0 * 1024.0), stats.entry_count,
+            static_cast<double>(stats.size) / (1024.0 * 1024.0),
+            static_cast<double>(cache.get_max_size()) / (1024.0 * 1024.0), stats.eviction_count
+        );
+    }
+
+    if (command_line.has("benchmark"))
+        failed += benchmark(jobs, std::max(command_line.get_int("iterations", 5), 1));
+
+    return failed == 0 ? 0 : 1;
+}
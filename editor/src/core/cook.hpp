@@ -0,0 +1,16 @@
+#ifndef __KRYOS_EDITOR_CORE_COOK_HPP__
+#define __KRYOS_EDITOR_CORE_COOK_HPP__
+
+#include "core/command_line.hpp"
+
+#include <string>
+
+// `Kryos cook` cooks every source mesh and texture under a directory into the engine native
+// formats in parallel, mirroring the directory layout under the output directory. With
+// --benchmark it then compares loading the source files against mapping the cooked ones
+struct KCookCommand
+{
+    static int run(const KCommandLine& command_line);
+};
+
+#endif
@@ -0,0 +1,120 @@
+#include "core/cooked_mesh.hpp"
+
+#include <kryos/core/debug.hpp>
+
+#include <cstddef>
+
+std::uint32_t KCookedMesh::get_index(std::size_t i) const
+{
+    if (get_header().index_size == 2)
+        return static_cast<const std::uint16_t*>(get_indices())[i];
+    return static_cast<const std::uint32_t*>(get_indices())[i];
+}
+
+glm::vec3 KCookedMesh::unpack_position(const KPackedVertex& vertex) const
+{
+    const KMeshFileHeader& header = get_header();
+    glm::vec3 bounds_min =
+        glm::vec3(header.bounds_min[0], header.bounds_min[1], header.bounds_min[2]);
+    glm::vec3 bounds_max =
+        glm::vec3(header.bounds_max[0], header.bounds_max[1], header.bounds_max[2]);
+    glm::vec3 t =
+        glm::vec3(vertex.position[0], vertex.position[1], vertex.position[2]) / 65535.0f;
+    return bounds_min + (bounds_max - bounds_min) * t;
+}
+
+bool KCookedMesh::open(const std::string& filename)
+{
+    if (!m_file.open(filename, sizeof(KMeshFileHeader), "CookedMesh::open()"))
+        return false;
+
+    if (!_validate(filename))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void KCookedMesh::close() { m_file.close(); }
+
+KCookedMeshBuffers KCookedMesh::upload() const
+{
+    KCookedMeshBuffers buffers = {};
+    if (!is_open())
+        return buffers;
+
+    const KMeshFileHeader& header = get_header();
+    std::uint64_t vertex_size =
+        static_cast<std::uint64_t>(header.vertex_count) * sizeof(KPackedVertex);
+    std::uint64_t index_size = static_cast<std::uint64_t>(header.index_count) * header.index_size;
+
+    glCreateBuffers(1, &buffers.vertex_buffer);
+    glNamedBufferStorage(
+        buffers.vertex_buffer, static_cast<GLsizeiptr>(vertex_size), get_vertices(), 0
+    );
+    glCreateBuffers(1, &buffers.index_buffer);
+    glNamedBufferStorage(
+        buffers.index_buffer, static_cast<GLsizeiptr>(index_size), get_indices(), 0
+    );
+    buffers.index_type = header.index_size == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+    glCreateVertexArrays(1, &buffers.vertex_array);
+    glVertexArrayVertexBuffer(
+        buffers.vertex_array, 0, buffers.vertex_buffer, 0, sizeof(KPackedVertex)
+    );
+    glVertexArrayElementBuffer(buffers.vertex_array, buffers.index_buffer);
+
+    glEnableVertexArrayAttrib(buffers.vertex_array, 0);
+    glVertexArrayAttribFormat(
+        buffers.vertex_array, 0, 3, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(KPackedVertex, position)
+    );
+    glVertexArrayAttribBinding(buffers.vertex_array, 0, 0);
+    glEnableVertexArrayAttrib(buffers.vertex_array, 1);
+    glVertexArrayAttribFormat(
+        buffers.vertex_array, 1, 3, GL_BYTE, GL_TRUE, offsetof(KPackedVertex, normal)
+    );
+    glVertexArrayAttribBinding(buffers.vertex_array, 1, 0);
+    glEnableVertexArrayAttrib(buffers.vertex_array, 2);
+    glVertexArrayAttribFormat(
+        buffers.vertex_array, 2, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(KPackedVertex, uv)
+    );
+    glVertexArrayAttribBinding(buffers.vertex_array, 2, 0);
+    return buffers;
+}
+
+bool KCookedMesh::_validate(const std::string& filename) const
+{
+    const KMeshFileHeader& header = get_header();
+    if (header.magic != mesh_file_magic || header.version != mesh_file_version)
+    {
+        KLDebug::log(
+            "CookedMesh::open() -> " + filename + " is not a version " +
+                std::to_string(mesh_file_version) + " cooked mesh",
+            KEDebugType_Error
+        );
+        return false;
+    }
+
+    std::uint64_t vertex_count = header.vertex_count;
+    std::uint64_t index_count = header.index_count;
+    std::uint64_t vertices_end = header.vertex_offset + vertex_count * sizeof(KPackedVertex);
+    std::uint64_t indices_end = header.index_offset + index_count * header.index_size;
+    std::uint64_t size = m_file.get_size();
+    bool valid = header.vertex_stride == sizeof(KPackedVertex) &&
+                 (header.index_size == 2 || header.index_size == 4) &&
+                 header.vertex_offset % mesh_file_alignment == 0 &&
+                 header.index_offset % mesh_file_alignment == 0 && vertices_end <= size &&
+                 indices_end <= size && header.lod_count >= 1 &&
+                 header.lod_count <= mesh_max_lods;
+    for (std::uint32_t i = 0; valid && i < header.lod_count; i++)
+    {
+        std::uint64_t lod_end =
+            static_cast<std::uint64_t>(header.lods[i].first_index) + header.lods[i].index_count;
+        valid = lod_end <= header.index_count;
+    }
+
+    if (!valid)
+        KLDebug::log("CookedMesh::open() -> " + filename + " is corrupted", KEDebugType_Error);
+    return valid;
+}
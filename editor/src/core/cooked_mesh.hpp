@@ -0,0 +1,66 @@
+#ifndef __KRYOS_EDITOR_CORE_COOKED_MESH_HPP__
+#define __KRYOS_EDITOR_CORE_COOKED_MESH_HPP__
+
+#include "core/mapped_file.hpp"
+#include "core/mesh_format.hpp"
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <string>
+
+struct KCookedMeshBuffers
+{
+    GLuint vertex_array = 0;
+    GLuint vertex_buffer = 0;
+    GLuint index_buffer = 0;
+    GLenum index_type = GL_UNSIGNED_INT;
+};
+
+// Cooked mesh file mapped into memory with a single mmap. The vertices and indices are used
+// straight from the mapping, so opening a mesh costs one syscall and nothing is parsed or copied
+class KCookedMesh
+{
+  public:
+    KCookedMesh() = default;
+    ~KCookedMesh() = default;
+
+    inline bool is_open() const { return m_file.is_open(); }
+    inline std::size_t get_mapped_size() const { return m_file.get_size(); }
+    inline const KMeshFileHeader& get_header() const
+    {
+        return *reinterpret_cast<const KMeshFileHeader*>(m_file.get_data());
+    }
+    inline const KPackedVertex* get_vertices() const
+    {
+        return reinterpret_cast<const KPackedVertex*>(
+            m_file.get_data() + get_header().vertex_offset
+        );
+    }
+    inline const void* get_indices() const
+    {
+        return m_file.get_data() + get_header().index_offset;
+    }
+    inline std::uint32_t get_lod_count() const { return get_header().lod_count; }
+    inline const KMeshLod& get_lod(std::uint32_t lod) const { return get_header().lods[lod]; }
+
+    std::uint32_t get_index(std::size_t i) const;
+    glm::vec3 unpack_position(const KPackedVertex& vertex) const;
+
+    bool open(const std::string& filename);
+    void close();
+
+    // Uploads the vertices and every LOD's indices as they are in the file. Attribute 0 is the
+    // quantized position (normalized inside the header's bounds), 1 the normal and 2 the uv.
+    // Returns empty buffers on failure
+    KCookedMeshBuffers upload() const;
+
+  private:
+    bool _validate(const std::string& filename) const;
+
+  private:
+    KMappedFile m_file = {};
+};
+
+#endif
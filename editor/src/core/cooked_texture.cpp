@@ -0,0 +1,135 @@
+#include "core/cooked_texture.hpp"
+#include "core/block_compression.hpp"
+
+#include <kryos/core/debug.hpp>
+
+#include <algorithm>
+
+// S3TC is an extension rather than core, the enums aren't always generated
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+GLenum KCookedTexture::get_internal_format() const
+{
+    const KTextureFileHeader& header = get_header();
+    bool srgb = (header.flags & KETextureFlags_Srgb) != 0;
+    switch (header.format)
+    {
+    case KETextureFormat_BC1:
+        return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case KETextureFormat_BC3:
+        return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case KETextureFormat_BC5:
+        return GL_COMPRESSED_RG_RGTC2;
+    default:
+        return srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+    }
+}
+
+bool KCookedTexture::open(const std::string& filename)
+{
+    if (!m_file.open(filename, sizeof(KTextureFileHeader), "CookedTexture::open()"))
+        return false;
+
+    if (!_validate(filename))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void KCookedTexture::close() { m_file.close(); }
+
+GLuint KCookedTexture::upload() const
+{
+    if (!is_open())
+        return 0;
+
+    const KTextureFileHeader& header = get_header();
+    GLenum internal_format = get_internal_format();
+
+    GLuint texture = 0;
+    glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+    glTextureStorage2D(
+        texture, static_cast<GLsizei>(header.mip_count), internal_format,
+        static_cast<GLsizei>(header.width), static_cast<GLsizei>(header.height)
+    );
+
+    // Small mips and odd widths don't keep rows 4 byte aligned
+    GLint last_alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &last_alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (std::uint32_t mip = 0; mip < header.mip_count; mip++)
+    {
+        const KTextureMip& level = header.mips[mip];
+        if (header.format == KETextureFormat_RGBA8)
+        {
+            glTextureSubImage2D(
+                texture, static_cast<GLint>(mip), 0, 0, static_cast<GLsizei>(level.width),
+                static_cast<GLsizei>(level.height), GL_RGBA, GL_UNSIGNED_BYTE, get_mip_data(mip)
+            );
+            continue;
+        }
+
+        glCompressedTextureSubImage2D(
+            texture, static_cast<GLint>(mip), 0, 0, static_cast<GLsizei>(level.width),
+            static_cast<GLsizei>(level.height), internal_format, static_cast<GLsizei>(level.size),
+            get_mip_data(mip)
+        );
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, last_alignment);
+    glTextureParameteri(
+        texture, GL_TEXTURE_MIN_FILTER,
+        header.mip_count > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR
+    );
+    glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(texture, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(header.mip_count - 1));
+    return texture;
+}
+
+bool KCookedTexture::_validate(const std::string& filename) const
+{
+    const KTextureFileHeader& header = get_header();
+    if (header.magic != texture_file_magic || header.version != texture_file_version)
+    {
+        KLDebug::log(
+            "CookedTexture::open() -> " + filename + " is not a version " +
+                std::to_string(texture_file_version) + " cooked texture",
+            KEDebugType_Error
+        );
+        return false;
+    }
+
+    KETextureFormat format = static_cast<KETextureFormat>(header.format);
+    bool valid = header.format < KETextureFormat_Auto && header.width > 0 && header.height > 0 &&
+                 header.mip_count >= 1 && header.mip_count <= texture_max_mips;
+    std::uint32_t width = header.width;
+    std::uint32_t height = header.height;
+    for (std::uint32_t mip = 0; valid && mip < header.mip_count; mip++)
+    {
+        const KTextureMip& level = header.mips[mip];
+        valid = level.width == width && level.height == height &&
+                level.size == KBlockCompression::get_mip_size(format, width, height) &&
+                level.offset % texture_file_alignment == 0 &&
+                level.offset + level.size <= m_file.get_size();
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+    }
+
+    if (!valid)
+        KLDebug::log("CookedTexture::open() -> " + filename + " is corrupted", KEDebugType_Error);
+    return valid;
+}
@@ -0,0 +1,47 @@
+#ifndef __KRYOS_EDITOR_CORE_COOKED_TEXTURE_HPP__
+#define __KRYOS_EDITOR_CORE_COOKED_TEXTURE_HPP__
+
+#include "core/mapped_file.hpp"
+#include "core/texture_format.hpp"
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+
+// Cooked texture file mapped into memory. Mips are handed to OpenGL straight from the mapping in
+// their compressed form, nothing is decoded or transcoded on load
+class KCookedTexture
+{
+  public:
+    KCookedTexture() = default;
+    ~KCookedTexture() = default;
+
+    inline bool is_open() const { return m_file.is_open(); }
+    inline std::size_t get_mapped_size() const { return m_file.get_size(); }
+    inline const KTextureFileHeader& get_header() const
+    {
+        return *reinterpret_cast<const KTextureFileHeader*>(m_file.get_data());
+    }
+    inline const std::uint8_t* get_mip_data(std::uint32_t mip) const
+    {
+        return m_file.get_data() + get_header().mips[mip].offset;
+    }
+
+    // OpenGL internal format for the file's format and color space
+    GLenum get_internal_format() const;
+
+    bool open(const std::string& filename);
+    void close();
+
+    // Creates an immutable texture with every mip uploaded, returns 0 on failure
+    GLuint upload() const;
+
+  private:
+    bool _validate(const std::string& filename) const;
+
+  private:
+    KMappedFile m_file = {};
+};
+
+#endif
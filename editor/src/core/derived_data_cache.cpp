@@ -0,0 +1,296 @@
+#include "core/derived_data_cache.hpp"
+
+#include <kryos/core/debug.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+static constexpr std::uint32_t blob_magic = 0x4344444b; // "KDDC"
+static constexpr std::uint32_t blob_version = 1;
+
+struct KBlobHeader
+{
+    std::uint32_t magic = blob_magic;
+    std::uint32_t version = blob_version;
+    std::uint64_t key = 0;
+};
+
+static std::uint64_t mix(std::uint64_t value)
+{
+    // MurmurHash3's finalizer
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdull;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ull;
+    value ^= value >> 33;
+    return value;
+}
+
+void KContentHasher::update(const void* data, std::size_t size)
+{
+    const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        std::uint64_t word = 0;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        m_state = (m_state ^ mix(word)) * 0x100000001b3ull;
+        m_state = (m_state << 31) | (m_state >> 33);
+    }
+
+    std::uint64_t tail = 0;
+    std::memcpy(&tail, bytes + i, size - i);
+    m_state = (m_state ^ mix(tail ^ (size - i))) * 0x100000001b3ull;
+    m_length += size;
+}
+
+void KContentHasher::update(const std::string& value)
+{
+    // Length first so ("ab", "c") and ("a", "bc") hash differently
+    update(static_cast<std::uint64_t>(value.size()));
+    update(value.data(), value.size());
+}
+
+void KContentHasher::update(std::uint64_t value) { update(&value, sizeof(value)); }
+
+std::uint64_t KContentHasher::finish() const { return mix(m_state ^ m_length); }
+
+KDerivedDataStats KDerivedDataCache::get_stats() const
+{
+    KDerivedDataStats stats = {};
+    stats.hit_count = m_hit_count.load(std::memory_order_relaxed);
+    stats.miss_count = m_miss_count.load(std::memory_order_relaxed);
+    stats.store_count = m_store_count.load(std::memory_order_relaxed);
+    stats.eviction_count = m_eviction_count.load(std::memory_order_relaxed);
+    stats.bytes_saved = m_bytes_saved.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(m_mutex);
+    stats.size = m_size;
+    stats.entry_count = m_entries.size();
+    return stats;
+}
+
+bool KDerivedDataCache::open(const std::string& directory, std::uint64_t max_size)
+{
+    close();
+
+    std::error_code error = {};
+    std::filesystem::create_directories(directory, error);
+    if (!std::filesystem::is_directory(directory, error))
+    {
+        KLDebug::log(
+            "DerivedDataCache::open() -> failed to create " + directory, KEDebugType_Error
+        );
+        return false;
+    }
+
+    struct KFound
+    {
+        std::uint64_t key = 0;
+        std::uint64_t size = 0;
+        std::filesystem::file_time_type time = {};
+    };
+
+    // Blobs live in <directory>/<first two hex digits>/<key as hex>
+    std::vector<KFound> found = {};
+    std::filesystem::file_time_type stale = std::filesystem::file_time_type::clock::now() -
+                                            std::chrono::hours(1);
+    for (auto it = std::filesystem::recursive_directory_iterator(directory, error);
+         it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+    {
+        if (error)
+            break;
+        if (!it->is_regular_file(error))
+            continue;
+
+        std::filesystem::file_time_type time = it->last_write_time(error);
+        std::string name = it->path().filename().string();
+
+        // Left behind by a store that never finished, recent ones may still be in progress
+        if (name.ends_with(".tmp"))
+        {
+            if (time < stale)
+                std::filesystem::remove(it->path(), error);
+            continue;
+        }
+
+        KFound blob = {};
+        const char* end = name.data() + name.size();
+        std::from_chars_result result = std::from_chars(name.data(), end, blob.key, 16);
+        if (result.ec != std::errc() || result.ptr != end || name.size() != 16)
+            continue;
+
+        blob.size = it->file_size(error);
+        blob.time = time;
+        found.push_back(blob);
+    }
+
+    std::sort(
+        found.begin(), found.end(),
+        [](const KFound& lhs, const KFound& rhs) { return lhs.time > rhs.time; }
+    );
+
+    std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(m_mutex);
+    m_directory = directory;
+    m_max_size = max_size;
+    for (const KFound& blob : found)
+    {
+        m_lru.push_back(blob.key);
+        m_entries[blob.key] = KEntry{blob.size, std::prev(m_lru.end())};
+        m_size += blob.size;
+    }
+    _evict();
+
+    return true;
+}
+
+void KDerivedDataCache::close()
+{
+    std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(m_mutex);
+    m_directory.clear();
+    m_entries.clear();
+    m_lru.clear();
+    m_size = 0;
+}
+
+bool KDerivedDataCache::load(std::uint64_t key, std::vector<char>& data)
+{
+    if (!is_open())
+        return false;
+
+    // Another process sharing the directory may have stored the blob, so the file is the source
+    // of truth rather than the entries
+    std::string filename = _get_filename(key);
+    std::ifstream file = std::ifstream(filename, std::ios::binary | std::ios::ate);
+    std::uint64_t size = file.is_open() ? static_cast<std::uint64_t>(file.tellg()) : 0;
+
+    KBlobHeader header = {};
+    bool valid = size >= sizeof(KBlobHeader);
+    if (valid)
+    {
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        data.resize(size - sizeof(KBlobHeader));
+        file.read(data.data(), static_cast<std::streamsize>(data.size()));
+        valid = file.good() && header.magic == blob_magic && header.version == blob_version &&
+                header.key == key;
+    }
+
+    std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(m_mutex);
+    if (!valid)
+    {
+        data.clear();
+        _erase(key);
+        m_miss_count.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    _touch(key, size);
+    m_hit_count.fetch_add(1, std::memory_order_relaxed);
+    m_bytes_saved.fetch_add(data.size(), std::memory_order_relaxed);
+
+    std::error_code error = {};
+    std::filesystem::last_write_time(
+        filename, std::filesystem::file_time_type::clock::now(), error
+    );
+    return true;
+}
+
+bool KDerivedDataCache::store(std::uint64_t key, const std::vector<char>& data)
+{
+    if (!is_open())
+        return false;
+
+    std::string filename = _get_filename(key);
+    std::error_code error = {};
+    std::filesystem::create_directories(std::filesystem::path(filename).parent_path(), error);
+
+    // Unique across threads and processes, the rename is what makes the blob visible
+    std::uint64_t unique = m_temporary_count.fetch_add(1, std::memory_order_relaxed);
+    unique ^= std::hash<std::thread::id>{}(std::this_thread::get_id());
+    unique ^= static_cast<std::uint64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count()
+    );
+    std::string temporary_filename = filename + "." + std::to_string(unique) + ".tmp";
+
+    KBlobHeader header = {};
+    header.key = key;
+    {
+        std::ofstream file = std::ofstream(temporary_filename, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!file.good())
+        {
+            file.close();
+            std::filesystem::remove(temporary_filename, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temporary_filename, filename, error);
+    if (error)
+    {
+        std::filesystem::remove(temporary_filename, error);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(m_mutex);
+    _touch(key, sizeof(KBlobHeader) + data.size());
+    m_store_count.fetch_add(1, std::memory_order_relaxed);
+    _evict();
+    return true;
+}
+
+std::string KDerivedDataCache::_get_filename(std::uint64_t key) const
+{
+    char name[17] = {};
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+    return m_directory + "/" + std::string(name, 2) + "/" + name;
+}
+
+void KDerivedDataCache::_touch(std::uint64_t key, std::uint64_t size)
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+    {
+        m_lru.push_front(key);
+        m_entries[key] = KEntry{size, m_lru.begin()};
+        m_size += size;
+        return;
+    }
+
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+    m_size = m_size - it->second.size + size;
+    it->second.size = size;
+}
+
+void KDerivedDataCache::_erase(std::uint64_t key)
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+        return;
+
+    m_size -= it->second.size;
+    m_lru.erase(it->second.lru);
+    m_entries.erase(it);
+}
+
+void KDerivedDataCache::_evict()
+{
+    while (m_size > m_max_size && !m_lru.empty())
+    {
+        std::uint64_t key = m_lru.back();
+        std::error_code error = {};
+        std::filesystem::remove(_get_filename(key), error);
+
+        _erase(key);
+        m_eviction_count.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef __KRYOS_EDITOR_CORE_DERIVED_DATA_CACHE_HPP__
+#define __KRYOS_EDITOR_CORE_DERIVED_DATA_CACHE_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Streaming 64 bit hash used to key derived data, fast rather than cryptographic. Feeding the same
+// values in the same order always gives the same hash
+class KContentHasher
+{
+  public:
+    void update(const void* data, std::size_t size);
+    void update(const std::string& value);
+    void update(std::uint64_t value);
+    std::uint64_t finish() const;
+
+  private:
+    std::uint64_t m_state = 0x9e3779b97f4a7c15ull;
+    std::uint64_t m_length = 0;
+};
+
+struct KDerivedDataStats
+{
+    std::size_t hit_count = 0;
+    std::size_t miss_count = 0;
+    std::size_t store_count = 0;
+    std::size_t eviction_count = 0;
+    // Derived data served from the cache instead of being generated again
+    std::uint64_t bytes_saved = 0;
+    std::uint64_t size = 0;
+    std::size_t entry_count = 0;
+
+    inline float get_hit_rate() const
+    {
+        std::size_t lookups = hit_count + miss_count;
+        return lookups > 0 ? static_cast<float>(hit_count) / static_cast<float>(lookups) : 0.0f;
+    }
+};
+
+// Directory of derived data blobs keyed by a hash of everything they were generated from, so a
+// blob is valid for as long as it exists. Blobs are written to a temporary file and renamed into
+// place, which keeps concurrent stores from threads or other editor processes sharing the
+// directory safe. The least recently used blobs are evicted once the cache grows past its size
+// cap, hits bump the file's modified time so the order survives restarts
+class KDerivedDataCache
+{
+  public:
+    KDerivedDataCache() = default;
+    ~KDerivedDataCache() = default;
+
+    inline bool is_open() const { return !m_directory.empty(); }
+    inline const std::string& get_directory() const { return m_directory; }
+    inline std::uint64_t get_max_size() const { return m_max_size; }
+    KDerivedDataStats get_stats() const;
+
+    // Neither may run while other threads are still using the cache
+    bool open(const std::string& directory, std::uint64_t max_size);
+    void close();
+
+    // Both are safe to call from any number of threads, file IO happens outside the lock
+    bool load(std::uint64_t key, std::vector<char>& data);
+    bool store(std::uint64_t key, const std::vector<char>& data);
+
+  private:
+    struct KEntry
+    {
+        std::uint64_t size = 0;
+        std::list<std::uint64_t>::iterator lru = {};
+    };
+
+  private:
+    std::string _get_filename(std::uint64_t key) const;
+    void _touch(std::uint64_t key, std::uint64_t size);
+    void _erase(std::uint64_t key);
+    void _evict();
+
+  private:
+    std::string m_directory = {};
+    std::uint64_t m_max_size = 0;
+
+    mutable std::mutex m_mutex = {};
+    std::unordered_map<std::uint64_t, KEntry> m_entries = {};
+    // Most recently used first
+    std::list<std::uint64_t> m_lru = {};
+    std::uint64_t m_size = 0;
+
+    std::atomic<std::size_t> m_hit_count = 0;
+    std::atomic<std::size_t> m_miss_count = 0;
+    std::atomic<std::size_t> m_store_count = 0;
+    std::atomic<std::size_t> m_eviction_count = 0;
+    std::atomic<std::uint64_t> m_bytes_saved = 0;
+    std::atomic<std::uint64_t> m_temporary_count = 0;
+};
+
+#endif
@@ -0,0 +1,183 @@
+#include "core/editor_entities.hpp"
+#include "core/scene_changes.hpp"
+
+#include <kryos/core/debug.hpp>
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+KLEditorEntities* KLEditorEntities::m_Instance = nullptr;
+
+// What the editor camera was tagged with before it was tracked by handle
+static constexpr const char* legacy_editor_tag = "@kryos_editor";
+
+static void setup_editor_camera(KEntity& entity)
+{
+    KCCamera* camera = entity.add_component<KCCamera>();
+    camera->clear_color = glm::vec4(0.1f, 0.1f, 0.1f, 1.0f);
+    camera->is_main = true;
+    // TODO: Set to Orthographic if in 2D mode
+    camera->projection_type = CameraProjection_Perspective;
+}
+
+KLEditorEntities::KLEditorEntities()
+{
+    assert(
+        m_Instance == nullptr && "EditorEntities::EditorEntities() -> cannot created multiple "
+                                 "editor entities application layers"
+    );
+
+    m_Instance = this;
+}
+
+KCCamera* KLEditorEntities::create_camera(KScene* scene)
+{
+    if (KCCamera* camera = get_camera(scene); camera != nullptr)
+        return camera;
+
+    KSceneEntities& entities = m_scenes[scene];
+    if (entities.detached)
+        return nullptr;
+
+    // A tracked camera that's gone means the scene was replaced under the same address, whatever
+    // else is tracked for it belongs to the old scene too
+    if (entities.camera != ECS_ENTITY_DESTROYED)
+        entities = {};
+
+    entities.camera = create_entity(scene, setup_editor_camera);
+    return get_camera(scene);
+}
+
+KCCamera* KLEditorEntities::get_camera(KScene* scene) const
+{
+    auto it = m_scenes.find(scene);
+    if (it == m_scenes.end() || it->second.detached ||
+        it->second.camera == ECS_ENTITY_DESTROYED)
+    {
+        return nullptr;
+    }
+
+    KEntity entity = KEntity(it->second.camera);
+    return entity.get_component<KCCamera>();
+}
+
+ecs::Entity KLEditorEntities::get_camera_entity(KScene* scene) const
+{
+    auto it = m_scenes.find(scene);
+    if (it == m_scenes.end())
+        return ECS_ENTITY_DESTROYED;
+    return it->second.camera;
+}
+
+ecs::Entity KLEditorEntities::create_entity(
+    KScene* scene, const std::function<void(KEntity&)>& setup
+)
+{
+    KSceneEntities& entities = m_scenes[scene];
+
+    KEntity entity = KEntity(true);
+    setup(entity);
+
+    ecs::Entity id = entity;
+    KLSceneChanges::get()->mark_entity_created(id);
+    entities.owned.insert(id);
+    entities.setups.emplace(id, setup);
+    return id;
+}
+
+bool KLEditorEntities::is_editor_entity(KScene* scene, ecs::Entity entity) const
+{
+    auto it = m_scenes.find(scene);
+    if (it == m_scenes.end())
+        return false;
+    return it->second.owned.contains(entity);
+}
+
+void KLEditorEntities::detach(KScene* scene)
+{
+    auto it = m_scenes.find(scene);
+    if (it == m_scenes.end() || it->second.detached)
+        return;
+
+    KSceneEntities& entities = it->second;
+    if (KCCamera* camera = get_camera(scene); camera != nullptr)
+        entities.detached_camera = *camera;
+
+    for (ecs::Entity id : entities.owned)
+    {
+        KEntity entity = KEntity(id);
+        entity.destroy();
+        KLSceneChanges::get()->mark_entity_destroyed(id);
+    }
+    entities.detached = true;
+}
+
+void KLEditorEntities::attach(KScene* scene)
+{
+    auto it = m_scenes.find(scene);
+    if (it == m_scenes.end() || !it->second.detached)
+        return;
+
+    KSceneEntities& entities = it->second;
+    std::unordered_map<ecs::Entity, std::function<void(KEntity&)>> setups =
+        std::move(entities.setups);
+    ecs::Entity old_camera = entities.camera;
+
+    entities.owned.clear();
+    entities.setups.clear();
+    entities.detached = false;
+
+    // Entity ids are not guaranteed to be the same after recreation, so the handles are remapped
+    for (auto& [old_id, setup] : setups)
+    {
+        ecs::Entity id = create_entity(scene, setup);
+        if (old_id == old_camera)
+        {
+            entities.camera = id;
+            if (KCCamera* camera = get_camera(scene); camera != nullptr)
+                *camera = entities.detached_camera;
+        }
+    }
+}
+
+void KLEditorEntities::migrate_legacy_entities(KScene* scene)
+{
+    if (scene == nullptr)
+        return;
+
+    std::vector<ecs::Entity> legacy = {};
+    KCCamera legacy_camera = {};
+    bool has_legacy_camera = false;
+
+    auto view = ecs::View<KCTag>(&scene->get_registry());
+    for (ecs::Entity entity : view)
+    {
+        if (!view.has_required(entity) || is_editor_entity(scene, entity))
+            continue;
+
+        auto [tag] = view.get();
+        if (std::string(tag->tag) != legacy_editor_tag)
+            continue;
+
+        legacy.push_back(entity);
+        if (KCCamera* camera = KEntity(entity).get_component<KCCamera>();
+            camera != nullptr && !has_legacy_camera)
+        {
+            legacy_camera = *camera;
+            has_legacy_camera = true;
+        }
+    }
+
+    for (ecs::Entity entity : legacy)
+    {
+        KEntity(entity).destroy();
+        KLSceneChanges::get()->mark_entity_destroyed(entity);
+    }
+
+    if (has_legacy_camera)
+    {
+        if (KCCamera* camera = create_camera(scene); camera != nullptr)
+            *camera = legacy_camera;
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef __KRYOS_EDITOR_CORE_EDITOR_ENTITIES_HPP__
+#define __KRYOS_EDITOR_CORE_EDITOR_ENTITIES_HPP__
+
+#include <kryos/core/application_layer.hpp>
+#include <kryos/scene/components.hpp>
+#include <kryos/scene/entity.hpp>
+#include <kryos/scene/scene_manager.hpp>
+
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+
+// Keeps track of the entities the editor itself owns (editor camera, gizmos, grid, ...) for each
+// scene, so panels can find them by handle instead of scanning the registry and comparing tags.
+// These entities are detached while a scene is being serialized so they never end up on disk
+class KLEditorEntities : public KIApplicationLayer
+{
+  public:
+    inline static KLEditorEntities* get() { return m_Instance; }
+
+  public:
+    KLEditorEntities();
+    virtual ~KLEditorEntities() override = default;
+
+    // NOTE: All functions expect the given scene to be the active scene, as KEntity operates on
+    // the active scene's registry
+    KCCamera* create_camera(KScene* scene);
+    KCCamera* get_camera(KScene* scene) const;
+    ecs::Entity get_camera_entity(KScene* scene) const;
+
+    ecs::Entity create_entity(KScene* scene, const std::function<void(KEntity&)>& setup);
+    bool is_editor_entity(KScene* scene, ecs::Entity entity) const;
+
+    void detach(KScene* scene);
+    void attach(KScene* scene);
+
+    // Scenes saved before editor entities were tracked by handle still contain the editor camera
+    // as a tagged entity. It's removed and its view carried over to the tracked camera
+    void migrate_legacy_entities(KScene* scene);
+
+  private:
+    struct KSceneEntities
+    {
+        ecs::Entity camera = ECS_ENTITY_DESTROYED;
+        KCCamera detached_camera = {};
+        bool detached = false;
+
+        std::unordered_set<ecs::Entity> owned = {};
+        std::unordered_map<ecs::Entity, std::function<void(KEntity&)>> setups = {};
+    };
+
+    static KLEditorEntities* m_Instance;
+
+  private:
+    std::unordered_map<KScene*, KSceneEntities> m_scenes = {};
+};
+
+#endif
@@ -0,0 +1,203 @@
+#include "core/file_watcher.hpp"
+
+#include <kryos/core/debug.hpp>
+
+#include <filesystem>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+static constexpr std::uint32_t watch_mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM |
+                                            IN_CREATE | IN_DELETE | IN_ONLYDIR;
+#endif
+
+KFileWatcher::KFileWatcher(float debounce_time)
+    : m_debounce_time(static_cast<std::int64_t>(debounce_time * 1000.0f))
+{
+}
+
+KFileWatcher::~KFileWatcher() { stop(); }
+
+bool KFileWatcher::start(const std::string& root_path)
+{
+    stop();
+
+#if defined(__linux__)
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify < 0)
+    {
+        KLDebug::log("FileWatcher::start() -> failed to initialize inotify", KEDebugType_Error);
+        return false;
+    }
+
+    if (pipe(m_wake_pipe) != 0)
+    {
+        KLDebug::log("FileWatcher::start() -> failed to create wake pipe", KEDebugType_Error);
+        close(m_inotify);
+        m_inotify = -1;
+        return false;
+    }
+
+    m_root_path = std::filesystem::path(root_path).lexically_normal().string();
+    while (m_root_path.size() > 1 && m_root_path.back() == '/')
+        m_root_path.pop_back();
+
+    m_thread = std::thread(&KFileWatcher::_run, this);
+    return true;
+#else
+    // TODO: ReadDirectoryChangesW / FSEvents
+    (void)root_path;
+    KLDebug::log(
+        "FileWatcher::start() -> file watching is not supported on this platform",
+        KEDebugType_Warning
+    );
+    return false;
+#endif
+}
+
+void KFileWatcher::stop()
+{
+#if defined(__linux__)
+    if (m_thread.joinable())
+    {
+        char wake = 1;
+        ssize_t written = write(m_wake_pipe[1], &wake, 1);
+        (void)written;
+        m_thread.join();
+    }
+
+    if (m_inotify >= 0)
+        close(m_inotify);
+    for (int& fd : m_wake_pipe)
+    {
+        if (fd >= 0)
+            close(fd);
+        fd = -1;
+    }
+    m_inotify = -1;
+#endif
+
+    m_watches.clear();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ready.clear();
+}
+
+bool KFileWatcher::poll(std::vector<std::string>& changes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_ready.empty())
+        return false;
+
+    changes.insert(changes.end(), m_ready.begin(), m_ready.end());
+    m_ready.clear();
+    return true;
+}
+
+void KFileWatcher::_run()
+{
+#if defined(__linux__)
+    using clock = std::chrono::steady_clock;
+    std::unordered_map<std::string, clock::time_point> pending = {};
+
+    // Walking the tree for watches can take a while on large projects, so it isn't done in start
+    _add_watches(m_root_path);
+
+    pollfd fds[2] = {};
+    fds[0].fd = m_inotify;
+    fds[0].events = POLLIN;
+    fds[1].fd = m_wake_pipe[0];
+    fds[1].events = POLLIN;
+
+    alignas(inotify_event) char buffer[16 * 1024];
+    while (true)
+    {
+        // Only wake up periodically while something is waiting to settle
+        int timeout = pending.empty() ? -1 : static_cast<int>(m_debounce_time.count() / 4 + 1);
+        if (::poll(fds, 2, timeout) < 0)
+            continue;
+        if (fds[1].revents & POLLIN)
+            return;
+
+        if (fds[0].revents & POLLIN)
+        {
+            clock::time_point now = clock::now();
+            ssize_t length = 0;
+            while ((length = read(m_inotify, buffer, sizeof(buffer))) > 0)
+            {
+                for (char* it = buffer; it < buffer + length;)
+                {
+                    const inotify_event* event = reinterpret_cast<const inotify_event*>(it);
+                    it += sizeof(inotify_event) + event->len;
+
+                    if (event->mask & IN_IGNORED)
+                    {
+                        m_watches.erase(event->wd);
+                        continue;
+                    }
+
+                    auto watch = m_watches.find(event->wd);
+                    if (watch == m_watches.end() || event->len == 0 || event->name[0] == '.')
+                        continue;
+
+                    std::string path = watch->second + "/" + event->name;
+                    if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)))
+                        _add_watches(path);
+
+                    // Later events for the same path push its deadline back
+                    pending[path] = now;
+                }
+            }
+        }
+
+        clock::time_point now = clock::now();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = pending.begin(); it != pending.end();)
+        {
+            if (now - it->second >= m_debounce_time)
+            {
+                m_ready.insert(it->first);
+                it = pending.erase(it);
+            }
+            else
+                it++;
+        }
+    }
+#endif
+}
+
+void KFileWatcher::_add_watches(const std::string& directory)
+{
+#if defined(__linux__)
+    // inotify isn't recursive, every directory in the tree needs its own watch
+    std::vector<std::string> stack = {directory};
+    while (!stack.empty())
+    {
+        std::string path = std::move(stack.back());
+        stack.pop_back();
+
+        int watch = inotify_add_watch(m_inotify, path.c_str(), watch_mask);
+        if (watch < 0)
+            continue;
+        m_watches[watch] = path;
+
+        std::error_code error = {};
+        std::filesystem::directory_iterator iterator = std::filesystem::directory_iterator(
+            path, std::filesystem::directory_options::skip_permission_denied, error
+        );
+        for (; !error && iterator != std::filesystem::directory_iterator();
+             iterator.increment(error))
+        {
+            std::string name = iterator->path().filename().string();
+            std::error_code entry_error = {};
+            if (!name.empty() && name[0] != '.' && iterator->is_directory(entry_error))
+                stack.push_back(iterator->path().string());
+        }
+    }
+#else
+    (void)directory;
+#endif
+}
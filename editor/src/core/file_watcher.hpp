@@ -0,0 +1,49 @@
+#ifndef __KRYOS_EDITOR_CORE_FILE_WATCHER_HPP__
+#define __KRYOS_EDITOR_CORE_FILE_WATCHER_HPP__
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Watches a directory tree for files being written, created, moved or deleted. Events for a path
+// are coalesced until it has been quiet for the debounce time, since most tools write a file in
+// several steps, and only then reported once through poll()
+class KFileWatcher
+{
+  public:
+    KFileWatcher(float debounce_time = 0.2f);
+    ~KFileWatcher();
+
+    inline bool watching() const { return m_thread.joinable(); }
+    inline const std::string& get_root_path() const { return m_root_path; }
+
+    bool start(const std::string& root_path);
+    void stop();
+
+    // Moves the absolute paths of every settled change into changes, returns false when there
+    // were none
+    bool poll(std::vector<std::string>& changes);
+
+  private:
+    void _run();
+    void _add_watches(const std::string& directory);
+
+  private:
+    std::string m_root_path = {};
+    std::chrono::milliseconds m_debounce_time = {};
+
+    int m_inotify = -1;
+    int m_wake_pipe[2] = {-1, -1};
+    std::thread m_thread = {};
+    // Only touched by the watcher thread once started
+    std::unordered_map<int, std::string> m_watches = {};
+
+    std::mutex m_mutex = {};
+    std::unordered_set<std::string> m_ready = {};
+};
+
+#endif
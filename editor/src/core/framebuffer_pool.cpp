@@ -0,0 +1,125 @@
+#include "core/framebuffer_pool.hpp"
+
+#include <kryos/core/debug.hpp>
+
+#include <algorithm>
+#include <string>
+
+KFramebufferPool::KFramebufferPool(int bucket_size, float settle_time)
+    : m_bucket_size(bucket_size), m_settle_time(settle_time)
+{
+}
+
+KFramebufferPool::~KFramebufferPool() { release(); }
+
+bool KFramebufferPool::acquire(int width, int height, float delta_time)
+{
+    if (width <= 0 || height <= 0)
+        return m_framebuffer != 0;
+
+    m_time += delta_time;
+    while (m_allocation_times.size() > 0 && m_time - m_allocation_times.front() > 1.0f)
+        m_allocation_times.pop_front();
+
+    if (width != m_requested_size.x || height != m_requested_size.y)
+    {
+        m_requested_size = glm::ivec2(width, height);
+        m_time_since_resize = 0.0f;
+    }
+    else
+        m_time_since_resize += delta_time;
+
+    int bucket_width = _bucket(width);
+    int bucket_height = _bucket(height);
+
+    // Grow when the request no longer fits, shrink when over half of the textures are unused
+    bool fits = width <= m_size.x && height <= m_size.y;
+    bool wasteful = bucket_width * bucket_height * 2 < m_size.x * m_size.y;
+
+    // There's nothing to show until the first allocation, so that one doesn't wait to settle
+    if (m_framebuffer == 0 || ((!fits || wasteful) && m_time_since_resize >= m_settle_time))
+    {
+        if (!_allocate(bucket_width, bucket_height))
+            return false;
+    }
+
+    _update_viewport(width, height);
+    return true;
+}
+
+void KFramebufferPool::release()
+{
+    if (m_framebuffer != 0)
+        glDeleteFramebuffers(1, &m_framebuffer);
+    if (m_texture != 0)
+        glDeleteTextures(1, &m_texture);
+    if (m_depth_buffer != 0)
+        glDeleteRenderbuffers(1, &m_depth_buffer);
+
+    m_framebuffer = 0;
+    m_texture = 0;
+    m_depth_buffer = 0;
+    m_size = glm::ivec2(0, 0);
+}
+
+int KFramebufferPool::_bucket(int size) const
+{
+    return ((size + m_bucket_size - 1) / m_bucket_size) * m_bucket_size;
+}
+
+bool KFramebufferPool::_allocate(int width, int height)
+{
+    release();
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &m_texture);
+    glTextureStorage2D(m_texture, 1, GL_RGBA8, width, height);
+    glTextureParameteri(m_texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(m_texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(m_texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(m_texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glCreateRenderbuffers(1, &m_depth_buffer);
+    glNamedRenderbufferStorage(m_depth_buffer, GL_DEPTH24_STENCIL8, width, height);
+
+    glCreateFramebuffers(1, &m_framebuffer);
+    glNamedFramebufferTexture(m_framebuffer, GL_COLOR_ATTACHMENT0, m_texture, 0);
+    glNamedFramebufferRenderbuffer(
+        m_framebuffer, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depth_buffer
+    );
+
+    if (glCheckNamedFramebufferStatus(m_framebuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        KLDebug::log(
+            "FramebufferPool::_allocate() -> framebuffer of " + std::to_string(width) + "x" +
+                std::to_string(height) + " is incomplete",
+            KEDebugType_Error
+        );
+        release();
+        return false;
+    }
+
+    m_size = glm::ivec2(width, height);
+    m_allocation_count++;
+    m_allocation_times.push_back(m_time);
+    return true;
+}
+
+void KFramebufferPool::_update_viewport(int width, int height)
+{
+    glm::vec2 framebuffer_size = glm::vec2(m_size);
+    glm::vec2 requested_size = glm::vec2(static_cast<float>(width), static_cast<float>(height));
+
+    // While waiting for the resize to settle the request might not fit, in that case it's scaled
+    // down with its aspect ratio kept and stretched back up when displayed
+    float scale = std::min(
+        {1.0f, framebuffer_size.x / requested_size.x, framebuffer_size.y / requested_size.y}
+    );
+    m_viewport_size = glm::ivec2(
+        std::max(static_cast<int>(requested_size.x * scale), 1),
+        std::max(static_cast<int>(requested_size.y * scale), 1)
+    );
+    m_uv_max = glm::vec2(
+        static_cast<float>(m_viewport_size.x) / framebuffer_size.x,
+        static_cast<float>(m_viewport_size.y) / framebuffer_size.y
+    );
+}
@@ -0,0 +1,65 @@
+#ifndef __KRYOS_EDITOR_CORE_FRAMEBUFFER_POOL_HPP__
+#define __KRYOS_EDITOR_CORE_FRAMEBUFFER_POOL_HPP__
+
+#include <glad/glad.h>
+
+#include <deque>
+#include <glm/glm.hpp>
+
+// Owns a framebuffer that is allocated in size buckets, larger than what is requested, so a
+// panel that is continuously being resized (dragging a dock splitter) renders into a sub-rectangle
+// of the same textures instead of reallocating them every frame. The sub-rectangle starts at the
+// framebuffer's origin and has the requested size, so the projection keeps the panel's aspect and
+// only that region is sampled. Reallocation only happens once the requested size has stopped
+// changing for the settle time.
+// The textures are the editor's own rather than the pipeline's, nothing but the scene renderer
+// draws into them, so a frame the scene isn't rendered on keeps showing the last one
+class KFramebufferPool
+{
+  public:
+    KFramebufferPool(int bucket_size = 256, float settle_time = 0.25f);
+    ~KFramebufferPool();
+
+    KFramebufferPool(const KFramebufferPool&) = delete;
+    KFramebufferPool& operator=(const KFramebufferPool&) = delete;
+
+    // 0 until the first acquire()
+    inline GLuint get_framebuffer() const { return m_framebuffer; }
+    inline GLuint get_texture() const { return m_texture; }
+    inline const glm::ivec2& get_size() const { return m_size; }
+    // Region to render into, the requested size scaled down to fit while a resize settles
+    inline const glm::ivec2& get_viewport_size() const { return m_viewport_size; }
+    inline const glm::vec2& get_uv_max() const { return m_uv_max; }
+    inline std::size_t get_allocation_count() const { return m_allocation_count; }
+    inline std::size_t get_allocations_per_second() const { return m_allocation_times.size(); }
+
+    // Called once per frame with the size the framebuffer is displayed at, the first call
+    // allocates right away. Returns false when the framebuffer failed to be allocated
+    bool acquire(int width, int height, float delta_time);
+    // Frees the framebuffer, the next acquire() allocates it again
+    void release();
+
+  private:
+    int _bucket(int size) const;
+    bool _allocate(int width, int height);
+    void _update_viewport(int width, int height);
+
+  private:
+    GLuint m_framebuffer = 0;
+    GLuint m_texture = 0;
+    GLuint m_depth_buffer = 0;
+    glm::ivec2 m_size = {};
+    int m_bucket_size = 256;
+    float m_settle_time = 0.25f;
+
+    glm::ivec2 m_requested_size = {};
+    float m_time_since_resize = 0.0f;
+    glm::ivec2 m_viewport_size = {};
+    glm::vec2 m_uv_max = {1.0f, 1.0f};
+
+    float m_time = 0.0f;
+    std::size_t m_allocation_count = 0;
+    std::deque<float> m_allocation_times = {};
+};
+
+#endif
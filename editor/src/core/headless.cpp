@@ -0,0 +1,327 @@
+#include "core/headless.hpp"
+#include "core/asset_residency.hpp"
+#include "core/editor_entities.hpp"
+#include "core/mapped_file.hpp"
+#include "core/member_tables.hpp"
+#include "core/mesh_lods.hpp"
+#include "core/prefabs.hpp"
+#include "core/project.hpp"
+#include "core/scene_changes.hpp"
+#include "core/spatial_index.hpp"
+#include "core/virtual_file_system.hpp"
+#include "utils/png.hpp"
+
+#include <kryos/core/debug.hpp>
+#include <kryos/renderer/window.hpp>
+#include <kryos/scene/components.hpp>
+#include <kryos/scene/scene_manager.hpp>
+
+#include <glad/glad.h>
+
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <set>
+#include <string_view>
+
+int KHeadlessApp::run_render(const KCommandLine& command_line)
+{
+    KHeadlessRenderSettings settings = {};
+    settings.project_filename = command_line.get("project");
+    settings.scene_filenames = command_line.get_all("scene");
+    settings.output_directory = command_line.get("output", ".");
+    settings.width = command_line.get_int("width", settings.width);
+    settings.height = command_line.get_int("height", settings.height);
+    settings.warmup_frames = command_line.get_int("warmup-frames", settings.warmup_frames);
+    settings.timed_frames = std::max(command_line.get_int("frames", settings.timed_frames), 1);
+    settings.surfaceless = !command_line.has("use-display");
+    settings.pak_filenames = command_line.get_all("pak");
+    settings.residency_budget =
+        static_cast<std::uint64_t>(std::max(command_line.get_int("residency-budget", 0), 0)) *
+        1024 * 1024;
+
+    if (settings.project_filename.empty() || settings.scene_filenames.empty())
+    {
+        std::fprintf(
+            stderr, "usage: Kryos render --project <file.kryosproject> --scene <file> "
+                    "[--scene <file> ...] [--output <directory>] [--width <px>] [--height <px>] "
+                    "[--frames <count>] [--warmup-frames <count>] [--residency-budget <MiB>] "
+                    "[--pak <file.kpak> ...] [--use-display]\n"
+        );
+        return 1;
+    }
+
+    if (!std::filesystem::exists(settings.output_directory))
+        std::filesystem::create_directories(settings.output_directory);
+
+#if defined(GLFW_PLATFORM_NULL)
+    // No window system at all, GLFW falls back to a software (OSMesa) context
+    if (settings.surfaceless)
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
+
+    KHeadlessApp* app = new KHeadlessApp(&settings);
+    app->run();
+    delete app;
+
+    return settings.succeeded ? 0 : 1;
+}
+
+KHeadlessApp::KHeadlessApp(KHeadlessRenderSettings* settings)
+{
+    KLWindow* window = get_application_layer<KLWindow>();
+    glfwHideWindow(window->get_internal());
+    glfwSwapInterval(0);
+
+    KLDebug* debug = get_application_layer<KLDebug>();
+    debug->set_serialize(false);
+
+    // Archives are mounted at the project's root before anything is loaded
+    KLVirtualFileSystem* file_system = push_layer<KLVirtualFileSystem>();
+    std::string root_path =
+        std::filesystem::path(settings->project_filename).parent_path().string();
+    for (const std::string& pak_filename : settings->pak_filenames)
+    {
+        if (!file_system->mount(pak_filename, root_path))
+        {
+            std::fprintf(stderr, "failed to mount '%s'\n", pak_filename.c_str());
+            settings->succeeded = false;
+        }
+    }
+
+    push_layer<KLMemberTables>();
+    push_layer<KLProject>();
+    push_layer<KLEditorEntities>();
+    push_layer<KLSceneChanges>();
+    push_layer<KLPrefabs>();
+    push_layer<KLSpatialIndex>();
+    push_layer<KLMeshLods>();
+    KLAssetResidency* residency = push_layer<KLAssetResidency>();
+    if (settings->residency_budget > 0)
+        residency->set_budget(settings->residency_budget, settings->residency_budget);
+    push_layer<KLHeadlessRender>(settings);
+}
+
+KLHeadlessRender::KLHeadlessRender(KHeadlessRenderSettings* settings) : m_settings(settings)
+{
+    if (!m_framebuffer_pool.acquire(settings->width, settings->height, 0.0f))
+    {
+        std::fprintf(
+            stderr, "failed to create %ix%i headless framebuffer\n", settings->width,
+            settings->height
+        );
+        m_settings->succeeded = false;
+        _finish();
+    }
+    else if (!KLProject::get()->load(m_settings->project_filename))
+    {
+        std::fprintf(
+            stderr, "failed to load project '%s'\n", m_settings->project_filename.c_str()
+        );
+        m_settings->succeeded = false;
+        _finish();
+    }
+}
+
+void KLHeadlessRender::on_update()
+{
+    if (m_scene_index >= m_settings->scene_filenames.size())
+        return;
+
+    const std::string& scene_filename = m_settings->scene_filenames[m_scene_index];
+
+    // The spatial index is updated before this layer, so the scene loaded here is first drawn on
+    // the next frame once it has been indexed
+    if (m_frame < 0)
+    {
+        if (!_load_scene(scene_filename))
+        {
+            std::fprintf(stderr, "failed to load scene '%s'\n", scene_filename.c_str());
+            m_settings->succeeded = false;
+            m_scene_index++;
+            if (m_scene_index >= m_settings->scene_filenames.size())
+                _finish();
+            return;
+        }
+
+        m_frame = 0;
+        m_frame_times.clear();
+        return;
+    }
+
+    // Frames are only timed once the scene's assets have streamed in
+    if (m_frame == 0 && KLAssetResidency::get()->get_loading_count() > 0)
+        return;
+
+    KScene* scene = KIApplication::get_layer<KLSceneManager>()->get_active_scene();
+    KCCamera* camera = KEntity(m_camera).get_component<KCCamera>();
+
+    // Waiting on the GPU makes the time cover the whole scene pass rather than just submission
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    m_scene_renderer.render(
+        scene, *camera, m_framebuffer_pool.get_framebuffer(), m_framebuffer_pool.get_size()
+    );
+    glFinish();
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    double frame_time = std::chrono::duration<double, std::milli>(end - start).count();
+    m_frame++;
+
+    if (m_frame > m_settings->warmup_frames)
+        m_frame_times.push_back(frame_time);
+
+    if (m_frame < m_settings->warmup_frames + m_settings->timed_frames)
+        return;
+
+    std::string scene_name = std::filesystem::path(scene_filename).stem().string();
+    std::string output = m_settings->output_directory + "/" + scene_name + ".png";
+    if (!_capture(output))
+    {
+        std::fprintf(stderr, "failed to write '%s'\n", output.c_str());
+        m_settings->succeeded = false;
+    }
+
+    _report(scene_name);
+
+    m_frame = -1;
+    m_scene_index++;
+    if (m_scene_index >= m_settings->scene_filenames.size())
+        _finish();
+}
+
+bool KLHeadlessRender::_load_scene(const std::string& filename)
+{
+    KLSceneManager* scene_manager = KIApplication::get_layer<KLSceneManager>();
+    std::string scene_name = std::filesystem::path(filename).stem().string();
+    scene_manager->set_active(scene_manager->push(scene_name));
+
+    KScene* scene = scene_manager->get_active_scene();
+    if (!KLProject::get()->deserialize_scene(scene, filename))
+        return false;
+
+    // Scenes are saved without the editor camera, only fall back to it if they have no camera
+    bool has_camera = false;
+    auto view = ecs::View<KCCamera>(&scene->get_registry());
+    for (ecs::Entity entity : view)
+    {
+        if (view.has_required(entity))
+        {
+            m_camera = entity;
+            has_camera = true;
+            break;
+        }
+    }
+
+    if (!has_camera)
+    {
+        KLEditorEntities::get()->create_camera(scene);
+        m_camera = KLEditorEntities::get()->get_camera_entity(scene);
+    }
+
+    _acquire_scene_assets(filename);
+    return true;
+}
+
+void KLHeadlessRender::_acquire_scene_assets(const std::string& filename)
+{
+    // The previous scene's assets become eviction candidates, scenes sharing assets with it don't
+    // have to load them again
+    std::vector<KAssetRef> previous_assets = std::move(m_scene_assets);
+    m_scene_assets.clear();
+
+    KMappedFile file = {};
+    if (!file.open(filename, 1, "HeadlessRender::_acquire_scene_assets()"))
+        return;
+    std::string_view text = std::string_view(
+        reinterpret_cast<const char*>(file.get_data()), file.get_size()
+    );
+
+    // Cooked assets can be loose or packed, packed ones shadow the loose ones
+    std::filesystem::path cooked_root = std::filesystem::absolute(
+        std::filesystem::path(KLProject::get()->get_root_path()) / ".kryos/cooked"
+    ).lexically_normal();
+    std::set<std::filesystem::path> cooked_paths = {};
+    for (const std::string& packed : KLVirtualFileSystem::get()->list(cooked_root.string()))
+        cooked_paths.insert(std::filesystem::path(packed).lexically_relative(cooked_root));
+
+    std::error_code error = {};
+    if (std::filesystem::is_directory(cooked_root, error))
+    {
+        for (const std::filesystem::directory_entry& entry :
+             std::filesystem::recursive_directory_iterator(cooked_root, error))
+            cooked_paths.insert(entry.path().lexically_relative(cooked_root));
+    }
+
+    // Scenes are serialized by the engine, rather than parsing one every cooked asset whose
+    // source path appears in the scene file counts as used by it
+    for (const std::filesystem::path& relative_path : cooked_paths)
+    {
+        std::string extension = relative_path.extension().string();
+        std::vector<const char*> source_extensions = {};
+        if (extension == ".kmesh")
+            source_extensions = {".obj"};
+        else if (extension == ".ktex")
+            source_extensions = {".png", ".tga"};
+
+        for (const char* source_extension : source_extensions)
+        {
+            std::string source_path =
+                std::filesystem::path(relative_path).replace_extension(source_extension)
+                    .generic_string();
+            if (text.find(source_path) == std::string::npos)
+                continue;
+
+            KAssetRef asset = KLAssetResidency::get()->acquire(source_path);
+            if (asset.is_valid())
+                m_scene_assets.push_back(std::move(asset));
+            break;
+        }
+    }
+}
+
+bool KLHeadlessRender::_capture(const std::string& filename)
+{
+    int width = m_framebuffer_pool.get_size().x;
+    int height = m_framebuffer_pool.get_size().y;
+    std::vector<std::uint8_t> pixels = std::vector<std::uint8_t>(
+        static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4
+    );
+
+    glGetTextureImage(
+        m_framebuffer_pool.get_texture(), 0, GL_RGBA, GL_UNSIGNED_BYTE,
+        static_cast<GLsizei>(pixels.size()), pixels.data()
+    );
+
+    // OpenGL's origin is the bottom left corner
+    return PngWriter::write(filename, width, height, pixels.data(), true);
+}
+
+void KLHeadlessRender::_report(const std::string& scene_name)
+{
+    if (m_frame_times.empty())
+        return;
+
+    std::vector<double> sorted = m_frame_times;
+    std::sort(sorted.begin(), sorted.end());
+
+    double total = 0.0;
+    for (double time : sorted)
+        total += time;
+
+    std::printf(
+        "%s: %zu frames, avg %.3fms, min %.3fms, median %.3fms, max %.3fms\n", scene_name.c_str(),
+        sorted.size(), total / static_cast<double>(sorted.size()), sorted.front(),
+        sorted[sorted.size() / 2], sorted.back()
+    );
+
+    for (std::size_t i = 0; i < m_frame_times.size(); i++)
+        std::printf("%s frame %zu: %.3fms\n", scene_name.c_str(), i, m_frame_times[i]);
+}
+
+void KLHeadlessRender::_finish()
+{
+    glfwSetWindowShouldClose(KIApplication::get_layer<KLWindow>()->get_internal(), GLFW_TRUE);
+}
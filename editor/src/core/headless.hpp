@@ -0,0 +1,74 @@
+#ifndef __KRYOS_EDITOR_CORE_HEADLESS_HPP__
+#define __KRYOS_EDITOR_CORE_HEADLESS_HPP__
+
+#include "core/asset_residency.hpp"
+#include "core/command_line.hpp"
+#include "core/framebuffer_pool.hpp"
+#include "core/scene_renderer.hpp"
+
+#include <kryos/core/application.hpp>
+#include <kryos/scene/scene_manager.hpp>
+
+#include <string>
+#include <vector>
+
+struct KHeadlessRenderSettings
+{
+    std::string project_filename = {};
+    std::vector<std::string> scene_filenames = {};
+    std::string output_directory = ".";
+    int width = 1280;
+    int height = 720;
+    int warmup_frames = 2;
+    int timed_frames = 1;
+    bool surfaceless = true;
+    // Memory and video memory budget for the scenes' cooked assets, 0 keeps the default budget
+    std::uint64_t residency_budget = 0;
+    // Mounted at the project's root, later archives shadow earlier ones
+    std::vector<std::string> pak_filenames = {};
+
+    bool succeeded = true;
+};
+
+// Renders project scenes offscreen with the editor's scene renderer and writes them out as PNG
+// files without creating the editor workspace, so it can run on build machines without a display
+class KHeadlessApp final : public KIApplication
+{
+  public:
+    static int run_render(const KCommandLine& command_line);
+
+  public:
+    KHeadlessApp(KHeadlessRenderSettings* settings);
+    virtual ~KHeadlessApp() override = default;
+};
+
+class KLHeadlessRender final : public KIApplicationLayer
+{
+  public:
+    KLHeadlessRender(KHeadlessRenderSettings* settings);
+    virtual ~KLHeadlessRender() override = default;
+
+    virtual void on_update() override;
+
+  private:
+    bool _load_scene(const std::string& filename);
+    void _acquire_scene_assets(const std::string& filename);
+    bool _capture(const std::string& filename);
+    void _report(const std::string& scene_name);
+    void _finish();
+
+  private:
+    KHeadlessRenderSettings* m_settings = nullptr;
+    // A bucket of one pixel allocates exactly the requested size, so the capture is the whole
+    // texture
+    KFramebufferPool m_framebuffer_pool = KFramebufferPool(1);
+    KSceneRenderer m_scene_renderer = {};
+
+    std::size_t m_scene_index = 0;
+    ecs::Entity m_camera = {};
+    int m_frame = -1;
+    std::vector<double> m_frame_times = {};
+    std::vector<KAssetRef> m_scene_assets = {};
+};
+
+#endif
@@ -0,0 +1,321 @@
+#include "core/hot_reload.hpp"
+#include "core/project.hpp"
+#include "core/render_worker.hpp"
+#include "core/scene_changes.hpp"
+
+#include <kryos/core/application.hpp>
+#include <kryos/core/debug.hpp>
+#include <kryos/scene/entity.hpp>
+#include <kryos/scene/scene_manager.hpp>
+#include <kryos/serialization/reflection.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <filesystem>
+
+KLHotReload* KLHotReload::m_Instance = nullptr;
+
+static bool has_extension(const std::string& filename, std::initializer_list<const char*> list)
+{
+    std::string extension = std::filesystem::path(filename).extension().string();
+    std::transform(
+        extension.begin(), extension.end(), extension.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); }
+    );
+    for (const char* entry : list)
+    {
+        if (extension == entry)
+            return true;
+    }
+    return false;
+}
+
+// Parsed on a worker and uploaded on the main thread. Only formats the editor parses itself can be
+// reloaded
+static std::shared_ptr<void> import_model(const std::string& filename)
+{
+    std::shared_ptr<KSourceMesh> mesh = std::make_shared<KSourceMesh>();
+    if (!has_extension(filename, {".obj"}) || !ObjLoader::load(filename, *mesh) ||
+        mesh->indices.empty())
+        return nullptr;
+    return mesh;
+}
+
+static GLuint create_buffer(const void* data, std::size_t size)
+{
+    GLuint buffer = 0;
+    glCreateBuffers(1, &buffer);
+    glNamedBufferStorage(buffer, static_cast<GLsizeiptr>(size), data, 0);
+    return buffer;
+}
+
+static void attach_attribute(
+    KLoadedModel& loaded, GLuint attribute, GLint size, const void* data, std::size_t count
+)
+{
+    std::size_t stride = static_cast<std::size_t>(size) * sizeof(float);
+    GLuint buffer = create_buffer(data, count * stride);
+    loaded.buffers.push_back(buffer);
+
+    glVertexArrayVertexBuffer(
+        loaded.vertex_array, attribute, buffer, 0, static_cast<GLsizei>(stride)
+    );
+    glEnableVertexArrayAttrib(loaded.vertex_array, attribute);
+    glVertexArrayAttribFormat(loaded.vertex_array, attribute, size, GL_FLOAT, GL_FALSE, 0);
+    glVertexArrayAttribBinding(loaded.vertex_array, attribute, attribute);
+}
+
+// Positions, normals and uvs are attributes 0, 1 and 2 like cooked meshes, but stay floats so the
+// LOD generator and the spatial index can read the positions back
+static KLoadedModel upload_model(const KSourceMesh& source)
+{
+    KLoadedModel loaded = {};
+    glCreateVertexArrays(1, &loaded.vertex_array);
+    attach_attribute(loaded, 0, 3, source.positions.data(), source.positions.size());
+    if (source.normals.size() == source.positions.size())
+        attach_attribute(loaded, 1, 3, source.normals.data(), source.normals.size());
+    if (source.uvs.size() == source.positions.size())
+        attach_attribute(loaded, 2, 2, source.uvs.data(), source.uvs.size());
+
+    GLuint index_buffer = create_buffer(
+        source.indices.data(), source.indices.size() * sizeof(std::uint32_t)
+    );
+    loaded.buffers.push_back(index_buffer);
+    glVertexArrayElementBuffer(loaded.vertex_array, index_buffer);
+
+    KMesh mesh = {};
+    mesh.vertex_array = loaded.vertex_array;
+    mesh.indices.assign(source.indices.begin(), source.indices.end());
+    loaded.model = std::make_unique<KModel>();
+    loaded.model->meshes.push_back(std::move(mesh));
+    return loaded;
+}
+
+static void free_model(KLoadedModel& loaded)
+{
+    glDeleteVertexArrays(1, &loaded.vertex_array);
+    glDeleteBuffers(static_cast<GLsizei>(loaded.buffers.size()), loaded.buffers.data());
+    loaded = {};
+}
+
+KLHotReload::KLHotReload()
+{
+    assert(
+        m_Instance == nullptr && "HotReload::HotReload() -> cannot created multiple hot reload "
+                                 "application layers"
+    );
+
+    m_Instance = this;
+
+    // Nothing in a scene holds on to a texture, so only models are swapped
+    KAssetImporter model_importer = {};
+    model_importer.import = import_model;
+    model_importer.swap = [this](const std::string& filename, std::shared_ptr<void> data)
+    { _swap_model(filename, std::move(data)); };
+    set_importer(KEAssetType_Model, model_importer);
+}
+
+KLHotReload::~KLHotReload()
+{
+    _wait_for_batch();
+    m_watcher.stop();
+    for (auto& [filename, loaded] : m_models)
+        free_model(loaded);
+}
+
+void KLHotReload::set_importer(KEAssetType type, KAssetImporter importer)
+{
+    m_importers[type] = std::move(importer);
+}
+
+KModelHandle KLHotReload::load_model(const std::string& path)
+{
+    std::string filename = _absolute_path(
+        (std::filesystem::path(KLProject::get()->get_root_path()) / path).string()
+    );
+    auto it = m_models.find(filename);
+    if (it != m_models.end())
+        return it->second.model.get();
+
+    std::shared_ptr<void> data = import_model(filename);
+    if (data == nullptr)
+    {
+        KLDebug::log(
+            "HotReload::load_model() -> failed to load '" + filename + "'", KEDebugType_Warning
+        );
+        return nullptr;
+    }
+
+    KLoadedModel& loaded = m_models[filename];
+    loaded = upload_model(*static_cast<KSourceMesh*>(data.get()));
+    return loaded.model.get();
+}
+
+void KLHotReload::on_update()
+{
+    const std::string& root_path = KLProject::get()->get_root_path();
+    if (root_path != m_root_path)
+        _open(root_path);
+
+    // Layers update before the workspace draws, so this is the frame boundary everything is
+    // swapped at
+    if (m_batch_running && m_batch_remaining.load(std::memory_order_acquire) == 0)
+        _finish_batch();
+
+    m_watcher.poll(m_changes);
+    if (!m_batch_running && !m_changes.empty())
+        _start_batch();
+}
+
+void KLHotReload::_open(const std::string& root_path)
+{
+    _wait_for_batch();
+    m_watcher.stop();
+    m_changes.clear();
+    m_batch.clear();
+    m_batch_running = false;
+
+    m_root_path = root_path;
+    if (!m_root_path.empty())
+        m_watcher.start(m_root_path);
+}
+
+void KLHotReload::_wait_for_batch()
+{
+    // Jobs reference the batch, it can't be dropped while they are still running
+    while (m_batch_running && m_batch_remaining.load(std::memory_order_acquire) > 0)
+        std::this_thread::yield();
+}
+
+void KLHotReload::_start_batch()
+{
+    std::vector<std::string> relative_paths = {};
+    relative_paths.reserve(m_changes.size());
+
+    m_batch.clear();
+    for (const std::string& filename : m_changes)
+    {
+        std::filesystem::path path = std::filesystem::path(filename);
+        relative_paths.push_back(
+            path.lexically_relative(m_watcher.get_root_path()).generic_string()
+        );
+
+        std::error_code error = {};
+        if (!std::filesystem::is_regular_file(path, error))
+            continue;
+
+        KEAssetType type = KLAssetIndex::type_from_extension(path.extension().string());
+        if (m_importers[type].import == nullptr)
+            continue;
+        // Models nothing loaded through the editor aren't referenced by anything it can re-point
+        if (type == KEAssetType_Model && !m_models.contains(_absolute_path(filename)))
+            continue;
+
+        m_batch.push_back({filename, m_importers[type], nullptr});
+    }
+    m_changes.clear();
+
+    // Created, deleted and edited files all need their index entries refreshed
+    if (KLAssetIndex::get() != nullptr)
+        KLAssetIndex::get()->rescan(relative_paths);
+
+    if (m_batch.empty())
+        return;
+
+    if (m_workers == nullptr)
+        m_workers = std::make_unique<KWorkerPool>();
+
+    m_batch_running = true;
+    m_batch_start = std::chrono::steady_clock::now();
+    m_batch_remaining.store(m_batch.size(), std::memory_order_release);
+    for (std::size_t i = 0; i < m_batch.size(); i++)
+    {
+        m_workers->push(
+            [this, i]()
+            {
+                KReload& reload = m_batch[i];
+                reload.data = reload.importer.import(reload.filename);
+                m_batch_remaining.fetch_sub(1, std::memory_order_acq_rel);
+            }
+        );
+    }
+}
+
+void KLHotReload::_finish_batch()
+{
+    // Frames recorded on the render worker point at the models about to be replaced, they're
+    // dropped and the viewport records again once the reload is marked below
+    KRenderWorker::drain_all();
+
+    std::size_t reloaded = 0;
+    for (KReload& reload : m_batch)
+    {
+        if (reload.data == nullptr)
+        {
+            KLDebug::log(
+                "HotReload::_finish_batch() -> failed to import '" + reload.filename + "'",
+                KEDebugType_Warning
+            );
+            continue;
+        }
+
+        reload.importer.swap(reload.filename, std::move(reload.data));
+        reloaded++;
+    }
+
+    m_batch.clear();
+    m_batch_running = false;
+    m_reload_count += reloaded;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    m_last_batch_time = std::chrono::duration<double, std::milli>(now - m_batch_start).count();
+
+    if (reloaded > 0)
+    {
+        KLSceneChanges::get()->mark_assets_reloaded();
+        KLDebug::log(
+            "Reloaded " + std::to_string(reloaded) + " assets in " +
+                std::to_string(m_last_batch_time) + "ms",
+            KEDebugType_Message
+        );
+    }
+}
+
+void KLHotReload::_swap_model(const std::string& filename, std::shared_ptr<void> data)
+{
+    auto it = m_models.find(_absolute_path(filename));
+    if (it == m_models.end())
+        return;
+
+    KLoadedModel previous = std::move(it->second);
+    it->second = upload_model(*static_cast<KSourceMesh*>(data.get()));
+    KModelHandle model = it->second.model.get();
+
+    // Only the active scene is edited, so it's the only one whose mesh renderers point at models
+    // the editor loaded
+    KScene* scene = KIApplication::get_layer<KLSceneManager>()->get_active_scene();
+    if (scene != nullptr)
+    {
+        const std::uint64_t mesh_renderer_type = KTypeId::create<KCMeshRenderer>().get_id();
+        auto view = ecs::View<KCMeshRenderer>(&scene->get_registry());
+        for (ecs::Entity entity : view)
+        {
+            if (!view.has_required(entity))
+                continue;
+
+            KCMeshRenderer* mesh_renderer = KEntity(entity).get_component<KCMeshRenderer>();
+            if (mesh_renderer->model != previous.model.get())
+                continue;
+
+            mesh_renderer->model = model;
+            KLSceneChanges::get()->mark_entity_mutated(entity, mesh_renderer_type);
+        }
+    }
+
+    free_model(previous);
+}
+
+std::string KLHotReload::_absolute_path(const std::string& filename) const
+{
+    return std::filesystem::absolute(filename).lexically_normal().generic_string();
+}
@@ -0,0 +1,104 @@
+#ifndef __KRYOS_EDITOR_CORE_HOT_RELOAD_HPP__
+#define __KRYOS_EDITOR_CORE_HOT_RELOAD_HPP__
+
+#include "core/asset_index.hpp"
+#include "core/file_watcher.hpp"
+#include "core/obj_loader.hpp"
+#include "core/render_queue.hpp"
+#include "core/worker_pool.hpp"
+
+#include <kryos/core/application_layer.hpp>
+#include <kryos/scene/components.hpp>
+
+#include <glad/glad.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct KAssetImporter
+{
+    // Runs on a worker thread, returns nullptr when the asset failed to import
+    std::function<std::shared_ptr<void>(const std::string& filename)> import = nullptr;
+    // Runs on the main thread at the start of a frame, for every asset of a batch back to back
+    std::function<void(const std::string& filename, std::shared_ptr<void> data)> swap = nullptr;
+};
+
+// A model the editor loaded from a project file, with the GL objects it owns
+struct KLoadedModel
+{
+    std::unique_ptr<KModel> model = nullptr;
+    GLuint vertex_array = 0;
+    std::vector<GLuint> buffers = {};
+};
+
+// Watches the project directory and re-imports assets when they change on disk. Changes are
+// collected into batches which are parsed in parallel on a worker pool into staging data, then
+// every imported asset of a batch is swapped in at once at the start of a frame.
+// The asset handler can't replace what it loaded, so only models the editor loaded itself through
+// load_model() are reloaded. A reload uploads the new model, points the active scene's mesh
+// renderers at it and frees the old one
+class KLHotReload : public KIApplicationLayer
+{
+  public:
+    inline static KLHotReload* get() { return m_Instance; }
+
+  public:
+    KLHotReload();
+    virtual ~KLHotReload() override;
+
+    inline std::size_t get_reload_count() const { return m_reload_count; }
+    // Milliseconds from a batch's changes settling to it being swapped in
+    inline double get_last_batch_time() const { return m_last_batch_time; }
+    inline std::size_t get_model_count() const { return m_models.size(); }
+
+    void set_importer(KEAssetType type, KAssetImporter importer);
+    // path is relative to the project root, the model stays loaded and is kept up to date with
+    // the file until the layer goes away. Returns nullptr when the file can't be loaded
+    KModelHandle load_model(const std::string& path);
+
+    virtual void on_update() override;
+
+  private:
+    struct KReload
+    {
+        std::string filename = {};
+        KAssetImporter importer = {};
+        std::shared_ptr<void> data = nullptr;
+    };
+
+    static KLHotReload* m_Instance;
+
+  private:
+    void _open(const std::string& root_path);
+    void _wait_for_batch();
+    void _start_batch();
+    void _finish_batch();
+    void _swap_model(const std::string& filename, std::shared_ptr<void> data);
+    std::string _absolute_path(const std::string& filename) const;
+
+  private:
+    std::string m_root_path = {};
+    KFileWatcher m_watcher = {};
+    KAssetImporter m_importers[KEAssetType_Count] = {};
+    std::unique_ptr<KWorkerPool> m_workers = nullptr;
+
+    // Changes that arrived while a batch was still importing wait for the next one
+    std::vector<std::string> m_changes = {};
+    std::vector<KReload> m_batch = {};
+    std::atomic<std::size_t> m_batch_remaining = 0;
+    bool m_batch_running = false;
+    std::chrono::steady_clock::time_point m_batch_start = {};
+
+    std::size_t m_reload_count = 0;
+    double m_last_batch_time = 0.0;
+
+    // By absolute path, so models loaded for an earlier project never alias the current one's
+    std::unordered_map<std::string, KLoadedModel> m_models = {};
+};
+
+#endif
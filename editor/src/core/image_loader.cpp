@@ -0,0 +1,692 @@
+#include "core/image_loader.hpp"
+#include "core/mapped_file.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+static constexpr std::uint8_t png_signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+static constexpr std::uint32_t max_image_size = 1u << 15;
+
+// Codes up to this long are decoded with a single table lookup, longer ones bit by bit
+static constexpr int huffman_fast_bits = 9;
+
+struct KHuffman
+{
+    // symbol << 4 | length, 0 when the code is longer than the fast bits
+    std::uint16_t fast[1 << huffman_fast_bits] = {};
+    std::uint16_t counts[16] = {};
+    // Ordered by code length then symbol, the canonical code order
+    std::uint16_t symbols[288] = {};
+};
+
+struct KInflateState
+{
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+    std::size_t position = 0;
+    std::uint64_t bits = 0;
+    int bit_count = 0;
+    // Reading past the end only pads with zeros, the caller checks this once a block is done
+    bool overrun = false;
+
+    inline void fill(int count)
+    {
+        while (bit_count < count)
+        {
+            std::uint64_t byte = 0;
+            if (position < size)
+                byte = data[position++];
+            else if (bit_count + 8 > count)
+                overrun = true;
+            bits |= byte << bit_count;
+            bit_count += 8;
+        }
+    }
+
+    inline std::uint32_t take(int count)
+    {
+        if (count == 0)
+            return 0;
+        fill(count);
+        std::uint32_t value = static_cast<std::uint32_t>(bits & ((1ull << count) - 1));
+        bits >>= count;
+        bit_count -= count;
+        return value;
+    }
+};
+
+static bool build_huffman(KHuffman& huffman, const std::uint8_t* lengths, std::size_t count)
+{
+    huffman = KHuffman{};
+    for (std::size_t symbol = 0; symbol < count; symbol++)
+        huffman.counts[lengths[symbol]]++;
+    huffman.counts[0] = 0;
+
+    // Over subscribed code sets can't be decoded, incomplete ones are allowed like zlib does
+    int left = 1;
+    for (int length = 1; length < 16; length++)
+    {
+        left = (left << 1) - huffman.counts[length];
+        if (left < 0)
+            return false;
+    }
+
+    std::uint16_t offsets[16] = {};
+    std::uint32_t next_code[16] = {};
+    std::uint32_t code = 0;
+    for (int length = 1; length < 16; length++)
+    {
+        offsets[length] =
+            static_cast<std::uint16_t>(offsets[length - 1] + huffman.counts[length - 1]);
+        code = (code + huffman.counts[length - 1]) << 1;
+        next_code[length] = code;
+    }
+
+    for (std::size_t symbol = 0; symbol < count; symbol++)
+    {
+        int length = lengths[symbol];
+        if (length == 0)
+            continue;
+
+        huffman.symbols[offsets[length]++] = static_cast<std::uint16_t>(symbol);
+        std::uint32_t symbol_code = next_code[length]++;
+        if (length > huffman_fast_bits)
+            continue;
+
+        // The stream stores codes most significant bit first
+        std::uint32_t reversed = 0;
+        for (int bit = 0; bit < length; bit++)
+            reversed |= ((symbol_code >> bit) & 1) << (length - 1 - bit);
+        for (std::uint32_t i = reversed; i < (1u << huffman_fast_bits); i += 1u << length)
+            huffman.fast[i] = static_cast<std::uint16_t>((symbol << 4) | length);
+    }
+    return true;
+}
+
+static int decode_symbol(KInflateState& state, const KHuffman& huffman)
+{
+    state.fill(huffman_fast_bits);
+    std::uint16_t entry = huffman.fast[state.bits & ((1u << huffman_fast_bits) - 1)];
+    if (entry != 0)
+    {
+        state.take(entry & 0xf);
+        return entry >> 4;
+    }
+
+    std::int32_t code = 0;
+    std::int32_t first = 0;
+    std::int32_t index = 0;
+    for (int length = 1; length < 16; length++)
+    {
+        code |= static_cast<std::int32_t>(state.take(1));
+        std::int32_t count = huffman.counts[length];
+        if (code - first < count)
+            return huffman.symbols[index + code - first];
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+static bool inflate_block(
+    KInflateState& state, const KHuffman& lengths, const KHuffman& distances,
+    std::vector<std::uint8_t>& output
+)
+{
+    static constexpr std::uint16_t length_base[29] = {3,  4,  5,  6,   7,   8,   9,   10,  11, 13,
+                                                      15, 17, 19, 23,  27,  31,  35,  43,  51, 59,
+                                                      67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static constexpr std::uint8_t length_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1,
+                                                      1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                                      4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static constexpr std::uint16_t distance_base[30] = {
+        1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+        193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+    };
+    static constexpr std::uint8_t distance_extra[30] = {0, 0, 0, 0, 1, 1, 2,  2,  3,  3,
+                                                        4, 4, 5, 5, 6, 6, 7,  7,  8,  8,
+                                                        9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+    while (true)
+    {
+        int symbol = decode_symbol(state, lengths);
+        if (symbol < 0 || state.overrun)
+            return false;
+        if (symbol < 256)
+        {
+            output.push_back(static_cast<std::uint8_t>(symbol));
+            continue;
+        }
+        if (symbol == 256)
+            return true;
+
+        symbol -= 257;
+        if (symbol >= 29)
+            return false;
+        std::size_t length = length_base[symbol] + state.take(length_extra[symbol]);
+
+        int distance_symbol = decode_symbol(state, distances);
+        if (distance_symbol < 0 || distance_symbol >= 30)
+            return false;
+        std::size_t distance =
+            distance_base[distance_symbol] + state.take(distance_extra[distance_symbol]);
+        if (distance > output.size())
+            return false;
+
+        // Byte by byte since the copy is allowed to overlap what it writes
+        std::size_t from = output.size() - distance;
+        output.reserve(output.size() + length);
+        for (std::size_t i = 0; i < length; i++)
+            output.push_back(output[from + i]);
+    }
+}
+
+static bool inflate_dynamic_tables(KInflateState& state, KHuffman& lengths, KHuffman& distances)
+{
+    static constexpr std::uint8_t order[19] = {16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+                                               11, 4,  12, 3, 13, 2, 14, 1, 15};
+
+    std::uint32_t length_count = state.take(5) + 257;
+    std::uint32_t distance_count = state.take(5) + 1;
+    std::uint32_t code_count = state.take(4) + 4;
+    if (length_count > 286 || distance_count > 30)
+        return false;
+
+    std::uint8_t code_lengths[19] = {};
+    for (std::uint32_t i = 0; i < code_count; i++)
+        code_lengths[order[i]] = static_cast<std::uint8_t>(state.take(3));
+
+    KHuffman codes = {};
+    if (!build_huffman(codes, code_lengths, 19))
+        return false;
+
+    std::uint8_t all_lengths[286 + 30] = {};
+    std::uint32_t index = 0;
+    while (index < length_count + distance_count)
+    {
+        int symbol = decode_symbol(state, codes);
+        if (symbol < 0 || state.overrun)
+            return false;
+
+        if (symbol < 16)
+        {
+            all_lengths[index++] = static_cast<std::uint8_t>(symbol);
+            continue;
+        }
+
+        std::uint8_t value = 0;
+        std::uint32_t repeat = 0;
+        if (symbol == 16)
+        {
+            if (index == 0)
+                return false;
+            value = all_lengths[index - 1];
+            repeat = 3 + state.take(2);
+        }
+        else if (symbol == 17)
+            repeat = 3 + state.take(3);
+        else
+            repeat = 11 + state.take(7);
+
+        if (index + repeat > length_count + distance_count)
+            return false;
+        while (repeat-- > 0)
+            all_lengths[index++] = value;
+    }
+
+    // The end of block code has to exist or the block can never finish
+    if (all_lengths[256] == 0)
+        return false;
+
+    return build_huffman(lengths, all_lengths, length_count) &&
+           build_huffman(distances, all_lengths + length_count, distance_count);
+}
+
+bool ImageLoader::inflate(
+    const std::uint8_t* data, std::size_t size, std::vector<std::uint8_t>& output
+)
+{
+    // zlib header, only deflate without a preset dictionary exists in practice
+    if (size < 2 || (data[0] & 0x0f) != 8 || ((data[0] << 8) | data[1]) % 31 != 0 ||
+        (data[1] & 0x20) != 0)
+        return false;
+
+    KInflateState state = {};
+    state.data = data;
+    state.size = size;
+    state.position = 2;
+
+    bool last = false;
+    while (!last)
+    {
+        last = state.take(1) != 0;
+        std::uint32_t type = state.take(2);
+
+        if (type == 0)
+        {
+            // Stored, give back the whole bytes already buffered and copy straight from the input
+            state.take(state.bit_count % 8);
+            state.position -= static_cast<std::size_t>(state.bit_count / 8);
+            state.bits = 0;
+            state.bit_count = 0;
+
+            if (state.position + 4 > size)
+                return false;
+            std::uint32_t length = data[state.position] | (data[state.position + 1] << 8);
+            std::uint32_t inverse = data[state.position + 2] | (data[state.position + 3] << 8);
+            state.position += 4;
+            if ((length ^ 0xffff) != inverse || state.position + length > size)
+                return false;
+
+            output.insert(output.end(), data + state.position, data + state.position + length);
+            state.position += length;
+        }
+        else if (type == 1)
+        {
+            static KHuffman fixed_lengths = {};
+            static KHuffman fixed_distances = {};
+            static bool fixed_built = [&]()
+            {
+                std::uint8_t lengths[288] = {};
+                std::fill(lengths, lengths + 144, 8);
+                std::fill(lengths + 144, lengths + 256, 9);
+                std::fill(lengths + 256, lengths + 280, 7);
+                std::fill(lengths + 280, lengths + 288, 8);
+                std::uint8_t distances[30] = {};
+                std::fill(distances, distances + 30, 5);
+                return build_huffman(fixed_lengths, lengths, 288) &&
+                       build_huffman(fixed_distances, distances, 30);
+            }();
+
+            if (!fixed_built || !inflate_block(state, fixed_lengths, fixed_distances, output))
+                return false;
+        }
+        else if (type == 2)
+        {
+            KHuffman lengths = {};
+            KHuffman distances = {};
+            if (!inflate_dynamic_tables(state, lengths, distances) ||
+                !inflate_block(state, lengths, distances, output))
+                return false;
+        }
+        else
+            return false;
+    }
+
+    return !state.overrun;
+}
+
+static std::uint32_t read_u32_be(const std::uint8_t* data)
+{
+    return (static_cast<std::uint32_t>(data[0]) << 24) |
+           (static_cast<std::uint32_t>(data[1]) << 16) |
+           (static_cast<std::uint32_t>(data[2]) << 8) | static_cast<std::uint32_t>(data[3]);
+}
+
+static std::uint8_t paeth(int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc)
+        return static_cast<std::uint8_t>(a);
+    if (pb <= pc)
+        return static_cast<std::uint8_t>(b);
+    return static_cast<std::uint8_t>(c);
+}
+
+static bool unfilter(
+    std::uint8_t* row, const std::uint8_t* previous, std::size_t row_size, std::size_t pixel_size,
+    std::uint8_t filter
+)
+{
+    switch (filter)
+    {
+    case 0:
+        return true;
+    case 1:
+        for (std::size_t i = pixel_size; i < row_size; i++)
+            row[i] = static_cast<std::uint8_t>(row[i] + row[i - pixel_size]);
+        return true;
+    case 2:
+        for (std::size_t i = 0; i < row_size; i++)
+            row[i] = static_cast<std::uint8_t>(row[i] + previous[i]);
+        return true;
+    case 3:
+        for (std::size_t i = 0; i < row_size; i++)
+        {
+            int left = i >= pixel_size ? row[i - pixel_size] : 0;
+            row[i] = static_cast<std::uint8_t>(row[i] + ((left + previous[i]) >> 1));
+        }
+        return true;
+    case 4:
+        for (std::size_t i = 0; i < row_size; i++)
+        {
+            int left = i >= pixel_size ? row[i - pixel_size] : 0;
+            int upper_left = i >= pixel_size ? previous[i - pixel_size] : 0;
+            row[i] = static_cast<std::uint8_t>(row[i] + paeth(left, previous[i], upper_left));
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+struct KPngInfo
+{
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    std::uint32_t bit_depth = 0;
+    std::uint32_t color_type = 0;
+    std::uint32_t channels = 0;
+    bool interlaced = false;
+
+    std::uint8_t palette[256][4] = {};
+    std::uint32_t palette_size = 0;
+    // Raw sample values of the single transparent color of gray and RGB images
+    bool has_color_key = false;
+    std::uint16_t color_key[3] = {};
+};
+
+static std::uint16_t read_sample(const std::uint8_t* row, std::size_t index, std::uint32_t depth)
+{
+    if (depth == 8)
+        return row[index];
+    if (depth == 16)
+        return static_cast<std::uint16_t>((row[index * 2] << 8) | row[index * 2 + 1]);
+
+    std::size_t bit = index * depth;
+    std::uint32_t shift = 8 - depth - static_cast<std::uint32_t>(bit % 8);
+    return static_cast<std::uint16_t>((row[bit / 8] >> shift) & ((1u << depth) - 1));
+}
+
+static void expand_pixel(
+    const KPngInfo& info, const std::uint8_t* row, std::uint32_t x, std::uint8_t* rgba
+)
+{
+    std::uint16_t samples[4] = {};
+    for (std::uint32_t channel = 0; channel < info.channels; channel++)
+        samples[channel] = read_sample(row, x * info.channels + channel, info.bit_depth);
+
+    if (info.color_type == 3)
+    {
+        std::memcpy(rgba, info.palette[samples[0]], 4);
+        return;
+    }
+
+    auto to_8_bit = [&](std::uint16_t value) -> std::uint8_t
+    {
+        if (info.bit_depth == 16)
+            return static_cast<std::uint8_t>(value >> 8);
+        return static_cast<std::uint8_t>(value * 255 / ((1u << info.bit_depth) - 1));
+    };
+
+    switch (info.color_type)
+    {
+    case 0:
+        rgba[0] = rgba[1] = rgba[2] = to_8_bit(samples[0]);
+        rgba[3] = info.has_color_key && samples[0] == info.color_key[0] ? 0 : 255;
+        break;
+    case 2:
+        rgba[0] = to_8_bit(samples[0]);
+        rgba[1] = to_8_bit(samples[1]);
+        rgba[2] = to_8_bit(samples[2]);
+        rgba[3] = info.has_color_key && samples[0] == info.color_key[0] &&
+                          samples[1] == info.color_key[1] && samples[2] == info.color_key[2]
+                      ? 0
+                      : 255;
+        break;
+    case 4:
+        rgba[0] = rgba[1] = rgba[2] = to_8_bit(samples[0]);
+        rgba[3] = to_8_bit(samples[1]);
+        break;
+    default:
+        for (int channel = 0; channel < 4; channel++)
+            rgba[channel] = to_8_bit(samples[channel]);
+        break;
+    }
+}
+
+static bool parse_png(const std::uint8_t* data, std::size_t size, KSourceImage& image)
+{
+    KPngInfo info = {};
+    std::vector<std::uint8_t> compressed = {};
+    bool has_header = false;
+
+    // Chunk CRCs aren't checked, a corrupted stream still fails to inflate or unfilter
+    std::size_t position = sizeof(png_signature);
+    while (position + 12 <= size)
+    {
+        std::uint32_t length = read_u32_be(data + position);
+        const std::uint8_t* type = data + position + 4;
+        const std::uint8_t* chunk = data + position + 8;
+        if (length > size - position - 12)
+            return false;
+        position += 12 + static_cast<std::size_t>(length);
+
+        if (std::memcmp(type, "IHDR", 4) == 0 && length >= 13)
+        {
+            info.width = read_u32_be(chunk);
+            info.height = read_u32_be(chunk + 4);
+            info.bit_depth = chunk[8];
+            info.color_type = chunk[9];
+            info.interlaced = chunk[12] == 1;
+            has_header = chunk[10] == 0 && chunk[11] == 0 && chunk[12] <= 1;
+        }
+        else if (std::memcmp(type, "PLTE", 4) == 0)
+        {
+            info.palette_size = std::min<std::uint32_t>(length / 3, 256);
+            for (std::uint32_t i = 0; i < info.palette_size; i++)
+            {
+                std::memcpy(info.palette[i], chunk + i * 3, 3);
+                info.palette[i][3] = 255;
+            }
+        }
+        else if (std::memcmp(type, "tRNS", 4) == 0)
+        {
+            if (info.color_type == 3)
+            {
+                for (std::uint32_t i = 0; i < std::min<std::uint32_t>(length, 256); i++)
+                    info.palette[i][3] = chunk[i];
+            }
+            else if (length >= 2)
+            {
+                info.has_color_key = true;
+                for (std::uint32_t i = 0; i < std::min<std::uint32_t>(length / 2, 3); i++)
+                {
+                    info.color_key[i] =
+                        static_cast<std::uint16_t>((chunk[i * 2] << 8) | chunk[i * 2 + 1]);
+                }
+            }
+        }
+        else if (std::memcmp(type, "IDAT", 4) == 0)
+            compressed.insert(compressed.end(), chunk, chunk + length);
+        else if (std::memcmp(type, "IEND", 4) == 0)
+            break;
+    }
+
+    static constexpr std::uint32_t channel_counts[7] = {1, 0, 3, 1, 2, 0, 4};
+    if (!has_header || info.color_type > 6 || channel_counts[info.color_type] == 0)
+        return false;
+    info.channels = channel_counts[info.color_type];
+
+    // Only the combinations the spec allows
+    std::uint32_t depth = info.bit_depth;
+    bool valid_depth = depth == 8 || (depth == 16 && info.color_type != 3) ||
+                       ((depth == 1 || depth == 2 || depth == 4) &&
+                        (info.color_type == 0 || info.color_type == 3));
+    if (!valid_depth || info.width == 0 || info.height == 0 || info.width > max_image_size ||
+        info.height > max_image_size)
+        return false;
+
+    std::vector<std::uint8_t> raw = {};
+    if (!ImageLoader::inflate(compressed.data(), compressed.size(), raw))
+        return false;
+
+    image.width = info.width;
+    image.height = info.height;
+    image.pixels.assign(static_cast<std::size_t>(info.width) * info.height * 4, 0);
+
+    // Adam7 passes as (x offset, y offset, x step, y step), a single pass otherwise
+    static constexpr std::uint32_t adam7[7][4] = {{0, 0, 8, 8}, {4, 0, 8, 8}, {0, 4, 4, 8},
+                                                  {2, 0, 4, 4}, {0, 2, 2, 4}, {1, 0, 2, 2},
+                                                  {0, 1, 1, 2}};
+    static constexpr std::uint32_t single_pass[1][4] = {{0, 0, 1, 1}};
+    const std::uint32_t(*passes)[4] = info.interlaced ? adam7 : single_pass;
+    std::uint32_t pass_count = info.interlaced ? 7 : 1;
+
+    std::size_t bits_per_pixel = static_cast<std::size_t>(info.channels) * depth;
+    std::size_t pixel_size = std::max<std::size_t>(bits_per_pixel / 8, 1);
+    std::size_t offset = 0;
+    for (std::uint32_t pass = 0; pass < pass_count; pass++)
+    {
+        const std::uint32_t* p = passes[pass];
+        if (info.width <= p[0] || info.height <= p[1])
+            continue;
+        std::uint32_t pass_width = (info.width - p[0] + p[2] - 1) / p[2];
+        std::uint32_t pass_height = (info.height - p[1] + p[3] - 1) / p[3];
+        std::size_t row_size = (pass_width * bits_per_pixel + 7) / 8;
+
+        std::vector<std::uint8_t> previous = std::vector<std::uint8_t>(row_size, 0);
+        for (std::uint32_t y = 0; y < pass_height; y++)
+        {
+            if (offset + 1 + row_size > raw.size())
+                return false;
+
+            std::uint8_t* row = raw.data() + offset + 1;
+            if (!unfilter(row, previous.data(), row_size, pixel_size, raw[offset]))
+                return false;
+            offset += 1 + row_size;
+
+            std::size_t target_y = p[1] + static_cast<std::size_t>(y) * p[3];
+            for (std::uint32_t x = 0; x < pass_width; x++)
+            {
+                std::size_t target_x = p[0] + static_cast<std::size_t>(x) * p[2];
+                std::uint8_t* rgba = image.pixels.data() + (target_y * info.width + target_x) * 4;
+                expand_pixel(info, row, x, rgba);
+            }
+
+            std::memcpy(previous.data(), row, row_size);
+        }
+    }
+    return true;
+}
+
+static bool parse_tga(const std::uint8_t* data, std::size_t size, KSourceImage& image)
+{
+    if (size < 18)
+        return false;
+
+    std::uint8_t id_length = data[0];
+    std::uint8_t color_map_type = data[1];
+    std::uint8_t image_type = data[2];
+    std::uint32_t width = data[12] | (data[13] << 8);
+    std::uint32_t height = data[14] | (data[15] << 8);
+    std::uint32_t depth = data[16];
+    bool top_down = (data[17] & 0x20) != 0;
+
+    bool gray = image_type == 3 || image_type == 11;
+    bool run_length = image_type == 10 || image_type == 11;
+    bool valid_type = image_type == 2 || image_type == 3 || image_type == 10 || image_type == 11;
+    bool valid_depth = gray ? depth == 8 : depth == 24 || depth == 32;
+    if (color_map_type != 0 || !valid_type || !valid_depth || width == 0 || height == 0 ||
+        width > max_image_size || height > max_image_size)
+        return false;
+
+    std::size_t pixel_size = depth / 8;
+    std::size_t pixel_count = static_cast<std::size_t>(width) * height;
+    std::size_t position = 18 + static_cast<std::size_t>(id_length);
+
+    // Unpacked as stored first, BGR(A) from the bottom row up unless flagged otherwise
+    std::vector<std::uint8_t> stored = std::vector<std::uint8_t>(pixel_count * pixel_size);
+    if (!run_length)
+    {
+        if (position + stored.size() > size)
+            return false;
+        std::memcpy(stored.data(), data + position, stored.size());
+    }
+    else
+    {
+        std::size_t pixel = 0;
+        while (pixel < pixel_count)
+        {
+            if (position >= size)
+                return false;
+            std::uint8_t packet = data[position++];
+            std::size_t count = std::min<std::size_t>((packet & 0x7f) + 1, pixel_count - pixel);
+
+            if (packet & 0x80)
+            {
+                if (position + pixel_size > size)
+                    return false;
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    std::memcpy(
+                        stored.data() + (pixel + i) * pixel_size, data + position, pixel_size
+                    );
+                }
+                position += pixel_size;
+            }
+            else
+            {
+                if (position + count * pixel_size > size)
+                    return false;
+                std::memcpy(
+                    stored.data() + pixel * pixel_size, data + position, count * pixel_size
+                );
+                position += count * pixel_size;
+            }
+            pixel += count;
+        }
+    }
+
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(pixel_count * 4);
+    for (std::uint32_t y = 0; y < height; y++)
+    {
+        std::uint32_t source_y = top_down ? y : height - 1 - y;
+        for (std::uint32_t x = 0; x < width; x++)
+        {
+            const std::uint8_t* source =
+                stored.data() + (static_cast<std::size_t>(source_y) * width + x) * pixel_size;
+            std::uint8_t* rgba =
+                image.pixels.data() + (static_cast<std::size_t>(y) * width + x) * 4;
+            if (gray)
+            {
+                rgba[0] = rgba[1] = rgba[2] = source[0];
+                rgba[3] = 255;
+                continue;
+            }
+
+            rgba[0] = source[2];
+            rgba[1] = source[1];
+            rgba[2] = source[0];
+            rgba[3] = pixel_size == 4 ? source[3] : 255;
+        }
+    }
+    return true;
+}
+
+bool ImageLoader::load(const std::string& filename, KSourceImage& image)
+{
+    KMappedFile file = {};
+    if (!file.open(filename, 0, "ImageLoader::load()"))
+        return false;
+
+    return parse(file.get_data(), file.get_size(), image);
+}
+
+bool ImageLoader::parse(const std::uint8_t* data, std::size_t size, KSourceImage& image)
+{
+    image = KSourceImage{};
+
+    // TGA has no signature, anything that isn't a PNG is tried as one
+    if (size >= sizeof(png_signature) &&
+        std::memcmp(data, png_signature, sizeof(png_signature)) == 0)
+        return parse_png(data, size, image);
+    return parse_tga(data, size, image);
+}
@@ -0,0 +1,32 @@
+#ifndef __KRYOS_EDITOR_CORE_IMAGE_LOADER_HPP__
+#define __KRYOS_EDITOR_CORE_IMAGE_LOADER_HPP__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// RGBA8 pixels with the top row first, what source textures are turned into before cooking
+struct KSourceImage
+{
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    std::vector<std::uint8_t> pixels = {};
+
+    inline std::size_t get_memory_size() const { return pixels.size(); }
+};
+
+// PNG and TGA reader. PNGs of every color type and bit depth are expanded to RGBA8, 16 bit
+// channels keep their high byte. TGAs can be true color or grayscale, raw or run length encoded
+struct ImageLoader
+{
+    static bool load(const std::string& filename, KSourceImage& image);
+    // The format is detected from the data, not the filename
+    static bool parse(const std::uint8_t* data, std::size_t size, KSourceImage& image);
+
+    // zlib stream, output is appended to
+    static bool inflate(
+        const std::uint8_t* data, std::size_t size, std::vector<std::uint8_t>& output
+    );
+};
+
+#endif
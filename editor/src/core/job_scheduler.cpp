@@ -0,0 +1,127 @@
+#include "core/job_scheduler.hpp"
+
+static thread_local const KJobScheduler* t_scheduler = nullptr;
+static thread_local std::size_t t_worker = 0;
+
+KJobScheduler::KJobScheduler(std::size_t thread_count)
+{
+    // Zero picks one thread per core, leaving one for the main thread
+    if (thread_count == 0)
+    {
+        unsigned int cores = std::thread::hardware_concurrency();
+        thread_count = cores > 1 ? cores - 1 : 1;
+    }
+
+    for (std::size_t i = 0; i <= thread_count; i++)
+        m_queues.push_back(std::make_unique<KJobQueue>());
+
+    m_threads.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; i++)
+        m_threads.emplace_back(&KJobScheduler::_run, this, i);
+}
+
+KJobScheduler::~KJobScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_stop = true;
+    }
+
+    m_sleep.notify_all();
+    for (std::thread& thread : m_threads)
+        thread.join();
+}
+
+std::size_t KJobScheduler::get_worker_index() const
+{
+    return t_scheduler == this ? t_worker : m_threads.size();
+}
+
+void KJobScheduler::push(KJobCounter& counter, std::function<void()> job)
+{
+    counter.m_count.fetch_add(1, std::memory_order_relaxed);
+
+    KJobQueue& queue = *m_queues[get_worker_index()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back({std::move(job), &counter});
+    }
+    m_queued.fetch_add(1, std::memory_order_release);
+
+    // Taken so a worker can't miss the job between checking for one and going to sleep
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+    }
+    m_sleep.notify_one();
+}
+
+void KJobScheduler::wait(KJobCounter& counter)
+{
+    std::size_t index = get_worker_index();
+    while (!counter.is_done())
+    {
+        KJob job = {};
+        if (_find(index, job))
+            _execute(job);
+        else
+            std::this_thread::yield();
+    }
+}
+
+bool KJobScheduler::_find(std::size_t index, KJob& job)
+{
+    if (m_queued.load(std::memory_order_acquire) == 0)
+        return false;
+
+    // Newest first from the own queue, oldest first from everyone else's
+    for (std::size_t i = 0; i < m_queues.size(); i++)
+    {
+        KJobQueue& queue = *m_queues[(index + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty())
+            continue;
+
+        if (i == 0)
+        {
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+        }
+        else
+        {
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+        }
+        m_queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void KJobScheduler::_execute(KJob& job)
+{
+    job.function();
+    job.counter->m_count.fetch_sub(1, std::memory_order_release);
+}
+
+void KJobScheduler::_run(std::size_t index)
+{
+    t_scheduler = this;
+    t_worker = index;
+
+    while (true)
+    {
+        KJob job = {};
+        if (_find(index, job))
+        {
+            _execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleep_mutex);
+        m_sleep.wait(
+            lock, [this]() { return m_stop || m_queued.load(std::memory_order_acquire) > 0; }
+        );
+        if (m_stop && m_queued.load(std::memory_order_acquire) == 0)
+            return;
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef __KRYOS_EDITOR_CORE_JOB_SCHEDULER_HPP__
+#define __KRYOS_EDITOR_CORE_JOB_SCHEDULER_HPP__
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class KJobScheduler;
+
+// Jobs of one batch that haven't finished yet, waited on with KJobScheduler::wait()
+class KJobCounter
+{
+  public:
+    inline bool is_done() const { return m_count.load(std::memory_order_acquire) == 0; }
+
+  private:
+    friend class KJobScheduler;
+    std::atomic<std::size_t> m_count = 0;
+};
+
+// Every worker has its own queue: jobs pushed from a worker go to its queue and are taken from
+// the back, so a worker keeps working on what it just split off, idle workers steal from the
+// front of the others' queues. Threads that aren't workers push to a queue of their own and run
+// jobs while they wait, so jobs may push more jobs and wait on them
+class KJobScheduler
+{
+  public:
+    KJobScheduler(std::size_t thread_count = 0);
+    ~KJobScheduler();
+
+    inline std::size_t get_thread_count() const { return m_threads.size(); }
+    // The worker running the caller, get_thread_count() for any other thread
+    std::size_t get_worker_index() const;
+
+    void push(KJobCounter& counter, std::function<void()> job);
+    void wait(KJobCounter& counter);
+
+    // Calls callback(begin, end) for chunks of [0, count) in parallel, the first chunk on the
+    // caller, and returns the number of chunks
+    template<typename _Callback>
+    std::size_t parallel_for(std::size_t count, std::size_t grain, _Callback&& callback)
+    {
+        grain = std::max<std::size_t>(grain, 1);
+        KJobCounter counter = {};
+        std::size_t chunk_count = 1;
+        for (std::size_t begin = grain; begin < count; begin += grain, chunk_count++)
+        {
+            std::size_t end = std::min(begin + grain, count);
+            push(counter, [&callback, begin, end]() { callback(begin, end); });
+        }
+
+        callback(0, std::min(grain, count));
+        wait(counter);
+        return chunk_count;
+    }
+
+  private:
+    struct KJob
+    {
+        std::function<void()> function = {};
+        KJobCounter* counter = nullptr;
+    };
+
+    struct KJobQueue
+    {
+        std::mutex mutex = {};
+        std::deque<KJob> jobs = {};
+    };
+
+    bool _find(std::size_t queue, KJob& job);
+    void _execute(KJob& job);
+    void _run(std::size_t index);
+
+  private:
+    std::vector<std::thread> m_threads = {};
+    // One per worker, the last one for every other thread
+    std::vector<std::unique_ptr<KJobQueue>> m_queues = {};
+    std::atomic<std::size_t> m_queued = 0;
+
+    std::mutex m_sleep_mutex = {};
+    std::condition_variable m_sleep = {};
+    bool m_stop = false;
+};
+
+#endif
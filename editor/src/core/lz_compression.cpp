@@ -0,0 +1,150 @@
+#include "core/lz_compression.hpp"
+
+#include <cstring>
+
+static constexpr std::uint32_t hash_bits = 16;
+
+static inline std::uint32_t read32(const std::uint8_t* data)
+{
+    std::uint32_t value = 0;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static inline std::uint32_t hash_sequence(std::uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - hash_bits);
+}
+
+static void write_length(std::vector<std::uint8_t>& output, std::size_t length)
+{
+    while (length >= 255)
+    {
+        output.push_back(255);
+        length -= 255;
+    }
+    output.push_back(static_cast<std::uint8_t>(length));
+}
+
+static void write_sequence(
+    std::vector<std::uint8_t>& output, const std::uint8_t* literals, std::size_t literal_count,
+    std::size_t offset, std::size_t match_length
+)
+{
+    std::size_t match_code = match_length > 0 ? match_length - KLzCompression::min_match : 0;
+    std::uint8_t token = static_cast<std::uint8_t>(
+        (literal_count < 15 ? literal_count : 15) << 4 | (match_code < 15 ? match_code : 15)
+    );
+    output.push_back(token);
+    if (literal_count >= 15)
+        write_length(output, literal_count - 15);
+    output.insert(output.end(), literals, literals + literal_count);
+
+    if (match_length == 0)
+        return;
+
+    output.push_back(static_cast<std::uint8_t>(offset & 0xff));
+    output.push_back(static_cast<std::uint8_t>(offset >> 8));
+    if (match_code >= 15)
+        write_length(output, match_code - 15);
+}
+
+void KLzCompression::compress(
+    const std::uint8_t* data, std::size_t size, std::vector<std::uint8_t>& output
+)
+{
+    // Last position + 1 each hashed sequence was seen at, 0 means never
+    std::vector<std::uint32_t> table = std::vector<std::uint32_t>(1u << hash_bits, 0);
+
+    std::size_t anchor = 0;
+    std::size_t i = 0;
+    while (size >= min_match && i <= size - min_match)
+    {
+        std::uint32_t sequence = read32(data + i);
+        std::uint32_t hash = hash_sequence(sequence);
+        std::size_t candidate = table[hash];
+        table[hash] = static_cast<std::uint32_t>(i + 1);
+
+        if (candidate == 0 || i - (candidate - 1) > max_offset ||
+            read32(data + candidate - 1) != sequence)
+        {
+            i++;
+            continue;
+        }
+
+        std::size_t match = candidate - 1;
+        std::size_t length = min_match;
+        while (i + length < size && data[match + length] == data[i + length])
+            length++;
+
+        write_sequence(output, data + anchor, i - anchor, i - match, length);
+        i += length;
+        anchor = i;
+    }
+
+    write_sequence(output, data + anchor, size - anchor, 0, 0);
+}
+
+bool KLzCompression::decompress(
+    const std::uint8_t* data, std::size_t size, std::uint8_t* output, std::size_t output_size
+)
+{
+    auto read_length = [&](std::size_t& position, std::size_t& length) -> bool
+    {
+        std::uint8_t byte = 255;
+        while (byte == 255)
+        {
+            if (position >= size)
+                return false;
+            byte = data[position++];
+            length += byte;
+        }
+        return true;
+    };
+
+    std::size_t position = 0;
+    std::size_t written = 0;
+    while (position < size)
+    {
+        std::uint8_t token = data[position++];
+
+        std::size_t literal_count = token >> 4;
+        if (literal_count == 15 && !read_length(position, literal_count))
+            return false;
+        if (literal_count > size - position || literal_count > output_size - written)
+            return false;
+        if (literal_count > 0)
+            std::memcpy(output + written, data + position, literal_count);
+        position += literal_count;
+        written += literal_count;
+
+        if (position == size)
+            break;
+
+        if (size - position < 2)
+            return false;
+        std::size_t offset = data[position] | static_cast<std::size_t>(data[position + 1]) << 8;
+        position += 2;
+
+        std::size_t length = token & 0x0f;
+        if (length == 15 && !read_length(position, length))
+            return false;
+        length += min_match;
+        if (offset == 0 || offset > written || length > output_size - written)
+            return false;
+
+        // Matches closer than their length overlap the bytes they produce, those are copied one
+        // byte at a time
+        const std::uint8_t* source = output + written - offset;
+        if (offset >= length)
+            std::memcpy(output + written, source, length);
+        else
+        {
+            for (std::size_t j = 0; j < length; j++)
+                output[written + j] = source[j];
+        }
+        written += length;
+    }
+
+    return written == output_size;
+}
@@ -0,0 +1,26 @@
+#ifndef __KRYOS_EDITOR_CORE_LZ_COMPRESSION_HPP__
+#define __KRYOS_EDITOR_CORE_LZ_COMPRESSION_HPP__
+
+#include <cstdint>
+#include <vector>
+
+// Byte aligned LZ77 in the spirit of LZ4, tuned for decompression speed over ratio. Each sequence
+// is a token (literal count in the high nibble, match length - 4 in the low one, 15 means more
+// length bytes follow), the literals, then a 16 bit little endian match offset. The last sequence
+// only has literals
+struct KLzCompression
+{
+    static constexpr std::size_t min_match = 4;
+    static constexpr std::size_t max_offset = 65535;
+
+    // Appends the compressed data to output
+    static void compress(
+        const std::uint8_t* data, std::size_t size, std::vector<std::uint8_t>& output
+    );
+    // Fails on malformed input or when it doesn't decompress to exactly size bytes
+    static bool decompress(
+        const std::uint8_t* data, std::size_t size, std::uint8_t* output, std::size_t output_size
+    );
+};
+
+#endif
@@ -0,0 +1,163 @@
+#include "core/mapped_file.hpp"
+#include "core/virtual_file_system.hpp"
+
+#include <kryos/core/debug.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+KMappedFile::~KMappedFile() { close(); }
+
+KMappedFile::KMappedFile(KMappedFile&& other) noexcept { *this = std::move(other); }
+
+KMappedFile& KMappedFile::operator=(KMappedFile&& other) noexcept
+{
+    if (this == &other)
+        return *this;
+
+    close();
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = std::exchange(other.m_size, 0);
+    m_mapped = std::exchange(other.m_mapped, false);
+    m_buffer = std::move(other.m_buffer);
+    m_owner = std::move(other.m_owner);
+    return *this;
+}
+
+bool KMappedFile::exists(const std::string& filename)
+{
+    KLVirtualFileSystem* file_system = KLVirtualFileSystem::get();
+    if (file_system != nullptr && file_system->exists(filename))
+        return true;
+
+    std::error_code error = {};
+    return std::filesystem::is_regular_file(filename, error);
+}
+
+bool KMappedFile::open(const std::string& filename, std::size_t min_size, const std::string& owner)
+{
+    close();
+
+    KLVirtualFileSystem* file_system = KLVirtualFileSystem::get();
+    if (file_system != nullptr && file_system->open(filename, *this))
+    {
+        if (m_size >= min_size && m_size > 0)
+            return true;
+
+        close();
+        KLDebug::log(owner + " -> " + filename + " is truncated", KEDebugType_Error);
+        return false;
+    }
+
+#if defined(__linux__) || defined(__APPLE__)
+    int file = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0)
+    {
+        KLDebug::log(owner + " -> failed to open " + filename, KEDebugType_Error);
+        return false;
+    }
+
+    struct stat status = {};
+    if (fstat(file, &status) != 0 || status.st_size < static_cast<off_t>(min_size) ||
+        status.st_size == 0)
+    {
+        ::close(file);
+        KLDebug::log(owner + " -> " + filename + " is truncated", KEDebugType_Error);
+        return false;
+    }
+
+    std::size_t size = static_cast<std::size_t>(status.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    // The mapping keeps its own reference to the file
+    ::close(file);
+    if (data == MAP_FAILED)
+    {
+        KLDebug::log(owner + " -> failed to map " + filename, KEDebugType_Error);
+        return false;
+    }
+
+    m_data = static_cast<const std::uint8_t*>(data);
+    m_size = size;
+    m_mapped = true;
+#else
+    std::ifstream file = std::ifstream(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        KLDebug::log(owner + " -> failed to open " + filename, KEDebugType_Error);
+        return false;
+    }
+
+    m_buffer.resize(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(
+        reinterpret_cast<char*>(m_buffer.data()), static_cast<std::streamsize>(m_buffer.size())
+    );
+    if (!file.good() || m_buffer.size() < min_size || m_buffer.empty())
+    {
+        m_buffer.clear();
+        KLDebug::log(owner + " -> " + filename + " is truncated", KEDebugType_Error);
+        return false;
+    }
+
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+#endif
+
+    return true;
+}
+
+void KMappedFile::open_view(
+    const std::uint8_t* data, std::size_t size, std::shared_ptr<const void> owner
+)
+{
+    close();
+    m_data = data;
+    m_size = size;
+    m_owner = std::move(owner);
+}
+
+void KMappedFile::open_buffer(std::vector<std::uint8_t> buffer)
+{
+    close();
+    m_buffer = std::move(buffer);
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+}
+
+void KMappedFile::close()
+{
+#if defined(__linux__) || defined(__APPLE__)
+    if (m_mapped)
+        munmap(const_cast<std::uint8_t*>(m_data), m_size);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = false;
+    m_buffer.clear();
+    m_owner = nullptr;
+}
+
+bool KMappedFileReader::read(void* data, std::size_t size)
+{
+    if (m_failed || size > m_file.get_size() - m_offset)
+    {
+        m_failed = true;
+        return false;
+    }
+
+    // memcpy from a null source is undefined even for 0 bytes
+    if (size > 0)
+        std::memcpy(data, m_file.get_data() + m_offset, size);
+    m_offset += size;
+    return true;
+}
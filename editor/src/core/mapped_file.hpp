@@ -0,0 +1,62 @@
+#ifndef __KRYOS_EDITOR_CORE_MAPPED_FILE_HPP__
+#define __KRYOS_EDITOR_CORE_MAPPED_FILE_HPP__
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Read only view of a whole file mapped into memory with a single mmap. Falls back to reading the
+// whole file into one buffer where mmap isn't available. Files inside an archive mounted in the
+// virtual file system are opened from the archive instead
+class KMappedFile
+{
+  public:
+    KMappedFile() = default;
+    ~KMappedFile();
+
+    KMappedFile(const KMappedFile&) = delete;
+    KMappedFile& operator=(const KMappedFile&) = delete;
+    KMappedFile(KMappedFile&& other) noexcept;
+    KMappedFile& operator=(KMappedFile&& other) noexcept;
+
+    // Whether open() would find the file, in a mounted archive or on disk
+    static bool exists(const std::string& filename);
+
+    inline bool is_open() const { return m_data != nullptr; }
+    inline const std::uint8_t* get_data() const { return m_data; }
+    inline std::size_t get_size() const { return m_size; }
+
+    // Fails when the file can't be opened or is smaller than min_size, errors are logged with
+    // owner as the function name
+    bool open(const std::string& filename, std::size_t min_size, const std::string& owner);
+    // Views memory that belongs to someone else, owner is kept alive until the view is closed
+    void open_view(const std::uint8_t* data, std::size_t size, std::shared_ptr<const void> owner);
+    void open_buffer(std::vector<std::uint8_t> buffer);
+    void close();
+
+  private:
+    const std::uint8_t* m_data = nullptr;
+    std::size_t m_size = 0;
+    bool m_mapped = false;
+    std::vector<std::uint8_t> m_buffer = {};
+    std::shared_ptr<const void> m_owner = nullptr;
+};
+
+// Reads an open mapped file front to back like a stream, once a read runs past the end every
+// read after it fails too
+class KMappedFileReader
+{
+  public:
+    KMappedFileReader(const KMappedFile& file) : m_file(file) {}
+    ~KMappedFileReader() = default;
+
+    bool read(void* data, std::size_t size);
+
+  private:
+    const KMappedFile& m_file;
+    std::size_t m_offset = 0;
+    bool m_failed = false;
+};
+
+#endif
@@ -0,0 +1,147 @@
+#include "core/member_tables.hpp"
+
+#include <kryos/core/application.hpp>
+#include <kryos/scene/entity.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+KLMemberTables* KLMemberTables::m_Instance = nullptr;
+
+KLMemberTables::KLMemberTables()
+{
+    assert(
+        m_Instance == nullptr && "MemberTables::MemberTables() -> cannot created multiple member "
+                                 "tables application layers"
+    );
+
+    m_Instance = this;
+    _build();
+}
+
+KLMemberTables::~KLMemberTables() { m_Instance = nullptr; }
+
+std::uint32_t KLMemberTables::find(std::uint64_t type_id) const
+{
+    auto it = m_table_indices.find(type_id);
+    return it != m_table_indices.end() ? it->second : null_table;
+}
+
+const KMemberEntry* KLMemberTables::find_entity_member(std::uint64_t type_id) const
+{
+    std::uint32_t table = find(type_id);
+    if (table == null_table)
+        return nullptr;
+
+    const std::uint64_t entity_type = KTypeId::create<ecs::Entity>().get_id();
+    const KMemberTable& member_table = m_tables[table];
+    for (const KMemberEntry* entry = begin(member_table); entry != end(member_table); entry++)
+    {
+        if (entry->type_id == entity_type &&
+            !(entry->flags & (KEMemberEntryFlag_Pointer | KEMemberEntryFlag_Array)))
+            return entry;
+    }
+    return nullptr;
+}
+
+void KLMemberTables::on_update()
+{
+    KLReflectionRegistry* reflection = KIApplication::get_layer<KLReflectionRegistry>();
+    if (reflection->get_all_type_infos().size() != m_registered_count)
+        _build();
+}
+
+void KLMemberTables::_build()
+{
+    KLReflectionRegistry* reflection = KIApplication::get_layer<KLReflectionRegistry>();
+    const auto& type_infos = reflection->get_all_type_infos();
+
+    m_tables.clear();
+    m_entries.clear();
+    m_strings.clear();
+    m_table_indices.clear();
+    m_registered_count = type_infos.size();
+    m_build_count++;
+
+    // Every table gets its index up front so members can point at tables that come after them
+    for (const auto& [type, info] : type_infos)
+    {
+        if (!reflection->type_contains_members(type))
+            continue;
+
+        m_table_indices.emplace(type, static_cast<std::uint32_t>(m_tables.size()));
+        m_tables.push_back(KMemberTable{type, 0, 0});
+    }
+
+    for (KMemberTable& table : m_tables)
+    {
+        table.first = static_cast<std::uint32_t>(m_entries.size());
+        for (const KMemberInfo& member : reflection->get_members(KTypeId(table.type_id)))
+        {
+            KMemberEntry entry = {};
+            entry.offset = static_cast<std::uint32_t>(member.offset);
+            entry.name = _add_string(member.fieldname);
+            entry.editor_flags = member.flags;
+            entry.type_id = member.variable.get_type().get_id();
+            if (member.variable.is_pointer())
+                entry.flags |= KEMemberEntryFlag_Pointer;
+            if (member.variable.is_array())
+            {
+                entry.flags |= KEMemberEntryFlag_Array;
+                entry.array_size = static_cast<std::uint32_t>(member.variable.get_array_size());
+            }
+
+            // NOTE: Not going to deal with pointers higher than 2, same as the properties panel
+            if (member.variable.get_pointer_count() > 2 ||
+                member.variable.get_flags() & KEVariableFlag_Const ||
+                member.flags & KEMemberInfoEditorFlag_Hide)
+            {
+                entry.flags |= KEMemberEntryFlag_Skip;
+                m_entries.push_back(entry);
+                continue;
+            }
+
+            const KTypeInfo& type_info = reflection->get_type_info(member.variable.get_type());
+            entry.type_name = _add_string(reflection->get_variable_type_name(member.variable));
+            entry.type_size = static_cast<std::uint32_t>(type_info.size);
+            if (type_info.flags & KETypeInfoFlag_StdArray)
+                entry.flags |= KEMemberEntryFlag_StdArray;
+            if (type_info.flags & KETypeInfoFlag_StdVector)
+            {
+                entry.flags |= KEMemberEntryFlag_StdVector;
+                if (reflection->is_templated_type(member.type))
+                {
+                    // There should only be one type for vector
+                    KTypeId element_type =
+                        KTypeId(reflection->get_templated_internal_types(member.type).front());
+                    entry.element_type_id = element_type.get_id();
+                    entry.element_size =
+                        static_cast<std::uint32_t>(reflection->get_type_info(element_type).size);
+                }
+            }
+
+            auto nested = m_table_indices.find(entry.type_id);
+            if (nested != m_table_indices.end())
+            {
+                entry.flags |= KEMemberEntryFlag_Nested;
+                entry.nested_table = nested->second;
+            }
+
+            m_entries.push_back(entry);
+        }
+
+        table.count = static_cast<std::uint32_t>(m_entries.size()) - table.first;
+        std::stable_sort(
+            m_entries.begin() + table.first, m_entries.end(),
+            [](const KMemberEntry& a, const KMemberEntry& b) { return a.offset < b.offset; }
+        );
+    }
+}
+
+std::uint32_t KLMemberTables::_add_string(const std::string& string)
+{
+    std::uint32_t index = static_cast<std::uint32_t>(m_strings.size());
+    m_strings.insert(m_strings.end(), string.begin(), string.end());
+    m_strings.push_back('\0');
+    return index;
+}
@@ -0,0 +1,127 @@
+#ifndef __KRYOS_EDITOR_CORE_MEMBER_TABLES_HPP__
+#define __KRYOS_EDITOR_CORE_MEMBER_TABLES_HPP__
+
+#include <kryos/core/application_layer.hpp>
+#include <kryos/serialization/reflection.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+enum KEMemberEntryFlag
+{
+    KEMemberEntryFlag_None = 0,
+    // Const, hidden from the editor or more than two pointers deep
+    KEMemberEntryFlag_Skip = 1 << 0,
+    KEMemberEntryFlag_Pointer = 1 << 1,
+    KEMemberEntryFlag_Array = 1 << 2,
+    KEMemberEntryFlag_StdVector = 1 << 3,
+    KEMemberEntryFlag_StdArray = 1 << 4,
+    // The member's type has reflected members of its own, see nested_table
+    KEMemberEntryFlag_Nested = 1 << 5,
+};
+typedef std::uint32_t KEMemberEntryFlags;
+
+struct KMemberEntry
+{
+    std::uint32_t offset = 0;
+    // Indices into the string pool
+    std::uint32_t name = 0;
+    std::uint32_t type_name = 0;
+    KEMemberEntryFlags flags = KEMemberEntryFlag_None;
+    KEMemberInfoEditorFlags editor_flags = 0;
+
+    // The member's type without pointers, arrays or const, what a value is drawn as
+    std::uint64_t type_id = 0;
+    std::uint32_t type_size = 0;
+    std::uint32_t array_size = 0;
+
+    // std::vector element type, 0 when the member isn't a vector
+    std::uint64_t element_type_id = 0;
+    std::uint32_t element_size = 0;
+    std::uint32_t nested_table = 0;
+};
+
+struct KMemberTable
+{
+    std::uint64_t type_id = 0;
+    std::uint32_t first = 0;
+    std::uint32_t count = 0;
+};
+
+// Frozen copy of the reflection registry's member sets. Every type's members sit next to each
+// other in one array sorted by offset and names are pooled, so walking a component is a linear
+// scan instead of a tree traversal per member. Built once the engine's types are registered and
+// rebuilt only if more types get registered later
+class KLMemberTables : public KIApplicationLayer
+{
+  public:
+    inline static KLMemberTables* get() { return m_Instance; }
+    static constexpr std::uint32_t null_table = ~0u;
+
+  public:
+    KLMemberTables();
+    virtual ~KLMemberTables() override;
+
+    inline std::size_t get_table_count() const { return m_tables.size(); }
+    inline std::size_t get_entry_count() const { return m_entries.size(); }
+    inline std::size_t get_string_pool_size() const { return m_strings.size(); }
+    inline std::size_t get_build_count() const { return m_build_count; }
+
+    // Returns null_table when the type has no reflected members
+    std::uint32_t find(std::uint64_t type_id) const;
+    inline const KMemberTable& get_table(std::uint32_t table) const { return m_tables[table]; }
+    inline const KMemberEntry* begin(const KMemberTable& table) const
+    {
+        return m_entries.data() + table.first;
+    }
+    inline const KMemberEntry* end(const KMemberTable& table) const
+    {
+        return m_entries.data() + table.first + table.count;
+    }
+    inline const char* get_string(std::uint32_t index) const { return m_strings.data() + index; }
+    // First member of the type holding a single entity, null when it has none. KCParent's member
+    // isn't named anywhere in the editor, this is how its parent is found
+    const KMemberEntry* find_entity_member(std::uint64_t type_id) const;
+
+    // Calls callback(entry, member) for every member that isn't skipped, depth first through
+    // nested types, with member pointing at the member inside object
+    template<typename _Callback>
+    void walk(std::uint32_t table, std::byte* object, _Callback&& callback) const
+    {
+        const KMemberTable& member_table = m_tables[table];
+        for (const KMemberEntry* entry = begin(member_table); entry != end(member_table); entry++)
+        {
+            if (entry->flags & KEMemberEntryFlag_Skip)
+                continue;
+
+            std::byte* member = object + entry->offset;
+            callback(*entry, member);
+            if ((entry->flags & KEMemberEntryFlag_Nested) &&
+                !(entry->flags & (KEMemberEntryFlag_Pointer | KEMemberEntryFlag_Array)))
+                walk(entry->nested_table, member, callback);
+        }
+    }
+
+    // Rebuilds the tables when the registry gained types since they were built
+    virtual void on_update() override;
+
+  private:
+    static KLMemberTables* m_Instance;
+
+  private:
+    void _build();
+    std::uint32_t _add_string(const std::string& string);
+
+  private:
+    std::vector<KMemberTable> m_tables = {};
+    std::vector<KMemberEntry> m_entries = {};
+    std::vector<char> m_strings = {};
+    std::unordered_map<std::uint64_t, std::uint32_t> m_table_indices = {};
+
+    std::size_t m_registered_count = 0;
+    std::size_t m_build_count = 0;
+};
+
+#endif
@@ -0,0 +1,616 @@
+#include "core/mesh_cooker.hpp"
+#include "core/mapped_file.hpp"
+#include "core/mesh_simplifier.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+
+static constexpr std::size_t forsyth_cache_size = 32;
+
+static float forsyth_vertex_score(int cache_position, std::uint32_t live_triangles)
+{
+    // Vertices no triangle needs anymore should never attract the next pick
+    if (live_triangles == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cache_position >= 0)
+    {
+        // The last triangle's vertices get a fixed score so its neighbours aren't favoured over
+        // other triangles that share two vertices with the cache
+        if (cache_position < 3)
+            score = 0.75f;
+        else
+        {
+            float scale = 1.0f / static_cast<float>(forsyth_cache_size - 3);
+            score = std::pow(1.0f - static_cast<float>(cache_position - 3) * scale, 1.5f);
+        }
+    }
+
+    // Favour finishing off vertices with few triangles left
+    return score + 2.0f / std::sqrt(static_cast<float>(live_triangles));
+}
+
+float KMeshCooker::average_cache_miss_ratio(
+    const std::vector<std::uint32_t>& indices, std::size_t vertex_count, std::size_t cache_size
+)
+{
+    if (indices.size() < 3)
+        return 0.0f;
+
+    // FIFO like most hardware, the timestamp of a vertex's insertion tells whether it's evicted
+    std::vector<std::size_t> inserted_at = std::vector<std::size_t>(vertex_count, 0);
+    std::size_t time = cache_size + 1;
+    std::size_t misses = 0;
+    for (std::uint32_t index : indices)
+    {
+        if (time - inserted_at[index] > cache_size)
+        {
+            inserted_at[index] = time++;
+            misses++;
+        }
+    }
+
+    return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+}
+
+void KMeshCooker::optimize_vertex_cache(
+    std::vector<std::uint32_t>& indices, std::size_t vertex_count
+)
+{
+    std::size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0)
+        return;
+
+    // Triangles adjacent to each vertex, packed with offsets
+    std::vector<std::uint32_t> live_triangles = std::vector<std::uint32_t>(vertex_count, 0);
+    for (std::uint32_t index : indices)
+        live_triangles[index]++;
+
+    std::vector<std::uint32_t> offsets = std::vector<std::uint32_t>(vertex_count + 1, 0);
+    for (std::size_t i = 0; i < vertex_count; i++)
+        offsets[i + 1] = offsets[i] + live_triangles[i];
+
+    std::vector<std::uint32_t> adjacency = std::vector<std::uint32_t>(indices.size());
+    std::vector<std::uint32_t> fill = std::vector<std::uint32_t>(offsets.begin(), offsets.end());
+    for (std::size_t triangle = 0; triangle < triangle_count; triangle++)
+    {
+        for (std::size_t corner = 0; corner < 3; corner++)
+        {
+            std::uint32_t vertex = indices[triangle * 3 + corner];
+            adjacency[fill[vertex]++] = static_cast<std::uint32_t>(triangle);
+        }
+    }
+
+    std::vector<int> cache_positions = std::vector<int>(vertex_count, -1);
+    std::vector<float> vertex_scores = std::vector<float>(vertex_count);
+    for (std::size_t i = 0; i < vertex_count; i++)
+        vertex_scores[i] = forsyth_vertex_score(-1, live_triangles[i]);
+
+    std::vector<bool> emitted = std::vector<bool>(triangle_count, false);
+
+    std::vector<std::uint32_t> result = {};
+    result.reserve(indices.size());
+
+    std::vector<std::uint32_t> cache = {};
+    std::vector<std::uint32_t> next_cache = {};
+    cache.reserve(forsyth_cache_size + 3);
+    next_cache.reserve(forsyth_cache_size + 3);
+
+    std::size_t input_cursor = 0;
+    std::int64_t best_triangle = -1;
+    for (std::size_t emitted_count = 0; emitted_count < triangle_count; emitted_count++)
+    {
+        // Nothing in the cache is connected to anything left, continue from the input order
+        if (best_triangle < 0)
+        {
+            while (emitted[input_cursor])
+                input_cursor++;
+            best_triangle = static_cast<std::int64_t>(input_cursor);
+        }
+
+        std::size_t triangle = static_cast<std::size_t>(best_triangle);
+        emitted[triangle] = true;
+
+        next_cache.clear();
+        for (std::size_t corner = 0; corner < 3; corner++)
+        {
+            std::uint32_t vertex = indices[triangle * 3 + corner];
+            result.push_back(vertex);
+            next_cache.push_back(vertex);
+
+            // Drop the triangle from the vertex's live adjacency
+            std::uint32_t* first = adjacency.data() + offsets[vertex];
+            std::uint32_t* last = first + live_triangles[vertex];
+            std::uint32_t* found = std::find(first, last, static_cast<std::uint32_t>(triangle));
+            std::swap(*found, *(last - 1));
+            live_triangles[vertex]--;
+        }
+
+        for (std::uint32_t vertex : cache)
+        {
+            if (std::find(next_cache.begin(), next_cache.begin() + 3, vertex) ==
+                next_cache.begin() + 3)
+                next_cache.push_back(vertex);
+        }
+
+        // Vertices pushed out of the cache lose their position score
+        for (std::size_t i = forsyth_cache_size; i < next_cache.size(); i++)
+            cache_positions[next_cache[i]] = -1;
+        if (next_cache.size() > forsyth_cache_size)
+            next_cache.resize(forsyth_cache_size);
+
+        std::vector<std::uint32_t> touched = cache;
+        cache.swap(next_cache);
+        for (std::size_t i = 0; i < cache.size(); i++)
+        {
+            cache_positions[cache[i]] = static_cast<int>(i);
+            touched.push_back(cache[i]);
+        }
+
+        for (std::uint32_t vertex : touched)
+            vertex_scores[vertex] =
+                forsyth_vertex_score(cache_positions[vertex], live_triangles[vertex]);
+
+        // Only triangles around cached vertices changed score, pick the best of those
+        best_triangle = -1;
+        float best_score = -1.0f;
+        for (std::uint32_t vertex : cache)
+        {
+            for (std::uint32_t i = 0; i < live_triangles[vertex]; i++)
+            {
+                std::uint32_t candidate = adjacency[offsets[vertex] + i];
+                float score = vertex_scores[indices[candidate * 3]] +
+                              vertex_scores[indices[candidate * 3 + 1]] +
+                              vertex_scores[indices[candidate * 3 + 2]];
+                if (score > best_score)
+                {
+                    best_score = score;
+                    best_triangle = candidate;
+                }
+            }
+        }
+    }
+
+    indices.swap(result);
+}
+
+void KMeshCooker::optimize_overdraw(
+    std::vector<std::uint32_t>& indices, const std::vector<glm::vec3>& positions
+)
+{
+    constexpr std::size_t cache_size = 16;
+    std::size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0)
+        return;
+
+    // Cluster boundaries are the triangles that miss the cache on all three vertices, reordering
+    // whole clusters keeps most of the cache efficiency
+    std::vector<std::size_t> cluster_starts = {};
+    std::vector<std::size_t> inserted_at = std::vector<std::size_t>(positions.size(), 0);
+    std::size_t time = cache_size + 1;
+    for (std::size_t triangle = 0; triangle < triangle_count; triangle++)
+    {
+        int misses = 0;
+        for (std::size_t corner = 0; corner < 3; corner++)
+        {
+            std::uint32_t vertex = indices[triangle * 3 + corner];
+            if (time - inserted_at[vertex] > cache_size)
+            {
+                inserted_at[vertex] = time++;
+                misses++;
+            }
+        }
+
+        if (misses == 3 || triangle == 0)
+            cluster_starts.push_back(triangle);
+    }
+    cluster_starts.push_back(triangle_count);
+
+    glm::vec3 mesh_center = glm::vec3(0.0f);
+    for (const glm::vec3& position : positions)
+        mesh_center += position;
+    mesh_center /= static_cast<float>(std::max<std::size_t>(positions.size(), 1));
+
+    // Clusters facing away from the mesh center are likely in front of the rest
+    std::size_t cluster_count = cluster_starts.size() - 1;
+    std::vector<float> cluster_sort = std::vector<float>(cluster_count, 0.0f);
+    for (std::size_t cluster = 0; cluster < cluster_count; cluster++)
+    {
+        glm::vec3 center = glm::vec3(0.0f);
+        glm::vec3 normal = glm::vec3(0.0f);
+        float area = 0.0f;
+        for (std::size_t triangle = cluster_starts[cluster];
+             triangle < cluster_starts[cluster + 1]; triangle++)
+        {
+            const glm::vec3& a = positions[indices[triangle * 3]];
+            const glm::vec3& b = positions[indices[triangle * 3 + 1]];
+            const glm::vec3& c = positions[indices[triangle * 3 + 2]];
+            glm::vec3 cross = glm::cross(b - a, c - a);
+            float triangle_area = glm::length(cross);
+
+            center += (a + b + c) * (triangle_area / 3.0f);
+            normal += cross;
+            area += triangle_area;
+        }
+
+        if (area <= 0.0f)
+            continue;
+
+        center /= area;
+        float normal_length = glm::length(normal);
+        if (normal_length > 0.0f)
+            cluster_sort[cluster] = glm::dot(center - mesh_center, normal / normal_length);
+    }
+
+    std::vector<std::size_t> order = std::vector<std::size_t>(cluster_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(
+        order.begin(), order.end(),
+        [&](std::size_t lhs, std::size_t rhs) { return cluster_sort[lhs] > cluster_sort[rhs]; }
+    );
+
+    std::vector<std::uint32_t> result = {};
+    result.reserve(indices.size());
+    for (std::size_t cluster : order)
+    {
+        result.insert(
+            result.end(), indices.begin() + cluster_starts[cluster] * 3,
+            indices.begin() + cluster_starts[cluster + 1] * 3
+        );
+    }
+
+    indices.swap(result);
+}
+
+std::vector<std::uint32_t> KMeshCooker::optimize_vertex_fetch(
+    std::vector<std::uint32_t>& indices, std::size_t vertex_count
+)
+{
+    constexpr std::uint32_t unused = ~0u;
+    std::vector<std::uint32_t> remap = std::vector<std::uint32_t>(vertex_count, unused);
+    std::vector<std::uint32_t> old_vertices = {};
+    old_vertices.reserve(vertex_count);
+
+    for (std::uint32_t& index : indices)
+    {
+        if (remap[index] == unused)
+        {
+            remap[index] = static_cast<std::uint32_t>(old_vertices.size());
+            old_vertices.push_back(index);
+        }
+        index = remap[index];
+    }
+
+    return old_vertices;
+}
+
+std::uint16_t KMeshCooker::float_to_half(float value)
+{
+    std::uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    std::uint32_t sign = (bits >> 16) & 0x8000;
+    std::int32_t exponent = static_cast<std::int32_t>((bits >> 23) & 0xff) - 127 + 15;
+    std::uint32_t mantissa = bits & 0x7fffff;
+
+    if (exponent <= 0)
+    {
+        // Too small even for a half denormal
+        if (exponent < -10)
+            return static_cast<std::uint16_t>(sign);
+
+        mantissa |= 0x800000;
+        std::uint32_t shift = static_cast<std::uint32_t>(14 - exponent);
+        std::uint32_t half_mantissa = mantissa >> shift;
+        // Round to nearest
+        if ((mantissa >> (shift - 1)) & 1)
+            half_mantissa++;
+        return static_cast<std::uint16_t>(sign | half_mantissa);
+    }
+
+    // NaN keeps a mantissa bit set, infinity and anything that overflows become infinity
+    bool nan = ((bits >> 23) & 0xff) == 0xff && mantissa != 0;
+    if (exponent >= 31)
+        return static_cast<std::uint16_t>(sign | 0x7c00 | (nan ? 0x200 : 0));
+
+    std::uint32_t half = sign | (static_cast<std::uint32_t>(exponent) << 10) | (mantissa >> 13);
+    // Round to nearest, a carry into the exponent is still correct
+    if (mantissa & 0x1000)
+        half++;
+    return static_cast<std::uint16_t>(half);
+}
+
+float KMeshCooker::half_to_float(std::uint16_t value)
+{
+    std::uint32_t sign = static_cast<std::uint32_t>(value & 0x8000) << 16;
+    std::uint32_t exponent = (value >> 10) & 0x1f;
+    std::uint32_t mantissa = value & 0x3ff;
+
+    std::uint32_t bits = 0;
+    if (exponent == 0)
+    {
+        if (mantissa == 0)
+            bits = sign;
+        else
+        {
+            // Denormal, normalize it
+            exponent = 127 - 15 + 1;
+            while ((mantissa & 0x400) == 0)
+            {
+                mantissa <<= 1;
+                exponent--;
+            }
+            bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+        }
+    }
+    else if (exponent == 31)
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    else
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+
+    float result = 0.0f;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+std::uint64_t KMeshCooker::get_cache_key(
+    std::string_view source, const std::string& importer, const KMeshCookSettings& settings
+)
+{
+    KContentHasher hasher = {};
+    hasher.update(source.data(), source.size());
+    hasher.update(importer);
+    hasher.update((static_cast<std::uint64_t>(mesh_file_version) << 32) | mesh_cooker_version);
+    hasher.update(
+        static_cast<std::uint64_t>(settings.optimize_vertex_cache) |
+        static_cast<std::uint64_t>(settings.optimize_overdraw) << 1 |
+        static_cast<std::uint64_t>(settings.lod_count) << 32
+    );
+    std::uint32_t lod_ratio = 0;
+    std::uint32_t lod_max_error = 0;
+    std::memcpy(&lod_ratio, &settings.lod_ratio, sizeof(lod_ratio));
+    std::memcpy(&lod_max_error, &settings.lod_max_error, sizeof(lod_max_error));
+    hasher.update((static_cast<std::uint64_t>(lod_ratio) << 32) | lod_max_error);
+    return hasher.finish();
+}
+
+bool KMeshCooker::cook(
+    const KSourceMesh& source, const KMeshCookSettings& settings, std::vector<char>& data,
+    KCookStats* stats
+)
+{
+    std::size_t vertex_count = source.positions.size();
+    if (vertex_count == 0 || source.indices.size() < 3)
+        return false;
+
+    std::vector<std::uint32_t> indices = source.indices;
+    float acmr_before = average_cache_miss_ratio(indices, vertex_count);
+
+    if (settings.optimize_vertex_cache)
+        optimize_vertex_cache(indices, vertex_count);
+    if (settings.optimize_overdraw)
+        optimize_overdraw(indices, source.positions);
+
+    std::vector<std::vector<std::uint32_t>> lods = {};
+    std::vector<float> lod_errors = {};
+    std::size_t simplified_triangles = 0;
+    std::chrono::steady_clock::time_point simplify_start = std::chrono::steady_clock::now();
+    generate_lods(source.positions, indices, settings, lods, lod_errors, &simplified_triangles);
+    std::chrono::steady_clock::time_point simplify_end = std::chrono::steady_clock::now();
+    double simplify_time =
+        std::chrono::duration<double, std::milli>(simplify_end - simplify_start).count();
+
+    KMeshFileHeader header = {};
+    header.lod_count = static_cast<std::uint32_t>(lods.size() + 1);
+    header.lods[0].index_count = static_cast<std::uint32_t>(indices.size());
+    for (std::size_t i = 0; i < lods.size(); i++)
+    {
+        KMeshLod& level = header.lods[i + 1];
+        level.first_index = static_cast<std::uint32_t>(indices.size());
+        level.index_count = static_cast<std::uint32_t>(lods[i].size());
+        level.error = lod_errors[i];
+        indices.insert(indices.end(), lods[i].begin(), lods[i].end());
+    }
+
+    // LOD 0 comes first in the index buffer, so vertices end up in the order it fetches them
+    std::vector<std::uint32_t> old_vertices = optimize_vertex_fetch(indices, vertex_count);
+
+    header.vertex_count = static_cast<std::uint32_t>(old_vertices.size());
+    header.index_count = static_cast<std::uint32_t>(indices.size());
+    header.index_size = header.vertex_count <= 0xffff ? 2 : 4;
+
+    glm::vec3 bounds_min = source.positions[old_vertices[0]];
+    glm::vec3 bounds_max = bounds_min;
+    for (std::uint32_t vertex : old_vertices)
+    {
+        bounds_min = glm::min(bounds_min, source.positions[vertex]);
+        bounds_max = glm::max(bounds_max, source.positions[vertex]);
+    }
+
+    glm::vec3 center = (bounds_min + bounds_max) * 0.5f;
+    float radius = 0.0f;
+    for (std::uint32_t vertex : old_vertices)
+        radius = std::max(radius, glm::length(source.positions[vertex] - center));
+
+    for (int i = 0; i < 3; i++)
+    {
+        header.bounds_min[i] = bounds_min[i];
+        header.bounds_max[i] = bounds_max[i];
+        header.sphere_center[i] = center[i];
+    }
+    header.sphere_radius = radius;
+
+    glm::vec3 extent = bounds_max - bounds_min;
+    std::vector<KPackedVertex> vertices = std::vector<KPackedVertex>(old_vertices.size());
+    for (std::size_t i = 0; i < old_vertices.size(); i++)
+    {
+        std::uint32_t vertex = old_vertices[i];
+        KPackedVertex& packed = vertices[i];
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float t = extent[axis] > 0.0f
+                          ? (source.positions[vertex][axis] - bounds_min[axis]) / extent[axis]
+                          : 0.0f;
+            packed.position[axis] =
+                static_cast<std::uint16_t>(std::lround(std::clamp(t, 0.0f, 1.0f) * 65535.0f));
+
+            float n = vertex < source.normals.size() ? source.normals[vertex][axis] : 0.0f;
+            packed.normal[axis] =
+                static_cast<std::int8_t>(std::lround(std::clamp(n, -1.0f, 1.0f) * 127.0f));
+        }
+
+        glm::vec2 uv = vertex < source.uvs.size() ? source.uvs[vertex] : glm::vec2(0.0f);
+        packed.uv[0] = float_to_half(uv.x);
+        packed.uv[1] = float_to_half(uv.y);
+    }
+
+    auto align = [](std::uint64_t offset)
+    { return (offset + mesh_file_alignment - 1) & ~(mesh_file_alignment - 1); };
+    header.vertex_offset = align(sizeof(KMeshFileHeader));
+    header.index_offset = align(header.vertex_offset + vertices.size() * sizeof(KPackedVertex));
+    std::uint64_t file_size = header.index_offset + indices.size() * header.index_size;
+
+    data.assign(file_size, 0);
+    std::memcpy(data.data(), &header, sizeof(header));
+    std::memcpy(
+        data.data() + header.vertex_offset, vertices.data(), vertices.size() * sizeof(KPackedVertex)
+    );
+    if (header.index_size == 2)
+    {
+        std::uint16_t* out = reinterpret_cast<std::uint16_t*>(data.data() + header.index_offset);
+        for (std::size_t i = 0; i < indices.size(); i++)
+            out[i] = static_cast<std::uint16_t>(indices[i]);
+    }
+    else
+        std::memcpy(data.data() + header.index_offset, indices.data(), indices.size() * 4);
+
+    if (stats != nullptr)
+    {
+        stats->source_memory = source.get_memory_size();
+        stats->cooked_size = data.size();
+        stats->vertex_count = header.vertex_count;
+        stats->index_count = header.index_count;
+        stats->acmr_before = acmr_before;
+        std::vector<std::uint32_t> lod0 = std::vector<std::uint32_t>(
+            indices.begin(), indices.begin() + header.lods[0].index_count
+        );
+        stats->acmr_after = average_cache_miss_ratio(lod0, header.vertex_count);
+        stats->lod_count = header.lod_count;
+        for (std::uint32_t i = 0; i < header.lod_count; i++)
+            stats->lod_triangle_counts[i] = header.lods[i].index_count / 3;
+        stats->simplified_triangles = simplified_triangles;
+        stats->simplify_time = simplify_time;
+    }
+
+    return true;
+}
+
+void KMeshCooker::generate_lods(
+    const std::vector<glm::vec3>& positions, const std::vector<std::uint32_t>& indices,
+    const KMeshCookSettings& settings, std::vector<std::vector<std::uint32_t>>& lods,
+    std::vector<float>& errors, std::size_t* simplified_triangles
+)
+{
+    lods.clear();
+    errors.clear();
+
+    // Each LOD is simplified from the one before, which is cheaper than starting from the full
+    // mesh every time, so their errors add up
+    std::vector<std::uint32_t> lod = indices;
+    float error = 0.0f;
+    std::uint32_t lod_count = std::clamp(settings.lod_count, 1u, mesh_max_lods);
+    while (lods.size() + 1 < lod_count)
+    {
+        std::size_t previous_count = lod.size();
+        float target_count = static_cast<float>(previous_count) * settings.lod_ratio;
+        std::size_t target = static_cast<std::size_t>(target_count) / 3 * 3;
+        float remaining_error = settings.lod_max_error - error;
+        if (target < 3 || remaining_error <= 0.0f)
+            break;
+
+        float level_error = 0.0f;
+        if (simplified_triangles != nullptr)
+            *simplified_triangles += previous_count / 3;
+        lod = KMeshSimplifier::simplify(positions, lod, target, remaining_error, &level_error);
+
+        // Not worth a level of its own once the error bound stops the simplifier early
+        if (lod.size() * 4 > previous_count * 3)
+            break;
+
+        error += level_error;
+        lods.push_back(lod);
+        errors.push_back(error);
+        if (settings.optimize_vertex_cache)
+            optimize_vertex_cache(lods.back(), positions.size());
+    }
+}
+
+bool KMeshCooker::write_file(const std::string& filename, const std::vector<char>& data)
+{
+    std::error_code error = {};
+    std::filesystem::path parent = std::filesystem::path(filename).parent_path();
+    if (!parent.empty())
+        std::filesystem::create_directories(parent, error);
+
+    std::string temporary_filename = filename + ".tmp";
+    {
+        std::ofstream file = std::ofstream(temporary_filename, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!file.good())
+            return false;
+    }
+
+    std::filesystem::rename(temporary_filename, filename, error);
+    return !error;
+}
+
+bool KMeshCooker::cook_file(
+    const std::string& source_filename, const std::string& filename,
+    const KMeshCookSettings& settings, KCookStats* stats, KDerivedDataCache* cache
+)
+{
+    KMappedFile file = {};
+    if (!file.open(source_filename, 0, "MeshCooker::cook_file()"))
+        return false;
+
+    std::string_view source =
+        std::string_view(reinterpret_cast<const char*>(file.get_data()), file.get_size());
+
+    // Hashing the source is far cheaper than parsing and optimizing it again
+    std::uint64_t key = get_cache_key(source, "obj", settings);
+    std::vector<char> data = {};
+    if (cache != nullptr && cache->load(key, data) && data.size() >= sizeof(KMeshFileHeader))
+    {
+        if (stats != nullptr)
+        {
+            KMeshFileHeader header = {};
+            std::memcpy(&header, data.data(), sizeof(header));
+            stats->cooked_size = data.size();
+            stats->vertex_count = header.vertex_count;
+            stats->index_count = header.index_count;
+            stats->lod_count = std::min(header.lod_count, mesh_max_lods);
+            for (std::uint32_t i = 0; i < stats->lod_count; i++)
+                stats->lod_triangle_counts[i] = header.lods[i].index_count / 3;
+            stats->cache_hit = true;
+        }
+        return write_file(filename, data);
+    }
+
+    KSourceMesh mesh = {};
+    if (!ObjLoader::parse(source.data(), source.size(), mesh) ||
+        !cook(mesh, settings, data, stats))
+        return false;
+
+    if (cache != nullptr)
+        cache->store(key, data);
+    return write_file(filename, data);
+}
@@ -0,0 +1,99 @@
+#ifndef __KRYOS_EDITOR_CORE_MESH_COOKER_HPP__
+#define __KRYOS_EDITOR_CORE_MESH_COOKER_HPP__
+
+#include "core/derived_data_cache.hpp"
+#include "core/mesh_format.hpp"
+#include "core/obj_loader.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Bump whenever the cooker's output changes for the same input, so stale derived data is never
+// used
+static constexpr std::uint32_t mesh_cooker_version = 2;
+
+struct KMeshCookSettings
+{
+    bool optimize_vertex_cache = true;
+    bool optimize_overdraw = true;
+    // Including LOD 0, each level aims for lod_ratio of the previous one's triangles and stops
+    // early once the error would pass lod_max_error
+    std::uint32_t lod_count = 4;
+    float lod_ratio = 0.5f;
+    float lod_max_error = 0.05f;
+};
+
+struct KCookStats
+{
+    std::size_t source_memory = 0;
+    std::size_t cooked_size = 0;
+    std::uint32_t vertex_count = 0;
+    std::uint32_t index_count = 0;
+    // Average cache misses per triangle with a 16 entry FIFO, before and after optimizing
+    float acmr_before = 0.0f;
+    float acmr_after = 0.0f;
+    std::uint32_t lod_count = 0;
+    std::uint32_t lod_triangle_counts[mesh_max_lods] = {};
+    // Triangles fed into the simplifier and the milliseconds it took
+    std::size_t simplified_triangles = 0;
+    double simplify_time = 0.0;
+    // Only the sizes and counts are known when the result came from the derived data cache
+    bool cache_hit = false;
+};
+
+// Turns source meshes into the engine native mesh format: indices reordered for the post
+// transform vertex cache and then for overdraw, vertices reordered for fetch locality, quantized
+// and written out interleaved with the mesh bounds
+class KMeshCooker
+{
+  public:
+    // Keyed by the source's content, the importer and everything that changes the output
+    static std::uint64_t get_cache_key(
+        std::string_view source, const std::string& importer, const KMeshCookSettings& settings
+    );
+    static bool cook(
+        const KSourceMesh& source, const KMeshCookSettings& settings, std::vector<char>& data,
+        KCookStats* stats
+    );
+    // Looks the source up in the cache first when one is given and stores the result on a miss
+    static bool cook_file(
+        const std::string& source_filename, const std::string& filename,
+        const KMeshCookSettings& settings, KCookStats* stats, KDerivedDataCache* cache = nullptr
+    );
+    // Simplifies LOD 1 and up from the given LOD 0 indices, errors are relative to the mesh's
+    // largest extent and include the error of the levels before
+    static void generate_lods(
+        const std::vector<glm::vec3>& positions, const std::vector<std::uint32_t>& indices,
+        const KMeshCookSettings& settings, std::vector<std::vector<std::uint32_t>>& lods,
+        std::vector<float>& errors, std::size_t* simplified_triangles = nullptr
+    );
+    // Written next to the target and renamed over it so readers never see a partial file
+    static bool write_file(const std::string& filename, const std::vector<char>& data);
+
+    static float average_cache_miss_ratio(
+        const std::vector<std::uint32_t>& indices, std::size_t vertex_count,
+        std::size_t cache_size = 16
+    );
+
+    // Forsyth's linear speed vertex cache optimisation
+    static void optimize_vertex_cache(
+        std::vector<std::uint32_t>& indices, std::size_t vertex_count
+    );
+    // Splits the cache optimized triangles into clusters at cache restarts and orders the
+    // clusters outside in, so front facing surfaces tend to be drawn before the ones they hide
+    static void optimize_overdraw(
+        std::vector<std::uint32_t>& indices, const std::vector<glm::vec3>& positions
+    );
+    // Renumbers vertices in the order the indices first use them, returns the old index of
+    // every new vertex
+    static std::vector<std::uint32_t> optimize_vertex_fetch(
+        std::vector<std::uint32_t>& indices, std::size_t vertex_count
+    );
+
+    static std::uint16_t float_to_half(float value);
+    static float half_to_float(std::uint16_t value);
+};
+
+#endif
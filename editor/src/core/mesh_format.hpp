@@ -0,0 +1,60 @@
+#ifndef __KRYOS_EDITOR_CORE_MESH_FORMAT_HPP__
+#define __KRYOS_EDITOR_CORE_MESH_FORMAT_HPP__
+
+#include <cstdint>
+
+// Engine native mesh file (.kmesh). Everything is little endian and laid out so the file can be
+// mapped into memory and used in place: a header, then the interleaved vertices and the indices,
+// each starting on a 16 byte boundary
+
+static constexpr std::uint32_t mesh_file_magic = 0x48534d4b; // "KMSH"
+static constexpr std::uint32_t mesh_file_version = 2;
+static constexpr std::uint64_t mesh_file_alignment = 16;
+static constexpr std::uint32_t mesh_max_lods = 8;
+
+// Positions are unorm16 inside the mesh bounds, normals snorm8 and uvs half floats, 16 bytes in
+// total compared to 32 for the unpacked floats
+struct KPackedVertex
+{
+    std::uint16_t position[4] = {};
+    std::int8_t normal[4] = {};
+    std::uint16_t uv[2] = {};
+};
+static_assert(sizeof(KPackedVertex) == 16, "KPackedVertex must stay 16 bytes");
+
+// Range of the index buffer drawn for one level of detail, LOD 0 is the full mesh. Every LOD
+// indexes the same vertices, error is the simplification error relative to the mesh's largest
+// extent
+struct KMeshLod
+{
+    std::uint32_t first_index = 0;
+    std::uint32_t index_count = 0;
+    float error = 0.0f;
+    std::uint32_t reserved = 0;
+};
+
+struct KMeshFileHeader
+{
+    std::uint32_t magic = mesh_file_magic;
+    std::uint32_t version = mesh_file_version;
+
+    std::uint32_t vertex_count = 0;
+    std::uint32_t vertex_stride = sizeof(KPackedVertex);
+    std::uint32_t index_count = 0;
+    // 2 when every index fits in 16 bits, otherwise 4
+    std::uint32_t index_size = 4;
+    std::uint64_t vertex_offset = 0;
+    std::uint64_t index_offset = 0;
+
+    float bounds_min[3] = {};
+    float bounds_max[3] = {};
+    float sphere_center[3] = {};
+    float sphere_radius = 0.0f;
+
+    std::uint32_t lod_count = 1;
+    std::uint32_t reserved[3] = {};
+    KMeshLod lods[mesh_max_lods] = {};
+};
+static_assert(sizeof(KMeshFileHeader) % mesh_file_alignment == 0, "header must stay aligned");
+
+#endif
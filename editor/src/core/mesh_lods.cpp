@@ -0,0 +1,288 @@
+#include "core/mesh_lods.hpp"
+#include "core/scene_changes.hpp"
+
+#include <kryos/core/debug.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <thread>
+
+KLMeshLods* KLMeshLods::m_Instance = nullptr;
+
+KLMeshLods::KLMeshLods()
+{
+    assert(
+        m_Instance == nullptr && "MeshLods::MeshLods() -> cannot created multiple mesh lods "
+                                 "application layers"
+    );
+
+    m_Instance = this;
+}
+
+KLMeshLods::~KLMeshLods() { _clear(); }
+
+void KLMeshLods::set_enabled(bool enabled)
+{
+    if (enabled != m_enabled)
+        m_version++;
+    m_enabled = enabled;
+}
+
+void KLMeshLods::set_pixel_error(float pixel_error)
+{
+    if (pixel_error != m_pixel_error)
+        m_version++;
+    m_pixel_error = pixel_error;
+}
+
+const KModelLods* KLMeshLods::find(KModelHandle model) const
+{
+    auto it = m_models.find(model);
+    if (it == m_models.end())
+        return nullptr;
+    return &it->second;
+}
+
+void KLMeshLods::request(KModelHandle model)
+{
+    if (model == nullptr || !m_requested.insert(model).second)
+        return;
+    m_requests.push_back(model);
+}
+
+std::uint32_t KLMeshLods::select(const KModelLods& lods, float pixels_per_unit) const
+{
+    std::uint32_t lod = 0;
+    for (std::uint32_t level = 1; level < lods.errors.size(); level++)
+    {
+        if (lods.errors[level] * pixels_per_unit > m_pixel_error)
+            break;
+        lod = level;
+    }
+    return lod;
+}
+
+void KLMeshLods::on_update()
+{
+    // Reloaded models may have kept their handle but not their meshes
+    std::uint64_t asset_version = KLSceneChanges::get()->get_asset_version();
+    if (asset_version != m_asset_version)
+    {
+        _clear();
+        m_asset_version = asset_version;
+    }
+
+    for (std::unique_ptr<KPendingModel>& pending : m_pending)
+    {
+        if (pending->remaining.load(std::memory_order_acquire) == 0)
+            _finish(*pending);
+    }
+    std::erase_if(
+        m_pending, [](const std::unique_ptr<KPendingModel>& pending)
+        { return pending->remaining.load(std::memory_order_acquire) == 0; }
+    );
+
+    for (KModelHandle model : m_requests)
+        _start(model);
+    m_requests.clear();
+}
+
+bool KLMeshLods::read_positions(
+    GLuint vertex_array, std::size_t vertex_count, std::vector<glm::vec3>& positions
+)
+{
+    // Positions are attribute 0, wherever the vertex array reads them from
+    GLint enabled = GL_FALSE;
+    GLint size = 0;
+    GLint type = 0;
+    GLint relative_offset = 0;
+    glGetVertexArrayIndexediv(vertex_array, 0, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
+    glGetVertexArrayIndexediv(vertex_array, 0, GL_VERTEX_ATTRIB_ARRAY_SIZE, &size);
+    glGetVertexArrayIndexediv(vertex_array, 0, GL_VERTEX_ATTRIB_ARRAY_TYPE, &type);
+    glGetVertexArrayIndexediv(vertex_array, 0, GL_VERTEX_ATTRIB_RELATIVE_OFFSET, &relative_offset);
+    if (enabled == GL_FALSE || size < 3 || type != GL_FLOAT)
+        return false;
+
+    GLint binding = 0;
+    GLint buffer = 0;
+    GLint stride = 0;
+    GLint64 offset = 0;
+    glBindVertexArray(vertex_array);
+    glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_BINDING, &binding);
+    glGetIntegeri_v(GL_VERTEX_BINDING_BUFFER, static_cast<GLuint>(binding), &buffer);
+    glGetIntegeri_v(GL_VERTEX_BINDING_STRIDE, static_cast<GLuint>(binding), &stride);
+    glGetInteger64i_v(GL_VERTEX_BINDING_OFFSET, static_cast<GLuint>(binding), &offset);
+    glBindVertexArray(0);
+    if (buffer == 0)
+        return false;
+    if (stride == 0)
+        stride = size * static_cast<GLint>(sizeof(float));
+
+    GLint64 buffer_size = 0;
+    glGetNamedBufferParameteri64v(static_cast<GLuint>(buffer), GL_BUFFER_SIZE, &buffer_size);
+    GLint64 start = offset + relative_offset;
+    GLint64 end = start + static_cast<GLint64>(vertex_count - 1) * stride + 3 * sizeof(float);
+    if (vertex_count == 0 || end > buffer_size)
+        return false;
+
+    std::vector<std::uint8_t> data =
+        std::vector<std::uint8_t>(static_cast<std::size_t>(end - start));
+    glGetNamedBufferSubData(
+        static_cast<GLuint>(buffer), static_cast<GLintptr>(start),
+        static_cast<GLsizeiptr>(data.size()), data.data()
+    );
+
+    positions.resize(vertex_count);
+    for (std::size_t i = 0; i < vertex_count; i++)
+        std::memcpy(&positions[i], data.data() + i * stride, sizeof(glm::vec3));
+    return true;
+}
+
+void KLMeshLods::_start(KModelHandle model)
+{
+    std::unique_ptr<KPendingModel> pending = std::make_unique<KPendingModel>();
+    pending->model = model;
+
+    // NOTE: Relies on the model's meshes keeping their index list and vertex array around after
+    // upload
+    for (const auto& mesh : model->meshes)
+    {
+        KSimplifyJob job = {};
+        job.indices.assign(mesh.indices.begin(), mesh.indices.end());
+
+        std::uint32_t max_index = 0;
+        for (std::uint32_t index : job.indices)
+            max_index = std::max(max_index, index);
+
+        if (job.indices.size() < 3 ||
+            !read_positions(mesh.vertex_array, max_index + 1, job.positions))
+        {
+            // The model is still drawn, just always at full detail
+            KLDebug::log(
+                "MeshLods::_start() -> cannot read the positions of a mesh, skipping its LODs",
+                KEDebugType_Warning
+            );
+            job.indices.clear();
+        }
+
+        GLint index_buffer = 0;
+        glGetVertexArrayiv(mesh.vertex_array, GL_ELEMENT_ARRAY_BUFFER_BINDING, &index_buffer);
+        pending->vertex_arrays.push_back(mesh.vertex_array);
+        pending->source_index_buffers.push_back(static_cast<GLuint>(index_buffer));
+        pending->jobs.push_back(std::move(job));
+    }
+
+    if (m_workers == nullptr)
+        m_workers = std::make_unique<KWorkerPool>();
+
+    // One job per mesh, so a model with many meshes is simplified in parallel
+    pending->remaining.store(pending->jobs.size(), std::memory_order_release);
+    KPendingModel* pending_model = pending.get();
+    KMeshCookSettings settings = m_settings;
+    for (KSimplifyJob& job : pending->jobs)
+    {
+        m_workers->push(
+            [&job, pending_model, settings]()
+            {
+                if (!job.indices.empty())
+                    KMeshCooker::generate_lods(
+                        job.positions, job.indices, settings, job.levels, job.errors
+                    );
+                pending_model->remaining.fetch_sub(1, std::memory_order_acq_rel);
+            }
+        );
+    }
+
+    if (pending->jobs.empty())
+        _finish(*pending);
+    else
+        m_pending.push_back(std::move(pending));
+}
+
+void KLMeshLods::_finish(KPendingModel& pending)
+{
+    KModelLods lods = {};
+    lods.errors.push_back(0.0f);
+
+    for (std::size_t i = 0; i < pending.jobs.size(); i++)
+    {
+        KSimplifyJob& job = pending.jobs[i];
+
+        KMeshLodSet mesh = {};
+        mesh.vertex_array = pending.vertex_arrays[i];
+        mesh.source_index_buffer = pending.source_index_buffers[i];
+        mesh.levels.push_back({0, static_cast<std::uint32_t>(job.indices.size())});
+
+        // Errors come back relative to the mesh's largest extent
+        glm::vec3 bounds_min = glm::vec3(0.0f);
+        glm::vec3 bounds_max = glm::vec3(0.0f);
+        if (!job.positions.empty())
+        {
+            bounds_min = job.positions[0];
+            bounds_max = job.positions[0];
+        }
+        for (const glm::vec3& position : job.positions)
+        {
+            bounds_min = glm::min(bounds_min, position);
+            bounds_max = glm::max(bounds_max, position);
+        }
+        glm::vec3 extent = bounds_max - bounds_min;
+        float scale = std::max({extent.x, extent.y, extent.z});
+
+        for (std::size_t level = 0; level < job.levels.size(); level++)
+        {
+            const std::vector<std::uint32_t>& indices = job.levels[level];
+            KMeshLodLevel lod = {};
+            lod.index_count = static_cast<std::uint32_t>(indices.size());
+            glCreateBuffers(1, &lod.index_buffer);
+            glNamedBufferStorage(
+                lod.index_buffer, static_cast<GLsizeiptr>(indices.size() * sizeof(std::uint32_t)),
+                indices.data(), 0
+            );
+            mesh.levels.push_back(lod);
+
+            // A mesh with fewer levels draws its coarsest one, so it bounds the levels past it
+            if (lods.errors.size() <= level + 1)
+                lods.errors.push_back(0.0f);
+            lods.errors[level + 1] = std::max(lods.errors[level + 1], job.errors[level] * scale);
+        }
+
+        lods.meshes.push_back(std::move(mesh));
+    }
+
+    m_models[pending.model] = std::move(lods);
+    m_version++;
+}
+
+void KLMeshLods::_wait()
+{
+    // Jobs reference the pending models, they can't be dropped while they are still running
+    for (std::unique_ptr<KPendingModel>& pending : m_pending)
+    {
+        while (pending->remaining.load(std::memory_order_acquire) > 0)
+            std::this_thread::yield();
+    }
+}
+
+void KLMeshLods::_clear()
+{
+    _wait();
+    m_pending.clear();
+    m_requests.clear();
+    m_requested.clear();
+
+    for (auto& [model, lods] : m_models)
+    {
+        for (KMeshLodSet& mesh : lods.meshes)
+        {
+            for (KMeshLodLevel& level : mesh.levels)
+            {
+                if (level.index_buffer != 0)
+                    glDeleteBuffers(1, &level.index_buffer);
+            }
+        }
+    }
+    m_models.clear();
+    m_version++;
+}
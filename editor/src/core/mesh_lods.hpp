@@ -0,0 +1,119 @@
+#ifndef __KRYOS_EDITOR_CORE_MESH_LODS_HPP__
+#define __KRYOS_EDITOR_CORE_MESH_LODS_HPP__
+
+#include "core/mesh_cooker.hpp"
+#include "core/render_queue.hpp"
+#include "core/worker_pool.hpp"
+
+#include <kryos/core/application_layer.hpp>
+
+#include <glad/glad.h>
+
+#include <atomic>
+#include <glm/glm.hpp>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+struct KMeshLodLevel
+{
+    // Level 0 draws with the vertex array's own element buffer
+    GLuint index_buffer = 0;
+    std::uint32_t index_count = 0;
+};
+
+struct KMeshLodSet
+{
+    GLuint vertex_array = 0;
+    GLuint source_index_buffer = 0;
+    std::vector<KMeshLodLevel> levels = {};
+};
+
+struct KModelLods
+{
+    std::vector<KMeshLodSet> meshes = {};
+    // Worst simplification error of any mesh at each level, in model space units
+    std::vector<float> errors = {};
+};
+
+// Simplified index buffers for the models drawn by mesh renderers. Models are requested by the
+// scene renderer the first time they are visible, their vertex positions are read back from the
+// GPU and every mesh is simplified on a worker pool with the same settings as the mesh cooker.
+// Everything is dropped and regenerated lazily when assets are reloaded
+class KLMeshLods : public KIApplicationLayer
+{
+  public:
+    inline static KLMeshLods* get() { return m_Instance; }
+    // Reads the first vertex_count positions of attribute 0 back from the vertex array's buffer,
+    // fails unless they are three or more floats
+    static bool read_positions(
+        GLuint vertex_array, std::size_t vertex_count, std::vector<glm::vec3>& positions
+    );
+
+  public:
+    KLMeshLods();
+    virtual ~KLMeshLods() override;
+
+    inline bool get_enabled() const { return m_enabled; }
+    // Largest simplification error allowed on screen, in pixels
+    inline float get_pixel_error() const { return m_pixel_error; }
+    inline std::size_t get_model_count() const { return m_models.size(); }
+    inline std::size_t get_pending_count() const { return m_pending.size(); }
+    // Bumped whenever the level a model would be drawn at can change, so cached frames know to
+    // render again
+    inline std::uint64_t get_version() const { return m_version; }
+
+    void set_enabled(bool enabled);
+    void set_pixel_error(float pixel_error);
+
+    // Returns nullptr until the model's LODs have been generated
+    const KModelLods* find(KModelHandle model) const;
+    void request(KModelHandle model);
+    // pixels_per_unit is how many pixels one model space unit covers on screen, returns the
+    // coarsest level whose error stays under the pixel error
+    std::uint32_t select(const KModelLods& lods, float pixels_per_unit) const;
+
+    virtual void on_update() override;
+
+  private:
+    struct KSimplifyJob
+    {
+        std::vector<glm::vec3> positions = {};
+        std::vector<std::uint32_t> indices = {};
+        std::vector<std::vector<std::uint32_t>> levels = {};
+        std::vector<float> errors = {};
+    };
+
+    struct KPendingModel
+    {
+        KModelHandle model = {};
+        std::vector<GLuint> vertex_arrays = {};
+        std::vector<GLuint> source_index_buffers = {};
+        std::vector<KSimplifyJob> jobs = {};
+        std::atomic<std::size_t> remaining = 0;
+    };
+
+    static KLMeshLods* m_Instance;
+
+  private:
+    void _start(KModelHandle model);
+    void _finish(KPendingModel& pending);
+    void _wait();
+    void _clear();
+
+  private:
+    bool m_enabled = true;
+    float m_pixel_error = 1.0f;
+    KMeshCookSettings m_settings = {};
+
+    std::unique_ptr<KWorkerPool> m_workers = nullptr;
+    std::vector<KModelHandle> m_requests = {};
+    std::unordered_set<KModelHandle> m_requested = {};
+    std::vector<std::unique_ptr<KPendingModel>> m_pending = {};
+    std::unordered_map<KModelHandle, KModelLods> m_models = {};
+    std::uint64_t m_asset_version = 0;
+    std::uint64_t m_version = 0;
+};
+
+#endif
@@ -0,0 +1,380 @@
+#include "core/mesh_simplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+// Symmetric 4x4 matrix of the squared distance to a set of planes, weighted by triangle area
+struct KQuadric
+{
+    float a00 = 0.0f, a01 = 0.0f, a02 = 0.0f, a11 = 0.0f, a12 = 0.0f, a22 = 0.0f;
+    float b0 = 0.0f, b1 = 0.0f, b2 = 0.0f;
+    float c = 0.0f;
+    float weight = 0.0f;
+
+    static KQuadric from_plane(const glm::vec3& normal, float distance, float weight)
+    {
+        KQuadric quadric = {};
+        quadric.a00 = normal.x * normal.x * weight;
+        quadric.a01 = normal.x * normal.y * weight;
+        quadric.a02 = normal.x * normal.z * weight;
+        quadric.a11 = normal.y * normal.y * weight;
+        quadric.a12 = normal.y * normal.z * weight;
+        quadric.a22 = normal.z * normal.z * weight;
+        quadric.b0 = normal.x * distance * weight;
+        quadric.b1 = normal.y * distance * weight;
+        quadric.b2 = normal.z * distance * weight;
+        quadric.c = distance * distance * weight;
+        quadric.weight = weight;
+        return quadric;
+    }
+
+    inline void add(const KQuadric& other)
+    {
+        a00 += other.a00;
+        a01 += other.a01;
+        a02 += other.a02;
+        a11 += other.a11;
+        a12 += other.a12;
+        a22 += other.a22;
+        b0 += other.b0;
+        b1 += other.b1;
+        b2 += other.b2;
+        c += other.c;
+        weight += other.weight;
+    }
+
+    // Area weighted average of the squared distances
+    inline float evaluate(const glm::vec3& p) const
+    {
+        float rx = a00 * p.x + a01 * p.y + a02 * p.z + b0;
+        float ry = a01 * p.x + a11 * p.y + a12 * p.z + b1;
+        float rz = a02 * p.x + a12 * p.y + a22 * p.z + b2;
+        float error = rx * p.x + ry * p.y + rz * p.z + b0 * p.x + b1 * p.y + b2 * p.z + c;
+        return weight > 0.0f ? std::fabs(error) / weight : 0.0f;
+    }
+};
+
+struct KCollapse
+{
+    std::uint32_t from = 0;
+    std::uint32_t to = 0;
+    float error = 0.0f;
+};
+
+struct KPositionHash
+{
+    inline std::size_t operator()(const glm::vec3& position) const
+    {
+        std::uint32_t bits[3] = {};
+        std::memcpy(bits, &position, sizeof(bits));
+        return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+    }
+};
+
+struct KPositionEqual
+{
+    inline bool operator()(const glm::vec3& lhs, const glm::vec3& rhs) const
+    {
+        return std::memcmp(&lhs, &rhs, sizeof(glm::vec3)) == 0;
+    }
+};
+
+// Triangles around every vertex, packed with offsets
+static void build_adjacency(
+    const std::vector<std::uint32_t>& indices, std::size_t index_count,
+    const std::vector<std::uint32_t>& canonical, std::vector<std::uint32_t>& offsets,
+    std::vector<std::uint32_t>& triangles
+)
+{
+    std::fill(offsets.begin(), offsets.end(), 0);
+    for (std::size_t i = 0; i < index_count; i++)
+        offsets[canonical[indices[i]] + 1]++;
+    for (std::size_t i = 0; i + 1 < offsets.size(); i++)
+        offsets[i + 1] += offsets[i];
+
+    triangles.resize(index_count);
+    std::vector<std::uint32_t> fill = std::vector<std::uint32_t>(offsets.begin(), offsets.end());
+    for (std::size_t i = 0; i < index_count; i++)
+        triangles[fill[canonical[indices[i]]]++] = static_cast<std::uint32_t>(i / 3);
+}
+
+// Least significant digit radix sort on the error's bits, which order like unsigned integers
+// since errors are never negative
+static void sort_collapses(std::vector<KCollapse>& collapses, std::vector<KCollapse>& scratch)
+{
+    scratch.resize(collapses.size());
+    for (std::uint32_t shift = 0; shift < 32; shift += 11)
+    {
+        std::uint32_t histogram[2048] = {};
+        for (const KCollapse& collapse : collapses)
+        {
+            std::uint32_t bits = 0;
+            std::memcpy(&bits, &collapse.error, sizeof(bits));
+            histogram[(bits >> shift) & 2047]++;
+        }
+
+        std::uint32_t sum = 0;
+        for (std::uint32_t& count : histogram)
+        {
+            std::uint32_t next = sum + count;
+            count = sum;
+            sum = next;
+        }
+
+        for (const KCollapse& collapse : collapses)
+        {
+            std::uint32_t bits = 0;
+            std::memcpy(&bits, &collapse.error, sizeof(bits));
+            scratch[histogram[(bits >> shift) & 2047]++] = collapse;
+        }
+        collapses.swap(scratch);
+    }
+}
+
+static bool flips(
+    const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, const glm::vec3& moved_a
+)
+{
+    glm::vec3 before = glm::cross(b - a, c - a);
+    glm::vec3 after = glm::cross(b - moved_a, c - moved_a);
+    // Also rejects collapses leaving a sliver, they would be next to collapse and flip anyway
+    return glm::dot(before, after) <= 0.25f * glm::length(before) * glm::length(after);
+}
+
+std::vector<std::uint32_t> KMeshSimplifier::simplify(
+    const std::vector<glm::vec3>& positions, const std::vector<std::uint32_t>& indices,
+    std::size_t target_index_count, float target_error, float* result_error
+)
+{
+    std::size_t vertex_count = positions.size();
+    std::vector<std::uint32_t> result = indices;
+    if (result_error != nullptr)
+        *result_error = 0.0f;
+    if (vertex_count == 0 || indices.size() <= target_index_count)
+        return result;
+
+    // Working in a unit box makes errors relative and keeps the quadrics well conditioned
+    glm::vec3 bounds_min = positions[0];
+    glm::vec3 bounds_max = positions[0];
+    for (const glm::vec3& position : positions)
+    {
+        bounds_min = glm::min(bounds_min, position);
+        bounds_max = glm::max(bounds_max, position);
+    }
+    glm::vec3 extent = bounds_max - bounds_min;
+    float scale = std::max({extent.x, extent.y, extent.z});
+    float inverse_scale = scale > 0.0f ? 1.0f / scale : 0.0f;
+
+    std::vector<glm::vec3> points = std::vector<glm::vec3>(vertex_count);
+    for (std::size_t i = 0; i < vertex_count; i++)
+        points[i] = (positions[i] - bounds_min) * inverse_scale;
+
+    // Vertices sharing a position are one vertex topologically, the first one stands for all
+    std::vector<std::uint32_t> canonical = std::vector<std::uint32_t>(vertex_count);
+    std::vector<std::uint32_t> wedge_count = std::vector<std::uint32_t>(vertex_count, 0);
+    {
+        std::unordered_map<glm::vec3, std::uint32_t, KPositionHash, KPositionEqual> first = {};
+        first.reserve(vertex_count);
+        for (std::uint32_t i = 0; i < vertex_count; i++)
+        {
+            canonical[i] = first.emplace(positions[i], i).first->second;
+            wedge_count[canonical[i]]++;
+        }
+    }
+
+    std::vector<std::uint32_t> triangle_offsets = std::vector<std::uint32_t>(vertex_count + 1);
+    std::vector<std::uint32_t> vertex_triangles = {};
+    build_adjacency(indices, indices.size(), canonical, triangle_offsets, vertex_triangles);
+
+    // Edges used by a single triangle are open borders
+    std::vector<bool> locked = std::vector<bool>(vertex_count, false);
+    for (std::size_t i = 0; i < indices.size(); i += 3)
+    {
+        for (std::size_t corner = 0; corner < 3; corner++)
+        {
+            std::uint32_t a = canonical[indices[i + corner]];
+            std::uint32_t b = canonical[indices[i + (corner + 1) % 3]];
+
+            std::size_t uses = 0;
+            for (std::uint32_t t = triangle_offsets[a]; t < triangle_offsets[a + 1]; t++)
+            {
+                std::uint32_t triangle = vertex_triangles[t];
+                uses += canonical[indices[triangle * 3]] == b ||
+                        canonical[indices[triangle * 3 + 1]] == b ||
+                        canonical[indices[triangle * 3 + 2]] == b;
+            }
+
+            if (uses == 1)
+            {
+                locked[a] = true;
+                locked[b] = true;
+            }
+        }
+    }
+
+    std::vector<KQuadric> quadrics = std::vector<KQuadric>(vertex_count);
+    for (std::size_t i = 0; i < indices.size(); i += 3)
+    {
+        std::uint32_t a = canonical[indices[i]];
+        std::uint32_t b = canonical[indices[i + 1]];
+        std::uint32_t c = canonical[indices[i + 2]];
+        glm::vec3 normal = glm::cross(points[b] - points[a], points[c] - points[a]);
+        float area = glm::length(normal);
+        if (area <= 0.0f)
+            continue;
+
+        normal /= area;
+        KQuadric quadric = KQuadric::from_plane(normal, -glm::dot(normal, points[a]), area);
+        quadrics[a].add(quadric);
+        quadrics[b].add(quadric);
+        quadrics[c].add(quadric);
+    }
+
+    float max_error = target_error * target_error;
+    float reached_error = 0.0f;
+
+    std::vector<KCollapse> collapses = {};
+    std::vector<KCollapse> scratch = {};
+    std::vector<std::uint32_t> collapse_to = std::vector<std::uint32_t>(vertex_count);
+    std::vector<bool> touched = std::vector<bool>(vertex_count);
+
+    std::size_t index_count = result.size();
+    while (index_count > target_index_count)
+    {
+        // Candidates for this pass, both directions of an edge are considered. Interior edges
+        // show up in two triangles and open ones can't collapse, so each edge is taken once
+        collapses.clear();
+        for (std::size_t i = 0; i < index_count; i += 3)
+        {
+            for (std::size_t corner = 0; corner < 3; corner++)
+            {
+                std::uint32_t a = canonical[result[i + corner]];
+                std::uint32_t b = canonical[result[i + (corner + 1) % 3]];
+                if (a > b)
+                    continue;
+
+                for (int direction = 0; direction < 2; direction++)
+                {
+                    std::uint32_t from = direction == 0 ? a : b;
+                    std::uint32_t to = direction == 0 ? b : a;
+                    // Seam vertices can't be a target either, the triangles around `from`
+                    // wouldn't know which of the wedges to use
+                    if (locked[from] || wedge_count[from] > 1 || wedge_count[to] > 1)
+                        continue;
+
+                    KQuadric quadric = quadrics[from];
+                    quadric.add(quadrics[to]);
+                    collapses.push_back({from, to, quadric.evaluate(points[to])});
+                }
+            }
+        }
+
+        if (collapses.empty())
+            break;
+
+        sort_collapses(collapses, scratch);
+        build_adjacency(result, index_count, canonical, triangle_offsets, vertex_triangles);
+
+        for (std::size_t i = 0; i < vertex_count; i++)
+            collapse_to[i] = static_cast<std::uint32_t>(i);
+        std::fill(touched.begin(), touched.end(), false);
+
+        std::size_t triangle_count = index_count / 3;
+        std::size_t target_triangle_count = target_index_count / 3;
+        bool limited = false;
+        for (const KCollapse& collapse : collapses)
+        {
+            if (triangle_count <= target_triangle_count)
+                break;
+            if (collapse.error > max_error)
+            {
+                limited = true;
+                break;
+            }
+            if (touched[collapse.from] || touched[collapse.to])
+                continue;
+
+            // Triangle lists are from the start of the pass, corners are resolved through this
+            // pass's collapses so the flip test sees the current mesh
+            bool valid = true;
+            std::size_t removed = 0;
+            for (std::uint32_t t = triangle_offsets[collapse.from];
+                 valid && t < triangle_offsets[collapse.from + 1]; t++)
+            {
+                std::uint32_t triangle = vertex_triangles[t];
+                std::uint32_t corners[3] = {
+                    collapse_to[canonical[result[triangle * 3]]],
+                    collapse_to[canonical[result[triangle * 3 + 1]]],
+                    collapse_to[canonical[result[triangle * 3 + 2]]]
+                };
+
+                // Already removed by an earlier collapse
+                if (corners[0] == corners[1] || corners[1] == corners[2] ||
+                    corners[2] == corners[0])
+                    continue;
+
+                if (corners[0] == collapse.to || corners[1] == collapse.to ||
+                    corners[2] == collapse.to)
+                {
+                    removed++;
+                    continue;
+                }
+
+                for (std::size_t corner = 0; corner < 3; corner++)
+                {
+                    if (corners[corner] != collapse.from)
+                        continue;
+                    valid = !flips(
+                        points[corners[corner]], points[corners[(corner + 1) % 3]],
+                        points[corners[(corner + 2) % 3]], points[collapse.to]
+                    );
+                }
+            }
+
+            if (!valid)
+                continue;
+
+            // Keeps collapses from chaining within a pass
+            touched[collapse.from] = true;
+            touched[collapse.to] = true;
+            collapse_to[collapse.from] = collapse.to;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            reached_error = std::max(reached_error, collapse.error);
+            triangle_count -= removed;
+        }
+
+        // Neither vertex of a collapse has multiple wedges, so the canonical vertex is the vertex
+        std::size_t write = 0;
+        for (std::size_t i = 0; i < index_count; i += 3)
+        {
+            std::uint32_t a = collapse_to[canonical[result[i]]] == canonical[result[i]]
+                                  ? result[i]
+                                  : collapse_to[canonical[result[i]]];
+            std::uint32_t b = collapse_to[canonical[result[i + 1]]] == canonical[result[i + 1]]
+                                  ? result[i + 1]
+                                  : collapse_to[canonical[result[i + 1]]];
+            std::uint32_t c = collapse_to[canonical[result[i + 2]]] == canonical[result[i + 2]]
+                                  ? result[i + 2]
+                                  : collapse_to[canonical[result[i + 2]]];
+            if (canonical[a] == canonical[b] || canonical[b] == canonical[c] ||
+                canonical[c] == canonical[a])
+                continue;
+
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+
+        bool progressed = write < index_count;
+        index_count = write;
+        if (!progressed || limited)
+            break;
+    }
+
+    result.resize(index_count);
+    if (result_error != nullptr)
+        *result_error = std::sqrt(reached_error);
+    return result;
+}
@@ -0,0 +1,23 @@
+#ifndef __KRYOS_EDITOR_CORE_MESH_SIMPLIFIER_HPP__
+#define __KRYOS_EDITOR_CORE_MESH_SIMPLIFIER_HPP__
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Quadric error metric simplification (Garland and Heckbert). Edges are collapsed onto one of
+// their existing vertices in order of increasing error, so the simplified index list still
+// refers to the original vertices and every LOD can share one vertex buffer. Vertices on open
+// borders and attribute seams (several vertices at the same position) are never moved
+struct KMeshSimplifier
+{
+    // Collapses edges until the index count reaches target_index_count or the next collapse
+    // would exceed target_error. Errors are relative to the mesh's largest extent, the error
+    // actually reached is written to result_error
+    static std::vector<std::uint32_t> simplify(
+        const std::vector<glm::vec3>& positions, const std::vector<std::uint32_t>& indices,
+        std::size_t target_index_count, float target_error, float* result_error = nullptr
+    );
+};
+
+#endif
@@ -0,0 +1,202 @@
+#include "core/obj_loader.hpp"
+#include "core/mapped_file.hpp"
+
+#include <charconv>
+#include <unordered_map>
+
+struct ObjVertexKey
+{
+    std::int64_t position = 0;
+    std::int64_t uv = 0;
+    std::int64_t normal = 0;
+
+    inline bool operator==(const ObjVertexKey& other) const
+    {
+        return position == other.position && uv == other.uv && normal == other.normal;
+    }
+};
+
+struct ObjVertexKeyHash
+{
+    inline std::size_t operator()(const ObjVertexKey& key) const
+    {
+        std::size_t hash = static_cast<std::size_t>(key.position) * 73856093u;
+        hash ^= static_cast<std::size_t>(key.uv) * 19349663u;
+        hash ^= static_cast<std::size_t>(key.normal) * 83492791u;
+        return hash;
+    }
+};
+
+static const char* skip_spaces(const char* it, const char* end)
+{
+    while (it < end && (*it == ' ' || *it == '\t'))
+        it++;
+    return it;
+}
+
+static const char* parse_float(const char* it, const char* end, float& value)
+{
+    it = skip_spaces(it, end);
+    // from_chars doesn't accept a leading '+'
+    if (it < end && *it == '+')
+        it++;
+
+    std::from_chars_result result = std::from_chars(it, end, value);
+    return result.ec == std::errc() ? result.ptr : nullptr;
+}
+
+static const char* parse_index(const char* it, const char* end, std::int64_t& value)
+{
+    std::from_chars_result result = std::from_chars(it, end, value);
+    return result.ec == std::errc() ? result.ptr : it;
+}
+
+// OBJ indices are 1 based and negative ones count back from the end, 0 means missing
+static std::int64_t resolve_index(std::int64_t index, std::size_t count)
+{
+    if (index > 0)
+        return index - 1 < static_cast<std::int64_t>(count) ? index - 1 : -1;
+    if (index < 0)
+        return static_cast<std::int64_t>(count) + index >= 0
+                   ? static_cast<std::int64_t>(count) + index
+                   : -1;
+    return -1;
+}
+
+bool ObjLoader::load(const std::string& filename, KSourceMesh& mesh)
+{
+    KMappedFile file = {};
+    if (!file.open(filename, 0, "ObjLoader::load()"))
+        return false;
+
+    return parse(reinterpret_cast<const char*>(file.get_data()), file.get_size(), mesh);
+}
+
+bool ObjLoader::parse(const char* data, std::size_t size, KSourceMesh& mesh)
+{
+    std::vector<glm::vec3> positions = {};
+    std::vector<glm::vec3> normals = {};
+    std::vector<glm::vec2> uvs = {};
+    std::unordered_map<ObjVertexKey, std::uint32_t, ObjVertexKeyHash> vertices = {};
+    std::vector<std::uint32_t> polygon = {};
+    bool has_normals = false;
+
+    mesh = KSourceMesh{};
+
+    const char* it = data;
+    const char* end = data + size;
+    while (it < end)
+    {
+        const char* line_end = it;
+        while (line_end < end && *line_end != '\n')
+            line_end++;
+
+        const char* cursor = skip_spaces(it, line_end);
+        if (line_end - cursor > 2 && cursor[0] == 'v' && cursor[1] == ' ')
+        {
+            glm::vec3 position = {};
+            cursor = parse_float(cursor + 2, line_end, position.x);
+            cursor = cursor ? parse_float(cursor, line_end, position.y) : nullptr;
+            cursor = cursor ? parse_float(cursor, line_end, position.z) : nullptr;
+            if (cursor == nullptr)
+                return false;
+            positions.push_back(position);
+        }
+        else if (line_end - cursor > 3 && cursor[0] == 'v' && cursor[1] == 'n')
+        {
+            glm::vec3 normal = {};
+            cursor = parse_float(cursor + 2, line_end, normal.x);
+            cursor = cursor ? parse_float(cursor, line_end, normal.y) : nullptr;
+            cursor = cursor ? parse_float(cursor, line_end, normal.z) : nullptr;
+            if (cursor == nullptr)
+                return false;
+            normals.push_back(normal);
+        }
+        else if (line_end - cursor > 3 && cursor[0] == 'v' && cursor[1] == 't')
+        {
+            glm::vec2 uv = {};
+            cursor = parse_float(cursor + 2, line_end, uv.x);
+            cursor = cursor ? parse_float(cursor, line_end, uv.y) : nullptr;
+            if (cursor == nullptr)
+                return false;
+            uvs.push_back(uv);
+        }
+        else if (line_end - cursor > 2 && cursor[0] == 'f' && cursor[1] == ' ')
+        {
+            polygon.clear();
+            cursor += 2;
+            while (true)
+            {
+                cursor = skip_spaces(cursor, line_end);
+                if (cursor >= line_end || *cursor == '\r' || *cursor == '#')
+                    break;
+
+                // v, v/vt, v//vn or v/vt/vn
+                std::int64_t indices[3] = {};
+                for (int i = 0; i < 3; i++)
+                {
+                    cursor = parse_index(cursor, line_end, indices[i]);
+                    if (cursor >= line_end || *cursor != '/')
+                        break;
+                    cursor++;
+                }
+
+                ObjVertexKey key = {};
+                key.position = resolve_index(indices[0], positions.size());
+                key.uv = resolve_index(indices[1], uvs.size());
+                key.normal = resolve_index(indices[2], normals.size());
+                if (key.position < 0)
+                    return false;
+
+                auto [vertex, inserted] =
+                    vertices.emplace(key, static_cast<std::uint32_t>(mesh.positions.size()));
+                if (inserted)
+                {
+                    mesh.positions.push_back(positions[key.position]);
+                    mesh.uvs.push_back(key.uv >= 0 ? uvs[key.uv] : glm::vec2(0.0f));
+                    mesh.normals.push_back(key.normal >= 0 ? normals[key.normal] : glm::vec3(0.0f));
+                    has_normals |= key.normal >= 0;
+                }
+                polygon.push_back(vertex->second);
+
+                // Skip anything left of a malformed vertex so the loop always advances
+                while (cursor < line_end && *cursor != ' ' && *cursor != '\t' && *cursor != '\r')
+                    cursor++;
+            }
+
+            for (std::size_t i = 2; i < polygon.size(); i++)
+            {
+                mesh.indices.push_back(polygon[0]);
+                mesh.indices.push_back(polygon[i - 1]);
+                mesh.indices.push_back(polygon[i]);
+            }
+        }
+
+        it = line_end + 1;
+    }
+
+    if (!has_normals)
+    {
+        // Area weighted, the cross product's length is twice the triangle's area
+        for (std::size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+        {
+            std::uint32_t a = mesh.indices[i];
+            std::uint32_t b = mesh.indices[i + 1];
+            std::uint32_t c = mesh.indices[i + 2];
+            glm::vec3 normal = glm::cross(
+                mesh.positions[b] - mesh.positions[a], mesh.positions[c] - mesh.positions[a]
+            );
+            mesh.normals[a] += normal;
+            mesh.normals[b] += normal;
+            mesh.normals[c] += normal;
+        }
+
+        for (glm::vec3& normal : mesh.normals)
+        {
+            float length = glm::length(normal);
+            normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+    }
+
+    return !mesh.indices.empty();
+}
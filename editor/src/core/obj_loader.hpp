@@ -0,0 +1,32 @@
+#ifndef __KRYOS_EDITOR_CORE_OBJ_LOADER_HPP__
+#define __KRYOS_EDITOR_CORE_OBJ_LOADER_HPP__
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+// Unpacked indexed triangle mesh, what source models are turned into before cooking
+struct KSourceMesh
+{
+    std::vector<glm::vec3> positions = {};
+    std::vector<glm::vec3> normals = {};
+    std::vector<glm::vec2> uvs = {};
+    std::vector<std::uint32_t> indices = {};
+
+    inline std::size_t get_memory_size() const
+    {
+        return positions.size() * sizeof(glm::vec3) + normals.size() * sizeof(glm::vec3) +
+               uvs.size() * sizeof(glm::vec2) + indices.size() * sizeof(std::uint32_t);
+    }
+};
+
+// Wavefront OBJ reader. Every object and group is merged into one mesh, polygons are fan
+// triangulated and normals are generated when the file has none
+struct ObjLoader
+{
+    static bool load(const std::string& filename, KSourceMesh& mesh);
+    static bool parse(const char* data, std::size_t size, KSourceMesh& mesh);
+};
+
+#endif
@@ -0,0 +1,240 @@
+#include "core/pack.hpp"
+#include "core/mapped_file.hpp"
+#include "core/pak_archive.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static double milliseconds_since(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Drops the file's pages from the page cache so the next read has to go to the disk. Only clean
+// pages that nothing maps are dropped, which is every file here between passes
+static bool evict_from_page_cache(const std::string& filename)
+{
+#if defined(__linux__)
+    int file = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0)
+        return false;
+    bool evicted = posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    ::close(file);
+    return evicted;
+#else
+    (void)filename;
+    return false;
+#endif
+}
+
+// Reads a byte of every page so the whole file is faulted in, not just mapped
+static std::uint32_t touch_pages(const std::uint8_t* data, std::size_t size)
+{
+    std::uint32_t sum = 0;
+    for (std::size_t offset = 0; offset < size; offset += 4096)
+        sum += data[offset];
+    return sum;
+}
+
+// Every packed file has to read back byte for byte as the loose file it came from, returns how
+// many don't
+static std::size_t verify(
+    const std::filesystem::path& input, const std::vector<std::string>& paths,
+    const std::string& archive_filename
+)
+{
+    KPakArchive archive = {};
+    if (!archive.open(archive_filename))
+    {
+        std::fprintf(stderr, "failed to open '%s'\n", archive_filename.c_str());
+        return paths.size();
+    }
+
+    std::size_t mismatch_count = 0;
+    std::vector<std::uint8_t> data = {};
+    for (const std::string& path : paths)
+    {
+        const KPakEntry* entry = archive.find(path);
+        bool match = false;
+        if (entry != nullptr)
+        {
+            const std::uint8_t* packed = nullptr;
+            std::size_t size = 0;
+            bool unpacked = true;
+            if (entry->compression == KEPakCompression_None)
+            {
+                packed = archive.get_stored_data(*entry);
+                size = entry->size;
+            }
+            else
+            {
+                unpacked = archive.read(*entry, data);
+                packed = data.data();
+                size = data.size();
+            }
+
+            // Empty files can't be mapped, they match when the entry is empty too
+            std::error_code error = {};
+            KMappedFile file = {};
+            if (unpacked && size == 0)
+                match = std::filesystem::file_size(input / path, error) == 0 && !error;
+            else if (unpacked && file.open((input / path).string(), 0, "Pack::verify()"))
+                match = file.get_size() == size && std::memcmp(file.get_data(), packed, size) == 0;
+        }
+
+        if (!match)
+        {
+            std::fprintf(stderr, "'%s' doesn't round trip through the archive\n", path.c_str());
+            mismatch_count++;
+        }
+    }
+
+    std::printf(
+        "round trip: %zu of %zu files match\n", paths.size() - mismatch_count, paths.size()
+    );
+    return mismatch_count;
+}
+
+static void benchmark(
+    const std::filesystem::path& input, const std::vector<std::string>& paths,
+    const std::string& archive_filename, int iterations
+)
+{
+    double loose_time[2] = {};
+    double packed_time[2] = {};
+    std::uint32_t checksum = 0;
+    bool evicted = true;
+
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        // Cold passes first, the warm ones then find everything already cached
+        for (int warm = 0; warm < 2; warm++)
+        {
+            if (warm == 0)
+            {
+                for (const std::string& path : paths)
+                    evicted &= evict_from_page_cache((input / path).string());
+            }
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (const std::string& path : paths)
+            {
+                KMappedFile file = {};
+                if (file.open((input / path).string(), 1, "Pack::benchmark()"))
+                    checksum += touch_pages(file.get_data(), file.get_size());
+            }
+            loose_time[warm] += milliseconds_since(start);
+
+            if (warm == 0)
+                evicted &= evict_from_page_cache(archive_filename);
+
+            start = std::chrono::steady_clock::now();
+            KPakArchive archive = {};
+            std::vector<std::uint8_t> data = {};
+            if (archive.open(archive_filename))
+            {
+                for (const std::string& path : paths)
+                {
+                    const KPakEntry* entry = archive.find(path);
+                    if (entry == nullptr)
+                        continue;
+
+                    if (entry->compression == KEPakCompression_None)
+                        checksum += touch_pages(archive.get_stored_data(*entry), entry->size);
+                    else if (archive.read(*entry, data))
+                        checksum += touch_pages(data.data(), data.size());
+                }
+            }
+            packed_time[warm] += milliseconds_since(start);
+        }
+    }
+
+    double count = static_cast<double>(std::max(iterations, 1));
+    std::printf(
+        "benchmark (%i iterations, %zu files, checksum %u%s):\n"
+        "  cold: loose %.3fms, packed %.3fms per pass, %.1fx faster\n"
+        "  warm: loose %.3fms, packed %.3fms per pass, %.1fx faster\n",
+        iterations, paths.size(), checksum, evicted ? "" : ", page cache not dropped",
+        loose_time[0] / count, packed_time[0] / count,
+        packed_time[0] > 0.0 ? loose_time[0] / packed_time[0] : 0.0, loose_time[1] / count,
+        packed_time[1] / count, packed_time[1] > 0.0 ? loose_time[1] / packed_time[1] : 0.0
+    );
+}
+
+int KPackCommand::run(const KCommandLine& command_line)
+{
+    std::string input_directory = command_line.get("input");
+    if (input_directory.empty() || !std::filesystem::is_directory(input_directory))
+    {
+        std::fprintf(
+            stderr, "usage: Kryos pack --input <project directory> [--output <file.kpak>] "
+                    "[--compress] [--benchmark] [--iterations <count>]\n"
+        );
+        return 1;
+    }
+
+    std::filesystem::path input = std::filesystem::path(input_directory).lexically_normal();
+    if (input.filename().empty())
+        input = input.parent_path();
+    std::string output =
+        command_line.get("output", (input / (input.filename().string() + ".kpak")).string());
+
+    std::vector<std::string> paths = {};
+    std::error_code error = {};
+    for (auto it = std::filesystem::recursive_directory_iterator(input, error);
+         it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+    {
+        if (error)
+            break;
+
+        // Cooked assets are what the runtime loads, the derived data cache can be rebuilt and
+        // anything else hidden isn't part of the project
+        std::filesystem::path relative = it->path().lexically_relative(input);
+        std::string name = it->path().filename().string();
+        bool kryos_directory = relative == ".kryos";
+        if ((name.starts_with(".") && !kryos_directory) || relative == ".kryos/derived_data")
+        {
+            if (it->is_directory())
+                it.disable_recursion_pending();
+            continue;
+        }
+
+        std::string extension = it->path().extension().string();
+        if (!it->is_regular_file() || extension == ".kpak" || extension == ".tmp")
+            continue;
+
+        paths.push_back(relative.generic_string());
+    }
+
+    KPakWriteStats stats = {};
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (!KPakWriter::write(output, input.string(), paths, command_line.has("compress"), &stats))
+    {
+        std::fprintf(stderr, "failed to write '%s'\n", output.c_str());
+        return 1;
+    }
+
+    std::printf(
+        "packed %zu files (%zu compressed) into %s, %.2f -> %.2fMiB in %.3fms\n",
+        stats.entry_count, stats.compressed_count, output.c_str(),
+        static_cast<double>(stats.size) / (1024.0 * 1024.0),
+        static_cast<double>(stats.archive_size) / (1024.0 * 1024.0), milliseconds_since(start)
+    );
+
+    if (!command_line.has("benchmark"))
+        return 0;
+
+    std::size_t mismatch_count = verify(input, paths, output);
+    benchmark(input, paths, output, std::max(command_line.get_int("iterations", 5), 1));
+    return mismatch_count == 0 ? 0 : 1;
+}
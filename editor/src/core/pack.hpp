@@ -0,0 +1,16 @@
+#ifndef __KRYOS_EDITOR_CORE_PACK_HPP__
+#define __KRYOS_EDITOR_CORE_PACK_HPP__
+
+#include "core/command_line.hpp"
+
+#include <string>
+
+// `Kryos pack` packs a project directory into one archive: the project file, scenes, sources and
+// cooked assets, without the derived data cache. With --benchmark it then compares opening every
+// file loose against opening them from the archive, both with a cold page cache and a warm one
+struct KPackCommand
+{
+    static int run(const KCommandLine& command_line);
+};
+
+#endif
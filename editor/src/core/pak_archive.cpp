@@ -0,0 +1,220 @@
+#include "core/pak_archive.hpp"
+#include "core/lz_compression.hpp"
+
+#include <kryos/core/debug.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+static std::uint64_t align_offset(std::uint64_t offset)
+{
+    return (offset + pak_file_alignment - 1) / pak_file_alignment * pak_file_alignment;
+}
+
+bool KPakArchive::open(const std::string& filename)
+{
+    if (!m_file.open(filename, sizeof(KPakFileHeader), "PakArchive::open()"))
+        return false;
+
+    if (!_validate(filename))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void KPakArchive::close() { m_file.close(); }
+
+const KPakEntry* KPakArchive::find(std::string_view path) const
+{
+    std::uint32_t first = 0;
+    std::uint32_t count = get_entry_count();
+    while (count > 0)
+    {
+        std::uint32_t half = count / 2;
+        const KPakEntry& entry = get_entry(first + half);
+        int compare = get_path(entry).compare(path);
+        if (compare == 0)
+            return &entry;
+
+        if (compare < 0)
+        {
+            first += half + 1;
+            count -= half + 1;
+        }
+        else
+            count = half;
+    }
+    return nullptr;
+}
+
+bool KPakArchive::read(const KPakEntry& entry, std::vector<std::uint8_t>& data) const
+{
+    data.resize(entry.size);
+    if (entry.compression == KEPakCompression_None)
+    {
+        if (entry.size > 0)
+            std::memcpy(data.data(), get_stored_data(entry), entry.size);
+        return true;
+    }
+
+    return KLzCompression::decompress(
+        get_stored_data(entry), entry.stored_size, data.data(), data.size()
+    );
+}
+
+bool KPakArchive::_validate(const std::string& filename) const
+{
+    const KPakFileHeader& header = get_header();
+    if (header.magic != pak_file_magic || header.version != pak_file_version)
+    {
+        KLDebug::log(
+            "PakArchive::open() -> " + filename + " is not a version " +
+                std::to_string(pak_file_version) + " pak archive",
+            KEDebugType_Error
+        );
+        return false;
+    }
+
+    // Checked once here so lookups never have to
+    std::uint64_t size = m_file.get_size();
+    std::uint64_t entries_end =
+        header.entry_offset + static_cast<std::uint64_t>(header.entry_count) * sizeof(KPakEntry);
+    bool valid = header.entry_offset % pak_file_alignment == 0 && entries_end <= size &&
+                 header.path_offset + header.path_size <= size;
+    for (std::uint32_t i = 0; valid && i < header.entry_count; i++)
+    {
+        const KPakEntry& entry = get_entry(i);
+        std::uint64_t path_end = static_cast<std::uint64_t>(entry.path_offset) + entry.path_length;
+        valid = entry.offset % pak_file_alignment == 0 &&
+                entry.offset + entry.stored_size <= size && path_end <= header.path_size &&
+                (entry.compression == KEPakCompression_Lz ||
+                 (entry.compression == KEPakCompression_None && entry.stored_size == entry.size));
+        // Sorted paths are what makes the binary search valid
+        if (valid && i > 0)
+            valid = get_path(get_entry(i - 1)) < get_path(entry);
+    }
+
+    if (!valid)
+        KLDebug::log("PakArchive::open() -> " + filename + " is corrupted", KEDebugType_Error);
+    return valid;
+}
+
+bool KPakWriter::write(
+    const std::string& filename, const std::string& root_path,
+    const std::vector<std::string>& paths, bool compress, KPakWriteStats* stats
+)
+{
+    std::vector<std::string> sorted_paths = paths;
+    std::sort(sorted_paths.begin(), sorted_paths.end());
+    sorted_paths.erase(std::unique(sorted_paths.begin(), sorted_paths.end()), sorted_paths.end());
+
+    KPakFileHeader header = {};
+    header.entry_count = static_cast<std::uint32_t>(sorted_paths.size());
+    header.entry_offset = sizeof(KPakFileHeader);
+    header.path_offset = header.entry_offset + sorted_paths.size() * sizeof(KPakEntry);
+
+    std::vector<KPakEntry> entries = std::vector<KPakEntry>(sorted_paths.size());
+    std::string path_table = {};
+    for (std::size_t i = 0; i < sorted_paths.size(); i++)
+    {
+        entries[i].path_offset = static_cast<std::uint32_t>(path_table.size());
+        entries[i].path_length = static_cast<std::uint32_t>(sorted_paths[i].size());
+        path_table += sorted_paths[i];
+    }
+    header.path_size = path_table.size();
+    header.data_offset = align_offset(header.path_offset + header.path_size);
+
+    std::error_code error = {};
+    std::filesystem::path parent = std::filesystem::path(filename).parent_path();
+    if (!parent.empty())
+        std::filesystem::create_directories(parent, error);
+
+    // Written next to the target and renamed over it so readers never see a partial archive
+    std::string temporary_filename = filename + ".tmp";
+    std::ofstream file = std::ofstream(temporary_filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    // The table of contents is only complete once every entry is written, it's filled in last
+    std::vector<char> padding = std::vector<char>(header.data_offset, 0);
+    file.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+
+    KPakWriteStats write_stats = {};
+    std::uint64_t offset = header.data_offset;
+    std::vector<std::uint8_t> data = {};
+    std::vector<std::uint8_t> compressed = {};
+    for (std::size_t i = 0; i < sorted_paths.size(); i++)
+    {
+        std::string source_filename =
+            (std::filesystem::path(root_path) / sorted_paths[i]).string();
+        std::ifstream source = std::ifstream(source_filename, std::ios::binary | std::ios::ate);
+        if (!source.is_open())
+        {
+            KLDebug::log(
+                "PakWriter::write() -> failed to open " + source_filename, KEDebugType_Error
+            );
+            return false;
+        }
+
+        data.resize(static_cast<std::size_t>(source.tellg()));
+        source.seekg(0);
+        source.read(
+            reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())
+        );
+        if (!source.good())
+            return false;
+
+        KPakEntry& entry = entries[i];
+        entry.offset = offset;
+        entry.size = data.size();
+        entry.stored_size = data.size();
+        const std::uint8_t* stored = data.data();
+
+        if (compress && !data.empty())
+        {
+            compressed.clear();
+            KLzCompression::compress(data.data(), data.size(), compressed);
+            if (compressed.size() <= data.size() - data.size() / 8)
+            {
+                entry.compression = KEPakCompression_Lz;
+                entry.stored_size = compressed.size();
+                stored = compressed.data();
+                write_stats.compressed_count++;
+            }
+        }
+
+        file.write(
+            reinterpret_cast<const char*>(stored),
+            static_cast<std::streamsize>(entry.stored_size)
+        );
+        std::uint64_t end = align_offset(offset + entry.stored_size);
+        file.write(padding.data(), static_cast<std::streamsize>(end - offset - entry.stored_size));
+        offset = end;
+        write_stats.size += entry.size;
+    }
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(
+        reinterpret_cast<const char*>(entries.data()),
+        static_cast<std::streamsize>(entries.size() * sizeof(KPakEntry))
+    );
+    file.write(path_table.data(), static_cast<std::streamsize>(path_table.size()));
+    file.close();
+    if (!file.good())
+        return false;
+
+    std::filesystem::rename(temporary_filename, filename, error);
+    if (error)
+        return false;
+
+    write_stats.entry_count = sorted_paths.size();
+    write_stats.archive_size = offset;
+    if (stats != nullptr)
+        *stats = write_stats;
+    return true;
+}
@@ -0,0 +1,78 @@
+#ifndef __KRYOS_EDITOR_CORE_PAK_ARCHIVE_HPP__
+#define __KRYOS_EDITOR_CORE_PAK_ARCHIVE_HPP__
+
+#include "core/mapped_file.hpp"
+#include "core/pak_format.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct KPakWriteStats
+{
+    std::size_t entry_count = 0;
+    std::size_t compressed_count = 0;
+    // Bytes of the files packed and of the whole archive
+    std::uint64_t size = 0;
+    std::uint64_t archive_size = 0;
+};
+
+// Packed archive opened with a single mmap. Looking an entry up is a binary search over the
+// table of contents, uncompressed entries are used straight from the mapping
+class KPakArchive
+{
+  public:
+    KPakArchive() = default;
+    ~KPakArchive() = default;
+
+    inline bool is_open() const { return m_file.is_open(); }
+    inline std::size_t get_mapped_size() const { return m_file.get_size(); }
+    inline const KPakFileHeader& get_header() const
+    {
+        return *reinterpret_cast<const KPakFileHeader*>(m_file.get_data());
+    }
+    inline std::uint32_t get_entry_count() const { return get_header().entry_count; }
+    inline const KPakEntry& get_entry(std::uint32_t i) const
+    {
+        return reinterpret_cast<const KPakEntry*>(
+            m_file.get_data() + get_header().entry_offset
+        )[i];
+    }
+    inline std::string_view get_path(const KPakEntry& entry) const
+    {
+        const char* paths =
+            reinterpret_cast<const char*>(m_file.get_data() + get_header().path_offset);
+        return std::string_view(paths + entry.path_offset, entry.path_length);
+    }
+    inline const std::uint8_t* get_stored_data(const KPakEntry& entry) const
+    {
+        return m_file.get_data() + entry.offset;
+    }
+
+    bool open(const std::string& filename);
+    void close();
+
+    // Returns nullptr when the archive has no entry for the path
+    const KPakEntry* find(std::string_view path) const;
+    // Decompresses compressed entries, uncompressed ones are copied
+    bool read(const KPakEntry& entry, std::vector<std::uint8_t>& data) const;
+
+  private:
+    bool _validate(const std::string& filename) const;
+
+  private:
+    KMappedFile m_file = {};
+};
+
+struct KPakWriter
+{
+    // Packs the files at the given paths relative to root_path. With compress set every entry
+    // that shrinks by at least an eighth is stored compressed, the rest stay mappable in place
+    static bool write(
+        const std::string& filename, const std::string& root_path,
+        const std::vector<std::string>& paths, bool compress, KPakWriteStats* stats
+    );
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef __KRYOS_EDITOR_CORE_PAK_FORMAT_HPP__
+#define __KRYOS_EDITOR_CORE_PAK_FORMAT_HPP__
+
+#include <cstdint>
+
+// Packed project archive (.kpak). Everything is little endian and laid out so the whole archive
+// can be mapped with one mmap and uncompressed entries used in place: a header, the table of
+// contents sorted by path, the path strings, then the entry data. Every table and entry starts on
+// a 16 byte boundary, which keeps the cooked formats' own alignment intact inside the archive
+
+static constexpr std::uint32_t pak_file_magic = 0x4b41504b; // "KPAK"
+static constexpr std::uint32_t pak_file_version = 1;
+static constexpr std::uint64_t pak_file_alignment = 16;
+
+enum KEPakCompression : std::uint32_t
+{
+    KEPakCompression_None,
+    // KLzCompression, decompressed into its own buffer when opened
+    KEPakCompression_Lz,
+};
+
+struct KPakEntry
+{
+    std::uint64_t offset = 0;
+    // Bytes in the archive, equal to size unless the entry is compressed
+    std::uint64_t stored_size = 0;
+    std::uint64_t size = 0;
+    // Relative to the archive's root, always separated by '/' and not null terminated
+    std::uint32_t path_offset = 0;
+    std::uint32_t path_length = 0;
+    std::uint32_t compression = KEPakCompression_None;
+    std::uint32_t reserved[3] = {};
+};
+static_assert(sizeof(KPakEntry) % pak_file_alignment == 0, "entries must stay aligned");
+
+struct KPakFileHeader
+{
+    std::uint32_t magic = pak_file_magic;
+    std::uint32_t version = pak_file_version;
+    std::uint32_t entry_count = 0;
+    std::uint32_t reserved = 0;
+
+    std::uint64_t entry_offset = 0;
+    std::uint64_t path_offset = 0;
+    std::uint64_t path_size = 0;
+    std::uint64_t data_offset = 0;
+};
+static_assert(sizeof(KPakFileHeader) % pak_file_alignment == 0, "header must stay aligned");
+
+#endif
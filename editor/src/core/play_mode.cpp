@@ -0,0 +1,81 @@
+#include "core/play_mode.hpp"
+
+#include <kryos/core/application.hpp>
+#include <kryos/core/debug.hpp>
+
+#include <cassert>
+#include <chrono>
+
+KLPlayMode* KLPlayMode::m_Instance = nullptr;
+
+static double milliseconds_since(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+KLPlayMode::KLPlayMode()
+{
+    assert(
+        m_Instance == nullptr && "PlayMode::PlayMode() -> cannot created multiple play mode "
+                                 "application layers"
+    );
+
+    m_Instance = this;
+}
+
+KLPlayMode::~KLPlayMode() { m_Instance = nullptr; }
+
+bool KLPlayMode::play()
+{
+    KScene* scene = KIApplication::get_layer<KLSceneManager>()->get_active_scene();
+    if (m_playing || scene == nullptr)
+        return false;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    m_snapshot.capture(scene);
+    m_last_snapshot_time = milliseconds_since(start);
+    m_playing = true;
+    return true;
+}
+
+bool KLPlayMode::stop()
+{
+    if (!m_playing)
+        return false;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool restored = m_snapshot.restore();
+    m_last_restore_time = milliseconds_since(start);
+    m_snapshot.clear();
+    m_playing = false;
+
+    if (!restored)
+    {
+        KLDebug::log(
+            "PlayMode::stop() -> scene couldn't be fully restored, reload it to get rid of the "
+            "play state",
+            KEDebugType_Error
+        );
+    }
+    return restored;
+}
+
+void KLPlayMode::on_update()
+{
+    if (!m_playing)
+        return;
+
+    // The snapshot belongs to a scene that is no longer the one being played, writing it back
+    // would be wrong
+    if (KIApplication::get_layer<KLSceneManager>()->get_active_scene() != m_snapshot.get_scene())
+    {
+        KLDebug::log(
+            "PlayMode::on_update() -> active scene changed while playing, stopped without "
+            "restoring",
+            KEDebugType_Warning
+        );
+        m_snapshot.clear();
+        m_playing = false;
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef __KRYOS_EDITOR_CORE_PLAY_MODE_HPP__
+#define __KRYOS_EDITOR_CORE_PLAY_MODE_HPP__
+
+#include "core/registry_snapshot.hpp"
+
+#include <kryos/core/application_layer.hpp>
+
+// Play in editor. Play snapshots the active scene's registry and Stop writes the snapshot back,
+// so nothing done to the scene while playing outlives the session and the scene never has to be
+// serialized and loaded again
+class KLPlayMode : public KIApplicationLayer
+{
+  public:
+    inline static KLPlayMode* get() { return m_Instance; }
+
+  public:
+    KLPlayMode();
+    virtual ~KLPlayMode() override;
+
+    inline bool is_playing() const { return m_playing; }
+    inline const KRegistrySnapshot& get_snapshot() const { return m_snapshot; }
+    inline double get_last_snapshot_time() const { return m_last_snapshot_time; }
+    inline double get_last_restore_time() const { return m_last_restore_time; }
+
+    bool play();
+    bool stop();
+
+    virtual void on_update() override;
+
+  private:
+    static KLPlayMode* m_Instance;
+
+  private:
+    bool m_playing = false;
+    KRegistrySnapshot m_snapshot = {};
+    double m_last_snapshot_time = 0.0;
+    double m_last_restore_time = 0.0;
+};
+
+#endif
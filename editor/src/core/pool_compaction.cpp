@@ -0,0 +1,230 @@
+#include "core/pool_compaction.hpp"
+#include "core/editor_entities.hpp"
+#include "core/play_mode.hpp"
+#include "core/scene_changes.hpp"
+
+#include <kryos/core/application.hpp>
+#include <kryos/core/debug.hpp>
+#include <kryos/serialization/reflection.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+KLPoolCompaction* KLPoolCompaction::m_Instance = nullptr;
+
+static double milliseconds_since(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+KRegistryFragmentation KLPoolCompaction::measure(KScene* scene)
+{
+    KFragmentationWalk walk = {};
+    _begin(walk, scene);
+    _step(walk, scene->get_registry().get_entities().size());
+    _finish(walk);
+    return std::move(walk.result);
+}
+
+KLPoolCompaction::KLPoolCompaction()
+{
+    assert(
+        m_Instance == nullptr && "PoolCompaction::PoolCompaction() -> cannot created multiple "
+                                 "pool compaction application layers"
+    );
+
+    m_Instance = this;
+}
+
+void KLPoolCompaction::compact()
+{
+    if (KLPlayMode::get()->is_playing())
+    {
+        KLDebug::log(
+            "PoolCompaction::compact() -> can't compact while playing, stopping would restore "
+            "the scene over it",
+            KEDebugType_Warning
+        );
+        return;
+    }
+
+    if (m_state == KECompactionState_Idle)
+        m_state = KECompactionState_Capturing;
+}
+
+void KLPoolCompaction::on_update()
+{
+    KScene* scene = KIApplication::get_layer<KLSceneManager>()->get_active_scene();
+    if (scene == nullptr)
+    {
+        m_walk = {};
+        m_fragmentation = {};
+        m_measured = false;
+        m_state = KECompactionState_Idle;
+        m_snapshot.clear();
+        return;
+    }
+
+    if (m_state != KECompactionState_Idle)
+    {
+        _update_compaction(scene);
+        return;
+    }
+
+    // Components only move when entities or components come and go, edits to them don't count
+    std::uint64_t structure_version = KLSceneChanges::get()->get_structure_version();
+    if (scene != m_walk.scene || structure_version != m_walk.structure_version)
+    {
+        _begin(m_walk, scene);
+        m_measured = false;
+    }
+
+    if (!m_measured && _step(m_walk, fragmentation_entities_per_frame))
+    {
+        _finish(m_walk);
+        m_fragmentation = m_walk.result;
+        m_measured = true;
+    }
+}
+
+void KLPoolCompaction::_update_compaction(KScene* scene)
+{
+    KLSceneChanges* changes = KLSceneChanges::get();
+    if (KLPlayMode::get()->is_playing())
+    {
+        m_state = KECompactionState_Idle;
+        m_snapshot.clear();
+        return;
+    }
+
+    // Anything edited between the two frames would be lost by rebuilding the older capture
+    if (m_state == KECompactionState_Rebuilding &&
+        (m_snapshot.get_scene() != scene || changes->get_version() != m_captured_version))
+        m_state = KECompactionState_Capturing;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (m_state == KECompactionState_Capturing)
+    {
+        m_snapshot.capture(scene);
+        m_captured_version = changes->get_version();
+        m_last_capture_time = milliseconds_since(start);
+        m_state = KECompactionState_Rebuilding;
+        return;
+    }
+
+    if (!m_snapshot.get_skipped_types().empty())
+    {
+        // Their components would be lost with the entities they belong to
+        KLDebug::log(
+            "PoolCompaction::on_update() -> scene wasn't compacted, some of its components "
+            "can't be copied",
+            KEDebugType_Error
+        );
+    }
+    else
+    {
+        if (!m_snapshot.rebuild())
+            KLDebug::log("PoolCompaction::on_update() -> rebuild failed", KEDebugType_Error);
+        m_last_rebuild_time = milliseconds_since(start);
+
+        if (m_snapshot.get_moved_count() > 0)
+        {
+            KLDebug::log(
+                "PoolCompaction::on_update() -> " +
+                    std::to_string(m_snapshot.get_moved_count()) +
+                    " entities couldn't keep their ids",
+                KEDebugType_Warning
+            );
+        }
+        changes->mark_structure_changed();
+    }
+
+    m_snapshot.clear();
+    m_state = KECompactionState_Idle;
+}
+
+void KLPoolCompaction::_begin(KFragmentationWalk& walk, KScene* scene)
+{
+    walk = {};
+    walk.scene = scene;
+    walk.structure_version = KLSceneChanges::get()->get_structure_version();
+
+    ecs::Registry& registry = scene->get_registry();
+    KLReflectionRegistry* reflection = KIApplication::get_layer<KLReflectionRegistry>();
+    for (ecs::ObjectPool* pool : registry.get_pools())
+    {
+        KPoolFragmentation fragmentation = {};
+        fragmentation.type = pool->get_type_hash();
+        fragmentation.name = pool->get_name();
+        fragmentation.component_size = static_cast<std::uint32_t>(
+            reflection->get_type_info(KTypeId(fragmentation.type)).size
+        );
+
+        walk.pools.push_back(pool);
+        walk.result.pools.push_back(std::move(fragmentation));
+    }
+    walk.addresses.resize(walk.pools.size());
+    walk.result.entity_slots = registry.get_entities().size();
+}
+
+bool KLPoolCompaction::_step(KFragmentationWalk& walk, std::size_t count)
+{
+    const std::vector<ecs::Entity>& entities = walk.scene->get_registry().get_entities();
+    KLEditorEntities* editor_entities = KLEditorEntities::get();
+
+    std::size_t end = std::min(walk.next + count, entities.size());
+    for (; walk.next < end; walk.next++)
+    {
+        ecs::Entity entity = entities[walk.next];
+        if (entity == ECS_ENTITY_DESTROYED)
+            continue;
+
+        walk.result.live_entities++;
+        if (editor_entities->is_editor_entity(walk.scene, entity))
+            continue;
+
+        for (std::size_t i = 0; i < walk.pools.size(); i++)
+        {
+            void* component = walk.pools[i]->get_entitys_object(entity);
+            if (component != nullptr)
+                walk.addresses[i].push_back(reinterpret_cast<std::uintptr_t>(component));
+        }
+    }
+    return walk.next >= entities.size();
+}
+
+void KLPoolCompaction::_finish(KFragmentationWalk& walk)
+{
+    for (std::size_t i = 0; i < walk.pools.size(); i++)
+    {
+        KPoolFragmentation& fragmentation = walk.result.pools[i];
+        std::vector<std::uintptr_t>& addresses = walk.addresses[i];
+        std::uintptr_t size = fragmentation.component_size;
+        fragmentation.live_count = addresses.size();
+        if (addresses.empty() || size == 0)
+            continue;
+
+        for (std::size_t k = 1; k < addresses.size(); k++)
+        {
+            if (addresses[k] != addresses[k - 1] + size)
+                fragmentation.order_breaks++;
+        }
+
+        std::sort(addresses.begin(), addresses.end());
+        fragmentation.slot_count = (addresses.back() - addresses.front()) / size + 1;
+        for (std::size_t k = 1; k < addresses.size(); k++)
+        {
+            if (addresses[k] - addresses[k - 1] > size)
+                fragmentation.hole_count++;
+        }
+        fragmentation.wasted_bytes =
+            static_cast<std::uint64_t>(fragmentation.slot_count - fragmentation.live_count) *
+            size;
+    }
+
+    // Only the results are kept, the addresses can be large
+    walk.addresses.clear();
+    walk.addresses.shrink_to_fit();
+}
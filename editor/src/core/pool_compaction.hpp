@@ -0,0 +1,110 @@
+#ifndef __KRYOS_EDITOR_CORE_POOL_COMPACTION_HPP__
+#define __KRYOS_EDITOR_CORE_POOL_COMPACTION_HPP__
+
+#include "core/registry_snapshot.hpp"
+
+#include <kryos/core/application_layer.hpp>
+#include <kryos/scene/scene_manager.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Entities the fragmentation of the active scene is measured over each frame
+constexpr std::size_t fragmentation_entities_per_frame = 16384;
+
+struct KPoolFragmentation
+{
+    std::uint64_t type = 0;
+    std::string name = {};
+    std::uint32_t component_size = 0;
+    std::size_t live_count = 0;
+    // Slots from the pool's first live component to its last, the live ones included
+    std::size_t slot_count = 0;
+    // Runs of empty slots in between live components
+    std::size_t hole_count = 0;
+    std::uint64_t wasted_bytes = 0;
+    // Entities whose component doesn't directly follow the previous entity's
+    std::size_t order_breaks = 0;
+};
+
+struct KRegistryFragmentation
+{
+    std::size_t entity_slots = 0;
+    std::size_t live_entities = 0;
+    std::vector<KPoolFragmentation> pools = {};
+};
+
+// Measures how fragmented the active scene's pools have become over an editing session and packs
+// them back into entity order on request. The pools are the engine's, so they're measured by
+// where their components sit: a packed pool has every entity's component right after the previous
+// entity's. Measuring walks a slice of the entities each frame. Compacting captures the registry
+// on one frame and rebuilds it in entity order on the next, components can't be removed one at a
+// time so the rebuild itself can't be split any further
+class KLPoolCompaction : public KIApplicationLayer
+{
+  public:
+    inline static KLPoolCompaction* get() { return m_Instance; }
+
+    // Walks the whole scene at once
+    static KRegistryFragmentation measure(KScene* scene);
+
+  public:
+    KLPoolCompaction();
+    virtual ~KLPoolCompaction() override = default;
+
+    // The last complete measurement, which may be from before the latest edits
+    inline const KRegistryFragmentation& get_fragmentation() const { return m_fragmentation; }
+    inline bool is_measured() const { return m_measured; }
+    inline bool is_compacting() const { return m_state != KECompactionState_Idle; }
+    inline double get_last_capture_time() const { return m_last_capture_time; }
+    inline double get_last_rebuild_time() const { return m_last_rebuild_time; }
+
+    // Compacts the active scene over the next frames, ignored while playing
+    void compact();
+
+    virtual void on_update() override;
+
+  private:
+    enum KECompactionState
+    {
+        KECompactionState_Idle,
+        KECompactionState_Capturing,
+        KECompactionState_Rebuilding,
+    };
+
+    struct KFragmentationWalk
+    {
+        KScene* scene = nullptr;
+        std::uint64_t structure_version = 0;
+        std::size_t next = 0;
+        std::vector<ecs::ObjectPool*> pools = {};
+        // Each pool's component addresses in entity order
+        std::vector<std::vector<std::uintptr_t>> addresses = {};
+        KRegistryFragmentation result = {};
+    };
+
+    static KLPoolCompaction* m_Instance;
+
+    static void _begin(KFragmentationWalk& walk, KScene* scene);
+    // True once every entity was walked
+    static bool _step(KFragmentationWalk& walk, std::size_t count);
+    static void _finish(KFragmentationWalk& walk);
+
+  private:
+    void _update_compaction(KScene* scene);
+
+  private:
+    KFragmentationWalk m_walk = {};
+    KRegistryFragmentation m_fragmentation = {};
+    bool m_measured = false;
+
+    KECompactionState m_state = KECompactionState_Idle;
+    KRegistrySnapshot m_snapshot = {};
+    std::uint64_t m_captured_version = 0;
+    double m_last_capture_time = 0.0;
+    double m_last_rebuild_time = 0.0;
+};
+
+#endif
@@ -0,0 +1,1033 @@
+#include "core/prefabs.hpp"
+#include "core/component_columns.hpp"
+#include "core/mapped_file.hpp"
+#include "core/member_tables.hpp"
+#include "core/project.hpp"
+#include "core/scene_changes.hpp"
+
+#include <kryos/core/application.hpp>
+#include <kryos/core/debug.hpp>
+#include <kryos/serialization/reflection.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_set>
+
+KLPrefabs* KLPrefabs::m_Instance = nullptr;
+
+template<typename _Type>
+static void write_value(std::ofstream& file, const _Type& value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(_Type));
+}
+
+static void write_string(std::ofstream& file, const std::string& value)
+{
+    write_value(file, static_cast<std::uint32_t>(value.size()));
+    file.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+template<typename _Type>
+static bool read_value(KMappedFileReader& file, _Type& value)
+{
+    return file.read(&value, sizeof(_Type));
+}
+
+static bool read_string(KMappedFileReader& file, std::string& value)
+{
+    std::uint32_t size = 0;
+    if (!read_value(file, size) || size > (1u << 20))
+        return false;
+
+    value.resize(size);
+    return file.read(value.data(), size);
+}
+
+// Flattens a reflected type into its fields. Fails for anything that can't be compared and copied
+// field by field: containers, pointers that own what they point at and members that aren't
+// reflected
+static bool build_fields(
+    std::uint64_t type, std::uint32_t component, std::uint32_t base, const std::string& prefix,
+    KPrefab& prefab, std::uint32_t& string_count, int depth
+)
+{
+    KLMemberTables* tables = KLMemberTables::get();
+    std::uint32_t table = tables->find(type);
+    if (table == KLMemberTables::null_table || depth > 8 ||
+        !KComponentColumns::is_fully_reflected(type))
+        return false;
+
+    KLReflectionRegistry* reflection = KIApplication::get_layer<KLReflectionRegistry>();
+    const std::uint64_t string_type = KTypeId::create<std::string>().get_id();
+    const KMemberTable& member_table = tables->get_table(table);
+    for (const KMemberEntry* entry = tables->begin(member_table);
+         entry != tables->end(member_table); entry++)
+    {
+        KPrefabField field = {};
+        field.component = component;
+        field.offset = base + entry->offset;
+        field.name = prefix + tables->get_string(entry->name);
+        std::uint32_t count = entry->flags & KEMemberEntryFlag_Array ? entry->array_size : 1;
+
+        if (entry->flags & KEMemberEntryFlag_Pointer)
+        {
+            if (entry->editor_flags & KEMemberInfoEditorFlag_OwnsPtrData)
+                return false;
+            field.kind = KEPrefabFieldKind_Pointer;
+            field.size = static_cast<std::uint32_t>(sizeof(void*)) * count;
+        }
+        else if (entry->flags & (KEMemberEntryFlag_StdVector | KEMemberEntryFlag_StdArray))
+            return false;
+        else if (KComponentColumns::is_plain_type(entry->type_id))
+        {
+            field.kind = KEPrefabFieldKind_Bytes;
+            std::size_t size = reflection->get_type_info(KTypeId(entry->type_id)).size;
+            field.size = static_cast<std::uint32_t>(size) * count;
+        }
+        else if (entry->flags & KEMemberEntryFlag_Array)
+            return false;
+        else if (entry->type_id == string_type)
+        {
+            field.kind = KEPrefabFieldKind_String;
+            field.size = static_cast<std::uint32_t>(sizeof(std::string));
+            field.string = string_count++;
+        }
+        else
+        {
+            if (!build_fields(
+                    entry->type_id, component, field.offset, field.name + ".", prefab,
+                    string_count, depth + 1
+                ))
+                return false;
+            continue;
+        }
+
+        prefab.fields.push_back(std::move(field));
+    }
+    return true;
+}
+
+// Adds the type's fields to the prefab, nothing is added when the type isn't supported
+static bool add_component_fields(KPrefab& prefab, std::uint64_t type)
+{
+    std::size_t field_count = prefab.fields.size();
+    std::uint32_t component = static_cast<std::uint32_t>(prefab.components.size());
+    std::uint32_t string_count = 0;
+    if (!build_fields(type, component, 0, "", prefab, string_count, 0))
+    {
+        prefab.fields.resize(field_count);
+        return false;
+    }
+
+    KLReflectionRegistry* reflection = KIApplication::get_layer<KLReflectionRegistry>();
+    const KTypeInfo& info = reflection->get_type_info(KTypeId(type));
+    KPrefabComponent prefab_component = {};
+    prefab_component.type = type;
+    prefab_component.type_name = info.name;
+    prefab_component.bytes.assign(info.size, 0);
+    prefab_component.strings.resize(string_count);
+    prefab.components.push_back(std::move(prefab_component));
+    return true;
+}
+
+// Fields are saved as "Component.field" so they are found again after the component changed
+static std::string get_field_key(const KPrefab& prefab, const KPrefabField& field)
+{
+    return prefab.components[field.component].type_name + "." + field.name;
+}
+
+static inline std::string& string_at(std::uint8_t* object, const KPrefabField& field)
+{
+    return *reinterpret_cast<std::string*>(object + field.offset);
+}
+
+static void read_field(const KPrefabField& field, std::uint8_t* object, KPrefabComponent& component)
+{
+    if (field.kind == KEPrefabFieldKind_String)
+        component.strings[field.string] = string_at(object, field);
+    else
+        std::memcpy(component.bytes.data() + field.offset, object + field.offset, field.size);
+}
+
+static void write_field(
+    const KPrefabField& field, std::uint8_t* object, const KPrefabComponent& component
+)
+{
+    if (field.kind == KEPrefabFieldKind_String)
+        string_at(object, field) = component.strings[field.string];
+    else
+        std::memcpy(object + field.offset, component.bytes.data() + field.offset, field.size);
+}
+
+KLPrefabs::KLPrefabs()
+{
+    assert(
+        m_Instance == nullptr && "Prefabs::Prefabs() -> cannot created multiple prefabs "
+                                 "application layers"
+    );
+
+    m_Instance = this;
+}
+
+KLPrefabs::~KLPrefabs() { m_Instance = nullptr; }
+
+const KPrefab* KLPrefabs::load(const std::string& path)
+{
+    std::string relative_path = _get_relative_path(path);
+    auto it = m_prefab_indices.find(relative_path);
+    if (it != m_prefab_indices.end())
+        return m_prefabs[it->second].get();
+
+    std::unique_ptr<KPrefab> prefab = std::make_unique<KPrefab>();
+    prefab->path = relative_path;
+    if (!_read_prefab(_get_filename(relative_path), *prefab))
+    {
+        KLDebug::log(
+            "Prefabs::load() -> failed to read prefab '" + relative_path + "'", KEDebugType_Error
+        );
+        return nullptr;
+    }
+
+    return m_prefabs[_add_prefab(std::move(prefab))].get();
+}
+
+bool KLPrefabs::create(KScene* scene, ecs::Entity entity, const std::string& path)
+{
+    std::string relative_path = _get_relative_path(path);
+    if (std::filesystem::path(relative_path).extension() != prefab_extension)
+        relative_path += prefab_extension;
+
+    if (m_prefab_indices.contains(relative_path))
+    {
+        KLDebug::log(
+            "Prefabs::create() -> '" + relative_path +
+                "' is already a prefab, apply one of its instances to change it",
+            KEDebugType_Error
+        );
+        return false;
+    }
+
+    std::unique_ptr<KPrefab> prefab = std::make_unique<KPrefab>();
+    prefab->path = relative_path;
+    for (ecs::ObjectPool* pool : scene->get_registry().get_pools())
+    {
+        std::uint8_t* object =
+            reinterpret_cast<std::uint8_t*>(pool->get_entitys_object(entity));
+        if (object == nullptr)
+            continue;
+
+        if (!add_component_fields(*prefab, pool->get_type_hash()))
+        {
+            KLDebug::log(
+                "Prefabs::create() -> " + pool->get_name() +
+                    " can't be compared field by field, it is left out of the prefab",
+                KEDebugType_Warning
+            );
+            continue;
+        }
+
+        KPrefabComponent& component = prefab->components.back();
+        for (const KPrefabField& field : prefab->fields)
+        {
+            if (field.component == prefab->components.size() - 1)
+                read_field(field, object, component);
+        }
+    }
+
+    if (prefab->components.empty() || !_write_prefab(*prefab))
+    {
+        KLDebug::log(
+            "Prefabs::create() -> failed to create prefab '" + relative_path + "'",
+            KEDebugType_Error
+        );
+        return false;
+    }
+
+    sync(scene);
+    KPrefabInstance instance = {};
+    instance.prefab = _add_prefab(std::move(prefab));
+    KSceneInstances& instances = m_scenes[scene];
+    instances.instances[entity] = std::move(instance);
+    _mark_synced(instances);
+    return true;
+}
+
+ecs::Entity KLPrefabs::instantiate(KScene* scene, const std::string& path)
+{
+    const KPrefab* prefab = load(path);
+    if (prefab == nullptr)
+        return ECS_ENTITY_DESTROYED;
+
+    KPrefabInstance instance = {};
+    instance.prefab = m_prefab_indices[prefab->path];
+    ecs::Entity entity = _create_instance(*prefab, instance);
+
+    KSceneInstances& instances = m_scenes[scene];
+    instances.instances[entity] = std::move(instance);
+    KLSceneChanges::get()->mark_structure_changed();
+    _mark_synced(instances);
+    return entity;
+}
+
+bool KLPrefabs::apply(KScene* scene, ecs::Entity entity)
+{
+    sync(scene);
+    KSceneInstances& instances = m_scenes[scene];
+    auto it = instances.instances.find(entity);
+    if (it == instances.instances.end())
+        return false;
+
+    std::uint32_t index = it->second.prefab;
+    KPrefab& prefab = *m_prefabs[index];
+    std::vector<std::uint8_t*> objects = _get_objects(prefab, entity);
+    for (const KPrefabField& field : prefab.fields)
+    {
+        if (objects[field.component] != nullptr)
+            read_field(field, objects[field.component], prefab.components[field.component]);
+    }
+
+    if (!_write_prefab(prefab))
+    {
+        KLDebug::log(
+            "Prefabs::apply() -> failed to write prefab '" + prefab.path + "'", KEDebugType_Error
+        );
+        return false;
+    }
+
+    // Fields an instance doesn't override still hold the prefab's previous values, so only
+    // those are written, a single pass over the instances and their fields
+    for (auto& [instance_entity, instance] : instances.instances)
+    {
+        if (instance.prefab != index)
+            continue;
+
+        if (instance_entity == entity)
+        {
+            instance.fields.clear();
+            instance.bytes.clear();
+            instance.strings.clear();
+            continue;
+        }
+
+        std::vector<std::uint8_t*> instance_objects = _get_objects(prefab, instance_entity);
+        std::size_t override_index = 0;
+        for (std::uint32_t i = 0; i < prefab.fields.size(); i++)
+        {
+            if (override_index < instance.fields.size() && instance.fields[override_index] == i)
+            {
+                override_index++;
+                continue;
+            }
+
+            const KPrefabField& field = prefab.fields[i];
+            if (instance_objects[field.component] != nullptr)
+            {
+                write_field(
+                    field, instance_objects[field.component], prefab.components[field.component]
+                );
+            }
+        }
+    }
+
+    _mark_mutated(scene, prefab);
+    return true;
+}
+
+void KLPrefabs::revert(KScene* scene, ecs::Entity entity)
+{
+    sync(scene);
+    KSceneInstances& instances = m_scenes[scene];
+    auto it = instances.instances.find(entity);
+    if (it == instances.instances.end())
+        return;
+
+    KPrefabInstance& instance = it->second;
+    const KPrefab& prefab = *m_prefabs[instance.prefab];
+    std::vector<std::uint8_t*> objects = _get_objects(prefab, entity);
+    for (std::uint32_t field : instance.fields)
+    {
+        const KPrefabField& prefab_field = prefab.fields[field];
+        if (objects[prefab_field.component] != nullptr)
+        {
+            write_field(
+                prefab_field, objects[prefab_field.component],
+                prefab.components[prefab_field.component]
+            );
+        }
+    }
+
+    instance.fields.clear();
+    instance.bytes.clear();
+    instance.strings.clear();
+    _mark_mutated(scene, prefab);
+}
+
+const KPrefabInstance* KLPrefabs::find_instance(KScene* scene, ecs::Entity entity) const
+{
+    auto scene_it = m_scenes.find(scene);
+    if (scene_it == m_scenes.end())
+        return nullptr;
+
+    auto it = scene_it->second.instances.find(entity);
+    return it != scene_it->second.instances.end() ? &it->second : nullptr;
+}
+
+KPrefabMemoryStats KLPrefabs::get_memory_stats(KScene* scene) const
+{
+    KPrefabMemoryStats stats = {};
+    auto scene_it = m_scenes.find(scene);
+    if (scene_it == m_scenes.end())
+        return stats;
+
+    auto string_bytes = [](const std::vector<std::string>& strings)
+    {
+        std::uint64_t size = 0;
+        for (const std::string& string : strings)
+            size += string.size();
+        return size;
+    };
+
+    std::unordered_set<std::uint32_t> prefabs = {};
+    for (const auto& [entity, instance] : scene_it->second.instances)
+    {
+        const KPrefab& prefab = *m_prefabs[instance.prefab];
+        for (const KPrefabComponent& component : prefab.components)
+            stats.full_bytes += component.bytes.size() + string_bytes(component.strings);
+
+        stats.instance_count++;
+        stats.override_count += instance.fields.size();
+        stats.shared_bytes += sizeof(KPrefabInstance) +
+                              instance.fields.size() * sizeof(std::uint32_t) +
+                              instance.bytes.size() +
+                              instance.strings.size() * sizeof(std::string) +
+                              string_bytes(instance.strings);
+        prefabs.insert(instance.prefab);
+    }
+
+    // Each prefab's data is counted once, however many instances refer to it
+    for (std::uint32_t index : prefabs)
+    {
+        for (const KPrefabComponent& component : m_prefabs[index]->components)
+            stats.shared_bytes += component.bytes.size() + string_bytes(component.strings);
+    }
+    return stats;
+}
+
+std::vector<ecs::Entity> KLPrefabs::get_instances(KScene* scene, const std::string& path) const
+{
+    std::vector<ecs::Entity> entities = {};
+    auto scene_it = m_scenes.find(scene);
+    auto prefab_it = m_prefab_indices.find(_get_relative_path(path));
+    if (scene_it == m_scenes.end() || prefab_it == m_prefab_indices.end())
+        return entities;
+
+    for (const auto& [entity, instance] : scene_it->second.instances)
+    {
+        if (instance.prefab == prefab_it->second)
+            entities.push_back(entity);
+    }
+    return entities;
+}
+
+void KLPrefabs::sync(KScene* scene)
+{
+    auto scene_it = m_scenes.find(scene);
+    if (scene_it == m_scenes.end() || scene_it->second.instances.empty())
+        return;
+
+    KSceneInstances& instances = scene_it->second;
+    KLSceneChanges* changes = KLSceneChanges::get();
+    if (instances.structure_version != changes->get_structure_version())
+    {
+        instances.structure_version = changes->get_structure_version();
+
+        std::unordered_set<ecs::Entity> alive = {};
+        for (ecs::Entity entity : scene->get_registry().get_entities())
+        {
+            if (entity != ECS_ENTITY_DESTROYED)
+                alive.insert(entity);
+        }
+        std::erase_if(
+            instances.instances,
+            [&](const auto& instance) { return !alive.contains(instance.first); }
+        );
+    }
+
+    // Only prefabs with a pool mutated since the last pass are compared against
+    std::vector<bool> dirty = std::vector<bool>(m_prefabs.size(), false);
+    bool any_dirty = false;
+    for (std::uint32_t i = 0; i < m_prefabs.size(); i++)
+    {
+        for (const KPrefabComponent& component : m_prefabs[i]->components)
+        {
+            if (instances.pool_mutations[component.type] !=
+                changes->get_pool_mutations(component.type))
+                dirty[i] = true;
+        }
+        any_dirty |= dirty[i];
+    }
+    if (!any_dirty)
+        return;
+
+    for (auto& [entity, instance] : instances.instances)
+    {
+        if (dirty[instance.prefab])
+            _compute_overrides(*m_prefabs[instance.prefab], entity, instance);
+    }
+    _mark_synced(instances);
+}
+
+void KLPrefabs::detach(KScene* scene)
+{
+    sync(scene);
+    auto scene_it = m_scenes.find(scene);
+    if (scene_it == m_scenes.end())
+        return;
+
+    KSceneInstances& instances = scene_it->second;
+    ecs::Registry& registry = scene->get_registry();
+    std::size_t kept_count = 0;
+    for (auto it = instances.instances.begin(); it != instances.instances.end();)
+    {
+        // A component the prefab doesn't have can't be written as an override, so the entity is
+        // left in the scene file and is a plain entity once loaded again
+        const KPrefab& prefab = *m_prefabs[it->second.prefab];
+        bool detachable = true;
+        for (ecs::ObjectPool* pool : registry.get_pools())
+        {
+            if (pool->get_entitys_object(it->first) == nullptr)
+                continue;
+
+            std::uint64_t type = pool->get_type_hash();
+            detachable &= std::any_of(
+                prefab.components.begin(), prefab.components.end(),
+                [&](const KPrefabComponent& component) { return component.type == type; }
+            );
+        }
+
+        if (!detachable)
+        {
+            kept_count++;
+            it++;
+            continue;
+        }
+
+        instances.detached.push_back(std::move(it->second));
+        KEntity(it->first).destroy();
+        KLSceneChanges::get()->mark_entity_destroyed(it->first);
+        it = instances.instances.erase(it);
+    }
+
+    if (kept_count > 0)
+    {
+        KLDebug::log(
+            "Prefabs::detach() -> " + std::to_string(kept_count) +
+                " prefab instances have components their prefab doesn't and are saved in full",
+            KEDebugType_Warning
+        );
+    }
+}
+
+void KLPrefabs::attach(KScene* scene)
+{
+    auto scene_it = m_scenes.find(scene);
+    if (scene_it == m_scenes.end() || scene_it->second.detached.empty())
+        return;
+
+    KSceneInstances& instances = scene_it->second;
+    for (KPrefabInstance& instance : instances.detached)
+    {
+        ecs::Entity entity = _create_instance(*m_prefabs[instance.prefab], instance);
+        instances.instances[entity] = std::move(instance);
+    }
+    instances.detached.clear();
+
+    KLSceneChanges::get()->mark_structure_changed();
+    _mark_synced(instances);
+}
+
+bool KLPrefabs::write_instances(KScene* scene, const std::string& filename) const
+{
+    auto scene_it = m_scenes.find(scene);
+    std::error_code error = {};
+    if (scene_it == m_scenes.end() || scene_it->second.detached.empty())
+    {
+        std::filesystem::remove(filename, error);
+        return true;
+    }
+
+    const std::vector<KPrefabInstance>& instances = scene_it->second.detached;
+    std::vector<std::uint32_t> prefab_indices = {};
+    std::unordered_map<std::uint32_t, std::uint32_t> prefab_remap = {};
+    std::vector<std::string> keys = {};
+    std::unordered_map<std::string, std::uint32_t> key_indices = {};
+    for (const KPrefabInstance& instance : instances)
+    {
+        if (prefab_remap.emplace(instance.prefab, prefab_indices.size()).second)
+            prefab_indices.push_back(instance.prefab);
+
+        const KPrefab& prefab = *m_prefabs[instance.prefab];
+        for (std::uint32_t field : instance.fields)
+        {
+            std::string key = get_field_key(prefab, prefab.fields[field]);
+            if (key_indices.emplace(key, keys.size()).second)
+                keys.push_back(std::move(key));
+        }
+    }
+
+    std::string temporary_filename = filename + ".tmp";
+    {
+        std::ofstream file = std::ofstream(temporary_filename, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+
+        write_value(file, prefab_instances_magic);
+        write_value(file, prefab_instances_version);
+        write_value(file, static_cast<std::uint32_t>(prefab_indices.size()));
+        write_value(file, static_cast<std::uint32_t>(keys.size()));
+        write_value(file, static_cast<std::uint32_t>(instances.size()));
+
+        for (std::uint32_t index : prefab_indices)
+            write_string(file, m_prefabs[index]->path);
+        for (const std::string& key : keys)
+            write_string(file, key);
+
+        for (const KPrefabInstance& instance : instances)
+        {
+            const KPrefab& prefab = *m_prefabs[instance.prefab];
+
+            // Pointers aren't written, the instance falls back to the prefab's
+            std::uint32_t count = 0;
+            for (std::uint32_t field : instance.fields)
+                count += prefab.fields[field].kind != KEPrefabFieldKind_Pointer;
+
+            write_value(file, prefab_remap[instance.prefab]);
+            write_value(file, count);
+
+            const std::uint8_t* bytes = instance.bytes.data();
+            const std::string* strings = instance.strings.data();
+            for (std::uint32_t field : instance.fields)
+            {
+                // Values are written as strings, both kinds are read back the same way
+                const KPrefabField& prefab_field = prefab.fields[field];
+                if (prefab_field.kind == KEPrefabFieldKind_String)
+                {
+                    write_value(file, key_indices[get_field_key(prefab, prefab_field)]);
+                    write_string(file, *strings++);
+                    continue;
+                }
+
+                if (prefab_field.kind == KEPrefabFieldKind_Bytes)
+                {
+                    write_value(file, key_indices[get_field_key(prefab, prefab_field)]);
+                    write_value(file, prefab_field.size);
+                    file.write(
+                        reinterpret_cast<const char*>(bytes),
+                        static_cast<std::streamsize>(prefab_field.size)
+                    );
+                }
+                bytes += prefab_field.size;
+            }
+        }
+
+        if (!file.good())
+            return false;
+    }
+
+    std::filesystem::rename(temporary_filename, filename, error);
+    return !error;
+}
+
+bool KLPrefabs::read_instances(KScene* scene, const std::string& filename)
+{
+    // The scene was just replaced, whatever instances it had are gone with it
+    m_scenes.erase(scene);
+
+    // Scenes saved before they had prefab instances have no file next to them
+    if (!KMappedFile::exists(filename))
+        return true;
+
+    KMappedFile mapped_file = {};
+    if (!mapped_file.open(filename, 0, "Prefabs::read_instances()"))
+        return false;
+    KMappedFileReader file = KMappedFileReader(mapped_file);
+
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    std::uint32_t prefab_count = 0;
+    std::uint32_t key_count = 0;
+    std::uint32_t instance_count = 0;
+    if (!read_value(file, magic) || !read_value(file, version) ||
+        !read_value(file, prefab_count) || !read_value(file, key_count) ||
+        !read_value(file, instance_count) || magic != prefab_instances_magic ||
+        version != prefab_instances_version)
+    {
+        KLDebug::log(
+            "Prefabs::read_instances() -> '" + filename + "' is not a prefab instances file",
+            KEDebugType_Error
+        );
+        return false;
+    }
+
+    std::vector<const KPrefab*> prefabs = std::vector<const KPrefab*>(prefab_count, nullptr);
+    for (const KPrefab*& prefab : prefabs)
+    {
+        std::string path = {};
+        if (!read_string(file, path))
+            return false;
+        prefab = load(path);
+    }
+
+    std::vector<std::string> keys = std::vector<std::string>(key_count);
+    for (std::string& key : keys)
+    {
+        if (!read_string(file, key))
+            return false;
+    }
+
+    // Keys are resolved against each prefab's fields once, an unknown key drops its override
+    std::vector<std::unordered_map<std::string, std::uint32_t>> fields = {};
+    for (const KPrefab* prefab : prefabs)
+    {
+        std::unordered_map<std::string, std::uint32_t>& prefab_fields = fields.emplace_back();
+        if (prefab == nullptr)
+            continue;
+        for (std::uint32_t i = 0; i < prefab->fields.size(); i++)
+        {
+            prefab_fields.emplace(get_field_key(*prefab, prefab->fields[i]), i);
+        }
+    }
+
+    KSceneInstances& instances = m_scenes[scene];
+    std::size_t skipped_count = 0;
+    for (std::uint32_t i = 0; i < instance_count; i++)
+    {
+        std::uint32_t prefab_index = 0;
+        std::uint32_t override_count = 0;
+        if (!read_value(file, prefab_index) || !read_value(file, override_count) ||
+            prefab_index >= prefab_count)
+            return false;
+
+        // Overrides are read into the prefab's field order, the file might be in another
+        std::vector<std::pair<std::uint32_t, std::string>> overrides = {};
+        for (std::uint32_t j = 0; j < override_count; j++)
+        {
+            std::uint32_t key = 0;
+            std::string value = {};
+            if (!read_value(file, key) || key >= key_count || !read_string(file, value))
+                return false;
+
+            auto field = fields[prefab_index].find(keys[key]);
+            if (field != fields[prefab_index].end())
+                overrides.emplace_back(field->second, std::move(value));
+        }
+
+        const KPrefab* prefab = prefabs[prefab_index];
+        if (prefab == nullptr)
+        {
+            skipped_count++;
+            continue;
+        }
+
+        std::sort(
+            overrides.begin(), overrides.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; }
+        );
+
+        KPrefabInstance instance = {};
+        instance.prefab = m_prefab_indices[prefab->path];
+        for (auto& [field, value] : overrides)
+        {
+            const KPrefabField& prefab_field = prefab->fields[field];
+            if (prefab_field.kind == KEPrefabFieldKind_String)
+                instance.strings.push_back(std::move(value));
+            else if (value.size() == prefab_field.size)
+                instance.bytes.insert(instance.bytes.end(), value.begin(), value.end());
+            else
+                continue;
+            instance.fields.push_back(field);
+        }
+
+        ecs::Entity entity = _create_instance(*prefab, instance);
+        instances.instances[entity] = std::move(instance);
+    }
+
+    if (skipped_count > 0)
+    {
+        KLDebug::log(
+            "Prefabs::read_instances() -> " + std::to_string(skipped_count) +
+                " instances of missing prefabs were left out",
+            KEDebugType_Warning
+        );
+    }
+
+    KLSceneChanges::get()->mark_structure_changed();
+    _mark_synced(instances);
+    return true;
+}
+
+void KLPrefabs::on_update()
+{
+    KScene* scene = KIApplication::get_layer<KLSceneManager>()->get_active_scene();
+    if (scene != nullptr)
+        sync(scene);
+}
+
+std::string KLPrefabs::_get_relative_path(const std::string& path) const
+{
+    std::filesystem::path filename = std::filesystem::path(path);
+    if (filename.is_relative())
+        return filename.generic_string();
+
+    std::error_code error = {};
+    std::filesystem::path relative =
+        std::filesystem::relative(filename, KLProject::get()->get_root_path(), error);
+    if (error || relative.empty() || *relative.begin() == "..")
+        return filename.generic_string();
+    return relative.generic_string();
+}
+
+std::string KLPrefabs::_get_filename(const std::string& path) const
+{
+    return (std::filesystem::path(KLProject::get()->get_root_path()) / path).string();
+}
+
+bool KLPrefabs::_read_prefab(const std::string& filename, KPrefab& prefab) const
+{
+    KMappedFile mapped_file = {};
+    if (!mapped_file.open(filename, 0, "Prefabs::load()"))
+        return false;
+    KMappedFileReader file = KMappedFileReader(mapped_file);
+
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    std::uint32_t component_count = 0;
+    if (!read_value(file, magic) || !read_value(file, version) ||
+        !read_value(file, component_count) || magic != prefab_file_magic ||
+        version != prefab_file_version)
+        return false;
+
+    KLReflectionRegistry* reflection = KIApplication::get_layer<KLReflectionRegistry>();
+    for (std::uint32_t i = 0; i < component_count; i++)
+    {
+        std::string type_name = {};
+        std::uint32_t field_count = 0;
+        if (!read_string(file, type_name) || !read_value(file, field_count))
+            return false;
+
+        std::uint64_t type = 0;
+        for (const auto& [type_id, info] : reflection->get_all_type_infos())
+        {
+            if (info.name == type_name)
+            {
+                type = type_id;
+                break;
+            }
+        }
+
+        // The component's fields are still read past, an unknown type just has nowhere to go
+        bool known = type != 0 && add_component_fields(prefab, type);
+        if (!known)
+        {
+            KLDebug::log(
+                "Prefabs::load() -> component '" + type_name + "' of '" + prefab.path +
+                    "' is unknown or can't be compared field by field, it is left out",
+                KEDebugType_Warning
+            );
+        }
+
+        std::unordered_map<std::string, const KPrefabField*> fields = {};
+        if (known)
+        {
+            for (const KPrefabField& field : prefab.fields)
+            {
+                if (field.component == prefab.components.size() - 1)
+                    fields.emplace(field.name, &field);
+            }
+        }
+
+        // Fields are matched by name, ones that no longer exist are dropped and new ones keep
+        // their zero value
+        for (std::uint32_t j = 0; j < field_count; j++)
+        {
+            std::string name = {};
+            std::string value = {};
+            if (!read_string(file, name) || !read_string(file, value))
+                return false;
+
+            auto it = fields.find(name);
+            if (it == fields.end())
+                continue;
+
+            const KPrefabField& field = *it->second;
+            KPrefabComponent& component = prefab.components.back();
+            if (field.kind == KEPrefabFieldKind_String)
+                component.strings[field.string] = std::move(value);
+            else if (field.kind == KEPrefabFieldKind_Bytes && value.size() == field.size)
+                std::memcpy(component.bytes.data() + field.offset, value.data(), field.size);
+        }
+    }
+
+    return !prefab.components.empty();
+}
+
+bool KLPrefabs::_write_prefab(const KPrefab& prefab) const
+{
+    std::string filename = _get_filename(prefab.path);
+    std::string temporary_filename = filename + ".tmp";
+    {
+        std::ofstream file = std::ofstream(temporary_filename, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+
+        write_value(file, prefab_file_magic);
+        write_value(file, prefab_file_version);
+        write_value(file, static_cast<std::uint32_t>(prefab.components.size()));
+
+        for (std::uint32_t i = 0; i < prefab.components.size(); i++)
+        {
+            const KPrefabComponent& component = prefab.components[i];
+            std::vector<const KPrefabField*> fields = {};
+            for (const KPrefabField& field : prefab.fields)
+            {
+                if (field.component == i && field.kind != KEPrefabFieldKind_Pointer)
+                    fields.push_back(&field);
+            }
+
+            write_string(file, component.type_name);
+            write_value(file, static_cast<std::uint32_t>(fields.size()));
+            for (const KPrefabField* field : fields)
+            {
+                write_string(file, field->name);
+                if (field->kind == KEPrefabFieldKind_String)
+                    write_string(file, component.strings[field->string]);
+                else
+                    write_string(
+                        file, std::string(
+                                  reinterpret_cast<const char*>(component.bytes.data()) +
+                                      field->offset,
+                                  field->size
+                              )
+                    );
+            }
+        }
+
+        if (!file.good())
+            return false;
+    }
+
+    std::error_code error = {};
+    std::filesystem::rename(temporary_filename, filename, error);
+    return !error;
+}
+
+std::uint32_t KLPrefabs::_add_prefab(std::unique_ptr<KPrefab> prefab)
+{
+    std::uint32_t index = static_cast<std::uint32_t>(m_prefabs.size());
+    m_prefab_indices.emplace(prefab->path, index);
+    m_prefabs.push_back(std::move(prefab));
+    return index;
+}
+
+std::vector<std::uint8_t*> KLPrefabs::_get_objects(const KPrefab& prefab, ecs::Entity entity)
+    const
+{
+    std::vector<std::uint8_t*> objects = std::vector<std::uint8_t*>(prefab.components.size());
+    KEntity instance = KEntity(entity);
+    for (std::size_t i = 0; i < prefab.components.size(); i++)
+    {
+        objects[i] =
+            reinterpret_cast<std::uint8_t*>(instance.get_component(prefab.components[i].type));
+    }
+    return objects;
+}
+
+void KLPrefabs::_compute_overrides(
+    const KPrefab& prefab, ecs::Entity entity, KPrefabInstance& instance
+) const
+{
+    instance.fields.clear();
+    instance.bytes.clear();
+    instance.strings.clear();
+
+    std::vector<std::uint8_t*> objects = _get_objects(prefab, entity);
+    for (std::uint32_t i = 0; i < prefab.fields.size(); i++)
+    {
+        const KPrefabField& field = prefab.fields[i];
+        const KPrefabComponent& component = prefab.components[field.component];
+        std::uint8_t* object = objects[field.component];
+        if (object == nullptr)
+            continue;
+
+        if (field.kind == KEPrefabFieldKind_String)
+        {
+            const std::string& value = string_at(object, field);
+            if (value == component.strings[field.string])
+                continue;
+            instance.strings.push_back(value);
+        }
+        else
+        {
+            const std::uint8_t* value = object + field.offset;
+            if (std::memcmp(value, component.bytes.data() + field.offset, field.size) == 0)
+                continue;
+            instance.bytes.insert(instance.bytes.end(), value, value + field.size);
+        }
+        instance.fields.push_back(i);
+    }
+}
+
+ecs::Entity KLPrefabs::_create_instance(const KPrefab& prefab, const KPrefabInstance& instance)
+    const
+{
+    KLReflectionRegistry* reflection = KIApplication::get_layer<KLReflectionRegistry>();
+    KEntity entity = KEntity(true);
+    for (const KPrefabComponent& component : prefab.components)
+        entity.add_component(reflection, component.type);
+
+    std::vector<std::uint8_t*> objects = _get_objects(prefab, entity);
+    std::size_t override_index = 0;
+    const std::uint8_t* bytes = instance.bytes.data();
+    const std::string* strings = instance.strings.data();
+    for (std::uint32_t i = 0; i < prefab.fields.size(); i++)
+    {
+        const KPrefabField& field = prefab.fields[i];
+        std::uint8_t* object = objects[field.component];
+        if (override_index == instance.fields.size() || instance.fields[override_index] != i)
+        {
+            write_field(field, object, prefab.components[field.component]);
+            continue;
+        }
+
+        override_index++;
+        if (field.kind == KEPrefabFieldKind_String)
+            string_at(object, field) = *strings++;
+        else
+        {
+            std::memcpy(object + field.offset, bytes, field.size);
+            bytes += field.size;
+        }
+    }
+    return entity;
+}
+
+void KLPrefabs::_mark_mutated(KScene* scene, const KPrefab& prefab)
+{
+    for (const KPrefabComponent& component : prefab.components)
+        KLSceneChanges::get()->mark_pool_mutated(component.type);
+    _mark_synced(m_scenes[scene]);
+}
+
+void KLPrefabs::_mark_synced(KSceneInstances& scene)
+{
+    KLSceneChanges* changes = KLSceneChanges::get();
+    scene.structure_version = changes->get_structure_version();
+    for (const std::unique_ptr<KPrefab>& prefab : m_prefabs)
+    {
+        for (const KPrefabComponent& component : prefab->components)
+            scene.pool_mutations[component.type] = changes->get_pool_mutations(component.type);
+    }
+}
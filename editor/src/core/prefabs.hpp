@@ -0,0 +1,152 @@
+#ifndef __KRYOS_EDITOR_CORE_PREFABS_HPP__
+#define __KRYOS_EDITOR_CORE_PREFABS_HPP__
+
+#include <kryos/core/application_layer.hpp>
+#include <kryos/scene/entity.hpp>
+#include <kryos/scene/scene_manager.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+constexpr const char* prefab_extension = ".kprefab";
+// Appended to a scene's filename, the scene's prefab instances are saved there as their overrides
+constexpr const char* prefab_instances_extension = ".prefabs";
+
+constexpr std::uint32_t prefab_file_magic = 0x4246504b; // "KPFB"
+constexpr std::uint32_t prefab_file_version = 1;
+constexpr std::uint32_t prefab_instances_magic = 0x4e49504b; // "KPIN"
+constexpr std::uint32_t prefab_instances_version = 1;
+
+enum KEPrefabFieldKind
+{
+    KEPrefabFieldKind_Bytes,
+    KEPrefabFieldKind_String,
+    // Shared in memory but never written to a file, an address means nothing to the next session
+    KEPrefabFieldKind_Pointer,
+};
+
+// A member of a component that isn't made of other reflected members, overrides are tracked per
+// field. Nested types are flattened, so "inner.a" is a field of its own
+struct KPrefabField
+{
+    std::uint32_t component = 0;
+    std::uint32_t offset = 0;
+    std::uint32_t size = 0;
+    KEPrefabFieldKind kind = KEPrefabFieldKind_Bytes;
+    // Index into the component's strings for string fields
+    std::uint32_t string = 0;
+    std::string name = {};
+};
+
+struct KPrefabComponent
+{
+    std::uint64_t type = 0;
+    std::string type_name = {};
+    // Byte and pointer fields are read from here at their offset, string fields from strings
+    std::vector<std::uint8_t> bytes = {};
+    std::vector<std::string> strings = {};
+};
+
+struct KPrefab
+{
+    // Relative to the project root, like the asset index's paths
+    std::string path = {};
+    std::vector<KPrefabComponent> components = {};
+    std::vector<KPrefabField> fields = {};
+};
+
+// What an instance holds on to, the fields it differs from its prefab in and nothing else
+struct KPrefabInstance
+{
+    std::uint32_t prefab = 0;
+    // Sorted, values of byte and pointer fields are packed back to back in bytes
+    std::vector<std::uint32_t> fields = {};
+    std::vector<std::uint8_t> bytes = {};
+    std::vector<std::string> strings = {};
+};
+
+struct KPrefabMemoryStats
+{
+    std::size_t instance_count = 0;
+    std::size_t override_count = 0;
+    // The instances' components as full copies against the prefabs plus the overrides
+    std::uint64_t full_bytes = 0;
+    std::uint64_t shared_bytes = 0;
+};
+
+// Prefab assets and the scenes' instances of them. The registry still holds every instance's
+// components since the renderer and the engine read them from there, an instance's record is
+// only its overrides, found by comparing its fields against the prefab whenever one of the
+// prefab's pools was mutated. Scene files don't hold instances at all, they are written next to
+// the scene as a prefab path and the overrides
+class KLPrefabs : public KIApplicationLayer
+{
+  public:
+    inline static KLPrefabs* get() { return m_Instance; }
+
+  public:
+    KLPrefabs();
+    virtual ~KLPrefabs() override;
+
+    // Paths can be absolute or relative to the project root. Loaded prefabs are kept around
+    const KPrefab* load(const std::string& path);
+    // Saves the entity's components as a prefab, the entity becomes its first instance
+    bool create(KScene* scene, ecs::Entity entity, const std::string& path);
+    ecs::Entity instantiate(KScene* scene, const std::string& path);
+    // The instance's values become the prefab's, then every other instance in the scene takes
+    // the fields it doesn't override in one pass
+    bool apply(KScene* scene, ecs::Entity entity);
+    void revert(KScene* scene, ecs::Entity entity);
+
+    const KPrefabInstance* find_instance(KScene* scene, ecs::Entity entity) const;
+    inline const KPrefab& get_prefab(std::uint32_t index) const { return *m_prefabs[index]; }
+    KPrefabMemoryStats get_memory_stats(KScene* scene) const;
+    std::vector<ecs::Entity> get_instances(KScene* scene, const std::string& path) const;
+    void sync(KScene* scene);
+
+    // Called by the project around serializing a scene, the instances are destroyed so the
+    // scene file doesn't hold them and recreated afterwards, with new ids
+    void detach(KScene* scene);
+    void attach(KScene* scene);
+    bool write_instances(KScene* scene, const std::string& filename) const;
+    bool read_instances(KScene* scene, const std::string& filename);
+
+    virtual void on_update() override;
+
+  private:
+    static KLPrefabs* m_Instance;
+
+  private:
+    struct KSceneInstances
+    {
+        std::unordered_map<ecs::Entity, KPrefabInstance> instances = {};
+        // Held on to while the scene is being serialized
+        std::vector<KPrefabInstance> detached = {};
+        std::uint64_t structure_version = 0;
+        std::unordered_map<std::uint64_t, std::uint64_t> pool_mutations = {};
+    };
+
+    std::string _get_relative_path(const std::string& path) const;
+    std::string _get_filename(const std::string& path) const;
+    bool _read_prefab(const std::string& filename, KPrefab& prefab) const;
+    bool _write_prefab(const KPrefab& prefab) const;
+    std::uint32_t _add_prefab(std::unique_ptr<KPrefab> prefab);
+    std::vector<std::uint8_t*> _get_objects(const KPrefab& prefab, ecs::Entity entity) const;
+    void _compute_overrides(
+        const KPrefab& prefab, ecs::Entity entity, KPrefabInstance& instance
+    ) const;
+    ecs::Entity _create_instance(const KPrefab& prefab, const KPrefabInstance& instance) const;
+    void _mark_mutated(KScene* scene, const KPrefab& prefab);
+    void _mark_synced(KSceneInstances& scene);
+
+  private:
+    std::vector<std::unique_ptr<KPrefab>> m_prefabs = {};
+    std::unordered_map<std::string, std::uint32_t> m_prefab_indices = {};
+    std::unordered_map<KScene*, KSceneInstances> m_scenes = {};
+};
+
+#endif
@@ -1,4 +1,8 @@
 #include "core/project.hpp"
+#include "core/editor_entities.hpp"
+#include "core/prefabs.hpp"
+#include "core/scene_file.hpp"
+#include "core/virtual_file_system.hpp"
 #include "gui/preferences.hpp"
 #include "utils/utils.hpp"
 
@@ -14,6 +18,14 @@
 
 KLProject* KLProject::m_Instance = nullptr;
 
+// The YAML and KSerialization readers only take filenames, packed files are read through a
+// temporary copy
+static std::string readable_path(const std::string& filename)
+{
+    KLVirtualFileSystem* file_system = KLVirtualFileSystem::get();
+    return file_system != nullptr ? file_system->get_readable_path(filename) : filename;
+}
+
 void KLProject::create_new_popup()
 {
     if (ImGui::BeginPopupModal("Create Project", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
@@ -199,7 +211,7 @@ bool KLProject::create(
 
 bool KLProject::load(const std::string& project_filename)
 {
-    yaml::Node root = yaml::open(project_filename);
+    yaml::Node root = yaml::open(readable_path(project_filename));
     if (!root.empty())
     {
         m_name = root["ProjectName"].as<std::string>();
@@ -219,7 +231,23 @@ bool KLProject::load(const std::string& project_filename)
 
 bool KLProject::serialize_scene(KScene* scene, const std::string& filename)
 {
-    bool result = KSerialization::serialize(filename, scene);
+    // Editor owned entities (camera, gizmos, ...) are never written with the scene
+    KLEditorEntities::get()->detach(scene);
+    // Prefab instances are written next to the scene as their overrides
+    KLPrefabs::get()->detach(scene);
+
+    // Written through the member tables when every component can be written field by field.
+    // NOTE: Components with pointers or containers are still left to KSerialization, which knows
+    // what the engine's pointers refer to, so scenes holding any of them are saved as YAML
+    std::string unsupported_type = {};
+    bool saved = KSceneFile::can_write(scene, unsupported_type)
+                     ? KSceneFile::write(scene, filename)
+                     : KSerialization::serialize(filename, scene);
+    bool result =
+        saved && KLPrefabs::get()->write_instances(scene, filename + prefab_instances_extension);
+    KLPrefabs::get()->attach(scene);
+    KLEditorEntities::get()->attach(scene);
+
     if (result)
         m_unsaved = false;
     else
@@ -236,9 +264,24 @@ bool KLProject::deserialize_scene(KScene* scene, const std::string& filename)
 {
     KLSceneManager* scene_manager = KIApplication::get_layer<KLSceneManager>();
 
-    bool result = KSerialization::deserialize(filename, scene_manager->get_active_scene());
+    KScene* active_scene = scene_manager->get_active_scene();
+
+    KLEditorEntities::get()->detach(active_scene);
+    // Scenes saved as YAML before, or with components the scene file can't hold, are still read
+    bool loaded = KSceneFile::is_scene_file(filename)
+                      ? KSceneFile::read(active_scene, filename)
+                      : KSerialization::deserialize(readable_path(filename), active_scene);
+    bool result = loaded &&
+                  KLPrefabs::get()->read_instances(
+                      active_scene, filename + prefab_instances_extension
+                  );
+    KLEditorEntities::get()->attach(active_scene);
+
     if (result)
+    {
+        KLEditorEntities::get()->migrate_legacy_entities(active_scene);
         m_unsaved = false;
+    }
     else
     {
         KLDebug::log(
@@ -0,0 +1,346 @@
+#include "core/registry_snapshot.hpp"
+#include "core/component_columns.hpp"
+#include "core/editor_entities.hpp"
+#include "core/member_tables.hpp"
+#include "core/scene_changes.hpp"
+
+#include <kryos/core/application.hpp>
+#include <kryos/core/debug.hpp>
+#include <kryos/scene/entity.hpp>
+#include <kryos/serialization/reflection.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+void KRegistrySnapshot::capture(KScene* scene)
+{
+    clear();
+    m_scene = scene;
+
+    ecs::Registry& registry = scene->get_registry();
+    KLEditorEntities* editor_entities = KLEditorEntities::get();
+    for (ecs::Entity entity : registry.get_entities())
+    {
+        if (entity != ECS_ENTITY_DESTROYED && !editor_entities->is_editor_entity(scene, entity))
+            m_entities.push_back(entity);
+    }
+
+    std::vector<std::uint64_t> column_types = KComponentColumns::get_copyable_types(registry);
+    KComponentColumns::write(registry, m_entities, column_types, m_columns);
+
+    for (ecs::ObjectPool* pool : registry.get_pools())
+    {
+        KPoolSnapshot snapshot = {};
+        snapshot.type = pool->get_type_hash();
+        snapshot.present.assign(m_entities.size(), false);
+
+        const KCopyPlan* plan = nullptr;
+        if (std::find(column_types.begin(), column_types.end(), snapshot.type) ==
+            column_types.end())
+        {
+            plan = &_get_plan(snapshot.type);
+            if (!plan->supported)
+            {
+                m_skipped_types.push_back(pool->get_name());
+                plan = nullptr;
+            }
+        }
+
+        if (plan != nullptr)
+        {
+            snapshot.reflected = true;
+            snapshot.size = plan->size;
+        }
+
+        for (std::size_t i = 0; i < m_entities.size(); i++)
+        {
+            const std::uint8_t* component =
+                reinterpret_cast<const std::uint8_t*>(pool->get_entitys_object(m_entities[i]));
+            if (component == nullptr)
+                continue;
+
+            snapshot.present[i] = true;
+            if (plan == nullptr)
+                continue;
+
+            // The std::string members' bytes come along as well, restore only uses the copies
+            snapshot.entities.push_back(static_cast<std::uint32_t>(i));
+            snapshot.bytes.insert(snapshot.bytes.end(), component, component + plan->size);
+            for (std::uint32_t offset : plan->string_offsets)
+                snapshot.strings.push_back(
+                    *reinterpret_cast<const std::string*>(component + offset)
+                );
+            m_reflected_count++;
+        }
+
+        m_pools.push_back(std::move(snapshot));
+    }
+
+    if (!m_skipped_types.empty())
+    {
+        std::string types = {};
+        for (const std::string& type : m_skipped_types)
+            types += (types.empty() ? "" : ", ") + type;
+        KLDebug::log(
+            "RegistrySnapshot::capture() -> " + types +
+                " can't be copied by their reflected layout and won't be restored",
+            KEDebugType_Warning
+        );
+    }
+}
+
+bool KRegistrySnapshot::restore() { return _restore(false); }
+
+bool KRegistrySnapshot::rebuild() { return _restore(true); }
+
+bool KRegistrySnapshot::_restore(bool rebuild)
+{
+    if (m_scene == nullptr)
+        return false;
+
+    ecs::Registry& registry = m_scene->get_registry();
+    KLEditorEntities* editor_entities = KLEditorEntities::get();
+    KLReflectionRegistry* reflection = KIApplication::get_layer<KLReflectionRegistry>();
+
+    std::unordered_map<ecs::Entity, std::uint32_t> indices = {};
+    indices.reserve(m_entities.size());
+    for (std::size_t i = 0; i < m_entities.size(); i++)
+        indices.emplace(m_entities[i], static_cast<std::uint32_t>(i));
+
+    std::vector<bool> alive = std::vector<bool>(m_entities.size(), false);
+    std::vector<ecs::Entity> created = {};
+    for (ecs::Entity entity : registry.get_entities())
+    {
+        if (entity == ECS_ENTITY_DESTROYED || editor_entities->is_editor_entity(m_scene, entity))
+            continue;
+
+        auto it = indices.find(entity);
+        if (it != indices.end())
+            alive[it->second] = true;
+        else
+            created.push_back(entity);
+    }
+
+    std::vector<bool> recreate = alive;
+    if (rebuild)
+        recreate.assign(m_entities.size(), true);
+    else
+        recreate.flip();
+
+    std::unordered_map<std::uint64_t, const KPoolSnapshot*> pools = {};
+    for (const KPoolSnapshot& pool : m_pools)
+        pools.emplace(pool.type, &pool);
+
+    for (ecs::ObjectPool* pool : registry.get_pools())
+    {
+        auto it = pools.find(pool->get_type_hash());
+        const KPoolSnapshot* snapshot = it != pools.end() ? it->second : nullptr;
+        for (std::size_t i = 0; i < m_entities.size(); i++)
+        {
+            if (recreate[i] || pool->get_entitys_object(m_entities[i]) == nullptr)
+                continue;
+            if (snapshot == nullptr || !snapshot->present[i])
+                recreate[i] = true;
+        }
+    }
+
+    bool structure_changed = !created.empty();
+    for (ecs::Entity entity : created)
+        KEntity(entity).destroy();
+
+    std::vector<ecs::Entity> entities = m_entities;
+    for (std::size_t i = 0; i < entities.size(); i++)
+    {
+        if (!recreate[i])
+            continue;
+
+        if (alive[i])
+            KEntity(entities[i]).destroy();
+        structure_changed = true;
+    }
+
+    // Recreated only once everything stale is gone, new entities may reuse destroyed ids
+    _recreate(entities, recreate);
+
+    bool succeeded = KComponentColumns::read(entities, m_columns.data(), m_columns.size());
+
+    for (const KPoolSnapshot& pool : m_pools)
+    {
+        if (!pool.reflected)
+            continue;
+
+        const KCopyPlan& plan = _get_plan(pool.type);
+        if (!plan.supported || plan.size != pool.size)
+        {
+            succeeded = false;
+            continue;
+        }
+
+        for (std::size_t i = 0; i < pool.entities.size(); i++)
+        {
+            KEntity entity = KEntity(entities[pool.entities[i]]);
+            void* component = entity.get_component(pool.type);
+            if (component == nullptr)
+            {
+                entity.add_component(reflection, pool.type);
+                component = entity.get_component(pool.type);
+            }
+
+            _restore_reflected(
+                plan, pool.bytes.data() + i * pool.size,
+                pool.strings.data() + i * plan.string_offsets.size(),
+                reinterpret_cast<std::uint8_t*>(component)
+            );
+        }
+
+        KLSceneChanges::get()->mark_pool_mutated(pool.type);
+    }
+
+    if (structure_changed)
+        KLSceneChanges::get()->mark_structure_changed();
+
+    // The snapshot stays usable for the next restore
+    m_entities = std::move(entities);
+    return succeeded;
+}
+
+void KRegistrySnapshot::clear()
+{
+    m_scene = nullptr;
+    m_entities.clear();
+    m_columns.clear();
+    m_pools.clear();
+    m_reflected_count = 0;
+    m_skipped_types.clear();
+    m_moved_count = 0;
+}
+
+void KRegistrySnapshot::_recreate(
+    std::vector<ecs::Entity>& entities, const std::vector<bool>& recreate
+)
+{
+    std::unordered_map<ecs::Entity, std::size_t> wanted = {};
+    for (std::size_t i = 0; i < entities.size(); i++)
+    {
+        if (recreate[i])
+            wanted.emplace(entities[i], i);
+    }
+
+    // The registry hands out its free ids before new ones, so creating entities until a new id
+    // comes up gets back every old id it still has
+    std::size_t slot_count = m_scene->get_registry().get_entities().size();
+    std::vector<ecs::Entity> others = {};
+    while (!wanted.empty())
+    {
+        ecs::Entity entity = KEntity(true);
+        auto it = wanted.find(entity);
+        if (it != wanted.end())
+            wanted.erase(it);
+        else
+        {
+            others.push_back(entity);
+            if (entity >= slot_count)
+                break;
+        }
+    }
+
+    m_moved_count = wanted.size();
+    for (const auto& [entity, index] : wanted)
+    {
+        if (!others.empty())
+        {
+            entities[index] = others.back();
+            others.pop_back();
+        }
+        else
+            entities[index] = KEntity(true);
+    }
+
+    for (ecs::Entity entity : others)
+        KEntity(entity).destroy();
+}
+
+const KRegistrySnapshot::KCopyPlan& KRegistrySnapshot::_get_plan(std::uint64_t type)
+{
+    KLMemberTables* tables = KLMemberTables::get();
+    if (m_plans_build != tables->get_build_count())
+    {
+        m_plans.clear();
+        m_plans_build = tables->get_build_count();
+    }
+
+    auto it = m_plans.find(type);
+    if (it != m_plans.end())
+        return it->second;
+
+    KLReflectionRegistry* reflection = KIApplication::get_layer<KLReflectionRegistry>();
+    KCopyPlan plan = {};
+    if (reflection->get_all_type_infos().contains(type))
+    {
+        plan.size = static_cast<std::uint32_t>(reflection->get_type_info(KTypeId(type)).size);
+        plan.supported = _plan_members(type, 0, plan, 0);
+        std::sort(plan.string_offsets.begin(), plan.string_offsets.end());
+    }
+
+    return m_plans.emplace(type, std::move(plan)).first->second;
+}
+
+bool KRegistrySnapshot::_plan_members(
+    std::uint64_t type, std::uint32_t base, KCopyPlan& plan, int depth
+) const
+{
+    // Nested a few levels deep at most, a type that refers back to itself is never copyable
+    KLMemberTables* tables = KLMemberTables::get();
+    std::uint32_t table = tables->find(type);
+    if (table == KLMemberTables::null_table || depth > 8)
+        return false;
+
+    if (!KComponentColumns::is_fully_reflected(type))
+        return false;
+
+    const std::uint64_t string_type = KTypeId::create<std::string>().get_id();
+    const KMemberTable& member_table = tables->get_table(table);
+    for (const KMemberEntry* entry = tables->begin(member_table);
+         entry != tables->end(member_table); entry++)
+    {
+        std::uint32_t offset = base + entry->offset;
+
+        // Pointers are copied as addresses, which is only right when the component doesn't own
+        // what they point at
+        if (entry->flags & KEMemberEntryFlag_Pointer)
+        {
+            if (entry->editor_flags & KEMemberInfoEditorFlag_OwnsPtrData)
+                return false;
+            continue;
+        }
+
+        if (entry->flags & (KEMemberEntryFlag_StdVector | KEMemberEntryFlag_StdArray))
+            return false;
+        if (KComponentColumns::is_plain_type(entry->type_id))
+            continue;
+        if (entry->flags & KEMemberEntryFlag_Array)
+            return false;
+
+        if (entry->type_id == string_type)
+            plan.string_offsets.push_back(offset);
+        else if (!_plan_members(entry->type_id, offset, plan, depth + 1))
+            return false;
+    }
+    return true;
+}
+
+void KRegistrySnapshot::_restore_reflected(
+    const KCopyPlan& plan, const std::uint8_t* bytes, const std::string* strings,
+    std::uint8_t* component
+) const
+{
+    std::uint32_t offset = 0;
+    for (std::size_t i = 0; i < plan.string_offsets.size(); i++)
+    {
+        std::uint32_t string_offset = plan.string_offsets[i];
+        std::memcpy(component + offset, bytes + offset, string_offset - offset);
+        *reinterpret_cast<std::string*>(component + string_offset) = strings[i];
+        offset = string_offset + static_cast<std::uint32_t>(sizeof(std::string));
+    }
+    std::memcpy(component + offset, bytes + offset, plan.size - offset);
+}
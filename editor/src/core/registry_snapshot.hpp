@@ -0,0 +1,88 @@
+#ifndef __KRYOS_EDITOR_CORE_REGISTRY_SNAPSHOT_HPP__
+#define __KRYOS_EDITOR_CORE_REGISTRY_SNAPSHOT_HPP__
+
+#include <kryos/scene/scene_manager.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// In memory copy of a scene's entities and components that can be written back over the live
+// registry. Trivially copyable pools are copied as columns, every other pool by its reflected
+// layout: the component's bytes in one memcpy with its std::string members copied on their own.
+// Editor entities are left out and never touched by a restore
+class KRegistrySnapshot
+{
+  public:
+    KRegistrySnapshot() = default;
+    ~KRegistrySnapshot() = default;
+
+    inline bool is_empty() const { return m_scene == nullptr; }
+    inline KScene* get_scene() const { return m_scene; }
+    inline std::size_t get_entity_count() const { return m_entities.size(); }
+    inline std::uint64_t get_column_size() const { return m_columns.size(); }
+    inline std::size_t get_reflected_count() const { return m_reflected_count; }
+    // Entities the last restore or rebuild couldn't give their old id back
+    inline std::size_t get_moved_count() const { return m_moved_count; }
+    // Pools whose components couldn't be copied, they keep their play state after a restore
+    inline const std::vector<std::string>& get_skipped_types() const { return m_skipped_types; }
+
+    void capture(KScene* scene);
+    // Entities created since the capture are destroyed and destroyed ones are recreated, under
+    // their old ids where the registry hands them out again. Components can't be removed one at a
+    // time, so an entity that gained a component is recreated as well
+    bool restore();
+    // Every captured entity is recreated and its components added back in entity order, which
+    // leaves the pools packed in that order
+    bool rebuild();
+    void clear();
+
+  private:
+    struct KPoolSnapshot
+    {
+        std::uint64_t type = 0;
+        // Whether each snapshot entity had the component
+        std::vector<bool> present = {};
+        // Filled for pools copied by their reflected layout, the columns hold the rest
+        bool reflected = false;
+        std::uint32_t size = 0;
+        std::vector<std::uint32_t> entities = {};
+        std::vector<std::uint8_t> bytes = {};
+        std::vector<std::string> strings = {};
+    };
+
+    struct KCopyPlan
+    {
+        bool supported = false;
+        std::uint32_t size = 0;
+        // Sorted, everything in between is copied as bytes
+        std::vector<std::uint32_t> string_offsets = {};
+    };
+
+    bool _restore(bool rebuild);
+    void _recreate(std::vector<ecs::Entity>& entities, const std::vector<bool>& recreate);
+    const KCopyPlan& _get_plan(std::uint64_t type);
+    bool _plan_members(std::uint64_t type, std::uint32_t base, KCopyPlan& plan, int depth) const;
+    void _restore_reflected(
+        const KCopyPlan& plan, const std::uint8_t* bytes, const std::string* strings,
+        std::uint8_t* component
+    ) const;
+
+  private:
+    KScene* m_scene = nullptr;
+    std::vector<ecs::Entity> m_entities = {};
+    std::vector<std::uint8_t> m_columns = {};
+    std::vector<KPoolSnapshot> m_pools = {};
+    std::size_t m_reflected_count = 0;
+    std::vector<std::string> m_skipped_types = {};
+    std::size_t m_moved_count = 0;
+
+    // Rebuilt whenever the member tables are
+    std::unordered_map<std::uint64_t, KCopyPlan> m_plans = {};
+    std::size_t m_plans_build = 0;
+};
+
+#endif
@@ -0,0 +1,83 @@
+#include "core/render_queue.hpp"
+
+#include <algorithm>
+
+std::uint64_t KRenderQueue::make_sort_key(
+    std::uint32_t shader, std::uint32_t material, std::uint32_t model, std::uint32_t lod
+)
+{
+    // Shader changes are the most expensive so they sit in the most significant bits, levels of
+    // the same model end up next to each other since they share vertex arrays
+    std::uint32_t lod_mask = (1u << lod_bits) - 1;
+    return (static_cast<std::uint64_t>(shader & 0xffff) << 48) |
+           (static_cast<std::uint64_t>(material & 0xffff) << 32) |
+           (static_cast<std::uint64_t>(model) << lod_bits) |
+           static_cast<std::uint64_t>(lod & lod_mask);
+}
+
+void KRenderQueue::clear()
+{
+    m_items.clear();
+    m_item_transforms.clear();
+    m_batches.clear();
+    m_instance_transforms.clear();
+}
+
+void KRenderQueue::push(
+    KModelHandle model, const glm::mat4& transform, std::uint32_t lod, std::uint32_t shader,
+    std::uint32_t material
+)
+{
+    KDrawItem item = {};
+    item.sort_key = make_sort_key(shader, material, _model_id(model), lod);
+    item.index = static_cast<std::uint32_t>(m_item_transforms.size());
+
+    m_items.push_back(item);
+    m_item_transforms.push_back(transform);
+}
+
+void KRenderQueue::build()
+{
+    m_batches.clear();
+    m_instance_transforms.clear();
+    m_instance_transforms.reserve(m_items.size());
+
+    std::sort(
+        m_items.begin(), m_items.end(),
+        [](const KDrawItem& lhs, const KDrawItem& rhs)
+        {
+            if (lhs.sort_key != rhs.sort_key)
+                return lhs.sort_key < rhs.sort_key;
+            return lhs.index < rhs.index;
+        }
+    );
+
+    for (const KDrawItem& item : m_items)
+    {
+        if (m_batches.empty() || m_batches.back().sort_key != item.sort_key)
+        {
+            KDrawBatch batch = {};
+            batch.sort_key = item.sort_key;
+            std::uint32_t low_bits = static_cast<std::uint32_t>(item.sort_key & 0xffffffff);
+            batch.model = m_models[low_bits >> lod_bits];
+            batch.lod = low_bits & ((1u << lod_bits) - 1);
+            batch.first_instance = static_cast<std::uint32_t>(m_instance_transforms.size());
+            m_batches.push_back(batch);
+        }
+
+        m_batches.back().instance_count++;
+        m_instance_transforms.push_back(m_item_transforms[item.index]);
+    }
+}
+
+std::uint32_t KRenderQueue::_model_id(KModelHandle model)
+{
+    auto it = m_model_ids.find(model);
+    if (it != m_model_ids.end())
+        return it->second;
+
+    std::uint32_t id = static_cast<std::uint32_t>(m_models.size());
+    m_models.push_back(model);
+    m_model_ids.emplace(model, id);
+    return id;
+}
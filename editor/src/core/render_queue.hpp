@@ -0,0 +1,73 @@
+#ifndef __KRYOS_EDITOR_CORE_RENDER_QUEUE_HPP__
+#define __KRYOS_EDITOR_CORE_RENDER_QUEUE_HPP__
+
+#include <kryos/scene/components.hpp>
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+
+using KModelHandle = decltype(KCMeshRenderer::model);
+
+// Run of instances that share the same sort key, drawn with a single instanced call.
+// first_instance indexes into the queue's packed instance transforms
+struct KDrawBatch
+{
+    std::uint64_t sort_key = 0;
+    KModelHandle model = {};
+    std::uint32_t lod = 0;
+    std::uint32_t first_instance = 0;
+    std::uint32_t instance_count = 0;
+};
+
+// Collects mesh renderers for a frame, sorts them by (shader, material, model, lod) and groups
+// identical ones into instanced batches with their transforms packed contiguously
+class KRenderQueue
+{
+  public:
+    KRenderQueue() = default;
+    ~KRenderQueue() = default;
+
+    inline const std::vector<KDrawBatch>& get_batches() const { return m_batches; }
+    inline const std::vector<glm::mat4>& get_instance_transforms() const
+    {
+        return m_instance_transforms;
+    }
+    inline std::size_t get_item_count() const { return m_items.size(); }
+
+    static constexpr std::uint32_t lod_bits = 4;
+
+    static std::uint64_t make_sort_key(
+        std::uint32_t shader, std::uint32_t material, std::uint32_t model, std::uint32_t lod = 0
+    );
+
+    void clear();
+    void push(
+        KModelHandle model, const glm::mat4& transform, std::uint32_t lod = 0,
+        std::uint32_t shader = 0, std::uint32_t material = 0
+    );
+    void build();
+
+  private:
+    struct KDrawItem
+    {
+        std::uint64_t sort_key = 0;
+        std::uint32_t index = 0;
+    };
+
+    std::uint32_t _model_id(KModelHandle model);
+
+  private:
+    std::vector<KDrawItem> m_items = {};
+    std::vector<glm::mat4> m_item_transforms = {};
+
+    std::vector<KDrawBatch> m_batches = {};
+    std::vector<glm::mat4> m_instance_transforms = {};
+
+    // Ids stay the same between frames so sort keys are stable
+    std::unordered_map<KModelHandle, std::uint32_t> m_model_ids = {};
+    std::vector<KModelHandle> m_models = {};
+};
+
+#endif
@@ -0,0 +1,135 @@
+#include "core/render_worker.hpp"
+
+#include <algorithm>
+
+// Every running worker, for drain_all()
+static std::mutex workers_mutex = {};
+static std::vector<KRenderWorker*> workers = {};
+
+KRenderWorker::KRenderWorker()
+{
+    m_thread = std::thread(&KRenderWorker::_run, this);
+
+    std::lock_guard<std::mutex> lock(workers_mutex);
+    workers.push_back(this);
+}
+
+KRenderWorker::~KRenderWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(workers_mutex);
+        workers.erase(std::find(workers.begin(), workers.end(), this));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_condition.notify_all();
+    m_thread.join();
+}
+
+void KRenderWorker::record(const KRenderSnapshot& snapshot, KRenderCommandList& command_list)
+{
+    command_list.view_projection = snapshot.view_projection;
+    command_list.clear_color = snapshot.clear_color;
+
+    // NOTE: KCMeshRenderer only references a model for now, so every item uses the default
+    // shader and material slots of the sort key
+    command_list.queue.clear();
+    for (const KRenderSnapshotItem& item : snapshot.items)
+        command_list.queue.push(item.model, item.transform, item.lod);
+    command_list.queue.build();
+}
+
+void KRenderWorker::drain_all()
+{
+    std::lock_guard<std::mutex> lock(workers_mutex);
+    for (KRenderWorker* worker : workers)
+        worker->_drain();
+}
+
+void KRenderWorker::submit(KRenderSnapshot&& snapshot)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_snapshot = std::move(snapshot);
+        m_has_snapshot = true;
+    }
+
+    m_condition.notify_all();
+}
+
+const KRenderCommandList* KRenderWorker::begin_replay()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_front_ready)
+        return nullptr;
+
+    m_front_ready = false;
+    m_replaying = true;
+    m_replay_index = m_front;
+    return &m_command_lists[m_front];
+}
+
+void KRenderWorker::end_replay()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_replaying = false;
+    }
+
+    m_condition.notify_all();
+}
+
+void KRenderWorker::_run()
+{
+    KRenderSnapshot snapshot = {};
+    while (true)
+    {
+        int back = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stop || m_has_snapshot; });
+            if (m_stop)
+                return;
+
+            std::swap(snapshot, m_snapshot);
+            m_has_snapshot = false;
+
+            // The back list can still be the one being replayed when the front was swapped
+            // during the replay
+            back = 1 - m_front;
+            m_condition.wait(
+                lock, [this, back]() { return m_stop || !m_replaying || m_replay_index != back; }
+            );
+            if (m_stop)
+                return;
+            m_recording = true;
+        }
+
+        record(snapshot, m_command_lists[back]);
+        snapshot.items.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_recording = false;
+            m_front = back;
+            m_front_ready = true;
+        }
+        m_condition.notify_all();
+    }
+}
+
+void KRenderWorker::_drain()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this]() { return !m_recording; });
+
+    m_snapshot.items.clear();
+    m_has_snapshot = false;
+    m_front_ready = false;
+    for (KRenderCommandList& command_list : m_command_lists)
+        command_list.queue.clear();
+}
@@ -0,0 +1,85 @@
+#ifndef __KRYOS_EDITOR_CORE_RENDER_WORKER_HPP__
+#define __KRYOS_EDITOR_CORE_RENDER_WORKER_HPP__
+
+#include "core/render_queue.hpp"
+
+#include <kryos/scene/components.hpp>
+
+#include <condition_variable>
+#include <glm/glm.hpp>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct KRenderSnapshotItem
+{
+    KModelHandle model = {};
+    // World matrix, parents included
+    glm::mat4 transform = glm::mat4(1.0f);
+    std::uint32_t lod = 0;
+};
+
+// Copy of everything needed to record a frame, taken on the main thread so the worker never
+// touches the registry while panels are editing it
+struct KRenderSnapshot
+{
+    glm::mat4 view_projection = glm::mat4(1.0f);
+    glm::vec4 clear_color = glm::vec4(0.0f);
+    std::vector<KRenderSnapshotItem> items = {};
+};
+
+// Recorded frame, only replayed by the GL thread
+struct KRenderCommandList
+{
+    glm::mat4 view_projection = glm::mat4(1.0f);
+    glm::vec4 clear_color = glm::vec4(0.0f);
+    KRenderQueue queue = {};
+};
+
+// Records snapshots into one of two command lists on a worker thread, so the next frame can be
+// recorded while the GL thread replays the last one. Only the newest recorded list is replayed,
+// lists the GL thread never picked up are dropped.
+// Snapshots and lists point at models without owning them, anything about to free or replace a
+// model calls drain_all() first
+class KRenderWorker
+{
+  public:
+    KRenderWorker();
+    ~KRenderWorker();
+
+    static void record(const KRenderSnapshot& snapshot, KRenderCommandList& command_list);
+    // Waits for every worker to finish the list it's recording, then drops it along with
+    // snapshots still waiting and lists not replayed yet. Only called from the main thread
+    // outside of a replay
+    static void drain_all();
+
+    // Replaces any snapshot that hasn't started recording yet
+    void submit(KRenderSnapshot&& snapshot);
+
+    // Returns the newest recorded list not replayed yet or nullptr, it stays valid until
+    // end_replay() is called
+    const KRenderCommandList* begin_replay();
+    void end_replay();
+
+  private:
+    void _run();
+    void _drain();
+
+  private:
+    std::thread m_thread = {};
+    std::mutex m_mutex = {};
+    std::condition_variable m_condition = {};
+    bool m_stop = false;
+
+    KRenderSnapshot m_snapshot = {};
+    bool m_has_snapshot = false;
+    bool m_recording = false;
+
+    KRenderCommandList m_command_lists[2] = {};
+    int m_front = 0;
+    bool m_front_ready = false;
+    bool m_replaying = false;
+    int m_replay_index = 0;
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include "core/scene_changes.hpp"
+
+#include <cassert>
+
+KLSceneChanges* KLSceneChanges::m_Instance = nullptr;
+
+KLSceneChanges::KLSceneChanges()
+{
+    assert(
+        m_Instance == nullptr && "SceneChanges::SceneChanges() -> cannot created multiple scene "
+                                 "changes application layers"
+    );
+
+    m_Instance = this;
+}
+
+std::uint64_t KLSceneChanges::get_pool_mutations(std::uint64_t type_hash) const
+{
+    auto it = m_pool_mutations.find(type_hash);
+    if (it == m_pool_mutations.end())
+        return 0;
+    return it->second;
+}
+
+bool KLSceneChanges::get_structure_changes(
+    std::uint64_t version, const KStructureChange*& changes, std::size_t& count
+) const
+{
+    changes = nullptr;
+    count = 0;
+    if (version < m_structure_log_base || version > m_structure_version)
+        return false;
+
+    count = static_cast<std::size_t>(m_structure_version - version);
+    if (count > 0)
+        changes = m_structure_changes.data() + (version - m_structure_log_base);
+    return true;
+}
+
+bool KLSceneChanges::get_entity_mutations(
+    std::uint64_t version, const KEntityMutation*& mutations, std::size_t& count
+) const
+{
+    mutations = nullptr;
+    count = 0;
+    if (version < m_mutation_log_base || version > m_mutation_version)
+        return false;
+
+    count = static_cast<std::size_t>(m_mutation_version - version);
+    if (count > 0)
+        mutations = m_entity_mutations.data() + (version - m_mutation_log_base);
+    return true;
+}
+
+void KLSceneChanges::mark_pool_mutated(std::uint64_t type_hash)
+{
+    m_pool_mutations[type_hash]++;
+    m_version++;
+
+    // Nothing before this can be replayed without knowing which entities it touched
+    m_mutation_version++;
+    m_entity_mutations.clear();
+    m_mutation_log_base = m_mutation_version;
+}
+
+void KLSceneChanges::mark_entity_mutated(ecs::Entity entity, std::uint64_t type_hash)
+{
+    if (m_entity_mutations.size() == entity_mutation_log_capacity)
+    {
+        m_entity_mutations.clear();
+        m_mutation_log_base = m_mutation_version;
+    }
+
+    m_entity_mutations.push_back({entity, type_hash});
+    m_mutation_version++;
+    m_pool_mutations[type_hash]++;
+    m_version++;
+}
+
+void KLSceneChanges::mark_structure_changed()
+{
+    m_structure_version++;
+    m_version++;
+
+    // Nothing before this can be replayed without also knowing what this change was
+    m_structure_changes.clear();
+    m_structure_log_base = m_structure_version;
+}
+
+void KLSceneChanges::mark_entity_created(ecs::Entity entity)
+{
+    _record({KEStructureChange_EntityCreated, entity, 0});
+}
+
+void KLSceneChanges::mark_entity_destroyed(ecs::Entity entity)
+{
+    _record({KEStructureChange_EntityDestroyed, entity, 0});
+}
+
+void KLSceneChanges::mark_component_added(ecs::Entity entity, std::uint64_t type_hash)
+{
+    _record({KEStructureChange_ComponentAdded, entity, type_hash});
+}
+
+void KLSceneChanges::mark_component_removed(ecs::Entity entity, std::uint64_t type_hash)
+{
+    _record({KEStructureChange_ComponentRemoved, entity, type_hash});
+}
+
+void KLSceneChanges::mark_assets_reloaded()
+{
+    m_asset_version++;
+    m_version++;
+}
+
+void KLSceneChanges::mark_selection_changed()
+{
+    m_selection_version++;
+    m_version++;
+}
+
+void KLSceneChanges::_record(const KStructureChange& change)
+{
+    if (m_structure_changes.size() == structure_change_log_capacity)
+    {
+        m_structure_changes.clear();
+        m_structure_log_base = m_structure_version;
+    }
+
+    m_structure_changes.push_back(change);
+    m_structure_version++;
+    m_version++;
+}
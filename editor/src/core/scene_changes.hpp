@@ -0,0 +1,105 @@
+#ifndef __KRYOS_EDITOR_CORE_SCENE_CHANGES_HPP__
+#define __KRYOS_EDITOR_CORE_SCENE_CHANGES_HPP__
+
+#include <kryos/core/application_layer.hpp>
+#include <kryos/scene/entity.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Structure changes recorded one by one before the log is dropped and readers have to rescan
+constexpr std::size_t structure_change_log_capacity = 4096;
+// Same for edits to single entities' components, more of them are made at once
+constexpr std::size_t entity_mutation_log_capacity = 65536;
+
+enum KEStructureChange
+{
+    KEStructureChange_EntityCreated,
+    KEStructureChange_EntityDestroyed,
+    KEStructureChange_ComponentAdded,
+    KEStructureChange_ComponentRemoved,
+};
+
+struct KStructureChange
+{
+    KEStructureChange change = KEStructureChange_EntityCreated;
+    ecs::Entity entity = ECS_ENTITY_DESTROYED;
+    // Only set for components being added or removed
+    std::uint64_t type_hash = 0;
+};
+
+struct KEntityMutation
+{
+    ecs::Entity entity = ECS_ENTITY_DESTROYED;
+    std::uint64_t type_hash = 0;
+};
+
+// Counts every mutation the editor makes to the active scene so that panels can tell whether
+// anything has changed since they last looked, without diffing the registry themselves
+class KLSceneChanges : public KIApplicationLayer
+{
+  public:
+    inline static KLSceneChanges* get() { return m_Instance; }
+
+  public:
+    KLSceneChanges();
+    virtual ~KLSceneChanges() override = default;
+
+    inline std::uint64_t get_version() const { return m_version; }
+    inline std::uint64_t get_structure_version() const { return m_structure_version; }
+    inline std::uint64_t get_asset_version() const { return m_asset_version; }
+    inline std::uint64_t get_selection_version() const { return m_selection_version; }
+    inline std::uint64_t get_mutation_version() const { return m_mutation_version; }
+    std::uint64_t get_pool_mutations(std::uint64_t type_hash) const;
+    // The edits to single entities made since the mutation version. Returns false when some pool
+    // was mutated as a whole since then and readers have to revisit every entity
+    bool get_entity_mutations(
+        std::uint64_t version, const KEntityMutation*& mutations, std::size_t& count
+    ) const;
+    // The changes that took the structure from version to the current one. Returns false when
+    // some of them were only marked as a structure change, or fell out of the log, and the reader
+    // has to rescan the registry
+    bool get_structure_changes(
+        std::uint64_t version, const KStructureChange*& changes, std::size_t& count
+    ) const;
+
+    // Mutates components of the type on any number of entities, none of them are recorded
+    void mark_pool_mutated(std::uint64_t type_hash);
+    // Mutates the entity's component of the type, counts as a mutation of its pool as well
+    void mark_entity_mutated(ecs::Entity entity, std::uint64_t type_hash);
+    // Changes the structure in a way that isn't recorded, for edits that touch many entities
+    void mark_structure_changed();
+    // A created entity is read with whatever components it has by the time the log is read
+    void mark_entity_created(ecs::Entity entity);
+    void mark_entity_destroyed(ecs::Entity entity);
+    void mark_component_added(ecs::Entity entity, std::uint64_t type_hash);
+    void mark_component_removed(ecs::Entity entity, std::uint64_t type_hash);
+    void mark_assets_reloaded();
+    void mark_selection_changed();
+
+  private:
+    static KLSceneChanges* m_Instance;
+
+  private:
+    void _record(const KStructureChange& change);
+
+  private:
+    std::uint64_t m_version = 0;
+    std::uint64_t m_structure_version = 0;
+    std::uint64_t m_asset_version = 0;
+    std::uint64_t m_selection_version = 0;
+    std::uint64_t m_mutation_version = 0;
+    std::unordered_map<std::uint64_t, std::uint64_t> m_pool_mutations = {};
+
+    // Entry i took the structure from version m_structure_log_base + i
+    std::vector<KStructureChange> m_structure_changes = {};
+    std::uint64_t m_structure_log_base = 0;
+
+    // Entry i took the mutations from version m_mutation_log_base + i
+    std::vector<KEntityMutation> m_entity_mutations = {};
+    std::uint64_t m_mutation_log_base = 0;
+};
+
+#endif
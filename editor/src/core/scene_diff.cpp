@@ -0,0 +1,937 @@
+#include "core/scene_diff.hpp"
+#include "core/component_columns.hpp"
+#include "core/derived_data_cache.hpp"
+#include "core/editor_entities.hpp"
+#include "core/mapped_file.hpp"
+#include "core/member_tables.hpp"
+#include "core/scene_changes.hpp"
+
+#include <kryos/core/application.hpp>
+#include <kryos/core/debug.hpp>
+#include <kryos/serialization/reflection.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <unordered_set>
+
+template<typename _Type>
+static void write_value(std::ofstream& file, const _Type& value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(_Type));
+}
+
+static void write_string(std::ofstream& file, const std::string& value)
+{
+    write_value(file, static_cast<std::uint32_t>(value.size()));
+    file.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+template<typename _Type>
+static bool read_value(KMappedFileReader& file, _Type& value)
+{
+    return file.read(&value, sizeof(_Type));
+}
+
+static bool read_string(KMappedFileReader& file, std::string& value)
+{
+    std::uint32_t size = 0;
+    if (!read_value(file, size) || size > (1u << 20))
+        return false;
+
+    value.resize(size);
+    return file.read(value.data(), size);
+}
+
+static double milliseconds_since(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static std::vector<ecs::Entity> get_scene_entities(KScene* scene)
+{
+    KLEditorEntities* editor_entities = KLEditorEntities::get();
+    std::vector<ecs::Entity> entities = {};
+    for (ecs::Entity entity : scene->get_registry().get_entities())
+    {
+        if (entity != ECS_ENTITY_DESTROYED && !editor_entities->is_editor_entity(scene, entity))
+            entities.push_back(entity);
+    }
+    return entities;
+}
+
+static ecs::ObjectPool* find_pool(ecs::Registry& registry, std::uint64_t type)
+{
+    for (ecs::ObjectPool* pool : registry.get_pools())
+    {
+        if (pool->get_type_hash() == type)
+            return pool;
+    }
+    return nullptr;
+}
+
+static inline const std::uint8_t* get_object(ecs::ObjectPool* pool, ecs::Entity entity)
+{
+    return pool != nullptr ? reinterpret_cast<const std::uint8_t*>(pool->get_entitys_object(entity))
+                           : nullptr;
+}
+
+template<typename... _Types>
+static std::unordered_set<std::uint64_t> type_ids()
+{
+    return {KTypeId::create<_Types>().get_id()...};
+}
+
+// Most fields are made of floats or ints, anything else is shown as its bytes
+static std::string format_value(
+    std::uint64_t type_id, const std::uint8_t* value, std::uint32_t size
+)
+{
+    static const std::unordered_set<std::uint64_t> float_types =
+        type_ids<float, glm::vec2, glm::vec3, glm::vec4, glm::quat, glm::mat3, glm::mat4>();
+    static const std::unordered_set<std::uint64_t> int_types =
+        type_ids<std::int32_t, glm::ivec2, glm::ivec3, glm::ivec4>();
+
+    std::string text = {};
+    char buffer[32] = {};
+    bool floats = float_types.contains(type_id);
+    if (floats || int_types.contains(type_id))
+    {
+        for (std::uint32_t offset = 0; offset + 4 <= size; offset += 4)
+        {
+            float float_value = 0.0f;
+            std::int32_t int_value = 0;
+            std::memcpy(&float_value, value + offset, sizeof(float));
+            std::memcpy(&int_value, value + offset, sizeof(std::int32_t));
+            if (floats)
+                std::snprintf(buffer, sizeof(buffer), "%g", static_cast<double>(float_value));
+            else
+                std::snprintf(buffer, sizeof(buffer), "%d", int_value);
+            text += (offset > 0 ? ", " : "") + std::string(buffer);
+        }
+        return text;
+    }
+
+    for (std::uint32_t i = 0; i < std::min(size, 16u); i++)
+    {
+        std::snprintf(buffer, sizeof(buffer), "%02x", value[i]);
+        text += buffer;
+    }
+    return text + (size > 16 ? "..." : "");
+}
+
+static inline const std::string& string_at(const std::uint8_t* object, std::uint32_t offset)
+{
+    return *reinterpret_cast<const std::string*>(object + offset);
+}
+
+// What a conflict or a patch entry is keyed by, entity ops leave type and field at 0
+struct KPatchKey
+{
+    ecs::Entity entity = ECS_ENTITY_DESTROYED;
+    std::uint64_t type = 0;
+    std::uint32_t field = 0;
+
+    inline bool operator==(const KPatchKey& other) const
+    {
+        return entity == other.entity && type == other.type && field == other.field;
+    }
+};
+
+struct KPatchKeyHash
+{
+    inline std::size_t operator()(const KPatchKey& key) const
+    {
+        KContentHasher hasher = {};
+        hasher.update(key.entity);
+        hasher.update(key.type);
+        hasher.update(static_cast<std::uint64_t>(key.field));
+        return static_cast<std::size_t>(hasher.finish());
+    }
+};
+
+KScenePatch KSceneDiff::diff(KScene* base, KScene* other)
+{
+    m_stats = {};
+    m_skipped_types.clear();
+
+    KScenePatch patch = {};
+    std::vector<ecs::Entity> base_entities = get_scene_entities(base);
+    std::vector<ecs::Entity> other_entities = get_scene_entities(other);
+    std::unordered_set<ecs::Entity> base_set =
+        std::unordered_set<ecs::Entity>(base_entities.begin(), base_entities.end());
+    std::unordered_set<ecs::Entity> other_set =
+        std::unordered_set<ecs::Entity>(other_entities.begin(), other_entities.end());
+    m_stats.entity_count = std::max(base_entities.size(), other_entities.size());
+
+    // Pools are only hashed and compared over the entities both scenes have, added and removed
+    // entities don't keep a pool from being skipped
+    std::vector<ecs::Entity> common = {};
+    common.reserve(base_entities.size());
+    for (ecs::Entity entity : base_entities)
+    {
+        if (other_set.contains(entity))
+            common.push_back(entity);
+        else
+        {
+            KScenePatchEntry entry = {};
+            entry.op = KEScenePatchOp_RemoveEntity;
+            entry.entity = entity;
+            patch.entries.push_back(entry);
+        }
+    }
+
+    ecs::Registry& base_registry = base->get_registry();
+    ecs::Registry& other_registry = other->get_registry();
+    std::vector<std::uint64_t> types = {};
+    std::unordered_map<std::uint64_t, std::string> type_names = {};
+    for (ecs::Registry* registry : {&base_registry, &other_registry})
+    {
+        for (ecs::ObjectPool* pool : registry->get_pools())
+        {
+            if (type_names.emplace(pool->get_type_hash(), pool->get_name()).second)
+                types.push_back(pool->get_type_hash());
+        }
+    }
+
+    for (std::uint64_t type : types)
+    {
+        const KDiffLayout& layout = _get_layout(type);
+        if (!layout.supported)
+        {
+            m_skipped_types.push_back(type_names[type]);
+            continue;
+        }
+
+        m_stats.pool_count++;
+        ecs::ObjectPool* base_pool = find_pool(base_registry, type);
+        ecs::ObjectPool* other_pool = find_pool(other_registry, type);
+        if (base_pool != nullptr && other_pool != nullptr)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            bool same = _hash_pool(base_pool, common, layout) ==
+                        _hash_pool(other_pool, common, layout);
+            m_stats.hash_time += milliseconds_since(start);
+            if (same)
+            {
+                m_stats.skipped_pool_count++;
+                continue;
+            }
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (ecs::Entity entity : common)
+        {
+            const std::uint8_t* base_object = get_object(base_pool, entity);
+            const std::uint8_t* other_object = get_object(other_pool, entity);
+            if (base_object == nullptr && other_object == nullptr)
+                continue;
+
+            m_stats.compared_count++;
+            if (other_object == nullptr)
+            {
+                KScenePatchEntry entry = {};
+                entry.op = KEScenePatchOp_RemoveComponent;
+                entry.entity = entity;
+                entry.type = type;
+                patch.entries.push_back(entry);
+            }
+            else if (base_object == nullptr)
+                _add_component(patch, entity, type, layout, other_object);
+            else if (!_is_equal(layout, base_object, other_object))
+            {
+                for (std::uint32_t i = 0; i < layout.fields.size(); i++)
+                {
+                    const KDiffField& field = layout.fields[i];
+                    bool equal = field.string ? string_at(base_object, field.offset) ==
+                                                    string_at(other_object, field.offset)
+                                              : std::memcmp(
+                                                    base_object + field.offset,
+                                                    other_object + field.offset, field.size
+                                                ) == 0;
+                    if (!equal)
+                        _set_field(patch, entity, type, i, field, other_object);
+                }
+            }
+        }
+        m_stats.compare_time += milliseconds_since(start);
+    }
+
+    for (ecs::Entity entity : other_entities)
+    {
+        if (base_set.contains(entity))
+            continue;
+
+        KScenePatchEntry entry = {};
+        entry.op = KEScenePatchOp_AddEntity;
+        entry.entity = entity;
+        patch.entries.push_back(entry);
+
+        for (ecs::ObjectPool* pool : other_registry.get_pools())
+        {
+            const std::uint8_t* object = get_object(pool, entity);
+            const KDiffLayout& layout = _get_layout(pool->get_type_hash());
+            if (object != nullptr && layout.supported)
+                _add_component(patch, entity, pool->get_type_hash(), layout, object);
+        }
+    }
+
+    // An added entity's entries were pushed together, starting with the entity itself
+    std::stable_sort(
+        patch.entries.begin(), patch.entries.end(),
+        [](const KScenePatchEntry& a, const KScenePatchEntry& b) { return a.entity < b.entity; }
+    );
+    return patch;
+}
+
+KScenePatch KSceneDiff::merge(
+    const KScenePatch& ours, const KScenePatch& theirs, std::vector<KSceneConflict>& conflicts
+)
+{
+    std::unordered_set<ecs::Entity> removed_entities = {};
+    std::unordered_set<ecs::Entity> changed_entities = {};
+    std::unordered_set<KPatchKey, KPatchKeyHash> removed_components = {};
+    std::unordered_set<KPatchKey, KPatchKeyHash> added_components = {};
+    std::unordered_set<KPatchKey, KPatchKeyHash> changed_components = {};
+    std::unordered_map<KPatchKey, const KScenePatchEntry*, KPatchKeyHash> fields = {};
+    for (const KScenePatchEntry& entry : ours.entries)
+    {
+        KPatchKey component = {entry.entity, entry.type, 0};
+        switch (entry.op)
+        {
+        case KEScenePatchOp_AddEntity:
+            break;
+        case KEScenePatchOp_RemoveEntity:
+            removed_entities.insert(entry.entity);
+            break;
+        case KEScenePatchOp_AddComponent:
+            added_components.insert(component);
+            changed_components.insert(component);
+            changed_entities.insert(entry.entity);
+            break;
+        case KEScenePatchOp_RemoveComponent:
+            removed_components.insert(component);
+            changed_entities.insert(entry.entity);
+            break;
+        case KEScenePatchOp_SetField:
+            fields.emplace(KPatchKey{entry.entity, entry.type, entry.field}, &entry);
+            changed_components.insert(component);
+            changed_entities.insert(entry.entity);
+            break;
+        }
+    }
+
+    auto conflict = [&](const KScenePatchEntry& entry, const std::string& description)
+    {
+        conflicts.push_back({entry.entity, describe(theirs, entry) + ": " + description});
+    };
+
+    // Entities theirs added only exist in theirs, even when ours added one with the same id
+    std::unordered_set<ecs::Entity> added_entities = {};
+    KScenePatch merged = {};
+    for (const KScenePatchEntry& entry : theirs.entries)
+    {
+        if (entry.op == KEScenePatchOp_AddEntity)
+            added_entities.insert(entry.entity);
+        if (added_entities.contains(entry.entity))
+        {
+            _take(merged, theirs, entry);
+            continue;
+        }
+
+        KPatchKey component = {entry.entity, entry.type, 0};
+        bool entity_removed = removed_entities.contains(entry.entity);
+        switch (entry.op)
+        {
+        case KEScenePatchOp_AddEntity:
+            break;
+        case KEScenePatchOp_RemoveEntity:
+            if (entity_removed)
+                break;
+            if (changed_entities.contains(entry.entity))
+                conflict(entry, "removed by theirs, changed by ours");
+            else
+                _take(merged, theirs, entry);
+            break;
+        case KEScenePatchOp_AddComponent:
+            if (entity_removed)
+                conflict(entry, "added by theirs, entity removed by ours");
+            else if (!added_components.contains(component))
+                _take(merged, theirs, entry);
+            break;
+        case KEScenePatchOp_RemoveComponent:
+            if (entity_removed || removed_components.contains(component))
+                break;
+            if (changed_components.contains(component))
+                conflict(entry, "removed by theirs, changed by ours");
+            else
+                _take(merged, theirs, entry);
+            break;
+        case KEScenePatchOp_SetField:
+        {
+            if (entity_removed || removed_components.contains(component))
+            {
+                conflict(entry, "changed by theirs, removed by ours");
+                break;
+            }
+
+            auto it = fields.find(KPatchKey{entry.entity, entry.type, entry.field});
+            if (it == fields.end())
+            {
+                _take(merged, theirs, entry);
+                break;
+            }
+
+            const KScenePatchEntry& our_entry = *it->second;
+            bool same = our_entry.value_size == entry.value_size &&
+                        std::memcmp(
+                            ours.values.data() + our_entry.value_offset,
+                            theirs.values.data() + entry.value_offset, entry.value_size
+                        ) == 0;
+            if (!same)
+                conflict(entry, "changed differently by ours and theirs");
+            break;
+        }
+        }
+    }
+    return merged;
+}
+
+bool KSceneDiff::apply(KScene* scene, const KScenePatch& patch)
+{
+    KLReflectionRegistry* reflection = KIApplication::get_layer<KLReflectionRegistry>();
+    KLSceneChanges* changes = KLSceneChanges::get();
+
+    std::unordered_set<ecs::Entity> alive = {};
+    for (ecs::Entity entity : get_scene_entities(scene))
+        alive.insert(entity);
+
+    std::unordered_map<ecs::Entity, ecs::Entity> created = {};
+    std::vector<KPatchKey> removed_components = {};
+    bool succeeded = true;
+    auto fail = [&](const KScenePatchEntry& entry, const std::string& reason)
+    {
+        KLDebug::log(
+            "SceneDiff::apply() -> can't apply '" + describe(patch, entry) + "', " + reason,
+            KEDebugType_Error
+        );
+        succeeded = false;
+    };
+
+    for (const KScenePatchEntry& entry : patch.entries)
+    {
+        auto created_it = created.find(entry.entity);
+        ecs::Entity entity = created_it != created.end() ? created_it->second : entry.entity;
+        if (entry.op == KEScenePatchOp_AddEntity)
+        {
+            ecs::Entity created_entity = KEntity(true);
+            created[entry.entity] = created_entity;
+            alive.insert(created_entity);
+            changes->mark_structure_changed();
+            continue;
+        }
+
+        if (!alive.contains(entity))
+        {
+            fail(entry, "the entity doesn't exist");
+            continue;
+        }
+
+        KEntity handle = KEntity(entity);
+        switch (entry.op)
+        {
+        case KEScenePatchOp_AddEntity:
+            break;
+        case KEScenePatchOp_RemoveEntity:
+            handle.destroy();
+            alive.erase(entity);
+            changes->mark_structure_changed();
+            break;
+        case KEScenePatchOp_AddComponent:
+            if (handle.get_component(entry.type) == nullptr)
+                handle.add_component(reflection, entry.type);
+            changes->mark_pool_mutated(entry.type);
+            changes->mark_structure_changed();
+            break;
+        case KEScenePatchOp_RemoveComponent:
+            removed_components.push_back({entity, entry.type, 0});
+            break;
+        case KEScenePatchOp_SetField:
+        {
+            const KDiffLayout& layout = _get_layout(entry.type);
+            std::uint8_t* object =
+                reinterpret_cast<std::uint8_t*>(handle.get_component(entry.type));
+            if (!layout.supported || entry.field >= layout.fields.size() || object == nullptr)
+            {
+                fail(entry, "the entity doesn't have the field");
+                break;
+            }
+
+            const KDiffField& field = layout.fields[entry.field];
+            const std::uint8_t* value = patch.values.data() + entry.value_offset;
+            if (field.string)
+            {
+                *reinterpret_cast<std::string*>(object + field.offset) =
+                    std::string(reinterpret_cast<const char*>(value), entry.value_size);
+            }
+            else if (field.size == entry.value_size)
+                std::memcpy(object + field.offset, value, field.size);
+            else
+                fail(entry, "the field's size changed");
+            changes->mark_entity_mutated(entity, entry.type);
+            break;
+        }
+        }
+    }
+
+    // Recreated last, the patch's other entries still refer to the entities by their old ids
+    for (const KPatchKey& component : removed_components)
+    {
+        if (alive.contains(component.entity) && !_recreate(scene, component.entity, component.type))
+            succeeded = false;
+    }
+    return succeeded;
+}
+
+std::string KSceneDiff::describe(const KScenePatch& patch, const KScenePatchEntry& entry)
+{
+    std::string entity = "entity " + std::to_string(entry.entity);
+    switch (entry.op)
+    {
+    case KEScenePatchOp_AddEntity:
+        return "+ " + entity;
+    case KEScenePatchOp_RemoveEntity:
+        return "- " + entity;
+    case KEScenePatchOp_AddComponent:
+        return "+ " + entity + " " + _get_layout(entry.type).name;
+    case KEScenePatchOp_RemoveComponent:
+        return "- " + entity + " " + _get_layout(entry.type).name;
+    case KEScenePatchOp_SetField:
+        break;
+    }
+
+    const KDiffLayout& layout = _get_layout(entry.type);
+    if (entry.field >= layout.fields.size())
+        return "~ " + entity + " " + layout.name;
+
+    const KDiffField& field = layout.fields[entry.field];
+    const std::uint8_t* value = patch.values.data() + entry.value_offset;
+    std::string text = "~ " + entity + " " + layout.name + "." + field.name + " = ";
+    if (field.string)
+        return text + "\"" + std::string(reinterpret_cast<const char*>(value), entry.value_size) +
+               "\"";
+    return text + format_value(field.type_id, value, entry.value_size);
+}
+
+bool KSceneDiff::write(const KScenePatch& patch, const std::string& filename)
+{
+    // Types are written once by name and entries refer to them by index
+    std::vector<std::uint64_t> types = {};
+    std::unordered_map<std::uint64_t, std::uint32_t> type_indices = {};
+    for (const KScenePatchEntry& entry : patch.entries)
+    {
+        bool component_op = entry.op == KEScenePatchOp_AddComponent ||
+                            entry.op == KEScenePatchOp_RemoveComponent ||
+                            entry.op == KEScenePatchOp_SetField;
+        if (component_op && type_indices.emplace(entry.type, types.size()).second)
+            types.push_back(entry.type);
+    }
+
+    std::error_code error = {};
+    std::string temporary_filename = filename + ".tmp";
+    {
+        std::ofstream file = std::ofstream(temporary_filename, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+
+        write_value(file, scene_patch_magic);
+        write_value(file, scene_patch_version);
+        write_value(file, static_cast<std::uint32_t>(types.size()));
+        write_value(file, static_cast<std::uint32_t>(patch.entries.size()));
+        write_value(file, static_cast<std::uint32_t>(patch.values.size()));
+
+        for (std::uint64_t type : types)
+        {
+            const KDiffLayout& layout = _get_layout(type);
+            write_string(file, layout.name);
+            write_value(file, static_cast<std::uint32_t>(layout.fields.size()));
+            for (const KDiffField& field : layout.fields)
+                write_string(file, field.name);
+        }
+
+        for (const KScenePatchEntry& entry : patch.entries)
+        {
+            auto it = type_indices.find(entry.type);
+            write_value(file, static_cast<std::uint8_t>(entry.op));
+            write_value(file, static_cast<std::uint64_t>(entry.entity));
+            write_value(file, it != type_indices.end() ? it->second : 0u);
+            write_value(file, entry.field);
+            write_value(file, entry.value_offset);
+            write_value(file, entry.value_size);
+        }
+
+        file.write(
+            reinterpret_cast<const char*>(patch.values.data()),
+            static_cast<std::streamsize>(patch.values.size())
+        );
+        if (!file.good())
+            return false;
+    }
+
+    std::filesystem::rename(temporary_filename, filename, error);
+    return !error;
+}
+
+bool KSceneDiff::read(const std::string& filename, KScenePatch& patch)
+{
+    KMappedFile mapped_file = {};
+    if (!mapped_file.open(filename, 0, "SceneDiff::read()"))
+        return false;
+    KMappedFileReader file = KMappedFileReader(mapped_file);
+
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    std::uint32_t type_count = 0;
+    std::uint32_t entry_count = 0;
+    std::uint32_t value_size = 0;
+    if (!read_value(file, magic) || !read_value(file, version) || !read_value(file, type_count) ||
+        !read_value(file, entry_count) || !read_value(file, value_size) ||
+        magic != scene_patch_magic || version != scene_patch_version)
+    {
+        KLDebug::log(
+            "SceneDiff::read() -> '" + filename + "' is not a scene patch", KEDebugType_Error
+        );
+        return false;
+    }
+
+    // Types and fields are looked up by name, a patch made before a component gained members
+    // still points at the right fields
+    std::unordered_map<std::string, std::uint64_t> type_ids = {};
+    KLReflectionRegistry* reflection = KIApplication::get_layer<KLReflectionRegistry>();
+    for (const auto& [type, info] : reflection->get_all_type_infos())
+        type_ids.emplace(info.name, type);
+
+    std::vector<std::uint64_t> types = {};
+    std::vector<std::vector<std::uint32_t>> field_indices = {};
+    for (std::uint32_t i = 0; i < type_count; i++)
+    {
+        std::string name = {};
+        std::uint32_t field_count = 0;
+        if (!read_string(file, name) || !read_value(file, field_count))
+            return false;
+
+        auto type_it = type_ids.find(name);
+        const KDiffLayout* layout =
+            type_it != type_ids.end() ? &_get_layout(type_it->second) : nullptr;
+        if (layout == nullptr || !layout->supported)
+        {
+            KLDebug::log(
+                "SceneDiff::read() -> '" + filename + "' refers to " + name +
+                    " which can't be compared field by field",
+                KEDebugType_Error
+            );
+            return false;
+        }
+
+        std::vector<std::uint32_t> indices = {};
+        for (std::uint32_t j = 0; j < field_count; j++)
+        {
+            std::string field_name = {};
+            if (!read_string(file, field_name))
+                return false;
+
+            auto field_it = std::find_if(
+                layout->fields.begin(), layout->fields.end(),
+                [&](const KDiffField& field) { return field.name == field_name; }
+            );
+            // Fields that are gone can't be set anymore, entries using them fail to apply
+            indices.push_back(static_cast<std::uint32_t>(field_it - layout->fields.begin()));
+        }
+
+        types.push_back(type_it->second);
+        field_indices.push_back(std::move(indices));
+    }
+
+    patch = {};
+    patch.entries.resize(entry_count);
+    for (KScenePatchEntry& entry : patch.entries)
+    {
+        std::uint8_t op = 0;
+        std::uint64_t entity = 0;
+        std::uint32_t type = 0;
+        if (!read_value(file, op) || !read_value(file, entity) || !read_value(file, type) ||
+            !read_value(file, entry.field) || !read_value(file, entry.value_offset) ||
+            !read_value(file, entry.value_size))
+            return false;
+
+        entry.op = static_cast<KEScenePatchOp>(op);
+        entry.entity = static_cast<ecs::Entity>(entity);
+        bool component_op = entry.op == KEScenePatchOp_AddComponent ||
+                            entry.op == KEScenePatchOp_RemoveComponent ||
+                            entry.op == KEScenePatchOp_SetField;
+        bool malformed = op > KEScenePatchOp_SetField ||
+                         static_cast<std::uint64_t>(entry.value_offset) + entry.value_size >
+                             value_size ||
+                         (component_op && type >= types.size()) ||
+                         (entry.op == KEScenePatchOp_SetField &&
+                          entry.field >= field_indices[type].size());
+        if (malformed)
+        {
+            KLDebug::log(
+                "SceneDiff::read() -> '" + filename + "' is malformed", KEDebugType_Error
+            );
+            return false;
+        }
+
+        if (component_op)
+            entry.type = types[type];
+        if (entry.op == KEScenePatchOp_SetField)
+            entry.field = field_indices[type][entry.field];
+    }
+
+    patch.values.resize(value_size);
+    return file.read(patch.values.data(), value_size);
+}
+
+const KSceneDiff::KDiffLayout& KSceneDiff::_get_layout(std::uint64_t type)
+{
+    KLMemberTables* tables = KLMemberTables::get();
+    if (m_layouts_build != tables->get_build_count())
+    {
+        m_layouts.clear();
+        m_layouts_build = tables->get_build_count();
+    }
+
+    auto it = m_layouts.find(type);
+    if (it != m_layouts.end())
+        return it->second;
+
+    KLReflectionRegistry* reflection = KIApplication::get_layer<KLReflectionRegistry>();
+    KDiffLayout layout = {};
+    if (reflection->get_all_type_infos().contains(type))
+    {
+        layout.name = reflection->get_type_info(KTypeId(type)).name;
+        layout.supported = _build_layout(type, 0, "", layout, 0);
+    }
+
+    for (const KDiffField& field : layout.fields)
+    {
+        if (field.string)
+            layout.string_offsets.push_back(field.offset);
+        else if (!layout.span_offsets.empty() &&
+                 layout.span_offsets.back() + layout.span_sizes.back() == field.offset)
+            layout.span_sizes.back() += field.size;
+        else
+        {
+            layout.span_offsets.push_back(field.offset);
+            layout.span_sizes.push_back(field.size);
+        }
+    }
+
+    return m_layouts.emplace(type, std::move(layout)).first->second;
+}
+
+bool KSceneDiff::_build_layout(
+    std::uint64_t type, std::uint32_t base, const std::string& prefix, KDiffLayout& layout,
+    int depth
+) const
+{
+    // Nested a few levels deep at most, a type that refers back to itself is never comparable
+    KLMemberTables* tables = KLMemberTables::get();
+    std::uint32_t table = tables->find(type);
+    if (table == KLMemberTables::null_table || depth > 8 ||
+        !KComponentColumns::is_fully_reflected(type))
+        return false;
+
+    const std::uint64_t string_type = KTypeId::create<std::string>().get_id();
+    const KMemberTable& member_table = tables->get_table(table);
+    for (const KMemberEntry* entry = tables->begin(member_table);
+         entry != tables->end(member_table); entry++)
+    {
+        KDiffField field = {};
+        field.offset = base + entry->offset;
+        field.type_id = entry->type_id;
+        field.name = prefix + tables->get_string(entry->name);
+        std::uint32_t count = entry->flags & KEMemberEntryFlag_Array ? entry->array_size : 1;
+
+        if (entry->flags & KEMemberEntryFlag_Pointer)
+        {
+            if (entry->editor_flags & KEMemberInfoEditorFlag_OwnsPtrData)
+                return false;
+            field.size = static_cast<std::uint32_t>(sizeof(void*)) * count;
+            layout.pointers.push_back(std::move(field));
+            continue;
+        }
+
+        if (entry->flags & (KEMemberEntryFlag_StdVector | KEMemberEntryFlag_StdArray))
+            return false;
+
+        if (KComponentColumns::is_plain_type(entry->type_id))
+            field.size = entry->type_size * count;
+        else if (entry->flags & KEMemberEntryFlag_Array)
+            return false;
+        else if (entry->type_id == string_type)
+        {
+            field.string = true;
+            field.size = static_cast<std::uint32_t>(sizeof(std::string));
+        }
+        else
+        {
+            if (!_build_layout(entry->type_id, field.offset, field.name + ".", layout, depth + 1))
+                return false;
+            continue;
+        }
+
+        layout.fields.push_back(std::move(field));
+    }
+    return true;
+}
+
+std::uint64_t KSceneDiff::_hash_pool(
+    ecs::ObjectPool* pool, const std::vector<ecs::Entity>& entities, const KDiffLayout& layout
+) const
+{
+    KContentHasher hasher = {};
+    for (ecs::Entity entity : entities)
+    {
+        const std::uint8_t* object = get_object(pool, entity);
+        hasher.update(static_cast<std::uint64_t>(object != nullptr));
+        if (object == nullptr)
+            continue;
+
+        for (std::size_t i = 0; i < layout.span_offsets.size(); i++)
+            hasher.update(object + layout.span_offsets[i], layout.span_sizes[i]);
+        for (std::uint32_t offset : layout.string_offsets)
+            hasher.update(string_at(object, offset));
+    }
+    return hasher.finish();
+}
+
+bool KSceneDiff::_is_equal(
+    const KDiffLayout& layout, const std::uint8_t* a, const std::uint8_t* b
+) const
+{
+    for (std::size_t i = 0; i < layout.span_offsets.size(); i++)
+    {
+        std::uint32_t offset = layout.span_offsets[i];
+        if (std::memcmp(a + offset, b + offset, layout.span_sizes[i]) != 0)
+            return false;
+    }
+
+    for (std::uint32_t offset : layout.string_offsets)
+    {
+        if (string_at(a, offset) != string_at(b, offset))
+            return false;
+    }
+    return true;
+}
+
+void KSceneDiff::_add_component(
+    KScenePatch& patch, ecs::Entity entity, std::uint64_t type, const KDiffLayout& layout,
+    const std::uint8_t* object
+) const
+{
+    KScenePatchEntry entry = {};
+    entry.op = KEScenePatchOp_AddComponent;
+    entry.entity = entity;
+    entry.type = type;
+    patch.entries.push_back(entry);
+
+    for (std::uint32_t i = 0; i < layout.fields.size(); i++)
+        _set_field(patch, entity, type, i, layout.fields[i], object);
+}
+
+void KSceneDiff::_set_field(
+    KScenePatch& patch, ecs::Entity entity, std::uint64_t type, std::uint32_t field,
+    const KDiffField& layout_field, const std::uint8_t* object
+) const
+{
+    const std::uint8_t* value = object + layout_field.offset;
+    std::uint32_t size = layout_field.size;
+    if (layout_field.string)
+    {
+        const std::string& string = string_at(object, layout_field.offset);
+        value = reinterpret_cast<const std::uint8_t*>(string.data());
+        size = static_cast<std::uint32_t>(string.size());
+    }
+
+    KScenePatchEntry entry = {};
+    entry.op = KEScenePatchOp_SetField;
+    entry.entity = entity;
+    entry.type = type;
+    entry.field = field;
+    entry.value_offset = static_cast<std::uint32_t>(patch.values.size());
+    entry.value_size = size;
+    patch.values.insert(patch.values.end(), value, value + size);
+    patch.entries.push_back(entry);
+}
+
+void KSceneDiff::_take(
+    KScenePatch& patch, const KScenePatch& source, const KScenePatchEntry& entry
+) const
+{
+    KScenePatchEntry taken = entry;
+    taken.value_offset = static_cast<std::uint32_t>(patch.values.size());
+    const std::uint8_t* value = source.values.data() + entry.value_offset;
+    patch.values.insert(patch.values.end(), value, value + entry.value_size);
+    patch.entries.push_back(taken);
+}
+
+bool KSceneDiff::_recreate(KScene* scene, ecs::Entity entity, std::uint64_t removed_type)
+{
+    // Everything the entity keeps has to be copied over field by field
+    ecs::Registry& registry = scene->get_registry();
+    std::vector<std::uint64_t> types = {};
+    for (ecs::ObjectPool* pool : registry.get_pools())
+    {
+        if (pool->get_type_hash() == removed_type || get_object(pool, entity) == nullptr)
+            continue;
+
+        if (!_get_layout(pool->get_type_hash()).supported)
+        {
+            KLDebug::log(
+                "SceneDiff::apply() -> can't remove " + _get_layout(removed_type).name +
+                    " from entity " + std::to_string(entity) + ", its " + pool->get_name() +
+                    " can't be copied to a new entity",
+                KEDebugType_Error
+            );
+            return false;
+        }
+        types.push_back(pool->get_type_hash());
+    }
+
+    KLReflectionRegistry* reflection = KIApplication::get_layer<KLReflectionRegistry>();
+    KEntity recreated = KEntity(true);
+    for (std::uint64_t type : types)
+    {
+        recreated.add_component(reflection, type);
+
+        // Looked up after adding, the pool may have moved its components
+        const KDiffLayout& layout = _get_layout(type);
+        const std::uint8_t* source = get_object(find_pool(registry, type), entity);
+        std::uint8_t* destination = reinterpret_cast<std::uint8_t*>(recreated.get_component(type));
+        for (const KDiffField& field : layout.fields)
+        {
+            if (field.string)
+            {
+                *reinterpret_cast<std::string*>(destination + field.offset) =
+                    string_at(source, field.offset);
+            }
+            else
+                std::memcpy(destination + field.offset, source + field.offset, field.size);
+        }
+        for (const KDiffField& field : layout.pointers)
+            std::memcpy(destination + field.offset, source + field.offset, field.size);
+        KLSceneChanges::get()->mark_pool_mutated(type);
+    }
+
+    KEntity(entity).destroy();
+    KLSceneChanges::get()->mark_structure_changed();
+    return true;
+}
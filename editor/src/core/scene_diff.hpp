@@ -0,0 +1,147 @@
+#ifndef __KRYOS_EDITOR_CORE_SCENE_DIFF_HPP__
+#define __KRYOS_EDITOR_CORE_SCENE_DIFF_HPP__
+
+#include <kryos/scene/entity.hpp>
+#include <kryos/scene/scene_manager.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+constexpr const char* scene_patch_extension = ".kpatch";
+constexpr std::uint32_t scene_patch_magic = 0x5450534b; // "KSPT"
+constexpr std::uint32_t scene_patch_version = 1;
+
+enum KEScenePatchOp
+{
+    KEScenePatchOp_AddEntity,
+    KEScenePatchOp_RemoveEntity,
+    KEScenePatchOp_AddComponent,
+    KEScenePatchOp_RemoveComponent,
+    KEScenePatchOp_SetField,
+};
+
+struct KScenePatchEntry
+{
+    KEScenePatchOp op = KEScenePatchOp_SetField;
+    // Added entities keep the id they have in the scene the patch was made from, applying the
+    // patch creates them with new ids
+    ecs::Entity entity = ECS_ENTITY_DESTROYED;
+    // Unused by entity ops, field indexes the type's flattened fields
+    std::uint64_t type = 0;
+    std::uint32_t field = 0;
+    // The field's value in the patch's values, a string field's value is its characters
+    std::uint32_t value_offset = 0;
+    std::uint32_t value_size = 0;
+};
+
+// Ordered by entity, an added entity's components and fields follow it. Files refer to types and
+// fields by name so a patch still applies after unrelated members were added to a component
+struct KScenePatch
+{
+    std::vector<KScenePatchEntry> entries = {};
+    std::vector<std::uint8_t> values = {};
+
+    inline bool is_empty() const { return entries.empty(); }
+};
+
+struct KSceneConflict
+{
+    ecs::Entity entity = ECS_ENTITY_DESTROYED;
+    std::string description = {};
+};
+
+struct KSceneDiffStats
+{
+    std::size_t entity_count = 0;
+    std::size_t pool_count = 0;
+    // Pools whose hashes matched, their components weren't compared one by one
+    std::size_t skipped_pool_count = 0;
+    std::size_t compared_count = 0;
+    double hash_time = 0.0;
+    double compare_time = 0.0;
+};
+
+// Structural diff of two scenes. Entities are aligned by the ids they were saved with and
+// components are compared field by field through their flattened reflected members. Each pool is
+// hashed over the entities both scenes have first, pools that hash the same are skipped whole.
+// Pointer fields aren't compared, an address means nothing in another scene
+class KSceneDiff
+{
+  public:
+    KSceneDiff() = default;
+    ~KSceneDiff() = default;
+
+    inline const KSceneDiffStats& get_stats() const { return m_stats; }
+    // Components that can't be compared field by field, changes to them are missing from patches
+    inline const std::vector<std::string>& get_skipped_types() const { return m_skipped_types; }
+
+    KScenePatch diff(KScene* base, KScene* other);
+    // Both patches were made against the same base. Changes only theirs made are kept and changes
+    // both made the same way only once, conflicting changes keep ours and are reported
+    KScenePatch merge(
+        const KScenePatch& ours, const KScenePatch& theirs, std::vector<KSceneConflict>& conflicts
+    );
+    // The scene has to be the active one, entities are created and destroyed through it. A
+    // removed component can only be removed by recreating its entity, which gets a new id
+    bool apply(KScene* scene, const KScenePatch& patch);
+
+    std::string describe(const KScenePatch& patch, const KScenePatchEntry& entry);
+    bool write(const KScenePatch& patch, const std::string& filename);
+    bool read(const std::string& filename, KScenePatch& patch);
+
+  private:
+    struct KDiffField
+    {
+        std::uint32_t offset = 0;
+        std::uint32_t size = 0;
+        bool string = false;
+        std::uint64_t type_id = 0;
+        std::string name = {};
+    };
+
+    struct KDiffLayout
+    {
+        bool supported = false;
+        std::string name = {};
+        std::vector<KDiffField> fields = {};
+        // Neighbouring byte fields merged, hashed and compared with one call each
+        std::vector<std::uint32_t> span_offsets = {};
+        std::vector<std::uint32_t> span_sizes = {};
+        std::vector<std::uint32_t> string_offsets = {};
+        // Never compared, only carried over when an entity is recreated
+        std::vector<KDiffField> pointers = {};
+    };
+
+    const KDiffLayout& _get_layout(std::uint64_t type);
+    bool _build_layout(
+        std::uint64_t type, std::uint32_t base, const std::string& prefix, KDiffLayout& layout,
+        int depth
+    ) const;
+    std::uint64_t _hash_pool(
+        ecs::ObjectPool* pool, const std::vector<ecs::Entity>& entities, const KDiffLayout& layout
+    ) const;
+    bool _is_equal(const KDiffLayout& layout, const std::uint8_t* a, const std::uint8_t* b) const;
+    void _add_component(
+        KScenePatch& patch, ecs::Entity entity, std::uint64_t type, const KDiffLayout& layout,
+        const std::uint8_t* object
+    ) const;
+    void _set_field(
+        KScenePatch& patch, ecs::Entity entity, std::uint64_t type, std::uint32_t field,
+        const KDiffField& layout_field, const std::uint8_t* object
+    ) const;
+    void _take(KScenePatch& patch, const KScenePatch& source, const KScenePatchEntry& entry) const;
+    bool _recreate(KScene* scene, ecs::Entity entity, std::uint64_t removed_type);
+
+  private:
+    KSceneDiffStats m_stats = {};
+    std::vector<std::string> m_skipped_types = {};
+
+    // Rebuilt whenever the member tables are
+    std::unordered_map<std::uint64_t, KDiffLayout> m_layouts = {};
+    std::size_t m_layouts_build = 0;
+};
+
+#endif
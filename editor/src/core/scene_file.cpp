@@ -0,0 +1,426 @@
+#include "core/scene_file.hpp"
+#include "core/component_columns.hpp"
+#include "core/mapped_file.hpp"
+#include "core/member_tables.hpp"
+#include "core/scene_changes.hpp"
+
+#include <kryos/core/application.hpp>
+#include <kryos/core/debug.hpp>
+#include <kryos/serialization/reflection.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+// Entities referenced by a field that aren't in the file, written as no entity
+static constexpr std::uint32_t null_entity_index = ~0u;
+
+template<typename _Type>
+static void write_value(std::ofstream& file, const _Type& value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(_Type));
+}
+
+static void write_string(std::ofstream& file, const std::string& value)
+{
+    write_value(file, static_cast<std::uint32_t>(value.size()));
+    file.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+template<typename _Type>
+static bool read_value(KMappedFileReader& file, _Type& value)
+{
+    return file.read(&value, sizeof(_Type));
+}
+
+static bool read_string(KMappedFileReader& file, std::string& value)
+{
+    std::uint32_t size = 0;
+    if (!read_value(file, size) || size > (1u << 24))
+        return false;
+
+    value.resize(size);
+    return file.read(value.data(), size);
+}
+
+static bool build_fields(
+    std::uint64_t type, std::uint32_t base, const std::string& prefix,
+    std::vector<KSceneField>& fields, int depth
+)
+{
+    KLMemberTables* tables = KLMemberTables::get();
+    std::uint32_t table = tables->find(type);
+    if (table == KLMemberTables::null_table || depth > 8 ||
+        !KComponentColumns::is_fully_reflected(type))
+        return false;
+
+    // NOTE: Assumes ecs::Entity has a type id of its own. If it's an alias of an integer type,
+    // every member of that type is read back as an entity reference
+    const std::uint64_t entity_type = KTypeId::create<ecs::Entity>().get_id();
+    const std::uint64_t string_type = KTypeId::create<std::string>().get_id();
+    const KMemberTable& member_table = tables->get_table(table);
+    for (const KMemberEntry* entry = tables->begin(member_table);
+         entry != tables->end(member_table); entry++)
+    {
+        KSceneField field = {};
+        field.offset = base + entry->offset;
+        field.name = prefix + tables->get_string(entry->name);
+        bool array = entry->flags & KEMemberEntryFlag_Array;
+
+        // An address means nothing to the next session and containers own heap memory
+        if (entry->flags & (KEMemberEntryFlag_Pointer | KEMemberEntryFlag_StdVector |
+                            KEMemberEntryFlag_StdArray))
+            return false;
+        else if (entry->type_id == entity_type && !array)
+        {
+            field.kind = KESceneFieldKind_Entity;
+            field.size = static_cast<std::uint32_t>(sizeof(ecs::Entity));
+        }
+        else if (KComponentColumns::is_plain_type(entry->type_id))
+        {
+            field.kind = KESceneFieldKind_Bytes;
+            field.size = entry->type_size * (array ? entry->array_size : 1);
+        }
+        else if (array)
+            return false;
+        else if (entry->type_id == string_type)
+        {
+            field.kind = KESceneFieldKind_String;
+            field.size = static_cast<std::uint32_t>(sizeof(std::string));
+        }
+        else
+        {
+            if (!build_fields(entry->type_id, field.offset, field.name + ".", fields, depth + 1))
+                return false;
+            continue;
+        }
+
+        fields.push_back(std::move(field));
+    }
+    return true;
+}
+
+KSceneLayout KSceneFile::get_layout(std::uint64_t type)
+{
+    KLReflectionRegistry* reflection = KIApplication::get_layer<KLReflectionRegistry>();
+
+    KSceneLayout layout = {};
+    layout.type_name = reflection->get_type_info(KTypeId(type)).name;
+    layout.supported = build_fields(type, 0, "", layout.fields, 0);
+    if (!layout.supported)
+        layout.fields.clear();
+    return layout;
+}
+
+bool KSceneFile::can_write(KScene* scene, std::string& type_name)
+{
+    ecs::Registry& registry = scene->get_registry();
+    for (ecs::ObjectPool* pool : registry.get_pools())
+    {
+        KSceneLayout layout = get_layout(pool->get_type_hash());
+        if (layout.supported)
+            continue;
+
+        // Types nothing in the scene has a component of don't need to be written
+        for (ecs::Entity entity : registry.get_entities())
+        {
+            if (entity != ECS_ENTITY_DESTROYED && pool->get_entitys_object(entity) != nullptr)
+            {
+                type_name = layout.type_name;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool KSceneFile::write(KScene* scene, const std::string& filename)
+{
+    ecs::Registry& registry = scene->get_registry();
+
+    std::vector<ecs::Entity> entities = {};
+    std::unordered_map<ecs::Entity, std::uint32_t> entity_indices = {};
+    for (ecs::Entity entity : registry.get_entities())
+    {
+        if (entity == ECS_ENTITY_DESTROYED)
+            continue;
+
+        entity_indices.emplace(entity, static_cast<std::uint32_t>(entities.size()));
+        entities.push_back(entity);
+    }
+
+    std::vector<ecs::ObjectPool*> pools = {};
+    std::vector<KSceneLayout> layouts = {};
+    for (ecs::ObjectPool* pool : registry.get_pools())
+    {
+        KSceneLayout layout = get_layout(pool->get_type_hash());
+        if (!layout.supported)
+        {
+            for (ecs::Entity entity : entities)
+            {
+                if (pool->get_entitys_object(entity) != nullptr)
+                    return false;
+            }
+            continue;
+        }
+
+        pools.push_back(pool);
+        layouts.push_back(std::move(layout));
+    }
+
+    std::string temporary_filename = filename + ".tmp";
+    {
+        std::ofstream file = std::ofstream(temporary_filename, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+
+        write_value(file, scene_file_magic);
+        write_value(file, scene_file_version);
+        write_value(file, static_cast<std::uint32_t>(layouts.size()));
+        for (const KSceneLayout& layout : layouts)
+        {
+            write_string(file, layout.type_name);
+            write_value(file, static_cast<std::uint32_t>(layout.fields.size()));
+            for (const KSceneField& field : layout.fields)
+            {
+                write_string(file, field.name);
+                write_value(file, static_cast<std::uint8_t>(field.kind));
+                write_value(file, field.size);
+            }
+        }
+
+        write_value(file, static_cast<std::uint32_t>(entities.size()));
+        std::vector<std::pair<std::uint32_t, const std::uint8_t*>> components = {};
+        for (ecs::Entity entity : entities)
+        {
+            components.clear();
+            for (std::uint32_t i = 0; i < pools.size(); i++)
+            {
+                void* object = pools[i]->get_entitys_object(entity);
+                if (object != nullptr)
+                    components.emplace_back(i, static_cast<const std::uint8_t*>(object));
+            }
+
+            write_value(file, static_cast<std::uint32_t>(components.size()));
+            for (const auto& [type, object] : components)
+            {
+                write_value(file, type);
+                for (const KSceneField& field : layouts[type].fields)
+                {
+                    const std::uint8_t* member = object + field.offset;
+                    if (field.kind == KESceneFieldKind_String)
+                        write_string(file, *reinterpret_cast<const std::string*>(member));
+                    else if (field.kind == KESceneFieldKind_Entity)
+                    {
+                        ecs::Entity referenced = ECS_ENTITY_DESTROYED;
+                        std::memcpy(&referenced, member, sizeof(ecs::Entity));
+                        auto it = entity_indices.find(referenced);
+                        write_value(
+                            file, it != entity_indices.end() ? it->second : null_entity_index
+                        );
+                    }
+                    else
+                        file.write(
+                            reinterpret_cast<const char*>(member),
+                            static_cast<std::streamsize>(field.size)
+                        );
+                }
+            }
+        }
+
+        if (!file.good())
+            return false;
+    }
+
+    std::error_code error = {};
+    std::filesystem::rename(temporary_filename, filename, error);
+    return !error;
+}
+
+bool KSceneFile::is_scene_file(const std::string& filename)
+{
+    if (!KMappedFile::exists(filename))
+        return false;
+
+    KMappedFile mapped_file = {};
+    if (!mapped_file.open(filename, 0, "SceneFile::is_scene_file()"))
+        return false;
+
+    std::uint32_t magic = 0;
+    KMappedFileReader file = KMappedFileReader(mapped_file);
+    return read_value(file, magic) && magic == scene_file_magic;
+}
+
+bool KSceneFile::read(KScene* scene, const std::string& filename)
+{
+    KMappedFile mapped_file = {};
+    if (!mapped_file.open(filename, 0, "SceneFile::read()"))
+        return false;
+    KMappedFileReader file = KMappedFileReader(mapped_file);
+
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    std::uint32_t type_count = 0;
+    if (!read_value(file, magic) || !read_value(file, version) ||
+        !read_value(file, type_count) || magic != scene_file_magic ||
+        version != scene_file_version)
+    {
+        KLDebug::log(
+            "SceneFile::read() -> '" + filename + "' is not a scene file", KEDebugType_Error
+        );
+        return false;
+    }
+
+    KLReflectionRegistry* reflection = KIApplication::get_layer<KLReflectionRegistry>();
+    std::unordered_map<std::string, std::uint64_t> type_ids = {};
+    for (const auto& [type_id, info] : reflection->get_all_type_infos())
+        type_ids.emplace(info.name, type_id);
+
+    struct KFileField
+    {
+        KESceneFieldKind kind = KESceneFieldKind_Bytes;
+        std::uint32_t size = 0;
+        // Null when the component no longer has a matching field, the value is read past
+        const KSceneField* field = nullptr;
+    };
+
+    struct KFileType
+    {
+        std::uint64_t type = 0;
+        KSceneLayout layout = {};
+        std::vector<KFileField> fields = {};
+    };
+
+    std::vector<KFileType> types = std::vector<KFileType>(type_count);
+    for (KFileType& type : types)
+    {
+        std::string type_name = {};
+        std::uint32_t field_count = 0;
+        if (!read_string(file, type_name) || !read_value(file, field_count))
+            return false;
+
+        auto it = type_ids.find(type_name);
+        if (it != type_ids.end())
+        {
+            type.type = it->second;
+            type.layout = get_layout(type.type);
+        }
+        if (!type.layout.supported)
+        {
+            type.type = 0;
+            KLDebug::log(
+                "SceneFile::read() -> component '" + type_name + "' of '" + filename +
+                    "' is unknown or can't be read field by field, it is left out",
+                KEDebugType_Warning
+            );
+        }
+
+        std::unordered_map<std::string, const KSceneField*> fields = {};
+        for (const KSceneField& field : type.layout.fields)
+            fields.emplace(field.name, &field);
+
+        type.fields.resize(field_count);
+        for (KFileField& file_field : type.fields)
+        {
+            std::string name = {};
+            std::uint8_t kind = 0;
+            if (!read_string(file, name) || !read_value(file, kind) ||
+                !read_value(file, file_field.size) || kind > KESceneFieldKind_Entity)
+                return false;
+            file_field.kind = static_cast<KESceneFieldKind>(kind);
+
+            auto field = fields.find(name);
+            if (field != fields.end() && field->second->kind == file_field.kind &&
+                field->second->size == file_field.size)
+                file_field.field = field->second;
+        }
+    }
+
+    std::uint32_t entity_count = 0;
+    if (!read_value(file, entity_count))
+        return false;
+
+    ecs::Registry& registry = scene->get_registry();
+    for (ecs::Entity entity : registry.get_entities())
+    {
+        if (entity != ECS_ENTITY_DESTROYED)
+            KEntity(entity).destroy();
+    }
+
+    // Every entity exists before any component is read, fields can refer to later entities
+    std::vector<ecs::Entity> entities = std::vector<ecs::Entity>(entity_count);
+    for (ecs::Entity& entity : entities)
+        entity = KEntity(true);
+
+    bool result = true;
+    std::vector<std::uint8_t> skipped = {};
+    for (std::uint32_t i = 0; i < entity_count && result; i++)
+    {
+        KEntity entity = KEntity(entities[i]);
+        std::uint32_t component_count = 0;
+        result = read_value(file, component_count);
+        for (std::uint32_t j = 0; j < component_count && result; j++)
+        {
+            std::uint32_t type_index = 0;
+            if (!read_value(file, type_index) || type_index >= type_count)
+            {
+                result = false;
+                break;
+            }
+
+            const KFileType& type = types[type_index];
+            std::uint8_t* object = nullptr;
+            if (type.type != 0)
+            {
+                if (entity.get_component(type.type) == nullptr)
+                    entity.add_component(reflection, type.type);
+                object = reinterpret_cast<std::uint8_t*>(entity.get_component(type.type));
+            }
+
+            for (const KFileField& file_field : type.fields)
+            {
+                std::uint8_t* member = nullptr;
+                if (object != nullptr && file_field.field != nullptr)
+                    member = object + file_field.field->offset;
+
+                if (file_field.kind == KESceneFieldKind_String)
+                {
+                    std::string value = {};
+                    result = read_string(file, value);
+                    if (result && member != nullptr)
+                        *reinterpret_cast<std::string*>(member) = std::move(value);
+                }
+                else if (file_field.kind == KESceneFieldKind_Entity)
+                {
+                    std::uint32_t index = null_entity_index;
+                    result = read_value(file, index);
+                    ecs::Entity referenced =
+                        index < entity_count ? entities[index] : ECS_ENTITY_DESTROYED;
+                    if (result && member != nullptr)
+                        std::memcpy(member, &referenced, sizeof(ecs::Entity));
+                }
+                else if (member != nullptr)
+                    result = file.read(member, file_field.size);
+                else
+                {
+                    skipped.resize(file_field.size);
+                    result = file.read(skipped.data(), file_field.size);
+                }
+
+                if (!result)
+                    break;
+            }
+        }
+    }
+
+    KLSceneChanges::get()->mark_structure_changed();
+    if (!result)
+    {
+        KLDebug::log(
+            "SceneFile::read() -> '" + filename + "' ends early, the scene is incomplete",
+            KEDebugType_Error
+        );
+    }
+    return result;
+}
@@ -0,0 +1,64 @@
+#ifndef __KRYOS_EDITOR_CORE_SCENE_FILE_HPP__
+#define __KRYOS_EDITOR_CORE_SCENE_FILE_HPP__
+
+#include <kryos/scene/entity.hpp>
+#include <kryos/scene/scene_manager.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr std::uint32_t scene_file_magic = 0x4e43534b; // "KSCN"
+constexpr std::uint32_t scene_file_version = 1;
+
+enum KESceneFieldKind
+{
+    KESceneFieldKind_Bytes,
+    KESceneFieldKind_String,
+    // Written as the index of the entity in the file, so references survive new entity ids
+    KESceneFieldKind_Entity,
+};
+
+// A member of a component that isn't made of other reflected members. Nested types are
+// flattened, so "inner.a" is a field of its own
+struct KSceneField
+{
+    std::uint32_t offset = 0;
+    std::uint32_t size = 0;
+    KESceneFieldKind kind = KESceneFieldKind_Bytes;
+    std::string name = {};
+};
+
+struct KSceneLayout
+{
+    // False when the type has members that can't be written field by field: pointers,
+    // containers or bytes that no reflected member accounts for
+    bool supported = false;
+    std::string type_name = {};
+    std::vector<KSceneField> fields = {};
+};
+
+// Scene files written by walking the member tables instead of the reflection registry's member
+// sets. Components are laid out once per type as flat fields and every entity's components are
+// written field by field after a header naming the types and fields, so a file still loads after
+// a component gained, lost or reordered members. Types are matched by name and fields by name,
+// kind and size, anything that no longer matches is skipped
+class KSceneFile
+{
+  public:
+    static KSceneLayout get_layout(std::uint64_t type);
+
+    // Whether every component in the scene can be written, the name of the first one that can't
+    // is written to type_name otherwise
+    static bool can_write(KScene* scene, std::string& type_name);
+    static bool write(KScene* scene, const std::string& filename);
+
+    // Whether the file starts with the scene file magic, scenes saved before are YAML
+    static bool is_scene_file(const std::string& filename);
+    // Replaces every entity in the scene with the file's, the scene has to be the active one since
+    // that's where entities are created
+    static bool read(KScene* scene, const std::string& filename);
+};
+
+#endif
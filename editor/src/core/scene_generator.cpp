@@ -0,0 +1,215 @@
+#include "core/scene_generator.hpp"
+#include "core/member_tables.hpp"
+#include "core/scene_changes.hpp"
+
+#include <kryos/core/application.hpp>
+#include <kryos/core/asset_handler.hpp>
+#include <kryos/core/debug.hpp>
+#include <kryos/scene/components.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Words names are built from, picked unevenly so short common words dominate like in a hand
+// made scene, with longer ones showing up now and then
+static const char* const name_words[] = {
+    "Rock",     "Tree",       "Wall",       "Lamp",        "Crate",       "Door",
+    "Floor",    "Pillar",     "Enemy",      "Player",      "Camera",      "Light",
+    "Spawn",    "Barrel",     "Window",     "Fence",       "Bridge",      "Trigger",
+    "Waypoint", "Pickup",     "Collider",   "Staircase",   "Foliage",     "Building",
+    "Vehicle",  "Marker",     "Checkpoint", "Background",  "Environment", "Interactable",
+};
+static constexpr std::uint32_t name_word_count = sizeof(name_words) / sizeof(name_words[0]);
+
+// Tags repeat a lot more than names, a few of them cover most tagged entities
+static const char* const tags[] = {
+    "Untagged", "Static",   "Player",    "Enemy",   "Prop",       "Light",
+    "Ground",   "Water",    "Trigger",   "Audio",   "Effect",     "Navigation",
+    "Pickup",   "Obstacle", "Cinematic", "EditorOnly",
+};
+static constexpr std::uint32_t tag_count = sizeof(tags) / sizeof(tags[0]);
+
+static const char* const mesh_names[] = {"cube", "sphere", "plane"};
+
+KSceneGenerator::KSceneGenerator(const KSceneGeneratorSettings& settings)
+    : m_settings(settings), m_state(settings.seed)
+{
+}
+
+KSceneGeneratorStats KSceneGenerator::generate(KScene* scene)
+{
+    KSceneGeneratorStats stats = {};
+    if (scene == nullptr)
+        return stats;
+
+    m_state = m_settings.seed;
+
+    const KMemberEntry* parent_member = nullptr;
+    if (m_settings.parent_percent > 0 && m_settings.parent_depth > 0)
+    {
+        // The editor never names KCParent's member, the reflected one holding an entity is written
+        parent_member =
+            KLMemberTables::get()->find_entity_member(KTypeId::create<KCParent>().get_id());
+        if (parent_member == nullptr)
+        {
+            KLDebug::log(
+                "SceneGenerator::generate() -> KCParent has no reflected entity member, "
+                "generating without parents",
+                KEDebugType_Warning
+            );
+        }
+    }
+
+    KLAssetHandler* asset_handler = KIApplication::get_layer<KLAssetHandler>();
+    KModel* models[3] = {};
+    for (std::size_t i = 0; i < 3; i++)
+        models[i] = asset_handler->get_static_model(mesh_names[i]);
+
+    // Entities from the root down to the last one parented, a new child either goes under the
+    // deepest of them or cuts the chain back at a random level first
+    std::vector<ecs::Entity> chain = {};
+    chain.reserve(static_cast<std::size_t>(m_settings.parent_depth) + 1);
+
+    for (std::size_t i = 0; i < m_settings.entity_count; i++)
+    {
+        KEntity entity = KEntity(true);
+
+        // Every draw is its own statement, arguments aren't evaluated in the same order
+        // everywhere
+        KCTransform* transform = entity.add_component<KCTransform>();
+        transform->position.x = _range(-500.0f, 500.0f);
+        transform->position.y = _range(0.0f, 50.0f);
+        transform->position.z = _range(-500.0f, 500.0f);
+        transform->scale = glm::vec3(_range(0.5f, 2.0f));
+
+        if (_chance(m_settings.name_percent))
+        {
+            KCName* name = entity.add_component<KCName>(_name(i));
+            stats.string_bytes += name->name.size();
+            stats.name_count++;
+        }
+
+        if (_chance(m_settings.tag_percent))
+        {
+            KCTag* tag = entity.add_component<KCTag>();
+            tag->tag = _tag();
+            stats.string_bytes += tag->tag.size();
+            stats.tag_count++;
+        }
+
+        if (_chance(m_settings.mesh_percent))
+        {
+            KCMeshRenderer* mesh_renderer = entity.add_component<KCMeshRenderer>();
+            mesh_renderer->model = models[_below(3)];
+            stats.mesh_count++;
+        }
+
+        if (_chance(m_settings.camera_percent))
+        {
+            KCCamera* camera = entity.add_component<KCCamera>();
+            camera->clear_color = glm::vec4(0.0f, 0.0f, 0.3f, 1.0f);
+            camera->clear_color.x = _range(0.0f, 0.3f);
+            camera->clear_color.y = _range(0.0f, 0.3f);
+            stats.camera_count++;
+        }
+
+        // Drawn even without a member to write, so the other components come out the same
+        bool parented = _chance(m_settings.parent_percent) && !chain.empty();
+        if (parented && parent_member != nullptr)
+        {
+            std::size_t depth = static_cast<std::size_t>(m_settings.parent_depth);
+            if (chain.size() > depth || !_chance(75))
+            {
+                std::uint32_t levels = static_cast<std::uint32_t>(std::min(chain.size(), depth));
+                chain.resize(1 + _below(levels));
+            }
+
+            ecs::Entity parent = chain.back();
+            KCParent* parent_component = entity.add_component<KCParent>();
+            std::memcpy(
+                reinterpret_cast<std::byte*>(parent_component) + parent_member->offset, &parent,
+                sizeof(ecs::Entity)
+            );
+            chain.push_back(entity);
+            stats.deepest_chain =
+                std::max(stats.deepest_chain, static_cast<int>(chain.size()) - 1);
+            stats.parent_count++;
+        }
+        else if (!parented)
+        {
+            chain.clear();
+            chain.push_back(entity);
+        }
+    }
+
+    stats.entity_count = m_settings.entity_count;
+
+    // Far more entities than the structure change log holds, everything is rescanned instead
+    if (KLSceneChanges::get() != nullptr)
+        KLSceneChanges::get()->mark_structure_changed();
+    return stats;
+}
+
+std::uint64_t KSceneGenerator::_next()
+{
+    // splitmix64, the same sequence on every platform and standard library
+    std::uint64_t z = (m_state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+std::uint32_t KSceneGenerator::_below(std::uint32_t count)
+{
+    return static_cast<std::uint32_t>(((_next() >> 32) * count) >> 32);
+}
+
+float KSceneGenerator::_range(float min, float max)
+{
+    // A float's 24 bits of precision, so every value is exact
+    float unit = static_cast<float>(_next() >> 40) * (1.0f / 16777216.0f);
+    return min + (max - min) * unit;
+}
+
+std::string KSceneGenerator::_name(std::size_t index)
+{
+    std::string name = {};
+
+    // Mostly one or two words, like "Rock" or "EnemySpawn", sometimes three
+    std::uint32_t roll = _below(100);
+    std::uint32_t word_count = roll < 50 ? 1 : roll < 85 ? 2 : 3;
+    for (std::uint32_t i = 0; i < word_count; i++)
+    {
+        // The smaller of two picks, so the short words at the front come up most
+        name += name_words[std::min(_below(name_word_count), _below(name_word_count))];
+    }
+
+    // Duplicated objects keep a number, a few imported ones keep their whole source path
+    roll = _below(100);
+    if (roll < 40)
+    {
+        char suffix[32] = {};
+        std::snprintf(suffix, sizeof(suffix), "_%03zu", index % 1000);
+        name += suffix;
+    }
+    else if (roll < 42)
+    {
+        std::string path = "Assets/Imported/";
+        std::uint32_t folder_count = 1 + _below(6);
+        for (std::uint32_t i = 0; i < folder_count; i++)
+        {
+            path += name_words[_below(name_word_count)];
+            path += '/';
+        }
+        name = path + name + ".fbx";
+    }
+    return name;
+}
+
+const char* KSceneGenerator::_tag()
+{
+    // Each pick is at most the one before, so the first few tags are the common ones
+    return tags[_below(_below(tag_count) + 1)];
+}
@@ -0,0 +1,66 @@
+#ifndef __KRYOS_EDITOR_CORE_SCENE_GENERATOR_HPP__
+#define __KRYOS_EDITOR_CORE_SCENE_GENERATOR_HPP__
+
+#include <kryos/scene/entity.hpp>
+#include <kryos/scene/scene_manager.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct KSceneGeneratorSettings
+{
+    std::size_t entity_count = 1000;
+    std::uint64_t seed = 0;
+
+    // Chance out of 100 of an entity getting each component, every entity has a transform
+    int name_percent = 90;
+    int tag_percent = 30;
+    int camera_percent = 1;
+    int mesh_percent = 60;
+    int parent_percent = 50;
+    // Longest chain of parents above an entity, 0 keeps every entity at the root
+    int parent_depth = 8;
+};
+
+struct KSceneGeneratorStats
+{
+    std::size_t entity_count = 0;
+    std::size_t name_count = 0;
+    std::size_t tag_count = 0;
+    std::size_t camera_count = 0;
+    std::size_t mesh_count = 0;
+    std::size_t parent_count = 0;
+    int deepest_chain = 0;
+    // Characters across every name and tag
+    std::size_t string_bytes = 0;
+};
+
+// Fills the active scene with synthetic entities for benchmarks. The same settings always give
+// the same scene: numbers come from a fixed generator and are shaped by hand rather than with
+// <random>'s distributions, whose results differ between standard libraries
+class KSceneGenerator
+{
+  public:
+    KSceneGenerator(const KSceneGeneratorSettings& settings);
+    ~KSceneGenerator() = default;
+
+    KSceneGeneratorStats generate(KScene* scene);
+
+  private:
+    std::uint64_t _next();
+    // Uniform in [0, count)
+    std::uint32_t _below(std::uint32_t count);
+    // Uniform in [min, max)
+    float _range(float min, float max);
+    inline bool _chance(int percent) { return static_cast<int>(_below(100)) < percent; }
+
+    std::string _name(std::size_t index);
+    const char* _tag();
+
+  private:
+    KSceneGeneratorSettings m_settings = {};
+    std::uint64_t m_state = 0;
+};
+
+#endif
@@ -0,0 +1,158 @@
+#include "core/scene_query.hpp"
+#include "core/scene_changes.hpp"
+
+#include <algorithm>
+
+KSceneQuery::KSceneQuery(const std::vector<std::uint64_t>& types) : m_types(types)
+{
+    m_pools.resize(m_types.size(), nullptr);
+}
+
+const std::vector<ecs::Entity>& KSceneQuery::update(KScene* scene)
+{
+    if (scene == nullptr)
+    {
+        reset();
+        return m_entities;
+    }
+
+    KLSceneChanges* changes = KLSceneChanges::get();
+    ecs::Registry& registry = scene->get_registry();
+    std::uint64_t structure_version = changes->get_structure_version();
+    std::size_t entity_count = registry.get_entities().size();
+
+    const KStructureChange* structure_changes = nullptr;
+    std::size_t change_count = 0;
+    bool logged =
+        changes->get_structure_changes(m_structure_version, structure_changes, change_count);
+
+    // Entities only come and go without a structure change when the editor didn't make them
+    bool unrecorded = entity_count != m_entity_count && change_count == 0;
+    if (scene != m_scene || !logged || unrecorded)
+        _rescan(registry);
+    else
+    {
+        if (change_count > 0)
+        {
+            // Pools are created with their type's first component, which could be in these
+            // changes
+            _find_pools(registry);
+            for (std::size_t i = 0; i < change_count; i++)
+            {
+                const KStructureChange& change = structure_changes[i];
+                if (change.change == KEStructureChange_ComponentAdded ||
+                    change.change == KEStructureChange_ComponentRemoved)
+                {
+                    if (!_has_type(change.type_hash))
+                        continue;
+                }
+
+                // Read against the registry as it is now, so the order of the changes doesn't
+                // matter
+                _refresh(change.entity);
+            }
+            m_replayed_count += change_count;
+        }
+
+        // When the entity count moved along with the recorded changes, some of the entities
+        // could have come or gone behind the log's back as well, so the matches are checked
+        // against the pools before they're handed out. A match that went away means the log
+        // missed changes, creations included, and the registry is rescanned. Checking on every
+        // update would walk every match even when nothing changed
+        if (entity_count != m_entity_count && !_validate())
+            _rescan(registry);
+    }
+
+    m_scene = scene;
+    m_structure_version = structure_version;
+    m_entity_count = entity_count;
+    return m_entities;
+}
+
+void KSceneQuery::reset()
+{
+    std::fill(m_pools.begin(), m_pools.end(), nullptr);
+    m_entities.clear();
+    m_indices.clear();
+    m_scene = nullptr;
+    m_structure_version = 0;
+    m_entity_count = 0;
+}
+
+void KSceneQuery::_rescan(ecs::Registry& registry)
+{
+    m_entities.clear();
+    m_indices.clear();
+    _find_pools(registry);
+    m_rescan_count++;
+
+    for (ecs::Entity entity : registry.get_entities())
+    {
+        if (entity != ECS_ENTITY_DESTROYED && _matches(entity))
+        {
+            m_indices.emplace(entity, m_entities.size());
+            m_entities.push_back(entity);
+        }
+    }
+}
+
+void KSceneQuery::_find_pools(ecs::Registry& registry)
+{
+    std::fill(m_pools.begin(), m_pools.end(), nullptr);
+    for (ecs::ObjectPool* pool : registry.get_pools())
+    {
+        for (std::size_t i = 0; i < m_types.size(); i++)
+        {
+            if (pool->get_type_hash() == m_types[i])
+                m_pools[i] = pool;
+        }
+    }
+}
+
+bool KSceneQuery::_validate() const
+{
+    for (ecs::Entity entity : m_entities)
+    {
+        if (!_matches(entity))
+            return false;
+    }
+    return true;
+}
+
+bool KSceneQuery::_has_type(std::uint64_t type) const
+{
+    return std::find(m_types.begin(), m_types.end(), type) != m_types.end();
+}
+
+bool KSceneQuery::_matches(ecs::Entity entity) const
+{
+    for (ecs::ObjectPool* pool : m_pools)
+    {
+        if (pool == nullptr || pool->get_entitys_object(entity) == nullptr)
+            return false;
+    }
+    return true;
+}
+
+void KSceneQuery::_refresh(ecs::Entity entity)
+{
+    auto it = m_indices.find(entity);
+    bool matches = _matches(entity);
+    if (matches && it == m_indices.end())
+    {
+        m_indices.emplace(entity, m_entities.size());
+        m_entities.push_back(entity);
+    }
+    else if (!matches && it != m_indices.end())
+    {
+        // The last match fills the hole
+        std::size_t index = it->second;
+        m_indices.erase(it);
+        if (index != m_entities.size() - 1)
+        {
+            m_entities[index] = m_entities.back();
+            m_indices[m_entities[index]] = index;
+        }
+        m_entities.pop_back();
+    }
+}
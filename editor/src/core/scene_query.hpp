@@ -0,0 +1,68 @@
+#ifndef __KRYOS_EDITOR_CORE_SCENE_QUERY_HPP__
+#define __KRYOS_EDITOR_CORE_SCENE_QUERY_HPP__
+
+#include <kryos/scene/entity.hpp>
+#include <kryos/scene/scene_manager.hpp>
+#include <kryos/serialization/reflection.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Keeps the entities that have every one of a set of components, so iterating them costs the
+// matches instead of a has_required check for every entity in the registry. Each update replays
+// the structure changes logged since the last one and only rescans the registry when the scene
+// changed, when the edits were only marked as a structure change or fell out of the log, or when
+// entities came or went without going through the editor. The matches are only checked against
+// the pools when the entity count changed, an unrecorded destroy or create that leaves the count
+// the same is picked up by the next rescan. The owner keeps the query around for as long as it
+// needs it
+class KSceneQuery
+{
+  public:
+    template<typename... _Components>
+    inline static KSceneQuery create()
+    {
+        return KSceneQuery({KTypeId::create<_Components>().get_id()...});
+    }
+
+  public:
+    KSceneQuery(const std::vector<std::uint64_t>& types);
+    ~KSceneQuery() = default;
+
+    inline const std::vector<std::uint64_t>& get_types() const { return m_types; }
+    inline const std::vector<ecs::Entity>& get_entities() const { return m_entities; }
+    inline std::size_t get_rescan_count() const { return m_rescan_count; }
+    inline std::size_t get_replayed_count() const { return m_replayed_count; }
+
+    // The matching entities in no particular order, valid until the next update
+    const std::vector<ecs::Entity>& update(KScene* scene);
+    void reset();
+
+  private:
+    void _rescan(ecs::Registry& registry);
+    void _find_pools(ecs::Registry& registry);
+    // Whether every match still has all of the types
+    bool _validate() const;
+    bool _has_type(std::uint64_t type) const;
+    bool _matches(ecs::Entity entity) const;
+    void _refresh(ecs::Entity entity);
+
+  private:
+    std::vector<std::uint64_t> m_types = {};
+    // In the order of the types, null until the registry has a pool for the type
+    std::vector<ecs::ObjectPool*> m_pools = {};
+
+    std::vector<ecs::Entity> m_entities = {};
+    std::unordered_map<ecs::Entity, std::size_t> m_indices = {};
+
+    KScene* m_scene = nullptr;
+    std::uint64_t m_structure_version = 0;
+    std::size_t m_entity_count = 0;
+
+    std::size_t m_rescan_count = 0;
+    std::size_t m_replayed_count = 0;
+};
+
+#endif
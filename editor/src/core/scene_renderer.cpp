@@ -0,0 +1,341 @@
+#include "core/scene_renderer.hpp"
+#include "core/bvh.hpp"
+#include "core/spatial_index.hpp"
+#include "utils/camera.hpp"
+
+#include <kryos/core/debug.hpp>
+#include <kryos/serialization/reflection.hpp>
+
+#include <algorithm>
+#include <string>
+
+static const char* scene_vertex_shader = R"(#version 450 core
+layout(location = 0) in vec3 a_position;
+layout(location = 1) in vec3 a_normal;
+
+layout(std430, binding = 0) readonly buffer Instances
+{
+    mat4 transforms[];
+};
+
+uniform mat4 u_view_projection;
+uniform uint u_first_instance;
+
+out vec3 v_normal;
+
+void main()
+{
+    mat4 model = transforms[u_first_instance + uint(gl_InstanceID)];
+    v_normal = mat3(transpose(inverse(model))) * a_normal;
+    gl_Position = u_view_projection * model * vec4(a_position, 1.0);
+}
+)";
+
+static const char* scene_fragment_shader = R"(#version 450 core
+in vec3 v_normal;
+
+out vec4 o_color;
+
+void main()
+{
+    vec3 light_direction = normalize(vec3(0.4, 1.0, 0.6));
+    float diffuse = max(dot(normalize(v_normal), light_direction), 0.0);
+    o_color = vec4(vec3(0.15 + 0.85 * diffuse), 1.0);
+}
+)";
+
+static GLuint compile_shader(GLenum type, const char* source)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint compiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (compiled == GL_FALSE)
+    {
+        char info[512] = {};
+        glGetShaderInfoLog(shader, sizeof(info), nullptr, info);
+        KLDebug::log(
+            std::string("SceneRenderer::_initialize() -> failed to compile shader: ") + info,
+            KEDebugType_Error
+        );
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    return shader;
+}
+
+KSceneRenderer::~KSceneRenderer()
+{
+    if (!m_initialized)
+        return;
+
+    glDeleteProgram(m_program);
+    glDeleteBuffers(1, &m_instance_buffer);
+}
+
+void KSceneRenderer::render(
+    KScene* scene, const KCCamera& camera, GLuint framebuffer, const glm::ivec2& viewport_size
+)
+{
+    if (framebuffer == 0 || viewport_size.x <= 0 || viewport_size.y <= 0)
+        return;
+
+    _capture(scene, camera, viewport_size, m_snapshot);
+    KRenderWorker::record(m_snapshot, m_command_list);
+    _replay(m_command_list, framebuffer, viewport_size);
+}
+
+void KSceneRenderer::submit(KScene* scene, const KCCamera& camera, const glm::ivec2& viewport_size)
+{
+    if (viewport_size.x <= 0 || viewport_size.y <= 0)
+        return;
+
+    if (m_worker == nullptr)
+        m_worker = std::make_unique<KRenderWorker>();
+
+    KRenderSnapshot snapshot = {};
+    _capture(scene, camera, viewport_size, snapshot);
+    m_worker->submit(std::move(snapshot));
+}
+
+bool KSceneRenderer::replay(GLuint framebuffer, const glm::ivec2& viewport_size)
+{
+    if (m_worker == nullptr || framebuffer == 0)
+        return false;
+
+    const KRenderCommandList* command_list = m_worker->begin_replay();
+    if (command_list == nullptr)
+        return false;
+
+    _replay(*command_list, framebuffer, viewport_size);
+    m_worker->end_replay();
+    return true;
+}
+
+void KSceneRenderer::_capture(
+    KScene* scene, const KCCamera& camera, const glm::ivec2& viewport_size,
+    KRenderSnapshot& snapshot
+)
+{
+    float aspect = static_cast<float>(viewport_size.x) / static_cast<float>(viewport_size.y);
+    snapshot.view_projection = CameraHelper::view_projection(camera, aspect);
+    snapshot.clear_color = camera.clear_color;
+    snapshot.items.clear();
+
+    KLSpatialIndex* spatial_index = KLSpatialIndex::get();
+    spatial_index->query(KFrustum::from_matrix(snapshot.view_projection), m_visible_entities);
+
+    ecs::ObjectPool* mesh_renderer_pool = nullptr;
+    for (ecs::ObjectPool* pool : scene->get_registry().get_pools())
+    {
+        if (pool->get_type_hash() == KTypeId::create<KCMeshRenderer>().get_id())
+            mesh_renderer_pool = pool;
+    }
+
+    if (mesh_renderer_pool == nullptr)
+        return;
+
+    KLMeshLods* mesh_lods = KLMeshLods::get();
+    if (mesh_lods != nullptr && !mesh_lods->get_enabled())
+        mesh_lods = nullptr;
+
+    snapshot.items.reserve(m_visible_entities.size());
+    for (ecs::Entity entity : m_visible_entities)
+    {
+        // Drawn with the same world matrix the culling bounds were built from
+        const glm::mat4* transform = spatial_index->find_world_matrix(entity);
+        KCMeshRenderer* mesh_renderer =
+            static_cast<KCMeshRenderer*>(mesh_renderer_pool->get_entitys_object(entity));
+
+        if (transform == nullptr || mesh_renderer == nullptr || mesh_renderer->model == nullptr)
+            continue;
+
+        std::uint32_t lod = 0;
+        if (mesh_lods != nullptr)
+        {
+            lod = _select_lod(
+                mesh_lods, mesh_renderer->model, *transform, camera,
+                static_cast<float>(viewport_size.y)
+            );
+        }
+        snapshot.items.push_back({mesh_renderer->model, *transform, lod});
+    }
+}
+
+std::uint32_t KSceneRenderer::_select_lod(
+    KLMeshLods* mesh_lods, KModelHandle model, const glm::mat4& transform,
+    const KCCamera& camera, float viewport_height
+)
+{
+    const KModelLods* lods = mesh_lods->find(model);
+    if (lods == nullptr)
+    {
+        mesh_lods->request(model);
+        return 0;
+    }
+
+    // Distance to the origin rather than to the bounds, close enough for picking a level and
+    // keeps the selection stable while the model rotates
+    float distance = glm::length(glm::vec3(transform[3]) - camera.position);
+    if (distance <= CameraHelper::near_plane)
+        return 0;
+
+    float scale = std::max(
+        {glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1])),
+         glm::length(glm::vec3(transform[2]))}
+    );
+    float pixels_per_unit = CameraHelper::pixels_per_unit(viewport_height, distance);
+    return mesh_lods->select(*lods, pixels_per_unit * scale);
+}
+
+void KSceneRenderer::_replay(
+    const KRenderCommandList& command_list, GLuint framebuffer, const glm::ivec2& viewport_size
+)
+{
+    if (!m_initialized && !_initialize())
+        return;
+
+    GLint last_viewport[4] = {};
+    glGetIntegerv(GL_VIEWPORT, last_viewport);
+    GLboolean last_depth_test = glIsEnabled(GL_DEPTH_TEST);
+
+    // Only the viewport's rectangle is sampled when the framebuffer is displayed
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, viewport_size.x, viewport_size.y);
+    glEnable(GL_DEPTH_TEST);
+    const glm::vec4& clear_color = command_list.clear_color;
+    glClearColor(clear_color.r, clear_color.g, clear_color.b, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    _upload_instances(command_list.queue.get_instance_transforms());
+
+    glUseProgram(m_program);
+    glUniformMatrix4fv(
+        m_view_projection_location, 1, GL_FALSE, &command_list.view_projection[0][0]
+    );
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_instance_buffer);
+
+    m_draw_calls = 0;
+    m_unbatched_draw_calls = 0;
+    m_triangle_count = 0;
+    for (const KDrawBatch& batch : command_list.queue.get_batches())
+        _draw_batch(batch);
+    m_batch_count = command_list.queue.get_batches().size();
+    m_instance_count = command_list.queue.get_item_count();
+
+    // Leave the state as imgui expects it
+    glBindVertexArray(0);
+    glUseProgram(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(last_viewport[0], last_viewport[1], last_viewport[2], last_viewport[3]);
+    if (last_depth_test == GL_FALSE)
+        glDisable(GL_DEPTH_TEST);
+}
+
+bool KSceneRenderer::_initialize()
+{
+    GLuint vertex_shader = compile_shader(GL_VERTEX_SHADER, scene_vertex_shader);
+    GLuint fragment_shader = compile_shader(GL_FRAGMENT_SHADER, scene_fragment_shader);
+    if (vertex_shader == 0 || fragment_shader == 0)
+    {
+        glDeleteShader(vertex_shader);
+        glDeleteShader(fragment_shader);
+        return false;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertex_shader);
+    glAttachShader(program, fragment_shader);
+    glLinkProgram(program);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE)
+    {
+        char info[512] = {};
+        glGetProgramInfoLog(program, sizeof(info), nullptr, info);
+        KLDebug::log(
+            std::string("SceneRenderer::_initialize() -> failed to link program: ") + info,
+            KEDebugType_Error
+        );
+        glDeleteProgram(program);
+        return false;
+    }
+
+    m_program = program;
+    m_view_projection_location = glGetUniformLocation(m_program, "u_view_projection");
+    m_first_instance_location = glGetUniformLocation(m_program, "u_first_instance");
+
+    glCreateBuffers(1, &m_instance_buffer);
+
+    m_initialized = true;
+    return true;
+}
+
+void KSceneRenderer::_upload_instances(const std::vector<glm::mat4>& transforms)
+{
+    if (transforms.empty())
+        return;
+
+    GLsizeiptr size = static_cast<GLsizeiptr>(transforms.size() * sizeof(glm::mat4));
+    if (transforms.size() > m_instance_capacity)
+    {
+        // Grow geometrically so a scene that keeps gaining entities doesn't reallocate each frame
+        m_instance_capacity = std::max(transforms.size(), m_instance_capacity * 2);
+        glNamedBufferData(
+            m_instance_buffer, static_cast<GLsizeiptr>(m_instance_capacity * sizeof(glm::mat4)),
+            nullptr, GL_DYNAMIC_DRAW
+        );
+    }
+
+    glNamedBufferSubData(m_instance_buffer, 0, size, transforms.data());
+}
+
+void KSceneRenderer::_draw_batch(const KDrawBatch& batch)
+{
+    glUniform1ui(m_first_instance_location, batch.first_instance);
+
+    // The LODs can have been dropped by an asset reload since the batch was recorded
+    const KModelLods* lods = nullptr;
+    if (batch.lod > 0 && KLMeshLods::get() != nullptr)
+        lods = KLMeshLods::get()->find(batch.model);
+    if (lods != nullptr && lods->meshes.size() != batch.model->meshes.size())
+        lods = nullptr;
+
+    // NOTE: Relies on the model's meshes keeping their vertex array and index list around after
+    // upload, with positions in attribute 0 and normals in attribute 1
+    for (std::size_t i = 0; i < batch.model->meshes.size(); i++)
+    {
+        const auto& mesh = batch.model->meshes[i];
+        glBindVertexArray(mesh.vertex_array);
+
+        std::size_t index_count = mesh.indices.size();
+        const KMeshLodSet* lod_set = lods != nullptr ? &lods->meshes[i] : nullptr;
+        if (lod_set != nullptr && lod_set->levels.size() > 1)
+        {
+            // Meshes simplified less than the rest of the model stop at their coarsest level
+            std::size_t level = std::min<std::size_t>(batch.lod, lod_set->levels.size() - 1);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lod_set->levels[level].index_buffer);
+            index_count = lod_set->levels[level].index_count;
+        }
+        else
+            lod_set = nullptr;
+
+        glDrawElementsInstanced(
+            GL_TRIANGLES, static_cast<GLsizei>(index_count), GL_UNSIGNED_INT, nullptr,
+            static_cast<GLsizei>(batch.instance_count)
+        );
+        m_draw_calls++;
+        m_unbatched_draw_calls += batch.instance_count;
+        m_triangle_count += index_count / 3 * batch.instance_count;
+
+        // The element buffer binding is vertex array state, put the model's own back
+        if (lod_set != nullptr)
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lod_set->source_index_buffer);
+    }
+}
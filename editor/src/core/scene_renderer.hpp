@@ -0,0 +1,93 @@
+#ifndef __KRYOS_EDITOR_CORE_SCENE_RENDERER_HPP__
+#define __KRYOS_EDITOR_CORE_SCENE_RENDERER_HPP__
+
+#include "core/mesh_lods.hpp"
+#include "core/render_queue.hpp"
+#include "core/render_worker.hpp"
+
+#include <kryos/scene/components.hpp>
+#include <kryos/scene/scene_manager.hpp>
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+// Draws the mesh renderers of a scene into a framebuffer with the editor's own GL calls. Visible
+// entities are culled through the spatial index into a snapshot, which is recorded into a command
+// list of sorted instanced batches, then every batch is replayed as one instanced draw per mesh
+// with the instance transforms read from a shader storage buffer. Recording can happen inline or
+// on a worker thread. Nothing is pushed onto the pipeline, so the scene is only drawn on the
+// frames the caller asks for
+class KSceneRenderer
+{
+  public:
+    KSceneRenderer() = default;
+    ~KSceneRenderer();
+
+    inline const std::vector<ecs::Entity>& get_visible_entities() const
+    {
+        return m_visible_entities;
+    }
+    // Counted as the draws are issued for the last replayed frame
+    inline std::size_t get_draw_calls() const { return m_draw_calls; }
+    // Draws the same frame takes without instancing, one per mesh of every instance
+    inline std::size_t get_unbatched_draw_calls() const { return m_unbatched_draw_calls; }
+    inline std::size_t get_batch_count() const { return m_batch_count; }
+    inline std::size_t get_instance_count() const { return m_instance_count; }
+    inline std::size_t get_triangle_count() const { return m_triangle_count; }
+
+    // Culls, records and draws the scene as seen from the camera on the calling thread. Only the
+    // viewport_size rectangle at the framebuffer's origin is drawn into, the whole framebuffer is
+    // cleared to the camera's clear color first. The framebuffer needs a depth attachment
+    void render(
+        KScene* scene, const KCCamera& camera, GLuint framebuffer, const glm::ivec2& viewport_size
+    );
+
+    // Captures a snapshot of the scene and hands it to the worker thread for recording
+    void submit(KScene* scene, const KCCamera& camera, const glm::ivec2& viewport_size);
+    // Draws the newest list the worker finished recording, returns false when there was none
+    bool replay(GLuint framebuffer, const glm::ivec2& viewport_size);
+
+  private:
+    void _capture(
+        KScene* scene, const KCCamera& camera, const glm::ivec2& viewport_size,
+        KRenderSnapshot& snapshot
+    );
+    std::uint32_t _select_lod(
+        KLMeshLods* mesh_lods, KModelHandle model, const glm::mat4& transform,
+        const KCCamera& camera, float viewport_height
+    );
+    void _replay(
+        const KRenderCommandList& command_list, GLuint framebuffer, const glm::ivec2& viewport_size
+    );
+
+    bool _initialize();
+    void _upload_instances(const std::vector<glm::mat4>& transforms);
+    void _draw_batch(const KDrawBatch& batch);
+
+  private:
+    std::vector<ecs::Entity> m_visible_entities = {};
+    std::size_t m_draw_calls = 0;
+    std::size_t m_unbatched_draw_calls = 0;
+    std::size_t m_batch_count = 0;
+    std::size_t m_instance_count = 0;
+    std::size_t m_triangle_count = 0;
+
+    // Used when recording inline
+    KRenderSnapshot m_snapshot = {};
+    KRenderCommandList m_command_list = {};
+    // Only started once something is submitted
+    std::unique_ptr<KRenderWorker> m_worker = nullptr;
+
+    bool m_initialized = false;
+    GLuint m_program = 0;
+    GLint m_view_projection_location = -1;
+    GLint m_first_instance_location = -1;
+
+    GLuint m_instance_buffer = 0;
+    std::size_t m_instance_capacity = 0;
+};
+
+#endif
@@ -0,0 +1,286 @@
+#include "core/scene_tool.hpp"
+#include "core/editor_entities.hpp"
+#include "core/member_tables.hpp"
+#include "core/prefabs.hpp"
+#include "core/project.hpp"
+#include "core/scene_changes.hpp"
+
+#include <kryos/core/debug.hpp>
+#include <kryos/renderer/window.hpp>
+
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+static double milliseconds_since(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int KSceneToolApp::run_diff(const KCommandLine& command_line)
+{
+    KSceneToolSettings settings = {};
+    settings.tool = KESceneTool_Diff;
+    settings.project_filename = command_line.get("project");
+    settings.scene_filenames = command_line.get_positionals();
+    settings.output_filename = command_line.get("output");
+
+    if (settings.project_filename.empty() || settings.scene_filenames.size() != 2)
+    {
+        std::fprintf(
+            stderr, "usage: Kryos diff <base> <other> --project <file.kryosproject> "
+                    "[--output <file.kpatch>]\n"
+        );
+        return 2;
+    }
+    return _run(settings);
+}
+
+int KSceneToolApp::run_merge(const KCommandLine& command_line)
+{
+    KSceneToolSettings settings = {};
+    settings.tool = KESceneTool_Merge;
+    settings.project_filename = command_line.get("project");
+    settings.scene_filenames = command_line.get_positionals();
+
+    if (settings.project_filename.empty() || settings.scene_filenames.size() != 3)
+    {
+        std::fprintf(
+            stderr, "usage: Kryos merge <base> <ours> <theirs> --project <file.kryosproject> "
+                    "[--output <file>]\n"
+        );
+        return 2;
+    }
+
+    // Written over ours by default, which is what git expects from a merge driver
+    settings.output_filename = command_line.get("output", settings.scene_filenames[1]);
+    return _run(settings);
+}
+
+int KSceneToolApp::run_generate(const KCommandLine& command_line)
+{
+    KSceneToolSettings settings = {};
+    settings.tool = KESceneTool_Generate;
+    settings.project_filename = command_line.get("project");
+    settings.output_filename = command_line.get("output");
+
+    KSceneGeneratorSettings& generator = settings.generator;
+    int entity_count = command_line.get_int("entities", 0);
+    generator.name_percent = command_line.get_int("names", generator.name_percent);
+    generator.tag_percent = command_line.get_int("tags", generator.tag_percent);
+    generator.camera_percent = command_line.get_int("cameras", generator.camera_percent);
+    generator.mesh_percent = command_line.get_int("meshes", generator.mesh_percent);
+    generator.parent_percent = command_line.get_int("parents", generator.parent_percent);
+    generator.parent_depth = command_line.get_int("parent-depth", generator.parent_depth);
+
+    // Seeds are 64 bit, more than get_int() holds
+    std::string seed = command_line.get("seed", "0");
+    char* seed_end = nullptr;
+    generator.seed = std::strtoull(seed.c_str(), &seed_end, 0);
+
+    if (settings.project_filename.empty() || settings.output_filename.empty() ||
+        entity_count <= 0 || *seed_end != '\0' || generator.parent_depth < 0)
+    {
+        std::fprintf(
+            stderr, "usage: Kryos generate --project <file.kryosproject> --output <file> "
+                    "--entities <count> [--seed <seed>] [--names <%%>] [--tags <%%>] "
+                    "[--cameras <%%>] [--meshes <%%>] [--parents <%%>] [--parent-depth <depth>]\n"
+        );
+        return 2;
+    }
+    generator.entity_count = static_cast<std::size_t>(entity_count);
+    return _run(settings);
+}
+
+int KSceneToolApp::_run(KSceneToolSettings& settings)
+{
+#if defined(GLFW_PLATFORM_NULL)
+    // Nothing is drawn, the window only exists because every application has one
+    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
+
+    KSceneToolApp* app = new KSceneToolApp(&settings);
+    app->run();
+    delete app;
+
+    return settings.exit_code;
+}
+
+KSceneToolApp::KSceneToolApp(KSceneToolSettings* settings)
+{
+    KLWindow* window = get_application_layer<KLWindow>();
+    glfwHideWindow(window->get_internal());
+
+    KLDebug* debug = get_application_layer<KLDebug>();
+    debug->set_serialize(false);
+
+    push_layer<KLMemberTables>();
+    push_layer<KLProject>();
+    push_layer<KLEditorEntities>();
+    push_layer<KLSceneChanges>();
+    push_layer<KLPrefabs>();
+    push_layer<KLSceneTool>(settings);
+}
+
+KLSceneTool::KLSceneTool(KSceneToolSettings* settings) : m_settings(settings)
+{
+    if (!KLProject::get()->load(m_settings->project_filename))
+    {
+        std::fprintf(
+            stderr, "failed to load project '%s'\n", m_settings->project_filename.c_str()
+        );
+        m_settings->exit_code = 2;
+        _finish();
+    }
+}
+
+void KLSceneTool::on_update()
+{
+    if (m_finished)
+        return;
+
+    // Run on the first update, once the member tables have been built
+    if (m_settings->tool == KESceneTool_Diff)
+        _diff();
+    else if (m_settings->tool == KESceneTool_Merge)
+        _merge();
+    else
+        _generate();
+    _finish();
+}
+
+KScene* KLSceneTool::_load_scene(const std::string& name, const std::string& filename)
+{
+    KLSceneManager* scene_manager = KIApplication::get_layer<KLSceneManager>();
+    scene_manager->set_active(scene_manager->push(name));
+
+    KScene* scene = scene_manager->get_active_scene();
+    if (!KLProject::get()->deserialize_scene(scene, filename))
+    {
+        std::fprintf(stderr, "failed to load scene '%s'\n", filename.c_str());
+        m_settings->exit_code = 2;
+        return nullptr;
+    }
+    return scene;
+}
+
+void KLSceneTool::_diff()
+{
+    KScene* base = _load_scene("base", m_settings->scene_filenames[0]);
+    KScene* other = base != nullptr ? _load_scene("other", m_settings->scene_filenames[1])
+                                    : nullptr;
+    if (other == nullptr)
+        return;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    KScenePatch patch = m_diff.diff(base, other);
+    double diff_time = milliseconds_since(start);
+
+    for (const KScenePatchEntry& entry : patch.entries)
+        std::printf("%s\n", m_diff.describe(patch, entry).c_str());
+    _report_skipped_types();
+
+    const KSceneDiffStats& stats = m_diff.get_stats();
+    std::fprintf(
+        stderr,
+        "%zu changes across %zu entities in %.3fms, %zu of %zu pools skipped by hash (hashing "
+        "%.3fms, comparing %.3fms)\n",
+        patch.entries.size(), stats.entity_count, diff_time, stats.skipped_pool_count,
+        stats.pool_count, stats.hash_time, stats.compare_time
+    );
+
+    if (!m_settings->output_filename.empty() && !m_diff.write(patch, m_settings->output_filename))
+    {
+        std::fprintf(stderr, "failed to write '%s'\n", m_settings->output_filename.c_str());
+        m_settings->exit_code = 2;
+        return;
+    }
+
+    m_settings->exit_code = patch.is_empty() ? 0 : 1;
+}
+
+void KLSceneTool::_merge()
+{
+    // Ours is loaded last so it's the active scene theirs' changes are applied to
+    KScene* base = _load_scene("base", m_settings->scene_filenames[0]);
+    KScene* theirs = base != nullptr ? _load_scene("theirs", m_settings->scene_filenames[2])
+                                     : nullptr;
+    KScene* ours = theirs != nullptr ? _load_scene("ours", m_settings->scene_filenames[1])
+                                     : nullptr;
+    if (ours == nullptr)
+        return;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    KScenePatch our_patch = m_diff.diff(base, ours);
+    KScenePatch their_patch = m_diff.diff(base, theirs);
+    std::vector<KSceneConflict> conflicts = {};
+    KScenePatch merged = m_diff.merge(our_patch, their_patch, conflicts);
+    bool applied = m_diff.apply(ours, merged);
+    double merge_time = milliseconds_since(start);
+    _report_skipped_types();
+
+    if (!applied || !KLProject::get()->serialize_scene(ours, m_settings->output_filename))
+    {
+        std::fprintf(stderr, "failed to merge into '%s'\n", m_settings->output_filename.c_str());
+        m_settings->exit_code = 2;
+        return;
+    }
+
+    for (const KSceneConflict& conflict : conflicts)
+        std::fprintf(stderr, "conflict: %s\n", conflict.description.c_str());
+    std::fprintf(
+        stderr, "merged %zu of their %zu changes in %.3fms, %zu conflicts kept ours\n",
+        merged.entries.size(), their_patch.entries.size(), merge_time, conflicts.size()
+    );
+
+    m_settings->exit_code = conflicts.empty() ? 0 : 1;
+}
+
+void KLSceneTool::_generate()
+{
+    KLSceneManager* scene_manager = KIApplication::get_layer<KLSceneManager>();
+    scene_manager->set_active(scene_manager->push("generated"));
+    KScene* scene = scene_manager->get_active_scene();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    KSceneGenerator generator = KSceneGenerator(m_settings->generator);
+    KSceneGeneratorStats stats = generator.generate(scene);
+    double generate_time = milliseconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    if (!KLProject::get()->serialize_scene(scene, m_settings->output_filename))
+    {
+        std::fprintf(stderr, "failed to write '%s'\n", m_settings->output_filename.c_str());
+        m_settings->exit_code = 2;
+        return;
+    }
+    double save_time = milliseconds_since(start);
+
+    std::error_code error = {};
+    std::uintmax_t file_size = std::filesystem::file_size(m_settings->output_filename, error);
+    std::fprintf(
+        stderr,
+        "generated %zu entities from seed %llu in %.3fms (%zu names, %zu tags, %zu cameras, %zu "
+        "meshes, %zu parented, deepest chain %d, %zu string bytes), saved %.1fKB in %.3fms\n",
+        stats.entity_count, static_cast<unsigned long long>(m_settings->generator.seed),
+        generate_time, stats.name_count, stats.tag_count, stats.camera_count, stats.mesh_count,
+        stats.parent_count, stats.deepest_chain, stats.string_bytes,
+        error ? 0.0 : static_cast<double>(file_size) / 1024.0, save_time
+    );
+}
+
+void KLSceneTool::_report_skipped_types()
+{
+    for (const std::string& type : m_diff.get_skipped_types())
+        std::fprintf(stderr, "warning: %s can't be compared field by field\n", type.c_str());
+}
+
+void KLSceneTool::_finish()
+{
+    m_finished = true;
+    glfwSetWindowShouldClose(KIApplication::get_layer<KLWindow>()->get_internal(), GLFW_TRUE);
+}
@@ -0,0 +1,76 @@
+#ifndef __KRYOS_EDITOR_CORE_SCENE_TOOL_HPP__
+#define __KRYOS_EDITOR_CORE_SCENE_TOOL_HPP__
+
+#include "core/command_line.hpp"
+#include "core/scene_diff.hpp"
+#include "core/scene_generator.hpp"
+
+#include <kryos/core/application.hpp>
+#include <kryos/scene/scene_manager.hpp>
+
+#include <string>
+#include <vector>
+
+enum KESceneTool
+{
+    KESceneTool_Diff,
+    KESceneTool_Merge,
+    KESceneTool_Generate,
+};
+
+struct KSceneToolSettings
+{
+    KESceneTool tool = KESceneTool_Diff;
+    std::string project_filename = {};
+    // Base and other for a diff, base, ours and theirs for a merge
+    std::vector<std::string> scene_filenames = {};
+    // The patch a diff is written to, the scene a merge or generate is written to
+    std::string output_filename = {};
+    KSceneGeneratorSettings generator = {};
+
+    // 0 when the scenes are the same or merged cleanly, 1 when they differ or conflict, like diff
+    // and git merge drivers, 2 when something failed
+    int exit_code = 0;
+};
+
+// `Kryos diff` and `Kryos merge` load scenes offscreen into an application without the editor
+// workspace, so they can run as git's diff and merge drivers for scene files. `Kryos generate`
+// writes seeded synthetic scenes the same way, as fixtures for benchmarks
+class KSceneToolApp final : public KIApplication
+{
+  public:
+    static int run_diff(const KCommandLine& command_line);
+    static int run_merge(const KCommandLine& command_line);
+    static int run_generate(const KCommandLine& command_line);
+
+  public:
+    KSceneToolApp(KSceneToolSettings* settings);
+    virtual ~KSceneToolApp() override = default;
+
+  private:
+    static int _run(KSceneToolSettings& settings);
+};
+
+class KLSceneTool final : public KIApplicationLayer
+{
+  public:
+    KLSceneTool(KSceneToolSettings* settings);
+    virtual ~KLSceneTool() override = default;
+
+    virtual void on_update() override;
+
+  private:
+    KScene* _load_scene(const std::string& name, const std::string& filename);
+    void _diff();
+    void _merge();
+    void _generate();
+    void _report_skipped_types();
+    void _finish();
+
+  private:
+    KSceneToolSettings* m_settings = nullptr;
+    KSceneDiff m_diff = {};
+    bool m_finished = false;
+};
+
+#endif
@@ -0,0 +1,364 @@
+#include "core/spatial_index.hpp"
+#include "core/editor_entities.hpp"
+#include "core/mesh_lods.hpp"
+#include "utils/transform.hpp"
+
+#include <kryos/core/application.hpp>
+#include <kryos/core/debug.hpp>
+#include <kryos/serialization/reflection.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <unordered_set>
+
+KLSpatialIndex* KLSpatialIndex::m_Instance = nullptr;
+
+KLSpatialIndex::KLSpatialIndex()
+{
+    assert(
+        m_Instance == nullptr && "SpatialIndex::SpatialIndex() -> cannot created multiple "
+                                 "spatial index application layers"
+    );
+
+    m_Instance = this;
+}
+
+const KAabb* KLSpatialIndex::find_bounds(ecs::Entity entity) const
+{
+    auto it = m_proxies.find(entity);
+    return it != m_proxies.end() ? &it->second.aabb : nullptr;
+}
+
+const glm::mat4* KLSpatialIndex::find_world_matrix(ecs::Entity entity) const
+{
+    auto it = m_proxies.find(entity);
+    return it != m_proxies.end() ? &it->second.world : nullptr;
+}
+
+const KAabb& KLSpatialIndex::get_model_bounds(KModelHandle model)
+{
+    auto it = m_model_bounds.find(model);
+    if (it != m_model_bounds.end())
+        return it->second;
+
+    // NOTE: Relies on the model's meshes keeping their index list and vertex array around after
+    // upload, the same as the mesh LODs
+    KAabb bounds = {
+        glm::vec3(std::numeric_limits<float>::max()),
+        glm::vec3(std::numeric_limits<float>::lowest())
+    };
+    std::vector<glm::vec3> positions = {};
+    for (const auto& mesh : model->meshes)
+    {
+        std::uint32_t max_index = 0;
+        for (std::uint32_t index : mesh.indices)
+            max_index = std::max(max_index, index);
+
+        if (mesh.indices.empty() ||
+            !KLMeshLods::read_positions(mesh.vertex_array, max_index + 1, positions))
+            continue;
+
+        for (const glm::vec3& position : positions)
+        {
+            bounds.min = glm::min(bounds.min, position);
+            bounds.max = glm::max(bounds.max, position);
+        }
+    }
+
+    if (bounds.min.x > bounds.max.x)
+    {
+        // The editor's own shapes fit in a cube of two units
+        KLDebug::log(
+            "SpatialIndex::get_model_bounds() -> cannot read the positions of a model, bounding "
+            "it by a unit cube",
+            KEDebugType_Warning
+        );
+        bounds = KAabb{glm::vec3(-1.0f), glm::vec3(1.0f)};
+    }
+
+    return m_model_bounds.emplace(model, bounds).first->second;
+}
+
+void KLSpatialIndex::on_update()
+{
+    KScene* scene = KIApplication::get_layer<KLSceneManager>()->get_active_scene();
+    if (scene != m_scene)
+    {
+        m_bvh.clear();
+        m_proxies.clear();
+        m_children.clear();
+        m_renderables.reset();
+        m_parented.reset();
+        m_scene = scene;
+        m_entity_count = 0;
+
+        if (m_scene != nullptr)
+            _sync(m_scene);
+        return;
+    }
+
+    if (m_scene == nullptr)
+        return;
+
+    KLSceneChanges* changes = KLSceneChanges::get();
+    m_last_refit_count = 0;
+
+    // Reloaded models can have new extents
+    if (changes->get_asset_version() != m_asset_version)
+        m_model_bounds.clear();
+
+    // Parents are only known from the last full sync, reparenting has to go through one
+    bool full_sync =
+        changes->get_structure_version() != m_structure_version ||
+        changes->get_asset_version() != m_asset_version ||
+        changes->get_pool_mutations(KTypeId::create<KCParent>().get_id()) != m_parent_mutations ||
+        m_scene->get_registry().get_entities().size() != m_entity_count;
+
+    bool moved =
+        changes->get_pool_mutations(KTypeId::create<KCTransform>().get_id()) !=
+            m_transform_mutations ||
+        changes->get_pool_mutations(KTypeId::create<KCMeshRenderer>().get_id()) !=
+            m_mesh_renderer_mutations;
+
+    if (!full_sync && moved)
+    {
+        const KEntityMutation* mutations = nullptr;
+        std::size_t count = 0;
+        if (changes->get_entity_mutations(m_mutation_version, mutations, count))
+        {
+            _find_pools(m_scene);
+            _refit(mutations, count);
+            _store_versions();
+        }
+        else
+            full_sync = true;
+    }
+
+    if (full_sync)
+        _sync(m_scene);
+}
+
+void KLSpatialIndex::query(const KFrustum& frustum, std::vector<ecs::Entity>& visible) const
+{
+    visible.clear();
+    m_bvh.query(
+        frustum,
+        [&](std::uint64_t user_data) { visible.push_back(static_cast<ecs::Entity>(user_data)); }
+    );
+}
+
+ecs::Entity KLSpatialIndex::raycast(
+    const glm::vec3& origin, const glm::vec3& direction, float max_distance
+) const
+{
+    glm::vec3 inverse_direction = glm::vec3(1.0f) / direction;
+    ecs::Entity closest = ECS_ENTITY_DESTROYED;
+
+    // The tree only stores fat bounds, the tight bounds decide the actual hit
+    m_bvh.raycast(
+        origin, direction, max_distance,
+        [&](std::uint64_t user_data, float) -> float
+        {
+            ecs::Entity entity = static_cast<ecs::Entity>(user_data);
+            float t_enter = 0.0f;
+            if (m_proxies.at(entity).aabb.raycast(
+                    origin, inverse_direction, max_distance, t_enter
+                ))
+            {
+                max_distance = t_enter;
+                closest = entity;
+            }
+            return max_distance;
+        }
+    );
+
+    return closest;
+}
+
+void KLSpatialIndex::_find_pools(KScene* scene)
+{
+    m_transform_pool = nullptr;
+    m_mesh_renderer_pool = nullptr;
+    m_parent_pool = nullptr;
+    for (ecs::ObjectPool* pool : scene->get_registry().get_pools())
+    {
+        if (pool->get_type_hash() == KTypeId::create<KCTransform>().get_id())
+            m_transform_pool = pool;
+        else if (pool->get_type_hash() == KTypeId::create<KCMeshRenderer>().get_id())
+            m_mesh_renderer_pool = pool;
+        else if (pool->get_type_hash() == KTypeId::create<KCParent>().get_id())
+            m_parent_pool = pool;
+    }
+
+    m_parent_member = KLMemberTables::get()->find_entity_member(
+        KTypeId::create<KCParent>().get_id()
+    );
+}
+
+void KLSpatialIndex::_sync(KScene* scene)
+{
+    _find_pools(scene);
+    m_generation++;
+    m_last_refit_count = 0;
+    m_full_sync_count++;
+
+    // Children are looked up when a parent moves, so only the parented entities are walked here
+    m_children.clear();
+    for (ecs::Entity entity : m_parented.update(scene))
+    {
+        ecs::Entity parent = _get_parent(entity);
+        if (parent != ECS_ENTITY_DESTROYED)
+            m_children[parent].push_back(entity);
+    }
+
+    // Only the entities with both components are walked, not the whole registry. The query can
+    // lag behind entities destroyed or stripped outside the editor, their proxies are removed
+    // right away or by the sweep below
+    for (ecs::Entity entity : m_renderables.update(scene))
+        _update_proxy(entity);
+
+    // Anything not seen this pass was destroyed or lost one of its components
+    for (auto it = m_proxies.begin(); it != m_proxies.end();)
+    {
+        if (it->second.generation != m_generation)
+        {
+            m_bvh.destroy_proxy(it->second.proxy);
+            it = m_proxies.erase(it);
+            m_last_refit_count++;
+        }
+        else
+            it++;
+    }
+
+    _store_versions();
+}
+
+void KLSpatialIndex::_refit(const KEntityMutation* mutations, std::size_t count)
+{
+    const std::uint64_t transform_type = KTypeId::create<KCTransform>().get_id();
+    const std::uint64_t mesh_renderer_type = KTypeId::create<KCMeshRenderer>().get_id();
+
+    // An entity edited several times since the last update is only refit once
+    std::unordered_set<ecs::Entity> refit = {};
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const KEntityMutation& mutation = mutations[i];
+        if (mutation.type_hash != transform_type && mutation.type_hash != mesh_renderer_type)
+            continue;
+        if (!refit.insert(mutation.entity).second)
+            continue;
+
+        _update_proxy(mutation.entity);
+        // Only a transform moves what's parented to the entity
+        if (mutation.type_hash == transform_type)
+            _refit_children(mutation.entity, 0);
+    }
+}
+
+void KLSpatialIndex::_refit_children(ecs::Entity entity, int depth)
+{
+    auto it = m_children.find(entity);
+    if (it == m_children.end() || depth >= max_parent_depth)
+        return;
+
+    for (ecs::Entity child : it->second)
+    {
+        _update_proxy(child);
+        _refit_children(child, depth + 1);
+    }
+}
+
+void KLSpatialIndex::_update_proxy(ecs::Entity entity)
+{
+    KCTransform* transform = nullptr;
+    KCMeshRenderer* mesh_renderer = nullptr;
+    if (entity != ECS_ENTITY_DESTROYED && m_transform_pool != nullptr &&
+        m_mesh_renderer_pool != nullptr &&
+        !KLEditorEntities::get()->is_editor_entity(m_scene, entity))
+    {
+        transform = static_cast<KCTransform*>(m_transform_pool->get_entitys_object(entity));
+        mesh_renderer =
+            static_cast<KCMeshRenderer*>(m_mesh_renderer_pool->get_entitys_object(entity));
+    }
+
+    auto it = m_proxies.find(entity);
+    if (transform == nullptr || mesh_renderer == nullptr || mesh_renderer->model == nullptr)
+    {
+        if (it != m_proxies.end())
+        {
+            m_bvh.destroy_proxy(it->second.proxy);
+            m_proxies.erase(it);
+            m_last_refit_count++;
+        }
+        return;
+    }
+
+    glm::mat4 world = _world_matrix(*transform, entity);
+    KAabb aabb = KAabb::transform(get_model_bounds(mesh_renderer->model), world);
+    if (it == m_proxies.end())
+    {
+        KProxy proxy = {};
+        proxy.proxy = m_bvh.create_proxy(aabb, static_cast<std::uint64_t>(entity));
+        proxy.aabb = aabb;
+        proxy.world = world;
+        proxy.generation = m_generation;
+        m_proxies.emplace(entity, proxy);
+        m_last_refit_count++;
+        return;
+    }
+
+    KProxy& proxy = it->second;
+    if (proxy.aabb.min != aabb.min || proxy.aabb.max != aabb.max)
+    {
+        m_bvh.move_proxy(proxy.proxy, aabb);
+        proxy.aabb = aabb;
+        m_last_refit_count++;
+    }
+    proxy.world = world;
+    proxy.generation = m_generation;
+}
+
+glm::mat4 KLSpatialIndex::_world_matrix(const KCTransform& transform, ecs::Entity entity) const
+{
+    // Parents without a transform of their own don't move their children
+    glm::mat4 world = TransformHelper::model_matrix(transform);
+    ecs::Entity parent = _get_parent(entity);
+    for (int depth = 0; parent != ECS_ENTITY_DESTROYED && depth < max_parent_depth; depth++)
+    {
+        KCTransform* parent_transform =
+            static_cast<KCTransform*>(m_transform_pool->get_entitys_object(parent));
+        if (parent_transform != nullptr)
+            world = TransformHelper::model_matrix(*parent_transform) * world;
+        parent = _get_parent(parent);
+    }
+    return world;
+}
+
+ecs::Entity KLSpatialIndex::_get_parent(ecs::Entity entity) const
+{
+    if (m_parent_pool == nullptr || m_parent_member == nullptr)
+        return ECS_ENTITY_DESTROYED;
+
+    std::byte* parent_component =
+        static_cast<std::byte*>(m_parent_pool->get_entitys_object(entity));
+    if (parent_component == nullptr)
+        return ECS_ENTITY_DESTROYED;
+
+    ecs::Entity parent = ECS_ENTITY_DESTROYED;
+    std::memcpy(&parent, parent_component + m_parent_member->offset, sizeof(ecs::Entity));
+    return parent != entity ? parent : ECS_ENTITY_DESTROYED;
+}
+
+void KLSpatialIndex::_store_versions()
+{
+    KLSceneChanges* changes = KLSceneChanges::get();
+    m_transform_mutations = changes->get_pool_mutations(KTypeId::create<KCTransform>().get_id());
+    m_mesh_renderer_mutations =
+        changes->get_pool_mutations(KTypeId::create<KCMeshRenderer>().get_id());
+    m_parent_mutations = changes->get_pool_mutations(KTypeId::create<KCParent>().get_id());
+    m_mutation_version = changes->get_mutation_version();
+    m_structure_version = changes->get_structure_version();
+    m_asset_version = changes->get_asset_version();
+    m_entity_count = m_scene->get_registry().get_entities().size();
+}
@@ -0,0 +1,103 @@
+#ifndef __KRYOS_EDITOR_CORE_SPATIAL_INDEX_HPP__
+#define __KRYOS_EDITOR_CORE_SPATIAL_INDEX_HPP__
+
+#include "core/bvh.hpp"
+#include "core/member_tables.hpp"
+#include "core/render_queue.hpp"
+#include "core/scene_changes.hpp"
+#include "core/scene_query.hpp"
+
+#include <kryos/core/application_layer.hpp>
+#include <kryos/scene/components.hpp>
+#include <kryos/scene/scene_manager.hpp>
+
+#include <glm/glm.hpp>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+// Parent chains longer than this are cut off, so a cycle can't hang the index
+constexpr int max_parent_depth = 256;
+
+// BVH over the world bounds of every mesh renderer in the active scene, used for frustum culling
+// and picking in the viewport. A renderer's bounds are its model's bounds moved by its world
+// matrix, which goes up its chain of KCParent. Kept in sync once per frame: entities whose
+// transform or mesh renderer was edited on its own are refit along with their children, the
+// registry is only walked again when the structure changed or a pool was mutated as a whole
+class KLSpatialIndex : public KIApplicationLayer
+{
+  public:
+    inline static KLSpatialIndex* get() { return m_Instance; }
+
+  public:
+    KLSpatialIndex();
+    virtual ~KLSpatialIndex() override = default;
+
+    inline const KDynamicBvh& get_bvh() const { return m_bvh; }
+    inline std::size_t get_last_refit_count() const { return m_last_refit_count; }
+    // Updates that walked every renderable instead of only the edited ones
+    inline std::size_t get_full_sync_count() const { return m_full_sync_count; }
+
+    // Null when the entity isn't indexed, valid until the next update
+    const KAabb* find_bounds(ecs::Entity entity) const;
+    const glm::mat4* find_world_matrix(ecs::Entity entity) const;
+    // Bounds of every mesh of the model in model space, read back once per model
+    const KAabb& get_model_bounds(KModelHandle model);
+
+    virtual void on_update() override;
+
+    void query(const KFrustum& frustum, std::vector<ecs::Entity>& visible) const;
+    ecs::Entity raycast(
+        const glm::vec3& origin, const glm::vec3& direction,
+        float max_distance = std::numeric_limits<float>::max()
+    ) const;
+
+  private:
+    struct KProxy
+    {
+        std::int32_t proxy = KDynamicBvh::null_node;
+        KAabb aabb = {};
+        glm::mat4 world = glm::mat4(1.0f);
+        std::uint64_t generation = 0;
+    };
+
+    static KLSpatialIndex* m_Instance;
+
+  private:
+    void _find_pools(KScene* scene);
+    void _sync(KScene* scene);
+    void _refit(const KEntityMutation* mutations, std::size_t count);
+    void _refit_children(ecs::Entity entity, int depth);
+    // Creates, moves or removes the entity's proxy to match its components
+    void _update_proxy(ecs::Entity entity);
+    glm::mat4 _world_matrix(const KCTransform& transform, ecs::Entity entity) const;
+    ecs::Entity _get_parent(ecs::Entity entity) const;
+    void _store_versions();
+
+  private:
+    KDynamicBvh m_bvh = {};
+    KSceneQuery m_renderables = KSceneQuery::create<KCTransform, KCMeshRenderer>();
+    KSceneQuery m_parented = KSceneQuery::create<KCParent>();
+    std::unordered_map<ecs::Entity, KProxy> m_proxies = {};
+    std::unordered_map<ecs::Entity, std::vector<ecs::Entity>> m_children = {};
+    std::unordered_map<KModelHandle, KAabb> m_model_bounds = {};
+    std::uint64_t m_generation = 0;
+    std::size_t m_last_refit_count = 0;
+    std::size_t m_full_sync_count = 0;
+
+    KScene* m_scene = nullptr;
+    ecs::ObjectPool* m_transform_pool = nullptr;
+    ecs::ObjectPool* m_mesh_renderer_pool = nullptr;
+    ecs::ObjectPool* m_parent_pool = nullptr;
+    const KMemberEntry* m_parent_member = nullptr;
+
+    std::uint64_t m_transform_mutations = 0;
+    std::uint64_t m_mesh_renderer_mutations = 0;
+    std::uint64_t m_parent_mutations = 0;
+    std::uint64_t m_mutation_version = 0;
+    std::uint64_t m_structure_version = 0;
+    std::uint64_t m_asset_version = 0;
+    std::size_t m_entity_count = 0;
+};
+
+#endif
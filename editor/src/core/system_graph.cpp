@@ -0,0 +1,153 @@
+#include "core/system_graph.hpp"
+
+#include <algorithm>
+
+static double milliseconds_between(
+    std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end
+)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static bool intersects(
+    const std::vector<std::uint64_t>& first, const std::vector<std::uint64_t>& second
+)
+{
+    for (std::uint64_t type : first)
+    {
+        if (std::find(second.begin(), second.end(), type) != second.end())
+            return true;
+    }
+    return false;
+}
+
+const std::vector<std::size_t>& KSystemGraph::get_dependencies(std::size_t system)
+{
+    if (!m_built)
+        _build();
+    return m_dependencies[system];
+}
+
+std::size_t KSystemGraph::add(KSystem system)
+{
+    m_systems.push_back(std::move(system));
+    m_built = false;
+    return m_systems.size() - 1;
+}
+
+void KSystemGraph::clear()
+{
+    m_systems.clear();
+    m_dependencies.clear();
+    m_dependents.clear();
+    m_timings.clear();
+    m_built = false;
+}
+
+void KSystemGraph::run(KScene* scene, float delta_time, KJobScheduler* scheduler)
+{
+    if (!m_built)
+        _build();
+
+    m_timings.assign(m_systems.size(), {});
+    m_run_start = std::chrono::steady_clock::now();
+
+    if (scheduler == nullptr)
+    {
+        for (std::size_t i = 0; i < m_systems.size(); i++)
+            _run_system(i, scene, delta_time, nullptr, nullptr);
+    }
+    else
+    {
+        for (std::size_t i = 0; i < m_systems.size(); i++)
+            m_waiting[i].store(m_dependencies[i].size(), std::memory_order_relaxed);
+
+        // Systems push the ones waiting on them, the counter covers those as well
+        KJobCounter counter = {};
+        for (std::size_t i = 0; i < m_systems.size(); i++)
+        {
+            if (m_dependencies[i].empty())
+            {
+                scheduler->push(
+                    counter, [=, this, &counter]()
+                    { _run_system(i, scene, delta_time, scheduler, &counter); }
+                );
+            }
+        }
+        scheduler->wait(counter);
+    }
+
+    m_last_time = milliseconds_between(m_run_start, std::chrono::steady_clock::now());
+    for (KSystemTiming& timing : m_timings)
+    {
+        for (const KSystemTiming& other : m_timings)
+        {
+            if (&other != &timing && other.start < timing.start + timing.duration &&
+                timing.start < other.start + other.duration)
+                timing.parallel_count++;
+        }
+    }
+}
+
+bool KSystemGraph::_conflicts(const KSystem& first, const KSystem& second)
+{
+    return intersects(first.writes, second.writes) || intersects(first.writes, second.reads) ||
+           intersects(first.reads, second.writes);
+}
+
+void KSystemGraph::_build()
+{
+    // Only the closest earlier system a system conflicts with per type would be enough, but
+    // graphs are small and waiting on every one of them is simpler to get right
+    m_dependencies.assign(m_systems.size(), {});
+    m_dependents.assign(m_systems.size(), {});
+    for (std::size_t second = 0; second < m_systems.size(); second++)
+    {
+        for (std::size_t first = 0; first < second; first++)
+        {
+            if (_conflicts(m_systems[first], m_systems[second]))
+            {
+                m_dependencies[second].push_back(first);
+                m_dependents[first].push_back(second);
+            }
+        }
+    }
+
+    m_waiting = std::make_unique<std::atomic<std::size_t>[]>(m_systems.size());
+    m_built = true;
+}
+
+void KSystemGraph::_run_system(
+    std::size_t system, KScene* scene, float delta_time, KJobScheduler* scheduler,
+    KJobCounter* counter
+)
+{
+    KSystemContext context = {};
+    context.scene = scene;
+    context.delta_time = delta_time;
+    context.scheduler = scheduler;
+
+    KSystemTiming& timing = m_timings[system];
+    timing.worker = scheduler != nullptr ? scheduler->get_worker_index() : 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (m_systems[system].run)
+        m_systems[system].run(context);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    timing.start = milliseconds_between(m_run_start, start);
+    timing.duration = milliseconds_between(start, end);
+    timing.chunk_count = context.chunk_count;
+
+    if (scheduler == nullptr)
+        return;
+
+    for (std::size_t dependent : m_dependents[system])
+    {
+        if (m_waiting[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            scheduler->push(
+                *counter, [=, this]()
+                { _run_system(dependent, scene, delta_time, scheduler, counter); }
+            );
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef __KRYOS_EDITOR_CORE_SYSTEM_GRAPH_HPP__
+#define __KRYOS_EDITOR_CORE_SYSTEM_GRAPH_HPP__
+
+#include "core/job_scheduler.hpp"
+
+#include <kryos/scene/scene_manager.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct KSystemContext
+{
+    KScene* scene = nullptr;
+    float delta_time = 0.0f;
+    // Null when the graph runs serially
+    KJobScheduler* scheduler = nullptr;
+    std::size_t chunk_count = 0;
+
+    // Calls callback(begin, end) for chunks of [0, count), in parallel when there is a scheduler
+    template<typename _Callback>
+    inline void parallel_for(std::size_t count, std::size_t grain, _Callback&& callback)
+    {
+        if (scheduler == nullptr || count <= grain)
+        {
+            callback(std::size_t(0), count);
+            chunk_count++;
+        }
+        else
+            chunk_count += scheduler->parallel_for(count, grain, callback);
+    }
+};
+
+struct KSystem
+{
+    std::string name = {};
+    // Component types the system only reads and the ones it writes
+    std::vector<std::uint64_t> reads = {};
+    std::vector<std::uint64_t> writes = {};
+    std::function<void(KSystemContext&)> run = {};
+};
+
+struct KSystemTiming
+{
+    // Milliseconds since the graph started running
+    double start = 0.0;
+    double duration = 0.0;
+    // The scheduler's worker index, get_thread_count() for the thread that ran the graph and 0
+    // when it ran serially
+    std::size_t worker = 0;
+    std::size_t chunk_count = 0;
+    // Systems that were running at some point while this one was
+    std::size_t parallel_count = 0;
+};
+
+// Systems declare the components they read and write. Two systems conflict when one writes what
+// the other reads or writes, conflicting systems run in the order they were added and everything
+// else runs in parallel on the scheduler as soon as what it waits for has finished
+class KSystemGraph
+{
+  public:
+    KSystemGraph() = default;
+    ~KSystemGraph() = default;
+
+    inline const std::vector<KSystem>& get_systems() const { return m_systems; }
+    // From the last run, in the order the systems were added
+    inline const std::vector<KSystemTiming>& get_timings() const { return m_timings; }
+    inline double get_last_time() const { return m_last_time; }
+    const std::vector<std::size_t>& get_dependencies(std::size_t system);
+
+    std::size_t add(KSystem system);
+    void clear();
+
+    // Without a scheduler the systems run one after another on the caller
+    void run(KScene* scene, float delta_time, KJobScheduler* scheduler);
+
+  private:
+    static bool _conflicts(const KSystem& first, const KSystem& second);
+
+    void _build();
+    void _run_system(
+        std::size_t system, KScene* scene, float delta_time, KJobScheduler* scheduler,
+        KJobCounter* counter
+    );
+
+  private:
+    std::vector<KSystem> m_systems = {};
+    std::vector<std::vector<std::size_t>> m_dependencies = {};
+    std::vector<std::vector<std::size_t>> m_dependents = {};
+    bool m_built = false;
+
+    // Dependencies each system still waits for during a run
+    std::unique_ptr<std::atomic<std::size_t>[]> m_waiting = {};
+    std::chrono::steady_clock::time_point m_run_start = {};
+    std::vector<KSystemTiming> m_timings = {};
+    double m_last_time = 0.0;
+};
+
+#endif
@@ -0,0 +1,383 @@
+#include "core/texture_cooker.hpp"
+#include "core/block_compression.hpp"
+#include "core/mapped_file.hpp"
+#include "core/mesh_cooker.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+// Block rows handed to a thread at a time, small enough to balance the last mips
+static constexpr std::uint32_t rows_per_task = 4;
+
+static float srgb_to_linear(float value)
+{
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+static float linear_to_srgb(float value)
+{
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+static std::uint8_t to_unorm8(float value)
+{
+    return static_cast<std::uint8_t>(std::clamp(value * 255.0f + 0.5f, 0.0f, 255.0f));
+}
+
+static std::uint64_t align_up(std::uint64_t value)
+{
+    return (value + texture_file_alignment - 1) & ~(texture_file_alignment - 1);
+}
+
+std::uint32_t KTextureCooker::get_channel_mask(KETextureFormat format)
+{
+    switch (format)
+    {
+    case KETextureFormat_BC1:
+        return 0x7;
+    case KETextureFormat_BC5:
+        return 0x3;
+    default:
+        return 0xf;
+    }
+}
+
+const char* KTextureCooker::get_format_name(KETextureFormat format)
+{
+    switch (format)
+    {
+    case KETextureFormat_RGBA8:
+        return "RGBA8";
+    case KETextureFormat_BC1:
+        return "BC1";
+    case KETextureFormat_BC3:
+        return "BC3";
+    case KETextureFormat_BC5:
+        return "BC5";
+    default:
+        return "Auto";
+    }
+}
+
+bool KTextureCooker::is_normal_map_name(const std::string& filename)
+{
+    std::string stem = std::filesystem::path(filename).stem().string();
+    std::transform(stem.begin(), stem.end(), stem.begin(), ::tolower);
+    return stem.ends_with("_n") || stem.ends_with("_nrm") || stem.ends_with("_normal");
+}
+
+KETextureFormat KTextureCooker::select_format(const KSourceImage& image, bool normal_map)
+{
+    if (normal_map)
+        return KETextureFormat_BC5;
+
+    for (std::size_t i = 3; i < image.pixels.size(); i += 4)
+    {
+        if (image.pixels[i] != 255)
+            return KETextureFormat_BC3;
+    }
+    return KETextureFormat_BC1;
+}
+
+void KTextureCooker::generate_mip(
+    const std::vector<std::uint8_t>& source, std::uint32_t width, std::uint32_t height, bool srgb,
+    bool normal_map, std::vector<std::uint8_t>& mip
+)
+{
+    static const std::array<float, 256> srgb_table = []()
+    {
+        std::array<float, 256> table = {};
+        for (std::size_t i = 0; i < table.size(); i++)
+            table[i] = srgb_to_linear(static_cast<float>(i) / 255.0f);
+        return table;
+    }();
+
+    std::uint32_t mip_width = std::max(width / 2, 1u);
+    std::uint32_t mip_height = std::max(height / 2, 1u);
+    mip.resize(static_cast<std::size_t>(mip_width) * mip_height * 4);
+
+    for (std::uint32_t y = 0; y < mip_height; y++)
+    {
+        // Odd sizes fold the last row and column into the mip's last texel
+        std::uint32_t rows[2] = {std::min(y * 2, height - 1), std::min(y * 2 + 1, height - 1)};
+        for (std::uint32_t x = 0; x < mip_width; x++)
+        {
+            std::uint32_t columns[2] = {std::min(x * 2, width - 1), std::min(x * 2 + 1, width - 1)};
+            float sum[4] = {};
+            for (std::uint32_t row : rows)
+            {
+                for (std::uint32_t column : columns)
+                {
+                    const std::uint8_t* texel =
+                        source.data() + (static_cast<std::size_t>(row) * width + column) * 4;
+                    for (int channel = 0; channel < 4; channel++)
+                    {
+                        bool linearize = srgb && channel < 3;
+                        sum[channel] += linearize ? srgb_table[texel[channel]]
+                                                  : static_cast<float>(texel[channel]) / 255.0f;
+                    }
+                }
+            }
+
+            std::uint8_t* texel = mip.data() + (static_cast<std::size_t>(y) * mip_width + x) * 4;
+            float average[4] = {sum[0] * 0.25f, sum[1] * 0.25f, sum[2] * 0.25f, sum[3] * 0.25f};
+            if (normal_map)
+            {
+                // Averaged normals get shorter, renormalize so lighting doesn't darken with
+                // distance
+                float normal[3] = {
+                    average[0] * 2.0f - 1.0f, average[1] * 2.0f - 1.0f, average[2] * 2.0f - 1.0f
+                };
+                float length = std::sqrt(
+                    normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]
+                );
+                if (length > 0.0f)
+                {
+                    for (int channel = 0; channel < 3; channel++)
+                        average[channel] = normal[channel] / length * 0.5f + 0.5f;
+                }
+            }
+
+            for (int channel = 0; channel < 4; channel++)
+            {
+                bool delinearize = srgb && channel < 3;
+                texel[channel] =
+                    to_unorm8(delinearize ? linear_to_srgb(average[channel]) : average[channel]);
+            }
+        }
+    }
+}
+
+float KTextureCooker::compute_psnr(
+    const std::uint8_t* expected, const std::uint8_t* actual, std::size_t pixel_count,
+    std::uint32_t channel_mask
+)
+{
+    double squared_error = 0.0;
+    std::size_t sample_count = 0;
+    for (int channel = 0; channel < 4; channel++)
+    {
+        if ((channel_mask & (1u << channel)) == 0)
+            continue;
+
+        for (std::size_t i = 0; i < pixel_count; i++)
+        {
+            double difference = static_cast<double>(expected[i * 4 + channel]) -
+                                static_cast<double>(actual[i * 4 + channel]);
+            squared_error += difference * difference;
+        }
+        sample_count += pixel_count;
+    }
+
+    if (sample_count == 0 || squared_error == 0.0)
+        return 99.0f;
+
+    double mean_squared_error = squared_error / static_cast<double>(sample_count);
+    double psnr = 10.0 * std::log10(255.0 * 255.0 / mean_squared_error);
+    return static_cast<float>(std::min(psnr, 99.0));
+}
+
+std::uint64_t KTextureCooker::get_cache_key(
+    std::string_view source, const std::string& importer, const KTextureCookSettings& settings
+)
+{
+    // The thread count only changes how fast the same output is made
+    KContentHasher hasher = {};
+    hasher.update(source.data(), source.size());
+    hasher.update(importer);
+    hasher.update(
+        (static_cast<std::uint64_t>(texture_file_version) << 32) | texture_cooker_version
+    );
+    hasher.update(
+        static_cast<std::uint64_t>(settings.format) |
+        static_cast<std::uint64_t>(settings.generate_mipmaps) << 32 |
+        static_cast<std::uint64_t>(settings.srgb) << 33
+    );
+    return hasher.finish();
+}
+
+bool KTextureCooker::cook(
+    const KSourceImage& source, bool normal_map, const KTextureCookSettings& settings,
+    std::vector<char>& data, KTextureCookStats* stats
+)
+{
+    if (source.width == 0 || source.height == 0 ||
+        source.pixels.size() != static_cast<std::size_t>(source.width) * source.height * 4)
+        return false;
+
+    KETextureFormat format = settings.format == KETextureFormat_Auto
+                                 ? select_format(source, normal_map)
+                                 : settings.format;
+    bool srgb = settings.srgb && !normal_map && format != KETextureFormat_BC5;
+
+    // OpenGL's origin is the bottom left corner
+    std::size_t row_size = static_cast<std::size_t>(source.width) * 4;
+    std::vector<std::vector<std::uint8_t>> levels = {};
+    levels.emplace_back(source.pixels.size());
+    for (std::uint32_t y = 0; y < source.height; y++)
+    {
+        std::memcpy(
+            levels[0].data() + (source.height - 1 - y) * row_size,
+            source.pixels.data() + y * row_size, row_size
+        );
+    }
+
+    std::vector<std::array<std::uint32_t, 2>> sizes = {{source.width, source.height}};
+    while (settings.generate_mipmaps && levels.size() < texture_max_mips &&
+           (sizes.back()[0] > 1 || sizes.back()[1] > 1))
+    {
+        std::vector<std::uint8_t> mip = {};
+        generate_mip(levels.back(), sizes.back()[0], sizes.back()[1], srgb, normal_map, mip);
+        levels.push_back(std::move(mip));
+        sizes.push_back({std::max(sizes.back()[0] / 2, 1u), std::max(sizes.back()[1] / 2, 1u)});
+    }
+
+    KTextureFileHeader header = {};
+    header.format = format;
+    header.flags = KETextureFlags_None;
+    if (srgb)
+        header.flags |= KETextureFlags_Srgb;
+    if (normal_map)
+        header.flags |= KETextureFlags_NormalMap;
+    header.width = source.width;
+    header.height = source.height;
+    header.mip_count = static_cast<std::uint32_t>(levels.size());
+
+    std::uint64_t offset = align_up(sizeof(KTextureFileHeader));
+    for (std::uint32_t mip = 0; mip < header.mip_count; mip++)
+    {
+        header.mips[mip].offset = offset;
+        header.mips[mip].size =
+            KBlockCompression::get_mip_size(format, sizes[mip][0], sizes[mip][1]);
+        header.mips[mip].width = sizes[mip][0];
+        header.mips[mip].height = sizes[mip][1];
+        offset = align_up(offset + header.mips[mip].size);
+    }
+
+    data.assign(static_cast<std::size_t>(offset), 0);
+    std::uint8_t* output = reinterpret_cast<std::uint8_t*>(data.data());
+
+    // Every task encodes a few block rows of one mip into its own part of the output, the
+    // threads only share the counter handing the tasks out
+    struct KEncodeTask
+    {
+        std::uint32_t mip = 0;
+        std::uint32_t first_row = 0;
+    };
+    std::vector<KEncodeTask> tasks = {};
+    for (std::uint32_t mip = 0; mip < header.mip_count; mip++)
+    {
+        std::uint32_t block_rows = KBlockCompression::get_block_count(sizes[mip][1]);
+        for (std::uint32_t row = 0; row < block_rows; row += rows_per_task)
+            tasks.push_back({mip, row});
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (format == KETextureFormat_RGBA8)
+    {
+        for (std::uint32_t mip = 0; mip < header.mip_count; mip++)
+            std::memcpy(output + header.mips[mip].offset, levels[mip].data(), levels[mip].size());
+    }
+    else
+    {
+        std::atomic<std::size_t> next_task = 0;
+        auto encode = [&]()
+        {
+            for (std::size_t task = next_task.fetch_add(1); task < tasks.size();
+                 task = next_task.fetch_add(1))
+            {
+                std::uint32_t mip = tasks[task].mip;
+                KBlockCompression::encode_rows(
+                    format, levels[mip].data(), sizes[mip][0], sizes[mip][1],
+                    tasks[task].first_row, rows_per_task, output + header.mips[mip].offset
+                );
+            }
+        };
+
+        std::size_t thread_count = std::clamp<std::size_t>(settings.thread_count, 1, tasks.size());
+        std::vector<std::thread> threads = {};
+        for (std::size_t i = 1; i < thread_count; i++)
+            threads.emplace_back(encode);
+        encode();
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    std::vector<std::uint8_t> decoded = std::vector<std::uint8_t>(levels[0].size());
+    KBlockCompression::decode_image(
+        format, output + header.mips[0].offset, source.width, source.height, decoded.data()
+    );
+    std::size_t pixel_count = static_cast<std::size_t>(source.width) * source.height;
+    header.psnr =
+        compute_psnr(levels[0].data(), decoded.data(), pixel_count, get_channel_mask(format));
+
+    std::memcpy(output, &header, sizeof(header));
+
+    if (stats != nullptr)
+    {
+        stats->source_memory = source.get_memory_size();
+        stats->cooked_size = data.size();
+        stats->width = header.width;
+        stats->height = header.height;
+        stats->mip_count = header.mip_count;
+        stats->format = format;
+        stats->psnr = header.psnr;
+        stats->encoded_pixels = 0;
+        for (const std::vector<std::uint8_t>& level : levels)
+            stats->encoded_pixels += level.size() / 4;
+        stats->encode_time = std::chrono::duration<double, std::milli>(end - start).count();
+    }
+    return true;
+}
+
+bool KTextureCooker::cook_file(
+    const std::string& source_filename, const std::string& filename,
+    const KTextureCookSettings& settings, KTextureCookStats* stats, KDerivedDataCache* cache
+)
+{
+    KMappedFile file = {};
+    if (!file.open(source_filename, 0, "TextureCooker::cook_file()"))
+        return false;
+
+    std::string_view source =
+        std::string_view(reinterpret_cast<const char*>(file.get_data()), file.get_size());
+
+    // The name decides whether the image is a normal map, so it's part of the importer
+    bool normal_map = is_normal_map_name(source_filename);
+    std::uint64_t key = get_cache_key(source, normal_map ? "image:normal" : "image", settings);
+    std::vector<char> data = {};
+    if (cache != nullptr && cache->load(key, data) && data.size() >= sizeof(KTextureFileHeader))
+    {
+        if (stats != nullptr)
+        {
+            KTextureFileHeader header = {};
+            std::memcpy(&header, data.data(), sizeof(header));
+            stats->cooked_size = data.size();
+            stats->width = header.width;
+            stats->height = header.height;
+            stats->mip_count = header.mip_count;
+            stats->format = static_cast<KETextureFormat>(header.format);
+            stats->psnr = header.psnr;
+            stats->cache_hit = true;
+        }
+        return KMeshCooker::write_file(filename, data);
+    }
+
+    KSourceImage image = {};
+    if (!ImageLoader::parse(
+            reinterpret_cast<const std::uint8_t*>(source.data()), source.size(), image
+        ) ||
+        !cook(image, normal_map, settings, data, stats))
+        return false;
+
+    if (cache != nullptr)
+        cache->store(key, data);
+    return KMeshCooker::write_file(filename, data);
+}
@@ -0,0 +1,84 @@
+#ifndef __KRYOS_EDITOR_CORE_TEXTURE_COOKER_HPP__
+#define __KRYOS_EDITOR_CORE_TEXTURE_COOKER_HPP__
+
+#include "core/derived_data_cache.hpp"
+#include "core/image_loader.hpp"
+#include "core/texture_format.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Bump whenever the cooker's output changes for the same input, so stale derived data is never
+// used
+static constexpr std::uint32_t texture_cooker_version = 1;
+
+struct KTextureCookSettings
+{
+    KETextureFormat format = KETextureFormat_Auto;
+    bool generate_mipmaps = true;
+    // Color textures are filtered in linear space and flagged sRGB, normal maps never are
+    bool srgb = true;
+    // Threads encoding the blocks of one texture, 1 keeps everything on the calling thread
+    std::uint32_t thread_count = 1;
+};
+
+struct KTextureCookStats
+{
+    std::size_t source_memory = 0;
+    std::size_t cooked_size = 0;
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    std::uint32_t mip_count = 0;
+    KETextureFormat format = KETextureFormat_RGBA8;
+    // Of the largest mip against the source, in dB
+    float psnr = 0.0f;
+    // Pixels fed to the block encoder over every mip and the milliseconds it took
+    std::size_t encoded_pixels = 0;
+    double encode_time = 0.0;
+    // Only the header's values are known when the result came from the derived data cache
+    bool cache_hit = false;
+};
+
+// Turns source images into the engine native texture format: flipped to OpenGL's row order, a
+// full mip chain box filtered in linear space, then every mip block compressed with the blocks
+// split between threads. The format follows the image unless forced, normal maps (named *_n,
+// *_nrm or *_normal) become BC5, images with any transparency BC3 and everything else BC1
+class KTextureCooker
+{
+  public:
+    static const char* get_format_name(KETextureFormat format);
+    static bool is_normal_map_name(const std::string& filename);
+    static KETextureFormat select_format(const KSourceImage& image, bool normal_map);
+    // Channels the format keeps, as compute_psnr() takes them
+    static std::uint32_t get_channel_mask(KETextureFormat format);
+
+    // Keyed by the source's content, the importer and everything that changes the output
+    static std::uint64_t get_cache_key(
+        std::string_view source, const std::string& importer,
+        const KTextureCookSettings& settings
+    );
+    static bool cook(
+        const KSourceImage& source, bool normal_map, const KTextureCookSettings& settings,
+        std::vector<char>& data, KTextureCookStats* stats
+    );
+    // Looks the source up in the cache first when one is given and stores the result on a miss
+    static bool cook_file(
+        const std::string& source_filename, const std::string& filename,
+        const KTextureCookSettings& settings, KTextureCookStats* stats,
+        KDerivedDataCache* cache = nullptr
+    );
+
+    static void generate_mip(
+        const std::vector<std::uint8_t>& source, std::uint32_t width, std::uint32_t height,
+        bool srgb, bool normal_map, std::vector<std::uint8_t>& mip
+    );
+    // Over the channels set in channel_mask (bit 0 red to bit 3 alpha), 99dB when they match
+    static float compute_psnr(
+        const std::uint8_t* expected, const std::uint8_t* actual, std::size_t pixel_count,
+        std::uint32_t channel_mask
+    );
+};
+
+#endif
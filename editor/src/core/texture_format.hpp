@@ -0,0 +1,61 @@
+#ifndef __KRYOS_EDITOR_CORE_TEXTURE_FORMAT_HPP__
+#define __KRYOS_EDITOR_CORE_TEXTURE_FORMAT_HPP__
+
+#include <cstdint>
+
+// Engine native texture file (.ktex). Everything is little endian and laid out so the file can be
+// mapped into memory and every mip level handed to the GPU as it is: a header, then the mip
+// levels from largest to smallest, each starting on a 16 byte boundary. Rows are stored bottom
+// row first like OpenGL expects
+
+static constexpr std::uint32_t texture_file_magic = 0x5845544b; // "KTEX"
+static constexpr std::uint32_t texture_file_version = 1;
+static constexpr std::uint64_t texture_file_alignment = 16;
+static constexpr std::uint32_t texture_max_mips = 16;
+
+enum KETextureFormat : std::uint32_t
+{
+    KETextureFormat_RGBA8,
+    // 4x4 blocks, 8 bytes of RGB with two 565 endpoints
+    KETextureFormat_BC1,
+    // BC1 color with a separate interpolated alpha block, 16 bytes
+    KETextureFormat_BC3,
+    // Two interpolated single channel blocks for red and green, 16 bytes. Used for normal maps
+    KETextureFormat_BC5,
+    // Only valid in cook settings, picks a format from the image's content and name
+    KETextureFormat_Auto,
+};
+
+enum KETextureFlags : std::uint32_t
+{
+    KETextureFlags_None = 0,
+    KETextureFlags_Srgb = 1 << 0,
+    KETextureFlags_NormalMap = 1 << 1,
+};
+
+struct KTextureMip
+{
+    std::uint64_t offset = 0;
+    std::uint64_t size = 0;
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+};
+
+struct KTextureFileHeader
+{
+    std::uint32_t magic = texture_file_magic;
+    std::uint32_t version = texture_file_version;
+
+    std::uint32_t format = KETextureFormat_RGBA8;
+    std::uint32_t flags = KETextureFlags_None;
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    std::uint32_t mip_count = 0;
+    // Of the largest mip against the source, in dB
+    float psnr = 0.0f;
+
+    KTextureMip mips[texture_max_mips] = {};
+};
+static_assert(sizeof(KTextureFileHeader) % texture_file_alignment == 0, "header must stay aligned");
+
+#endif
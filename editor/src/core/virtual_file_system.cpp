@@ -0,0 +1,251 @@
+#include "core/virtual_file_system.hpp"
+
+#include <kryos/core/debug.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+
+KLVirtualFileSystem* KLVirtualFileSystem::m_Instance = nullptr;
+
+KLVirtualFileSystem::KLVirtualFileSystem()
+{
+    assert(
+        m_Instance == nullptr && "VirtualFileSystem::VirtualFileSystem() -> cannot created "
+                                 "multiple virtual file system application layers"
+    );
+
+    m_Instance = this;
+
+    // Unique to this instance, so editors running side by side don't share temporary files
+    std::string suffix =
+        std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    m_extract_directory =
+        (std::filesystem::temp_directory_path() / ("kryos-vfs-" + suffix)).generic_string();
+}
+
+KLVirtualFileSystem::~KLVirtualFileSystem()
+{
+    _remove_extracted();
+    std::error_code error = {};
+    std::filesystem::remove_all(m_extract_directory, error);
+
+    // Files opened afterwards go straight to disk, the ones still open keep their archive alive
+    m_Instance = nullptr;
+}
+
+std::size_t KLVirtualFileSystem::get_mount_count() const
+{
+    std::shared_lock lock = std::shared_lock(m_mutex);
+    return m_mounts.size();
+}
+
+bool KLVirtualFileSystem::mount(const std::string& pak_filename, const std::string& mount_path)
+{
+    // Opened before taking the lock, opening any file looks through the mounted archives first
+    std::shared_ptr<KPakArchive> archive = std::make_shared<KPakArchive>();
+    if (!archive->open(pak_filename))
+        return false;
+
+    KMount mount = {};
+    mount.pak_filename = pak_filename;
+    mount.mount_path = _normalize(mount_path);
+    while (mount.mount_path.size() > 1 && mount.mount_path.back() == '/')
+        mount.mount_path.pop_back();
+    mount.archive = std::move(archive);
+
+    _remove_extracted();
+    std::unique_lock lock = std::unique_lock(m_mutex);
+    m_mounts.push_back(std::move(mount));
+    return true;
+}
+
+void KLVirtualFileSystem::unmount(const std::string& pak_filename)
+{
+    _remove_extracted();
+    std::unique_lock lock = std::unique_lock(m_mutex);
+    std::erase_if(
+        m_mounts, [&](const KMount& mount) { return mount.pak_filename == pak_filename; }
+    );
+}
+
+void KLVirtualFileSystem::unmount_all()
+{
+    _remove_extracted();
+    std::unique_lock lock = std::unique_lock(m_mutex);
+    m_mounts.clear();
+}
+
+bool KLVirtualFileSystem::open(const std::string& filename, KMappedFile& file) const
+{
+    std::shared_ptr<KPakArchive> archive = nullptr;
+    const KPakEntry* entry = nullptr;
+    if (!_find(filename, archive, entry))
+        return false;
+
+    m_opened_count.fetch_add(1, std::memory_order_relaxed);
+    if (entry->compression == KEPakCompression_None)
+    {
+        // Taken before the archive is moved into the view, arguments are evaluated in any order
+        const std::uint8_t* data = archive->get_stored_data(*entry);
+        file.open_view(data, entry->size, std::move(archive));
+        return true;
+    }
+
+    std::vector<std::uint8_t> data = {};
+    if (!archive->read(*entry, data))
+    {
+        KLDebug::log(
+            "VirtualFileSystem::open() -> " + filename + " is corrupted in its archive",
+            KEDebugType_Error
+        );
+        // Still counts as found, a corrupted packed file must not fall back to a stale loose one
+        file.close();
+        return true;
+    }
+
+    m_decompressed_size.fetch_add(data.size(), std::memory_order_relaxed);
+    file.open_buffer(std::move(data));
+    return true;
+}
+
+bool KLVirtualFileSystem::exists(const std::string& filename) const
+{
+    std::shared_ptr<KPakArchive> archive = nullptr;
+    const KPakEntry* entry = nullptr;
+    return _find(filename, archive, entry);
+}
+
+std::vector<std::string> KLVirtualFileSystem::list(const std::string& directory) const
+{
+    std::string path = _normalize(directory);
+    while (path.size() > 1 && path.back() == '/')
+        path.pop_back();
+
+    std::vector<std::string> filenames = {};
+    std::shared_lock lock = std::shared_lock(m_mutex);
+    for (const KMount& mount : m_mounts)
+    {
+        // Directory relative to the archive's root, empty when it's the mount point itself
+        std::string prefix = {};
+        if (path.size() > mount.mount_path.size())
+        {
+            if (path.compare(0, mount.mount_path.size(), mount.mount_path) != 0 ||
+                path[mount.mount_path.size()] != '/')
+                continue;
+            prefix = path.substr(mount.mount_path.size() + 1) + "/";
+        }
+        else if (path != mount.mount_path)
+            continue;
+
+        // Paths are sorted, so everything under the prefix is one contiguous range
+        const KPakArchive& archive = *mount.archive;
+        bool in_range = false;
+        for (std::uint32_t i = 0; i < archive.get_entry_count(); i++)
+        {
+            std::string_view entry_path = archive.get_path(archive.get_entry(i));
+            if (entry_path.compare(0, prefix.size(), prefix) != 0)
+            {
+                if (in_range)
+                    break;
+                continue;
+            }
+
+            in_range = true;
+            filenames.push_back(mount.mount_path + "/" + std::string(entry_path));
+        }
+    }
+
+    std::sort(filenames.begin(), filenames.end());
+    filenames.erase(std::unique(filenames.begin(), filenames.end()), filenames.end());
+    return filenames;
+}
+
+std::string KLVirtualFileSystem::get_readable_path(const std::string& filename)
+{
+    std::string path = _normalize(filename);
+    auto it = m_extracted.find(path);
+    if (it != m_extracted.end())
+        return it->second;
+
+    KMappedFile file = {};
+    if (!open(filename, file))
+        return filename;
+    // Already logged as corrupted, no path fails the reader instead of it falling back to a stale
+    // loose file
+    if (!file.is_open())
+        return {};
+
+    // Keeps the extension, readers may pick the format by it
+    std::error_code error = {};
+    std::filesystem::create_directories(m_extract_directory, error);
+    std::string extracted =
+        (std::filesystem::path(m_extract_directory) /
+         (std::to_string(std::hash<std::string>()(path)) +
+          std::filesystem::path(path).extension().string()))
+            .generic_string();
+
+    std::ofstream output = std::ofstream(extracted, std::ios::binary | std::ios::trunc);
+    output.write(
+        reinterpret_cast<const char*>(file.get_data()),
+        static_cast<std::streamsize>(file.get_size())
+    );
+    if (!output)
+    {
+        KLDebug::log(
+            "VirtualFileSystem::get_readable_path() -> failed to write " + extracted,
+            KEDebugType_Error
+        );
+        return filename;
+    }
+
+    m_extracted[path] = extracted;
+    return extracted;
+}
+
+void KLVirtualFileSystem::_remove_extracted()
+{
+    std::error_code error = {};
+    for (const auto& [path, extracted] : m_extracted)
+        std::filesystem::remove(extracted, error);
+    m_extracted.clear();
+}
+
+std::string KLVirtualFileSystem::_normalize(const std::string& filename)
+{
+    std::error_code error = {};
+    std::filesystem::path path = std::filesystem::path(filename);
+    if (!path.is_absolute())
+        path = std::filesystem::absolute(path, error);
+    return path.lexically_normal().generic_string();
+}
+
+bool KLVirtualFileSystem::_find(
+    const std::string& filename, std::shared_ptr<KPakArchive>& archive, const KPakEntry*& entry
+) const
+{
+    std::shared_lock lock = std::shared_lock(m_mutex);
+    if (m_mounts.empty())
+        return false;
+
+    std::string path = _normalize(filename);
+    for (auto it = m_mounts.rbegin(); it != m_mounts.rend(); ++it)
+    {
+        const std::string& mount_path = it->mount_path;
+        if (path.size() <= mount_path.size() + 1 ||
+            path.compare(0, mount_path.size(), mount_path) != 0 || path[mount_path.size()] != '/')
+            continue;
+
+        entry = it->archive->find(std::string_view(path).substr(mount_path.size() + 1));
+        if (entry != nullptr)
+        {
+            archive = it->archive;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,89 @@
+#ifndef __KRYOS_EDITOR_CORE_VIRTUAL_FILE_SYSTEM_HPP__
+#define __KRYOS_EDITOR_CORE_VIRTUAL_FILE_SYSTEM_HPP__
+
+#include "core/mapped_file.hpp"
+#include "core/pak_archive.hpp"
+
+#include <kryos/core/application_layer.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Serves files out of mounted pak archives. An archive mounted at a directory shadows the loose
+// files under it, anything it doesn't contain is still read from disk. Every KMappedFile looks
+// here first, so loaders built on it read packed files with zero copies unless the entry is
+// compressed. Lookups are safe from any thread, mounting and unmounting only from the main one.
+// Readers that only take a filename (the project's YAML, scenes KSerialization reads) go through
+// get_readable_path(), which writes a packed file out to a temporary one they can open
+class KLVirtualFileSystem : public KIApplicationLayer
+{
+  public:
+    inline static KLVirtualFileSystem* get() { return m_Instance; }
+
+  public:
+    KLVirtualFileSystem();
+    virtual ~KLVirtualFileSystem() override;
+
+    std::size_t get_mount_count() const;
+    inline std::size_t get_opened_count() const
+    {
+        return m_opened_count.load(std::memory_order_relaxed);
+    }
+    inline std::uint64_t get_decompressed_size() const
+    {
+        return m_decompressed_size.load(std::memory_order_relaxed);
+    }
+
+    // Mounts the archive's root at the given directory, archives mounted later take priority
+    bool mount(const std::string& pak_filename, const std::string& mount_path);
+    void unmount(const std::string& pak_filename);
+    void unmount_all();
+
+    // Returns false when no mounted archive has the file, otherwise the file is opened from the
+    // archive
+    bool open(const std::string& filename, KMappedFile& file) const;
+    bool exists(const std::string& filename) const;
+    // Every packed file under the directory, recursively
+    std::vector<std::string> list(const std::string& directory) const;
+    // A packed file is written out to a temporary file the first time and that file's path is
+    // returned, anything else is returned as is. Only from the main thread, the temporary files
+    // are removed when archives are mounted or unmounted and with the layer
+    std::string get_readable_path(const std::string& filename);
+
+  private:
+    struct KMount
+    {
+        std::string pak_filename = {};
+        // Absolute and normalized, without a trailing separator
+        std::string mount_path = {};
+        std::shared_ptr<KPakArchive> archive = nullptr;
+    };
+
+    static KLVirtualFileSystem* m_Instance;
+
+  private:
+    static std::string _normalize(const std::string& filename);
+    void _remove_extracted();
+    bool _find(
+        const std::string& filename, std::shared_ptr<KPakArchive>& archive,
+        const KPakEntry*& entry
+    ) const;
+
+  private:
+    mutable std::shared_mutex m_mutex = {};
+    std::vector<KMount> m_mounts = {};
+
+    // Temporary copies of packed files, by normalized path
+    std::string m_extract_directory = {};
+    std::unordered_map<std::string, std::string> m_extracted = {};
+
+    mutable std::atomic<std::size_t> m_opened_count = 0;
+    mutable std::atomic<std::uint64_t> m_decompressed_size = 0;
+};
+
+#endif
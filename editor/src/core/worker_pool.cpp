@@ -0,0 +1,56 @@
+#include "core/worker_pool.hpp"
+
+KWorkerPool::KWorkerPool(std::size_t thread_count)
+{
+    // Zero picks one thread per core, leaving one for the main thread
+    if (thread_count == 0)
+    {
+        unsigned int cores = std::thread::hardware_concurrency();
+        thread_count = cores > 1 ? cores - 1 : 1;
+    }
+
+    m_threads.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; i++)
+        m_threads.emplace_back(&KWorkerPool::_run, this);
+}
+
+KWorkerPool::~KWorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_condition.notify_all();
+    for (std::thread& thread : m_threads)
+        thread.join();
+}
+
+void KWorkerPool::push(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(std::move(job));
+    }
+
+    m_condition.notify_one();
+}
+
+void KWorkerPool::_run()
+{
+    while (true)
+    {
+        std::function<void()> job = {};
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+            if (m_stop && m_jobs.empty())
+                return;
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        job();
+    }
+}
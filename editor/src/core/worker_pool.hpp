@@ -0,0 +1,33 @@
+#ifndef __KRYOS_EDITOR_CORE_WORKER_POOL_HPP__
+#define __KRYOS_EDITOR_CORE_WORKER_POOL_HPP__
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads running jobs in the order they were pushed
+class KWorkerPool
+{
+  public:
+    KWorkerPool(std::size_t thread_count = 0);
+    ~KWorkerPool();
+
+    inline std::size_t get_thread_count() const { return m_threads.size(); }
+
+    void push(std::function<void()> job);
+
+  private:
+    void _run();
+
+  private:
+    std::vector<std::thread> m_threads = {};
+    std::mutex m_mutex = {};
+    std::condition_variable m_condition = {};
+    std::deque<std::function<void()>> m_jobs = {};
+    bool m_stop = false;
+};
+
+#endif
@@ -1,15 +1,27 @@
 #include "gui/app.hpp"
+#include "core/asset_cooker.hpp"
+#include "core/asset_index.hpp"
+#include "core/asset_residency.hpp"
+#include "core/editor_entities.hpp"
+#include "core/hot_reload.hpp"
+#include "core/member_tables.hpp"
+#include "core/mesh_lods.hpp"
+#include "core/play_mode.hpp"
+#include "core/pool_compaction.hpp"
+#include "core/prefabs.hpp"
 #include "core/project.hpp"
+#include "core/scene_changes.hpp"
+#include "core/spatial_index.hpp"
 #include "gui/assets.hpp"
 #include "gui/console.hpp"
 #include "gui/docking.hpp"
 #include "gui/editor.hpp"
 #include "gui/hierarchy.hpp"
 #include "gui/properties.hpp"
+#include "gui/statistics.hpp"
 #include "gui/viewport.hpp"
 
 #include <glm/gtc/matrix_transform.hpp>
-#include <kryos/renderer/renderer.hpp>
 #include <portable-file-dialogs/portable-file-dialogs.h>
 
 KEditorApp::KEditorApp()
@@ -19,13 +31,10 @@ KEditorApp::KEditorApp()
                                       "therefore cannot run this program, sorry"
     );
 
-    // Framebuffers
-    KLPipeline* pipeline = get_application_layer<KLPipeline>();
+    // Window
     KLWindow* window = get_application_layer<KLWindow>();
     window->set_title("Kryos - No Project Selected");
     window->set_size(WindowResolution_Maximize);
-    static_cast<KBasicRenderer*>(pipeline->push_renderer(new KBasicRenderer()))
-        ->use_default_framebuffer(false);
 
     // Debug Logger
     KLDebug* debug = get_application_layer<KLDebug>();
@@ -33,20 +42,35 @@ KEditorApp::KEditorApp()
     debug->set_serialize(true);
 
     // Editor Project Layer
+    push_layer<KLMemberTables>();
     push_layer<KLProject>();
+    push_layer<KLAssetIndex>();
+    push_layer<KLEditorEntities>();
+    push_layer<KLSceneChanges>();
+    push_layer<KLPlayMode>();
+    push_layer<KLPrefabs>();
+    push_layer<KLPoolCompaction>();
+    push_layer<KLSpatialIndex>();
+    push_layer<KLMeshLods>();
+    push_layer<KLHotReload>();
+    push_layer<KLAssetCooker>();
+    push_layer<KLAssetResidency>();
 
     // Editor Workspace Layer
     KLEditorWorkspace* workspace = push_layer<KLEditorWorkspace>();
     workspace->push_panels({
         new workspace::KDocking(workspace),
         new workspace::KConsole(debug),
-        new workspace::KViewport(pipeline->create_framebuffer("editor viewport", 1280, 720)),
+        new workspace::KViewport(),
         new workspace::KHierarchy(),
         new workspace::KAssets(),
     });
     workspace->push_panel<workspace::KProperties>(
         static_cast<workspace::KHierarchy*>(workspace->get_panel("Hierarchy"))
     );
+    workspace->push_panel<workspace::KStatistics>(
+        static_cast<workspace::KViewport*>(workspace->get_panel("Viewport"))
+    );
 
     // get_application_layer<ReflectionRegistry>()->log_all_detailed_types();
     // get_application_layer<ReflectionRegistry>()->log_all_templated_types();
@@ -1,15 +1,380 @@
 #include "gui/assets.hpp"
+#include "core/hot_reload.hpp"
+#include "core/prefabs.hpp"
+#include "core/scene_changes.hpp"
 
+#include <kryos/core/application.hpp>
+#include <kryos/scene/components.hpp>
+#include <kryos/scene/entity.hpp>
+#include <kryos/scene/scene_manager.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
 #include <imgui/imgui.h>
 
 namespace workspace {
 
+static bool contains_lowercase(const char* text, const std::string& lowercase_pattern)
+{
+    if (lowercase_pattern.empty())
+        return true;
+
+    const char* end = text + std::strlen(text);
+    return std::search(
+               text, end, lowercase_pattern.begin(), lowercase_pattern.end(),
+               [](char lhs, char rhs)
+               { return std::tolower(static_cast<unsigned char>(lhs)) == rhs; }
+           ) != end;
+}
+
+static std::string format_size(std::uint64_t size)
+{
+    const char* units[] = {"B", "KB", "MB", "GB"};
+    double value = static_cast<double>(size);
+    std::size_t unit = 0;
+    while (value >= 1024.0 && unit < 3)
+    {
+        value /= 1024.0;
+        unit++;
+    }
+
+    char buffer[32] = {};
+    std::snprintf(buffer, sizeof(buffer), unit == 0 ? "%.0f %s" : "%.1f %s", value, units[unit]);
+    return buffer;
+}
+
+// Cuts the text down and adds "..." so it fits in the given width
+static std::string fit_text(const char* text, float width)
+{
+    std::string result = text;
+    if (ImGui::CalcTextSize(result.c_str()).x <= width)
+        return result;
+
+    while (!result.empty() && ImGui::CalcTextSize((result + "...").c_str()).x > width)
+        result.pop_back();
+    return result + "...";
+}
+
 KAssets::KAssets() : KIWorkspace("Assets") {}
 
 void KAssets::on_imgui_update()
 {
     ImGui::Begin(get_name().c_str(), &get_enabled());
+
+    KLAssetIndex* asset_index = KLAssetIndex::get();
+    std::shared_ptr<const KAssetSnapshot> snapshot = asset_index->get_snapshot();
+
+    if (snapshot == nullptr)
+    {
+        _toolbar(0);
+        if (asset_index->scanning())
+            ImGui::Text("Scanning... %zu", asset_index->get_scanned_count());
+        ImGui::End();
+        return;
+    }
+
+    _update_filter(*snapshot, asset_index->get_version());
+    _toolbar(snapshot->entries.size());
+
+    ImGui::BeginChild("Assets -> Items");
+    {
+        if (m_grid_view)
+            _draw_grid(*snapshot);
+        else
+        {
+            m_thumbnails.clear();
+            _draw_list(*snapshot);
+        }
+    }
+    ImGui::EndChild();
+
     ImGui::End();
 }
 
+void KAssets::_toolbar(std::size_t total_count)
+{
+    KLAssetIndex* asset_index = KLAssetIndex::get();
+
+    ImGui::PushItemWidth(ImGui::GetContentRegionAvail().x * 0.4f);
+    ImGui::InputTextWithHint("###AssetsFilter", "Filter", m_filter, sizeof(m_filter));
+    ImGui::PopItemWidth();
+
+    ImGui::SameLine();
+    ImGui::PushItemWidth(ImGui::CalcTextSize("Directory").x * 1.5f);
+    KEAssetType type_filter = static_cast<KEAssetType>(m_type_filter);
+    const char* preview = m_type_filter < 0 ? "All" : KLAssetIndex::get_type_name(type_filter);
+    if (ImGui::BeginCombo("###AssetsType", preview))
+    {
+        if (ImGui::Selectable("All", m_type_filter < 0))
+            m_type_filter = -1;
+        for (int type = 0; type < KEAssetType_Count; type++)
+        {
+            const char* name = KLAssetIndex::get_type_name(static_cast<KEAssetType>(type));
+            if (ImGui::Selectable(name, m_type_filter == type))
+                m_type_filter = type;
+        }
+        ImGui::EndCombo();
+    }
+    ImGui::PopItemWidth();
+
+    ImGui::SameLine();
+    if (ImGui::Button(m_grid_view ? "List" : "Grid"))
+        m_grid_view = !m_grid_view;
+
+    ImGui::SameLine();
+    if (ImGui::Button("Rescan"))
+        asset_index->rescan();
+
+    ImGui::SameLine();
+    ImGui::Text("%zu / %zu", m_filtered.size(), total_count);
+    if (asset_index->scanning())
+    {
+        ImGui::SameLine();
+        ImGui::Text("(Scanning... %zu)", asset_index->get_scanned_count());
+    }
+}
+
+void KAssets::_update_filter(const KAssetSnapshot& snapshot, std::uint64_t version)
+{
+    std::string filter = m_filter;
+    std::transform(
+        filter.begin(), filter.end(), filter.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); }
+    );
+
+    bool same_source = m_filter_valid && version == m_filtered_version &&
+                       m_type_filter == m_applied_type_filter;
+    if (same_source && filter == m_applied_filter)
+        return;
+
+    // Anything matching a longer filter also matched the shorter one
+    bool narrow = same_source && filter.find(m_applied_filter) != std::string::npos;
+
+    std::vector<std::uint32_t> candidates = {};
+    if (narrow)
+        candidates.swap(m_filtered);
+
+    m_filtered.clear();
+    auto matches = [&](std::uint32_t index)
+    {
+        const KAssetEntry& entry = snapshot.entries[index];
+        // Directories are only listed when explicitly filtered for
+        if (m_type_filter < 0 ? entry.type == KEAssetType_Directory : entry.type != m_type_filter)
+            return false;
+        return contains_lowercase(entry.get_name(), filter);
+    };
+
+    if (narrow)
+    {
+        for (std::uint32_t index : candidates)
+        {
+            if (matches(index))
+                m_filtered.push_back(index);
+        }
+    }
+    else
+    {
+        for (std::uint32_t index = 0; index < snapshot.entries.size(); index++)
+        {
+            if (matches(index))
+                m_filtered.push_back(index);
+        }
+    }
+
+    m_filter_valid = true;
+    m_filtered_version = version;
+    m_applied_filter = std::move(filter);
+    m_applied_type_filter = m_type_filter;
+}
+
+void KAssets::_draw_grid(const KAssetSnapshot& snapshot)
+{
+    constexpr float cell_size = 96.0f;
+    ImGuiStyle& style = ImGui::GetStyle();
+
+    float cell_width = cell_size + style.ItemSpacing.x;
+    int columns = std::max(1, static_cast<int>(ImGui::GetContentRegionAvail().x / cell_width));
+    int rows = static_cast<int>((m_filtered.size() + columns - 1) / columns);
+    float row_height = cell_size + ImGui::GetTextLineHeightWithSpacing() + style.ItemSpacing.y;
+
+    // References of textures that stay in view carry over, the others are dropped at the end
+    std::unordered_map<std::string, KAssetRef> thumbnails = {};
+
+    // Only the rows in view are submitted, so the cost doesn't depend on the asset count
+    ImGuiListClipper clipper;
+    clipper.Begin(rows, row_height);
+    while (clipper.Step())
+    {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+        {
+            for (int column = 0; column < columns; column++)
+            {
+                std::size_t i = static_cast<std::size_t>(row) * columns + column;
+                if (i >= m_filtered.size())
+                    break;
+
+                const KAssetEntry& entry = snapshot.entries[m_filtered[i]];
+                if (column > 0)
+                    ImGui::SameLine();
+
+                const KResidentAsset* thumbnail = nullptr;
+                if (entry.type == KEAssetType_Texture)
+                {
+                    auto it = m_thumbnails.find(entry.path);
+                    KAssetRef asset = it != m_thumbnails.end()
+                                          ? std::move(it->second)
+                                          : KLAssetResidency::get()->acquire(entry.path);
+                    if (asset.is_resident() && asset.get()->texture != 0)
+                        thumbnail = asset.get();
+                    if (asset.is_valid())
+                        thumbnails[entry.path] = std::move(asset);
+                }
+
+                ImGui::PushID(static_cast<int>(m_filtered[i]));
+                ImGui::BeginGroup();
+                {
+                    bool selected = entry.path == m_selected;
+                    if (selected)
+                        ImGui::PushStyleColor(ImGuiCol_Button, style.Colors[ImGuiCol_ButtonActive]);
+                    std::string label = thumbnail != nullptr
+                                            ? std::string()
+                                            : std::string(KLAssetIndex::get_type_name(entry.type));
+                    if (ImGui::Button((label + "###Cell").c_str(), ImVec2(cell_size, cell_size)))
+                        m_selected = entry.path;
+                    if (selected)
+                        ImGui::PopStyleColor();
+                    if (thumbnail != nullptr)
+                        _draw_thumbnail(*thumbnail);
+                    _item_tooltip(entry);
+                    _item_context_menu(entry);
+
+                    ImGui::TextUnformatted(fit_text(entry.get_name(), cell_size).c_str());
+                }
+                ImGui::EndGroup();
+                ImGui::PopID();
+            }
+        }
+    }
+    clipper.End();
+
+    m_thumbnails = std::move(thumbnails);
+}
+
+void KAssets::_draw_thumbnail(const KResidentAsset& asset)
+{
+    // Fit inside the button keeping the texture's aspect ratio
+    ImVec2 min = ImGui::GetItemRectMin();
+    ImVec2 max = ImGui::GetItemRectMax();
+    ImVec2 padding = ImGui::GetStyle().FramePadding;
+    float width = max.x - min.x - padding.x * 2.0f;
+    float height = max.y - min.y - padding.y * 2.0f;
+    float aspect = static_cast<float>(asset.texture_width) /
+                   static_cast<float>(std::max(asset.texture_height, 1u));
+    if (aspect > width / height)
+        height = width / aspect;
+    else
+        width = height * aspect;
+
+    ImVec2 center = ImVec2((min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f);
+    ImVec2 image_min = ImVec2(center.x - width * 0.5f, center.y - height * 0.5f);
+    ImVec2 image_max = ImVec2(center.x + width * 0.5f, center.y + height * 0.5f);
+
+    // Cooked textures are stored bottom row first for OpenGL
+    std::uint64_t texture_id = static_cast<std::uint64_t>(asset.texture);
+    ImGui::GetWindowDrawList()->AddImage(
+        reinterpret_cast<void*>(texture_id), image_min, image_max, ImVec2(0.0f, 1.0f),
+        ImVec2(1.0f, 0.0f)
+    );
+}
+
+void KAssets::_draw_list(const KAssetSnapshot& snapshot)
+{
+    ImGuiTableFlags flags = ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg |
+                            ImGuiTableFlags_Resizable | ImGuiTableFlags_BordersInnerV;
+    if (!ImGui::BeginTable("Assets -> List", 4, flags))
+        return;
+
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Name");
+    ImGui::TableSetupColumn("Type");
+    ImGui::TableSetupColumn("Size");
+    ImGui::TableSetupColumn("Path");
+    ImGui::TableHeadersRow();
+
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(m_filtered.size()));
+    while (clipper.Step())
+    {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+        {
+            const KAssetEntry& entry = snapshot.entries[m_filtered[i]];
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::PushID(static_cast<int>(m_filtered[i]));
+            if (ImGui::Selectable(
+                    entry.get_name(), entry.path == m_selected, ImGuiSelectableFlags_SpanAllColumns
+                ))
+                m_selected = entry.path;
+            _item_tooltip(entry);
+            _item_context_menu(entry);
+            ImGui::PopID();
+
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(KLAssetIndex::get_type_name(entry.type));
+            ImGui::TableNextColumn();
+            if (entry.type != KEAssetType_Directory)
+                ImGui::TextUnformatted(format_size(entry.size).c_str());
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(entry.path.c_str());
+        }
+    }
+    clipper.End();
+
+    ImGui::EndTable();
+}
+
+void KAssets::_item_tooltip(const KAssetEntry& entry)
+{
+    if (!ImGui::IsItemHovered())
+        return;
+
+    ImGui::BeginTooltip();
+    ImGui::TextUnformatted(entry.path.c_str());
+    if (entry.type != KEAssetType_Directory)
+        ImGui::Text(
+            "%s, %s", KLAssetIndex::get_type_name(entry.type), format_size(entry.size).c_str()
+        );
+    ImGui::EndTooltip();
+}
+
+void KAssets::_item_context_menu(const KAssetEntry& entry)
+{
+    if ((entry.type != KEAssetType_Prefab && entry.type != KEAssetType_Model) ||
+        !ImGui::BeginPopupContextItem())
+        return;
+
+    KScene* scene = KIApplication::get_layer<KLSceneManager>()->get_active_scene();
+    if (ImGui::MenuItem("Instantiate", nullptr, false, scene != nullptr))
+    {
+        if (entry.type == KEAssetType_Prefab)
+            KLPrefabs::get()->instantiate(scene, entry.path);
+        else
+        {
+            // Loaded by the editor so the entity follows the file when it changes on disk
+            KModelHandle model = KLHotReload::get()->load_model(entry.path);
+            if (model != nullptr)
+            {
+                KEntity entity{};
+                entity.add_component<KCName>(entry.get_name());
+                entity.add_component<KCMeshRenderer>()->model = model;
+                KLSceneChanges::get()->mark_entity_created(entity);
+            }
+        }
+    }
+    ImGui::EndPopup();
+}
+
 } // namespace workspace
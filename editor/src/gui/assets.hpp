@@ -1,8 +1,15 @@
 #ifndef __KRYOS_EDITOR_GUI_ASSETS_HPP__
 #define __KRYOS_EDITOR_GUI_ASSETS_HPP__
 
+#include "core/asset_index.hpp"
+#include "core/asset_residency.hpp"
 #include "gui/editor.hpp"
 
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 namespace workspace {
 
 class KAssets final : public KIWorkspace
@@ -12,6 +19,31 @@ class KAssets final : public KIWorkspace
     virtual ~KAssets() override = default;
 
     virtual void on_imgui_update() override;
+
+  private:
+    void _toolbar(std::size_t total_count);
+    void _update_filter(const KAssetSnapshot& snapshot, std::uint64_t version);
+    void _draw_grid(const KAssetSnapshot& snapshot);
+    void _draw_thumbnail(const KResidentAsset& asset);
+    void _draw_list(const KAssetSnapshot& snapshot);
+    void _item_tooltip(const KAssetEntry& entry);
+    void _item_context_menu(const KAssetEntry& entry);
+
+  private:
+    char m_filter[256] = {};
+    int m_type_filter = -1;
+    bool m_grid_view = true;
+    std::string m_selected = {};
+    // Textures in the visible grid rows, the rest are released so they can be evicted
+    std::unordered_map<std::string, KAssetRef> m_thumbnails = {};
+
+    // Indices into the snapshot's entries that pass the filter, narrowed instead of rebuilt when
+    // the filter text only gets longer
+    std::vector<std::uint32_t> m_filtered = {};
+    std::uint64_t m_filtered_version = 0;
+    std::string m_applied_filter = {};
+    int m_applied_type_filter = -1;
+    bool m_filter_valid = false;
 };
 
 } // namespace workspace
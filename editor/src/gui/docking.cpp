@@ -1,4 +1,5 @@
 #include "gui/docking.hpp"
+#include "core/play_mode.hpp"
 #include "core/project.hpp"
 #include "gui/preferences.hpp"
 
@@ -40,6 +41,7 @@ void KDocking::on_imgui_update()
     ImGuiID dock_space_id = ImGui::GetID("DockSpace");
     ImGui::DockSpace(dock_space_id, ImVec2(0.0f, 0.0f), m_dock_node_flags);
     bool scene_loaded = KIApplication::get_layer<KLSceneManager>()->get_active_scene() != nullptr;
+    KLPlayMode* play_mode = KLPlayMode::get();
 
     bool open_project_popup = false;
 
@@ -111,7 +113,10 @@ void KDocking::on_imgui_update()
             if (ImGui::MenuItem("Save", "Ctrl+S", nullptr, scene_loaded))
                 KLDebug::log("Not Implemented yet", KEDebugType_Warning);
 
-            if (ImGui::MenuItem("Save As", "Ctrl+Shift+S", nullptr, scene_loaded))
+            // Saving while playing would write the play state over the scene
+            if (ImGui::MenuItem(
+                    "Save As", "Ctrl+Shift+S", nullptr, scene_loaded && !play_mode->is_playing()
+                ))
             {
                 KScene* active_scene =
                     KIApplication::get_layer<KLSceneManager>()->get_active_scene();
@@ -156,6 +161,14 @@ void KDocking::on_imgui_update()
 
             ImGui::EndMenu();
         }
+
+        if (!play_mode->is_playing())
+        {
+            if (ImGui::MenuItem("Play", nullptr, false, scene_loaded))
+                play_mode->play();
+        }
+        else if (ImGui::MenuItem("Stop"))
+            play_mode->stop();
         ImGui::EndMenuBar();
     }
 
@@ -4,8 +4,6 @@
 #include <kryos/core/application_layer.hpp>
 #include <yaml/yaml.hpp>
 
-#define HIERARCHY_FILTER_NAME "@kryos_editor"
-
 #define PREF_NAME_SIZE 32
 
 struct ImGuiIO;
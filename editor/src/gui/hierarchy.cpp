@@ -1,10 +1,15 @@
 #include "gui/hierarchy.hpp"
+#include "core/editor_entities.hpp"
+#include "core/prefabs.hpp"
+#include "core/project.hpp"
+#include "core/scene_changes.hpp"
 
 #include <kryos/core/asset_handler.hpp>
 #include <kryos/scene/components.hpp>
 #include <kryos/scene/scene_manager.hpp>
 
 #include <imgui/imgui.h>
+#include <portable-file-dialogs/portable-file-dialogs.h>
 
 namespace workspace {
 
@@ -20,36 +25,30 @@ void KHierarchy::on_imgui_update()
         ecs::Registry& registry = active_scene->get_registry();
         const std::vector<ecs::Entity>& entities = registry.get_entities();
 
+        KLEditorEntities* editor_entities = KLEditorEntities::get();
+
         ecs::Entity entity_clicked = ECS_ENTITY_DESTROYED;
         bool opened_targeted_entity_popup = false;
         for (std::size_t i = 0; i < entities.size(); i++)
         {
+            if (editor_entities->is_editor_entity(active_scene, entities[i]))
+                continue;
+
             KEntity entity = KEntity(entities[i]);
             if (entity)
-            {
-                KCTag* tag = entity.get_component<KCTag>();
-                bool include_ent = true;
-                if (tag != nullptr)
-                {
-                    if (tag->tag.size() > 0)
-                    {
-                        // PERFORMANCE: try to avoid string comparison
-                        if (std::string(HIERARCHY_FILTER_NAME) == tag->tag)
-                            include_ent = false;
-                    }
-                }
-
-                if (include_ent)
-                    _draw_entity(entity, entity_clicked, opened_targeted_entity_popup);
-            }
+                _draw_entity(entity, entity_clicked, opened_targeted_entity_popup);
         }
 
+        ecs::Entity last_selected_entity = m_selected_entity;
         if (entity_clicked != ECS_ENTITY_DESTROYED)
             m_selected_entity = entity_clicked;
 
         if (ImGui::IsMouseDown(0) && ImGui::IsWindowHovered())
             m_selected_entity = ECS_ENTITY_DESTROYED;
 
+        if (m_selected_entity != last_selected_entity)
+            KLSceneChanges::get()->mark_selection_changed();
+
         if (!opened_targeted_entity_popup)
         {
             if (ImGui::BeginPopupContextWindow())
@@ -63,6 +62,15 @@ void KHierarchy::on_imgui_update()
     ImGui::End();
 }
 
+void KHierarchy::set_selected_entity(ecs::Entity entity)
+{
+    if (m_selected_entity == entity)
+        return;
+
+    m_selected_entity = entity;
+    KLSceneChanges::get()->mark_selection_changed();
+}
+
 void KHierarchy::_draw_entity(KEntity entity, ecs::Entity& entity_clicked, bool& opened_popup)
 {
     int flags = ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen |
@@ -103,6 +111,8 @@ void KHierarchy::_create_shape(
     {
         // TODO: Setup parent component
     }
+
+    KLSceneChanges::get()->mark_entity_created(entity);
 }
 
 void KHierarchy::_popup_menu(KEntity* entity)
@@ -114,7 +124,10 @@ void KHierarchy::_popup_menu(KEntity* entity)
         if (ImGui::BeginMenu("New"))
         {
             if (ImGui::MenuItem("Entity"))
+            {
                 KEntity creating{};
+                KLSceneChanges::get()->mark_entity_created(creating);
+            }
 
             if (ImGui::BeginMenu("Shape"))
             {
@@ -131,8 +144,32 @@ void KHierarchy::_popup_menu(KEntity* entity)
 
         if (entity != nullptr)
         {
+            KLPrefabs* prefabs = KLPrefabs::get();
+            if (ImGui::MenuItem("Create Prefab"))
+            {
+                std::string filename = pfd::save_file(
+                                           "Create Prefab", KLProject::get()->get_root_path(),
+                                           {"Kryos Prefab Files", "*.kprefab"}
+                )
+                                           .result();
+                if (filename.size() > 0)
+                    prefabs->create(scene, *entity, filename);
+            }
+
+            if (prefabs->find_instance(scene, *entity) != nullptr)
+            {
+                if (ImGui::MenuItem("Apply to Prefab"))
+                    prefabs->apply(scene, *entity);
+                if (ImGui::MenuItem("Revert to Prefab"))
+                    prefabs->revert(scene, *entity);
+            }
+
             if (ImGui::MenuItem("Delete"))
+            {
+                ecs::Entity destroyed = *entity;
                 entity->destroy();
+                KLSceneChanges::get()->mark_entity_destroyed(destroyed);
+            }
         }
     }
     else
@@ -14,6 +14,7 @@ class KHierarchy final : public KIWorkspace
     virtual ~KHierarchy() override = default;
 
     inline ecs::Entity get_selected_entity() const { return m_selected_entity; }
+    void set_selected_entity(ecs::Entity entity);
 
     virtual void on_imgui_update() override;
 
@@ -1,4 +1,6 @@
 #include "gui/properties.hpp"
+#include "core/member_tables.hpp"
+#include "core/scene_changes.hpp"
 #include "gui/editor.hpp"
 
 #include <kryos/core/application.hpp>
@@ -12,25 +14,25 @@
 
 namespace workspace {
 
-void int_draw(const std::string& fieldname, void* ptr, float step_size)
+void int_draw(const char* fieldname, void* ptr, float step_size)
 {
     int* value = reinterpret_cast<int*>(ptr);
-    ImGui::DragInt(std::string("##" + fieldname).c_str(), value, step_size);
+    ImGui::DragInt((std::string("##") + fieldname).c_str(), value, step_size);
 }
 
-void float_draw(const std::string& fieldname, void* ptr, float step_size)
+void float_draw(const char* fieldname, void* ptr, float step_size)
 {
     float* value = reinterpret_cast<float*>(ptr);
-    ImGui::DragFloat(std::string("##" + fieldname).c_str(), value, step_size);
+    ImGui::DragFloat((std::string("##") + fieldname).c_str(), value, step_size);
 }
 
-void bool_draw(const std::string& fieldname, void* ptr, float step_size)
+void bool_draw(const char* fieldname, void* ptr, float step_size)
 {
     bool* value = reinterpret_cast<bool*>(ptr);
-    ImGui::Checkbox(std::string("##" + fieldname).c_str(), value);
+    ImGui::Checkbox((std::string("##") + fieldname).c_str(), value);
 }
 
-void str_draw(const std::string& fieldname, void* ptr, float step_size)
+void str_draw(const char* fieldname, void* ptr, float step_size)
 {
     constexpr std::size_t max_line_length = 10000;
 
@@ -39,44 +41,44 @@ void str_draw(const std::string& fieldname, void* ptr, float step_size)
 
     strncpy(str, value->c_str(), value->size());
     str[value->size()] = '\0';
-    ImGui::InputText(std::string("##" + fieldname).c_str(), str, max_line_length);
+    ImGui::InputText((std::string("##") + fieldname).c_str(), str, max_line_length);
     *value = str;
 }
 
-void vec2_draw(const std::string& fieldname, void* ptr, float step_size)
+void vec2_draw(const char* fieldname, void* ptr, float step_size)
 {
     glm::vec2& vec = *reinterpret_cast<glm::vec2*>(ptr);
-    ImGui::DragFloat2(std::string("##" + fieldname).c_str(), &vec[0], step_size);
+    ImGui::DragFloat2((std::string("##") + fieldname).c_str(), &vec[0], step_size);
 }
 
-void vec3_draw(const std::string& fieldname, void* ptr, float step_size)
+void vec3_draw(const char* fieldname, void* ptr, float step_size)
 {
     float* vec = reinterpret_cast<float*>(ptr);
-    ImGui::DragFloat3(std::string("##" + fieldname).c_str(), vec, step_size);
+    ImGui::DragFloat3((std::string("##") + fieldname).c_str(), vec, step_size);
 }
 
-void vec4_draw(const std::string& fieldname, void* ptr, float step_size)
+void vec4_draw(const char* fieldname, void* ptr, float step_size)
 {
     float* vec = reinterpret_cast<float*>(ptr);
-    ImGui::DragFloat4(std::string("##" + fieldname).c_str(), vec, step_size);
+    ImGui::DragFloat4((std::string("##") + fieldname).c_str(), vec, step_size);
 }
 
-void ivec2_draw(const std::string& fieldname, void* ptr, float step_size)
+void ivec2_draw(const char* fieldname, void* ptr, float step_size)
 {
     int* vec = reinterpret_cast<int*>(ptr);
-    ImGui::DragInt2(std::string("##" + fieldname).c_str(), vec, step_size);
+    ImGui::DragInt2((std::string("##") + fieldname).c_str(), vec, step_size);
 }
 
-void ivec3_draw(const std::string& fieldname, void* ptr, float step_size)
+void ivec3_draw(const char* fieldname, void* ptr, float step_size)
 {
     int* vec = reinterpret_cast<int*>(ptr);
-    ImGui::DragInt3(std::string("##" + fieldname).c_str(), vec, step_size);
+    ImGui::DragInt3((std::string("##") + fieldname).c_str(), vec, step_size);
 }
 
-void ivec4_draw(const std::string& fieldname, void* ptr, float step_size)
+void ivec4_draw(const char* fieldname, void* ptr, float step_size)
 {
     int* vec = reinterpret_cast<int*>(ptr);
-    ImGui::DragInt4(std::string("##" + fieldname).c_str(), vec, step_size);
+    ImGui::DragInt4((std::string("##") + fieldname).c_str(), vec, step_size);
 }
 
 KProperties::KProperties(KHierarchy* hierarchy)
@@ -120,13 +122,23 @@ void KProperties::on_imgui_update()
             if (entity.get_component<KCName>() == nullptr)
             {
                 if (ImGui::MenuItem("Add Name"))
+                {
                     entity.add_component<KCName>();
+                    KLSceneChanges::get()->mark_component_added(
+                        entity, KTypeId::create<KCName>().get_id()
+                    );
+                }
             }
 
             if (entity.get_component<KCTag>() == nullptr)
             {
                 if (ImGui::MenuItem("Add Tag"))
+                {
                     entity.add_component<KCTag>();
+                    KLSceneChanges::get()->mark_component_added(
+                        entity, KTypeId::create<KCTag>().get_id()
+                    );
+                }
             }
         }
 
@@ -151,6 +163,8 @@ void KProperties::on_imgui_update()
 
             ImGui::InputText("##NameComponent", str, KRYOS_NAME_COMPONENT_MAX_SIZE);
             name_comp->name = str;
+            if (ImGui::IsItemEdited())
+                KLSceneChanges::get()->mark_pool_mutated(KTypeId::create<KCName>().get_id());
         }
 
         if (tag_comp != nullptr)
@@ -160,6 +174,8 @@ void KProperties::on_imgui_update()
 
             ImGui::InputText("##NameComponent", str, KRYOS_NAME_COMPONENT_MAX_SIZE);
             tag_comp->tag = str;
+            if (ImGui::IsItemEdited())
+                KLSceneChanges::get()->mark_pool_mutated(KTypeId::create<KCTag>().get_id());
         }
         ImGui::PopItemWidth();
 
@@ -194,15 +210,17 @@ void KProperties::on_imgui_update()
                                 "settings", ImGuiTableColumnFlags_WidthFixed,
                                 ImGui::GetContentRegionAvail().x * 0.75f
                             );
-                            const std::set<KMemberInfo>& members =
-                                reflection->get_members(KTypeId(pool->get_type_hash()));
-
-                            KSerializeData data = {};
-                            data.object = object;
-                            data.iter = members.begin();
-                            data.end = members.end();
-                            data.reflection = reflection;
-                            _imgui_draw(data);
+                            _imgui_draw(
+                                KLMemberTables::get()->find(pool->get_type_hash()), object
+                            );
+
+                            if (m_edited)
+                            {
+                                KLSceneChanges::get()->mark_entity_mutated(
+                                    entity, pool->get_type_hash()
+                                );
+                                m_edited = false;
+                            }
                         }
                         ImGui::EndTable();
                     }
@@ -234,6 +252,7 @@ void KProperties::on_imgui_update()
                             ))
                         {
                             entity.add_component(reflection, type);
+                            KLSceneChanges::get()->mark_component_added(entity, type);
                             break;
                         }
                     }
@@ -255,90 +274,77 @@ void KProperties::_initialize_draw_fnptrs(
         m_draw_fnptrs.emplace(hash, fnptr);
 }
 
-void KProperties::_imgui_draw(KSerializeData& data)
+void KProperties::_imgui_draw(std::uint32_t table, std::byte* object)
 {
-    // NOTE: Not going to deal with pointers higher than 2, dealing with single pointer is enough
-    if (data.iter == data.end)
+    // Types without reflected members have no table
+    if (table == KLMemberTables::null_table)
         return;
 
-    if (data.iter->variable.get_pointer_count() > 2 ||
-        data.iter->variable.get_flags() & KEVariableFlag_Const ||
-        data.iter->flags & KEMemberInfoEditorFlag_Hide)
+    const KLMemberTables* tables = KLMemberTables::get();
+    const KMemberTable& member_table = tables->get_table(table);
+    for (const KMemberEntry* entry = tables->begin(member_table);
+         entry != tables->end(member_table); entry++)
     {
-        data.iter++;
-        _imgui_draw(data);
-        return;
-    }
-
-    const KTypeInfo& stripped_info = data.reflection->get_type_info(data.iter->variable.get_type());
-
-    if (stripped_info.flags & KETypeInfoFlag_StdVector)
-        _imgui_draw_std_vector(data, stripped_info);
-    if (stripped_info.flags & KETypeInfoFlag_StdArray)
-        _imgui_draw_std_array(data);
-    else if (m_draw_fnptrs.contains(data.iter->variable.get_type().get_id()))
-    {
-        ImGui::TableNextColumn();
-        ImGui::Text("%s", data.iter->fieldname.c_str());
-        ImGui::TableNextColumn();
-
-        fnptr_imgui_draw_property fnptr = m_draw_fnptrs[data.iter->variable.get_type().get_id()];
-        if (data.iter->variable.is_array())
-            _imgui_draw_array(data, stripped_info, fnptr);
-        else
+        if (entry->flags & KEMemberEntryFlag_Skip)
+            continue;
+
+        if (entry->flags & KEMemberEntryFlag_StdVector)
+            _imgui_draw_std_vector(*entry, object);
+        else if (entry->flags & KEMemberEntryFlag_StdArray)
+            _imgui_draw_std_array(*entry);
+        else if (m_draw_fnptrs.contains(entry->type_id))
         {
-            // Primitive type that can easly be printed
-            ImGui::PushItemWidth(ImGui::GetContentRegionAvail().x);
-            fnptr(
-                data.iter->fieldname, static_cast<void*>(data.object + data.iter->offset),
-                m_step_size
-            );
-            ImGui::PopItemWidth();
+            const char* fieldname = tables->get_string(entry->name);
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", fieldname);
+            ImGui::TableNextColumn();
+
+            fnptr_imgui_draw_property fnptr = m_draw_fnptrs[entry->type_id];
+            if (entry->flags & KEMemberEntryFlag_Array)
+                _imgui_draw_array(*entry, object, fnptr);
+            else
+            {
+                // Primitive type that can easly be printed
+                ImGui::PushItemWidth(ImGui::GetContentRegionAvail().x);
+                fnptr(fieldname, static_cast<void*>(object + entry->offset), m_step_size);
+                m_edited |= ImGui::IsItemEdited();
+                ImGui::PopItemWidth();
 
-            ImGui::TableNextRow();
+                ImGui::TableNextRow();
+            }
         }
-
-        data.iter++;
-        _imgui_draw(data);
+        else
+            _imgui_draw_non_primitive(*entry, object);
     }
-    else
-        _imgui_draw_non_primitive(data);
 }
 
-void KProperties::_imgui_draw_std_vector(
-    KSerializeData& data, const KTypeInfo& vector_inner_type_info
-)
+void KProperties::_imgui_draw_std_vector(const KMemberEntry& entry, std::byte* object)
 {
+    const KLMemberTables* tables = KLMemberTables::get();
+    const char* fieldname = tables->get_string(entry.name);
     ImGui::TableNextColumn();
-    ImGui::Text("%s", data.iter->fieldname.c_str());
+    ImGui::Text("%s", fieldname);
     ImGui::TableNextColumn();
 
     assert(
-        data.reflection->is_templated_type(data.iter->type) &&
+        entry.element_type_id != 0 &&
         "Attempted to create vector property in editor, however type is not in the "
         "templated reflection registry"
     );
 
-    // There should only be one type for vector
-    KTypeId internal_type =
-        KTypeId(data.reflection->get_templated_internal_types(data.iter->type).front());
-
-    if (m_draw_fnptrs.contains(internal_type.get_id()))
+    if (m_draw_fnptrs.contains(entry.element_type_id))
     {
-        const KTypeInfo& internal_type_info =
-            data.reflection->get_type_info(KTypeId(internal_type));
-
         KVectorInternalStructor* internal_structure =
-            reinterpret_cast<KVectorInternalStructor*>(data.object + data.iter->offset);
+            reinterpret_cast<KVectorInternalStructor*>(object + entry.offset);
         std::size_t vector_size =
-            (internal_structure->end - internal_structure->begin) / internal_type_info.size;
+            (internal_structure->end - internal_structure->begin) / entry.element_size;
 
         // Printing the vector
         if (vector_size > 0)
         {
             ImGui::TableNextRow();
 
-            fnptr_imgui_draw_property fnptr = m_draw_fnptrs[internal_type.get_id()];
+            fnptr_imgui_draw_property fnptr = m_draw_fnptrs[entry.element_type_id];
             for (std::size_t i = 0; i < vector_size; i++)
             {
                 ImGui::TableNextColumn();
@@ -353,41 +359,44 @@ void KProperties::_imgui_draw_std_vector(
 
                 ImGui::PushItemWidth(ImGui::GetContentRegionAvail().x);
                 fnptr(
-                    data.iter->fieldname + std::to_string(i),
-                    internal_structure->begin + (internal_type_info.size * i), m_step_size
+                    (fieldname + std::to_string(i)).c_str(),
+                    internal_structure->begin + (entry.element_size * i), m_step_size
                 );
+                m_edited |= ImGui::IsItemEdited();
                 ImGui::PopItemWidth();
             }
         }
 
         ImGui::TableNextRow();
-        data.iter++;
-        _imgui_draw(data);
     }
     else
+    {
         ImGui::Text(
             "%s not supported editable type, structures will come soon",
-            vector_inner_type_info.name.c_str()
+            tables->get_string(entry.type_name)
         );
+        ImGui::TableNextRow();
+    }
 }
 
-void KProperties::_imgui_draw_std_array(KSerializeData& data)
+void KProperties::_imgui_draw_std_array(const KMemberEntry& entry)
 {
     ImGui::TableNextColumn();
-    ImGui::Text("%s", data.iter->fieldname.c_str());
+    ImGui::Text("%s", KLMemberTables::get()->get_string(entry.name));
     ImGui::TableNextColumn();
     ImGui::Text("std::array coming soon...");
     ImGui::TableNextRow();
 }
 
 void KProperties::_imgui_draw_array(
-    KSerializeData& data, const KTypeInfo& info, fnptr_imgui_draw_property fnptr
+    const KMemberEntry& entry, std::byte* object, fnptr_imgui_draw_property fnptr
 )
 {
     ImGui::TableNextRow();
 
-    std::byte* array_begin = data.object + data.iter->offset;
-    for (std::size_t i = 0; i < data.iter->variable.get_array_size(); i++)
+    const char* fieldname = KLMemberTables::get()->get_string(entry.name);
+    std::byte* array_begin = object + entry.offset;
+    for (std::size_t i = 0; i < entry.array_size; i++)
     {
         ImGui::TableNextColumn();
 
@@ -398,27 +407,28 @@ void KProperties::_imgui_draw_array(
 
         ImGui::TableNextColumn();
         ImGui::PushItemWidth(ImGui::GetContentRegionAvail().x);
-        std::byte* element = array_begin + (i * info.size);
-        fnptr(data.iter->fieldname + std::to_string(i), element, m_step_size);
+        std::byte* element = array_begin + (i * entry.type_size);
+        fnptr((fieldname + std::to_string(i)).c_str(), element, m_step_size);
+        m_edited |= ImGui::IsItemEdited();
         ImGui::PopItemWidth();
 
         ImGui::TableNextRow();
     }
 }
 
-void KProperties::_imgui_draw_non_primitive(KSerializeData& data)
+void KProperties::_imgui_draw_non_primitive(const KMemberEntry& entry, std::byte* object)
 {
-    if (data.reflection->type_contains_members(data.iter->variable.get_type().get_id()))
+    if (entry.flags & KEMemberEntryFlag_Nested)
     {
-        KEMemberInfoEditorFlags flags = data.iter->flags;
+        const KLMemberTables* tables = KLMemberTables::get();
+        KEMemberInfoEditorFlags flags = entry.editor_flags;
         ImGui::TableNextColumn();
         ImGui::Text(
-            "%s (%s)", data.iter->fieldname.c_str(),
-            data.reflection->get_variable_type_name(data.iter->variable).c_str()
+            "%s (%s)", tables->get_string(entry.name), tables->get_string(entry.type_name)
         );
         ImGui::TableNextRow();
 
-        if (data.iter->variable.is_pointer())
+        if (entry.flags & KEMemberEntryFlag_Pointer)
         {
             if (flags & KEMemberInfoEditorFlag_NeverOwnsPtrData)
             {
@@ -429,22 +439,12 @@ void KProperties::_imgui_draw_non_primitive(KSerializeData& data)
                 // TODO: ...
             }
         }
-        else if (data.iter->variable.is_array())
+        else if (entry.flags & KEMemberEntryFlag_Array)
         {
             // TODO: ...
         }
         else
-        {
-            const std::set<KMemberInfo>& members = data.reflection->get_members(data.iter->type);
-
-            KSerializeData new_object = {};
-            new_object.object = data.object + data.iter->offset;
-            new_object.iter = members.begin();
-            new_object.end = members.end();
-            new_object.reflection = data.reflection;
-
-            _imgui_draw(new_object);
-        }
+            _imgui_draw(entry.nested_table, object + entry.offset);
     }
 }
 
@@ -1,6 +1,7 @@
 #ifndef __KRYOS_ENGINE_GUI_PROPERTIES_HPP__
 #define __KRYOS_ENGINE_GUI_PROPERTIES_HPP__
 
+#include "core/member_tables.hpp"
 #include "gui/editor.hpp"
 #include "gui/hierarchy.hpp"
 
@@ -10,7 +11,7 @@
 
 namespace workspace {
 
-typedef void (*fnptr_imgui_draw_property)(const std::string& fieldname, void* ptr, float step_size);
+typedef void (*fnptr_imgui_draw_property)(const char* fieldname, void* ptr, float step_size);
 
 class KProperties final : public KIWorkspace
 {
@@ -24,19 +25,20 @@ class KProperties final : public KIWorkspace
     void _initialize_draw_fnptrs(
         std::initializer_list<std::pair<std::uint64_t, fnptr_imgui_draw_property>> list
     );
-    void _imgui_draw(KSerializeData& data);
-    void
-        _imgui_draw_std_vector(KSerializeData& data, const KTypeInfo& vector_inner_type_info);
+    // Draws the members of the object through its type's flattened member table
+    void _imgui_draw(std::uint32_t table, std::byte* object);
+    void _imgui_draw_std_vector(const KMemberEntry& entry, std::byte* object);
     void _imgui_draw_array(
-        KSerializeData& data, const KTypeInfo& type, fnptr_imgui_draw_property
+        const KMemberEntry& entry, std::byte* object, fnptr_imgui_draw_property fnptr
     );
-    void _imgui_draw_std_array(KSerializeData& data);
-    void _imgui_draw_non_primitive(KSerializeData& data);
+    void _imgui_draw_std_array(const KMemberEntry& entry);
+    void _imgui_draw_non_primitive(const KMemberEntry& entry, std::byte* object);
 
   private:
     KHierarchy* m_hierarchy = nullptr;
     std::unordered_map<std::uint64_t, fnptr_imgui_draw_property> m_draw_fnptrs = {};
     float m_step_size = 0.5f;
+    bool m_edited = false;
 };
 
 }
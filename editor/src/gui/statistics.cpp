@@ -0,0 +1,258 @@
+#include "gui/statistics.hpp"
+#include "core/asset_cooker.hpp"
+#include "core/asset_index.hpp"
+#include "core/asset_residency.hpp"
+#include "core/hot_reload.hpp"
+#include "core/mesh_lods.hpp"
+#include "core/play_mode.hpp"
+#include "core/pool_compaction.hpp"
+#include "core/prefabs.hpp"
+
+#include <kryos/core/application.hpp>
+#include <kryos/scene/scene_manager.hpp>
+
+#include <imgui/imgui.h>
+
+namespace workspace {
+
+KStatistics::KStatistics(KViewport* viewport) : KIWorkspace("Statistics"), m_viewport(viewport)
+{
+    get_enabled() = false;
+}
+
+void KStatistics::on_imgui_update()
+{
+    ImGui::Begin(get_name().c_str(), &get_enabled());
+
+    if (ImGui::CollapsingHeader("Viewport", ImGuiTreeNodeFlags_DefaultOpen))
+        _viewport_stats();
+
+    if (ImGui::CollapsingHeader("Assets", ImGuiTreeNodeFlags_DefaultOpen))
+        _asset_stats();
+
+    if (ImGui::CollapsingHeader("Residency", ImGuiTreeNodeFlags_DefaultOpen))
+        _residency_stats();
+
+    if (ImGui::CollapsingHeader("Play Mode", ImGuiTreeNodeFlags_DefaultOpen))
+        _play_mode_stats();
+
+    if (ImGui::CollapsingHeader("Prefabs", ImGuiTreeNodeFlags_DefaultOpen))
+        _prefab_stats();
+
+    if (ImGui::CollapsingHeader("Pools"))
+        _pool_stats();
+
+    ImGui::End();
+}
+
+void KStatistics::_viewport_stats()
+{
+    std::uint64_t rendered = m_viewport->get_rendered_frames();
+    std::uint64_t reused = m_viewport->get_reused_frames();
+    std::uint64_t total = rendered + reused;
+    float reused_percent =
+        total > 0 ? static_cast<float>(reused) / static_cast<float>(total) * 100.0f : 0.0f;
+
+    ImGui::Text("Rendered Frames: %llu", static_cast<unsigned long long>(rendered));
+    ImGui::Text(
+        "Reused Frames: %llu (%.1f%%)", static_cast<unsigned long long>(reused), reused_percent
+    );
+
+    const KFramebufferPool& pool = m_viewport->get_framebuffer_pool();
+    ImGui::Text(
+        "Framebuffer Allocations: %zu (%zu/s)", pool.get_allocation_count(),
+        pool.get_allocations_per_second()
+    );
+
+    const KSceneRenderer& scene_renderer = m_viewport->get_scene_renderer();
+    const KDynamicBvh& bvh = KLSpatialIndex::get()->get_bvh();
+    ImGui::Text(
+        "Visible: %zu / %zu", scene_renderer.get_visible_entities().size(),
+        bvh.get_proxy_count()
+    );
+    ImGui::Text(
+        "BVH Height: %i, Reinserts: %zu, Last Refit: %zu", bvh.get_height(),
+        bvh.get_reinsert_count(), KLSpatialIndex::get()->get_last_refit_count()
+    );
+
+    ImGui::Text(
+        "Draw Calls: %zu (%zu unbatched), Batches: %zu, Instances: %zu",
+        scene_renderer.get_draw_calls(), scene_renderer.get_unbatched_draw_calls(),
+        scene_renderer.get_batch_count(), scene_renderer.get_instance_count()
+    );
+    ImGui::Text("Triangles: %zu", scene_renderer.get_triangle_count());
+
+    KLMeshLods* mesh_lods = KLMeshLods::get();
+    bool lods_enabled = mesh_lods->get_enabled();
+    if (ImGui::Checkbox("Mesh LODs", &lods_enabled))
+        mesh_lods->set_enabled(lods_enabled);
+    float pixel_error = mesh_lods->get_pixel_error();
+    if (ImGui::SliderFloat("LOD Pixel Error", &pixel_error, 0.25f, 16.0f, "%.2fpx"))
+        mesh_lods->set_pixel_error(pixel_error);
+    ImGui::Text(
+        "LOD Models: %zu (%zu pending)", mesh_lods->get_model_count(),
+        mesh_lods->get_pending_count()
+    );
+
+    // Toggling this compares the main thread cost of recording inline against the worker
+    ImGui::Checkbox("Record On Worker Thread", &m_viewport->get_record_on_worker());
+    ImGui::Text("Scene Main Thread: %.3fms", m_viewport->get_scene_main_thread_time());
+}
+
+void KStatistics::_asset_stats()
+{
+    std::shared_ptr<const KAssetSnapshot> snapshot = KLAssetIndex::get()->get_snapshot();
+    ImGui::Text("Indexed: %zu", snapshot != nullptr ? snapshot->entries.size() : 0);
+
+    KLHotReload* hot_reload = KLHotReload::get();
+    ImGui::Text(
+        "Hot Reloads: %zu, Last Batch: %.3fms", hot_reload->get_reload_count(),
+        hot_reload->get_last_batch_time()
+    );
+
+    KLAssetCooker* asset_cooker = KLAssetCooker::get();
+    ImGui::Text(
+        "Cooked Assets: %zu (%zu pending), Last Batch: %.3fms", asset_cooker->get_cooked_count(),
+        asset_cooker->get_pending_count(), asset_cooker->get_last_batch_time()
+    );
+
+    const KDerivedDataCache& cache = asset_cooker->get_cache();
+    KDerivedDataStats stats = cache.get_stats();
+    constexpr double mebibyte = 1024.0 * 1024.0;
+    ImGui::Text(
+        "Derived Data: %zu entries, %.1f / %.0f MiB, %zu evicted", stats.entry_count,
+        static_cast<double>(stats.size) / mebibyte,
+        static_cast<double>(cache.get_max_size()) / mebibyte, stats.eviction_count
+    );
+    ImGui::Text(
+        "Cache Hit Rate: %.1f%% (%zu / %zu), Saved: %.1f MiB", stats.get_hit_rate() * 100.0f,
+        stats.hit_count, stats.hit_count + stats.miss_count,
+        static_cast<double>(stats.bytes_saved) / mebibyte
+    );
+}
+
+void KStatistics::_residency_stats()
+{
+    KLAssetResidency* residency = KLAssetResidency::get();
+    constexpr double mebibyte = 1024.0 * 1024.0;
+
+    int cpu_budget = static_cast<int>(residency->get_cpu_budget() / (1024 * 1024));
+    int gpu_budget = static_cast<int>(residency->get_gpu_budget() / (1024 * 1024));
+    bool cpu_changed = ImGui::SliderInt("Memory Budget", &cpu_budget, 16, 4096, "%i MiB");
+    bool gpu_changed = ImGui::SliderInt("Video Memory Budget", &gpu_budget, 16, 4096, "%i MiB");
+    if (cpu_changed || gpu_changed)
+        residency->set_budget(
+            static_cast<std::uint64_t>(cpu_budget) * 1024 * 1024,
+            static_cast<std::uint64_t>(gpu_budget) * 1024 * 1024
+        );
+
+    ImGui::Text(
+        "Resident: %.1f MiB memory, %.1f MiB video memory%s",
+        static_cast<double>(residency->get_cpu_bytes()) / mebibyte,
+        static_cast<double>(residency->get_gpu_bytes()) / mebibyte,
+        residency->is_over_budget() ? " (over budget)" : ""
+    );
+    ImGui::Text(
+        "Loads: %zu (%zu reloads, %zu streaming), Evictions: %zu", residency->get_load_count(),
+        residency->get_reload_count(), residency->get_loading_count(),
+        residency->get_eviction_count()
+    );
+
+    for (KEAssetType type : {KEAssetType_Model, KEAssetType_Texture})
+    {
+        KResidencyTypeStats stats = residency->get_type_stats(type);
+        ImGui::Text(
+            "%s: %zu (%zu referenced), %.1f MiB memory, %.1f MiB video memory",
+            KLAssetIndex::get_type_name(type), stats.asset_count, stats.referenced_count,
+            static_cast<double>(stats.cpu_bytes) / mebibyte,
+            static_cast<double>(stats.gpu_bytes) / mebibyte
+        );
+    }
+}
+
+void KStatistics::_play_mode_stats()
+{
+    KLPlayMode* play_mode = KLPlayMode::get();
+    const KRegistrySnapshot& snapshot = play_mode->get_snapshot();
+
+    ImGui::Text("State: %s", play_mode->is_playing() ? "Playing" : "Stopped");
+    if (play_mode->is_playing())
+    {
+        ImGui::Text(
+            "Snapshot: %zu entities, %.1f KiB columns, %zu reflected components",
+            snapshot.get_entity_count(), static_cast<double>(snapshot.get_column_size()) / 1024.0,
+            snapshot.get_reflected_count()
+        );
+        for (const std::string& type : snapshot.get_skipped_types())
+            ImGui::Text("Not Restored: %s", type.c_str());
+    }
+    ImGui::Text(
+        "Last Snapshot: %.3f ms, Last Restore: %.3f ms", play_mode->get_last_snapshot_time(),
+        play_mode->get_last_restore_time()
+    );
+}
+
+void KStatistics::_prefab_stats()
+{
+    KScene* scene = KIApplication::get_layer<KLSceneManager>()->get_active_scene();
+    KPrefabMemoryStats stats = KLPrefabs::get()->get_memory_stats(scene);
+
+    ImGui::Text("Instances: %zu, Overrides: %zu", stats.instance_count, stats.override_count);
+    ImGui::Text(
+        "Component Data: %.1f KiB shared, %.1f KiB as full copies",
+        static_cast<double>(stats.shared_bytes) / 1024.0,
+        static_cast<double>(stats.full_bytes) / 1024.0
+    );
+}
+
+void KStatistics::_pool_stats()
+{
+    KLPoolCompaction* compaction = KLPoolCompaction::get();
+    const KRegistryFragmentation& fragmentation = compaction->get_fragmentation();
+
+    ImGui::Text(
+        "Entities: %zu live in %zu slots%s", fragmentation.live_entities,
+        fragmentation.entity_slots, compaction->is_measured() ? "" : " (measuring)"
+    );
+
+    ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV;
+    if (ImGui::BeginTable("Statistics -> Pools", 6, flags))
+    {
+        ImGui::TableSetupColumn("Pool");
+        ImGui::TableSetupColumn("Live");
+        ImGui::TableSetupColumn("Slots");
+        ImGui::TableSetupColumn("Holes");
+        ImGui::TableSetupColumn("Wasted");
+        ImGui::TableSetupColumn("Out of Order");
+        ImGui::TableHeadersRow();
+
+        for (const KPoolFragmentation& pool : fragmentation.pools)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(pool.name.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", pool.live_count);
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", pool.slot_count);
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", pool.hole_count);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f KiB", static_cast<double>(pool.wasted_bytes) / 1024.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", pool.order_breaks);
+        }
+        ImGui::EndTable();
+    }
+
+    if (compaction->is_compacting())
+        ImGui::TextUnformatted("Compacting...");
+    else if (!KLPlayMode::get()->is_playing() && ImGui::Button("Compact"))
+        compaction->compact();
+    ImGui::Text(
+        "Last Compaction: capture %.3f ms, rebuild %.3f ms", compaction->get_last_capture_time(),
+        compaction->get_last_rebuild_time()
+    );
+}
+
+} // namespace workspace
@@ -0,0 +1,31 @@
+#ifndef __KRYOS_EDITOR_GUI_STATISTICS_HPP__
+#define __KRYOS_EDITOR_GUI_STATISTICS_HPP__
+
+#include "gui/editor.hpp"
+#include "gui/viewport.hpp"
+
+namespace workspace {
+
+class KStatistics final : public KIWorkspace
+{
+  public:
+    KStatistics(KViewport* viewport);
+    virtual ~KStatistics() override = default;
+
+    virtual void on_imgui_update() override;
+
+  private:
+    void _viewport_stats();
+    void _asset_stats();
+    void _residency_stats();
+    void _play_mode_stats();
+    void _prefab_stats();
+    void _pool_stats();
+
+  private:
+    KViewport* m_viewport = nullptr;
+};
+
+} // namespace workspace
+
+#endif
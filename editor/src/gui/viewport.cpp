@@ -1,26 +1,32 @@
 #include "gui/viewport.hpp"
+#include "core/editor_entities.hpp"
+#include "core/mesh_lods.hpp"
 #include "core/project.hpp"
+#include "core/scene_changes.hpp"
 #include "gui/editor.hpp"
+#include "gui/hierarchy.hpp"
 #include "gui/preferences.hpp"
+#include "utils/camera.hpp"
 #include "utils/utils.hpp"
 
 #include <kryos/core/input.hpp>
 
+#include <chrono>
 #include <imgui/imgui.h>
 #include <imgui/imgui_internal.h>
 #include <portable-file-dialogs/portable-file-dialogs.h>
 
 namespace workspace {
 
-KViewport::KViewport(KFramebuffer* framebuffer) : KIWorkspace("Viewport")
+static bool cameras_equal(const KCCamera& lhs, const KCCamera& rhs)
 {
-    if (framebuffer != nullptr)
-        m_framebuffer = framebuffer;
-    else
-        KLDebug::log("Viewport::Viewport(Framebuffer*) -> failed to create "
-                     "viewport as framebuffer is nullptr");
+    return lhs.position == rhs.position && lhs.forward == rhs.forward && lhs.up == rhs.up &&
+           lhs.clear_color == rhs.clear_color && lhs.projection_type == rhs.projection_type &&
+           lhs.is_main == rhs.is_main;
 }
 
+KViewport::KViewport() : KIWorkspace("Viewport") {}
+
 void KViewport::on_imgui_update()
 {
     ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
@@ -37,26 +43,17 @@ void KViewport::on_imgui_update()
 
         if (scene != nullptr)
         {
-            auto view = ecs::View<KCCamera, KCTag>(&scene->get_registry());
-            for (ecs::Entity entity : view)
-            {
-                if (view.has_required(entity))
-                {
-                    auto [camera, tag] = view.get();
-                    if (std::string(tag->tag) == HIERARCHY_FILTER_NAME)
-                    {
-                        editor_camera = camera;
-                        break;
-                    }
-                }
-            }
+            // Scenes loaded from disk never contain the editor camera, so create it on demand
+            editor_camera = KLEditorEntities::get()->get_camera(scene);
+            if (editor_camera == nullptr)
+                editor_camera = KLEditorEntities::get()->create_camera(scene);
         }
         else
         {
             ImVec2 window_size = ImGui::GetWindowSize();
 
             if (KLProject::get()->opened())
-                _no_scene(editor_camera, window_size.x, window_size.y);
+                _no_scene(window_size.x, window_size.y);
             else
                 _no_project();
         }
@@ -66,46 +63,124 @@ void KViewport::on_imgui_update()
             _camera_controller(editor_camera);
             ImGui::BeginChild(1);
             {
-                if (m_framebuffer != nullptr)
+                ImVec2 window_size = ImGui::GetWindowSize();
+                if (m_framebuffer_pool.acquire(
+                        static_cast<int>(window_size.x), static_cast<int>(window_size.y),
+                        KTime::get_delta()
+                    ))
                 {
-                    ImVec2 window_size = ImGui::GetWindowSize();
+                    _update_render_state(scene, editor_camera);
 
-                    if (window_size.x != m_framebuffer->size.x ||
-                        window_size.y != m_framebuffer->size.y)
-                    {
-                        m_framebuffer =
-                            KIApplication::get_layer<KLPipeline>()->recreate_framebuffer(
-                                m_framebuffer, static_cast<int>(window_size.x),
-                                static_cast<int>(window_size.y)
-                            );
-                        if (m_framebuffer == nullptr)
-                        {
-                            KLDebug::log("Viewport::on_imgui_update() -> failed to resize "
-                                         "framebuffer size");
-                            return;
-                        }
-                    }
+                    // The pool over-allocates, so only the sub-rectangle the scene was rendered
+                    // into is displayed, flipped vertically as OpenGL's origin is the bottom left
+                    const glm::vec2& uv_max = m_framebuffer_pool.get_uv_max();
 
-                    uint64_t viewport_texture_id = static_cast<uint64_t>(m_framebuffer->texture);
+                    uint64_t viewport_texture_id =
+                        static_cast<uint64_t>(m_framebuffer_pool.get_texture());
                     ImGui::Image(
-                        reinterpret_cast<void*>(viewport_texture_id),
-                        ImVec2(
-                            static_cast<float>(m_framebuffer->size.x),
-                            static_cast<float>(m_framebuffer->size.y)
-                        ),
-                        ImVec2(1, 1), ImVec2(0, 0)
+                        reinterpret_cast<void*>(viewport_texture_id), window_size,
+                        ImVec2(0.0f, uv_max.y), ImVec2(uv_max.x, 0.0f)
                     );
+
+                    // Shift is held while navigating, clicks then belong to the camera controller
+                    if (ImGui::IsItemClicked(ImGuiMouseButton_Left) &&
+                        !KInput::pressed_key(InputKeyCode_LeftShift))
+                    {
+                        _pick_entity(*editor_camera);
+                    }
                 }
                 else
                     ImGui::Text("No Framebuffer Allocated");
             }
             ImGui::EndChild();
         }
+        else
+        {
+            // Nothing is cached to fall back on, the next frame with a camera needs rendering
+            m_force_render = true;
+        }
     }
 
     ImGui::End();
 }
 
+void KViewport::_update_render_state(KScene* scene, KCCamera* camera)
+{
+    KLSceneChanges* changes = KLSceneChanges::get();
+    ecs::Registry& registry = scene->get_registry();
+
+    // Entity and pool counts catch changes that weren't made through the editor panels
+    bool dirty = m_force_render || scene != m_last_scene ||
+                 !cameras_equal(*camera, m_last_camera) ||
+                 changes->get_version() != m_last_version ||
+                 m_framebuffer_pool.get_allocation_count() != m_last_allocation_count ||
+                 m_framebuffer_pool.get_viewport_size() != m_last_viewport_size ||
+                 registry.get_entities().size() != m_last_entity_count ||
+                 registry.get_pools().size() != m_last_pool_count ||
+                 m_record_on_worker != m_last_record_on_worker ||
+                 KLMeshLods::get()->get_version() != m_last_lod_version;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Recorded lists are replayed a frame after they were submitted, so keep replaying while the
+    // worker still has one in flight even when nothing is dirty anymore
+    GLuint framebuffer = m_framebuffer_pool.get_framebuffer();
+    const glm::ivec2& viewport_size = m_framebuffer_pool.get_viewport_size();
+    if (dirty)
+    {
+        if (m_record_on_worker)
+            m_scene_renderer.submit(scene, *camera, viewport_size);
+        else
+            m_scene_renderer.render(scene, *camera, framebuffer, viewport_size);
+
+        m_force_render = false;
+        m_last_scene = scene;
+        m_last_camera = *camera;
+        m_last_version = changes->get_version();
+        m_last_allocation_count = m_framebuffer_pool.get_allocation_count();
+        m_last_viewport_size = m_framebuffer_pool.get_viewport_size();
+        m_last_entity_count = registry.get_entities().size();
+        m_last_pool_count = registry.get_pools().size();
+        m_last_record_on_worker = m_record_on_worker;
+        m_last_lod_version = KLMeshLods::get()->get_version();
+        m_rendered_frames++;
+    }
+    else
+        m_reused_frames++;
+
+    if (m_record_on_worker)
+        m_scene_renderer.replay(framebuffer, viewport_size);
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    double time = std::chrono::duration<double, std::milli>(end - start).count();
+    m_scene_main_thread_time = m_scene_main_thread_time * 0.95 + time * 0.05;
+}
+
+void KViewport::_pick_entity(const KCCamera& camera)
+{
+    const glm::ivec2& viewport_size = m_framebuffer_pool.get_viewport_size();
+    float aspect = static_cast<float>(viewport_size.x) / static_cast<float>(viewport_size.y);
+
+    ImVec2 item_min = ImGui::GetItemRectMin();
+    ImVec2 item_size = ImGui::GetItemRectSize();
+    ImVec2 mouse = ImGui::GetMousePos();
+    glm::vec2 local =
+        glm::vec2((mouse.x - item_min.x) / item_size.x, (mouse.y - item_min.y) / item_size.y);
+
+    // The image shows exactly the rendered sub-rectangle, with its bottom row at the bottom
+    glm::vec2 ndc = glm::vec2(local.x * 2.0f - 1.0f, 1.0f - local.y * 2.0f);
+
+    glm::vec3 origin = {};
+    glm::vec3 direction = {};
+    CameraHelper::ndc_to_ray(camera, aspect, ndc, origin, direction);
+
+    KHierarchy* hierarchy = static_cast<KHierarchy*>(
+        KIApplication::get_layer<KLEditorWorkspace>()->get_panel("Hierarchy")
+    );
+    if (hierarchy != nullptr)
+        hierarchy->set_selected_entity(KLSpatialIndex::get()->raycast(origin, direction));
+}
+
 void KViewport::_camera_controller(KCCamera* camera)
 {
     glm::vec2 mouse_position = KInput::get_mouse_position();
@@ -164,7 +239,7 @@ void KViewport::_camera_controller(KCCamera* camera)
     last_mouse_position = mouse_position;
 }
 
-void KViewport::_no_scene(KCCamera* editor_camera, float window_width, float window_height)
+void KViewport::_no_scene(float window_width, float window_height)
 {
     ImVec2 text_size = ImGui::CalcTextSize("Create Empty Scene");
     ImGui::SetCursorPosX((window_width - text_size.x) * 0.5f);
@@ -172,19 +247,11 @@ void KViewport::_no_scene(KCCamera* editor_camera, float window_width, float win
 
     if (ImGui::Button("Create Empty Scene"))
     {
-        KIApplication::get_layer<KLSceneManager>()->set_active(
-            KIApplication::get_layer<KLSceneManager>()->push("Empty Scene")
-        );
+        KLSceneManager* scene_manager = KIApplication::get_layer<KLSceneManager>();
+        scene_manager->set_active(scene_manager->push("Empty Scene"));
 
         // Create Editor Camera for new scene
-        KEntity entity = KEntity(true);
-        entity.add_component<KCTag>(HIERARCHY_FILTER_NAME);
-
-        editor_camera = entity.add_component<KCCamera>();
-        editor_camera->clear_color = glm::vec4(0.1f, 0.1f, 0.1f, 1.0f);
-        editor_camera->is_main = true;
-        // TODO: Set to Orthographic if in 2D mode
-        editor_camera->projection_type = CameraProjection_Perspective;
+        KLEditorEntities::get()->create_camera(scene_manager->get_active_scene());
         KLProject::get()->unsaved() = true;
     }
 }
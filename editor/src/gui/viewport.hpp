@@ -1,28 +1,58 @@
 #ifndef __KRYOS_EDITOR_GUI_VIEWPORT_HPP__
 #define __KRYOS_EDITOR_GUI_VIEWPORT_HPP__
 
+#include "core/framebuffer_pool.hpp"
+#include "core/scene_renderer.hpp"
+#include "core/spatial_index.hpp"
 #include "gui/editor.hpp"
 
-#include <kryos/renderer/pipeline.hpp>
 #include <kryos/scene/components.hpp>
+#include <kryos/scene/scene_manager.hpp>
 
 namespace workspace {
 
 class KViewport final : public KIWorkspace
 {
   public:
-    KViewport(KFramebuffer* framebuffer);
+    KViewport();
     virtual ~KViewport() override = default;
 
+    inline const KFramebufferPool& get_framebuffer_pool() const { return m_framebuffer_pool; }
+    inline std::uint64_t get_rendered_frames() const { return m_rendered_frames; }
+    inline std::uint64_t get_reused_frames() const { return m_reused_frames; }
+    inline double get_scene_main_thread_time() const { return m_scene_main_thread_time; }
+    inline bool& get_record_on_worker() { return m_record_on_worker; }
+    inline const KSceneRenderer& get_scene_renderer() const { return m_scene_renderer; }
+
     virtual void on_imgui_update() override;
 
   private:
+    void _update_render_state(KScene* scene, KCCamera* camera);
+    void _pick_entity(const KCCamera& camera);
     void _camera_controller(KCCamera* camera);
-    void _no_scene(KCCamera* camera, float window_width, float window_height);
+    void _no_scene(float window_width, float window_height);
     void _no_project();
 
-    glm::ivec2 m_last_required_framebuffer_size = {};
-    KFramebuffer* m_framebuffer = nullptr;
+    KFramebufferPool m_framebuffer_pool = {};
+    KSceneRenderer m_scene_renderer = {};
+    bool m_record_on_worker = true;
+    // Averaged milliseconds the main thread spends on the scene pass each frame
+    double m_scene_main_thread_time = 0.0;
+
+    // State the last rendered viewport frame was produced from, the scene isn't drawn and the
+    // cached framebuffer texture is shown again while nothing differs from it
+    bool m_force_render = true;
+    KScene* m_last_scene = nullptr;
+    KCCamera m_last_camera = {};
+    std::uint64_t m_last_version = 0;
+    std::size_t m_last_allocation_count = 0;
+    glm::ivec2 m_last_viewport_size = {};
+    std::size_t m_last_entity_count = 0;
+    std::size_t m_last_pool_count = 0;
+    bool m_last_record_on_worker = true;
+    std::uint64_t m_last_lod_version = 0;
+    std::uint64_t m_rendered_frames = 0;
+    std::uint64_t m_reused_frames = 0;
 
     float m_camera_move_speed = 5.0f;
     glm::vec2 m_camera_sensitivity = {0.05f, 0.05f};
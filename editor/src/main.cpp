@@ -1,7 +1,54 @@
+#include "core/benchmark.hpp"
+#include "core/command_line.hpp"
+#include "core/cook.hpp"
+#include "core/headless.hpp"
+#include "core/pack.hpp"
+#include "core/scene_tool.hpp"
 #include "gui/app.hpp"
 
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// Options each command reads a value from, the rest of its options are flags
+static const std::unordered_map<std::string, std::unordered_set<std::string>> value_options = {
+    {"render",
+     {"project", "scene", "output", "width", "height", "frames", "warmup-frames",
+      "residency-budget", "pak"}},
+    {"cook",
+     {"input", "output", "lods", "texture-format", "min-psnr", "cache", "cache-size", "threads",
+      "iterations"}},
+    {"pack", {"input", "output", "iterations"}},
+    {"diff", {"project", "output"}},
+    {"merge", {"project", "output"}},
+    {"generate",
+     {"project", "output", "entities", "names", "tags", "cameras", "meshes", "parents",
+      "parent-depth", "seed"}},
+    {"benchmark", {"project", "entities", "seed", "passes"}},
+};
+
 int main(int argc, char** argv)
 {
+    auto it = value_options.find(argc > 1 ? argv[1] : "");
+    KCommandLine command_line = KCommandLine(
+        argc, argv,
+        it != value_options.end() ? it->second : std::unordered_set<std::string>()
+    );
+    if (command_line.get_command() == "render")
+        return KHeadlessApp::run_render(command_line);
+    if (command_line.get_command() == "cook")
+        return KCookCommand::run(command_line);
+    if (command_line.get_command() == "pack")
+        return KPackCommand::run(command_line);
+    if (command_line.get_command() == "diff")
+        return KSceneToolApp::run_diff(command_line);
+    if (command_line.get_command() == "merge")
+        return KSceneToolApp::run_merge(command_line);
+    if (command_line.get_command() == "generate")
+        return KSceneToolApp::run_generate(command_line);
+    if (command_line.get_command() == "benchmark")
+        return KBenchmarkApp::run_benchmark(command_line);
+
     KEditorApp* app = new KEditorApp();
     app->run();
     delete app;
@@ -0,0 +1,56 @@
+#ifndef __KRYOS_EDITOR_UTILS_CAMERA_HPP__
+#define __KRYOS_EDITOR_UTILS_CAMERA_HPP__
+
+#include <kryos/scene/components.hpp>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// KCCamera only carries where the camera is and where it looks, the lens is the editor's own
+// since the scene renderer, culling and picking all project through it
+struct CameraHelper
+{
+    // Vertical, in degrees
+    static constexpr float fov = 60.0f;
+    static constexpr float near_plane = 0.1f;
+    static constexpr float far_plane = 2000.0f;
+
+    static glm::mat4 view(const KCCamera& camera)
+    {
+        return glm::lookAt(camera.position, camera.position + camera.forward, camera.up);
+    }
+
+    static glm::mat4 projection(const KCCamera&, float aspect)
+    {
+        // TODO: Orthographic projection for 2D projects
+        return glm::perspective(glm::radians(fov), aspect, near_plane, far_plane);
+    }
+
+    static glm::mat4 view_projection(const KCCamera& camera, float aspect)
+    {
+        return projection(camera, aspect) * view(camera);
+    }
+
+    // How many pixels one world space unit covers at the given distance from the camera
+    static float pixels_per_unit(float viewport_height, float distance)
+    {
+        float half_height = distance * glm::tan(glm::radians(fov) * 0.5f);
+        return viewport_height / (2.0f * glm::max(half_height, 1e-6f));
+    }
+
+    // Converts a point in normalized device coordinates into a world space ray
+    static void ndc_to_ray(
+        const KCCamera& camera, float aspect, const glm::vec2& ndc, glm::vec3& origin,
+        glm::vec3& direction
+    )
+    {
+        glm::mat4 inverse = glm::inverse(view_projection(camera, aspect));
+        glm::vec4 near_point = inverse * glm::vec4(ndc.x, ndc.y, -1.0f, 1.0f);
+        glm::vec4 far_point = inverse * glm::vec4(ndc.x, ndc.y, 1.0f, 1.0f);
+
+        origin = glm::vec3(near_point) / near_point.w;
+        direction = glm::normalize(glm::vec3(far_point) / far_point.w - origin);
+    }
+};
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef __KRYOS_EDITOR_UTILS_PNG_HPP__
+#define __KRYOS_EDITOR_UTILS_PNG_HPP__
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Minimal PNG writer for RGBA8 images, uses uncompressed deflate blocks so it doesn't need zlib.
+// Good enough for thumbnails and golden images where size doesn't matter
+struct PngWriter
+{
+    static bool write(
+        const std::string& filename, int width, int height, const std::uint8_t* rgba,
+        bool flip_vertically = false
+    )
+    {
+        std::size_t stride = static_cast<std::size_t>(width) * 4;
+
+        // Every scanline is prefixed with filter type 0 (none)
+        std::vector<std::uint8_t> raw = {};
+        raw.reserve((stride + 1) * static_cast<std::size_t>(height));
+        for (int y = 0; y < height; y++)
+        {
+            int row = flip_vertically ? height - y - 1 : y;
+            const std::uint8_t* scanline = rgba + static_cast<std::size_t>(row) * stride;
+            raw.push_back(0);
+            raw.insert(raw.end(), scanline, scanline + stride);
+        }
+
+        std::vector<std::uint8_t> idat = {0x78, 0x01};
+        std::size_t offset = 0;
+        do
+        {
+            std::size_t block_size = std::min<std::size_t>(raw.size() - offset, 65535);
+            bool final_block = offset + block_size == raw.size();
+            std::uint16_t length = static_cast<std::uint16_t>(block_size);
+
+            idat.push_back(final_block ? 1 : 0);
+            idat.push_back(static_cast<std::uint8_t>(length & 0xff));
+            idat.push_back(static_cast<std::uint8_t>(length >> 8));
+            idat.push_back(static_cast<std::uint8_t>(~length & 0xff));
+            idat.push_back(static_cast<std::uint8_t>((~length >> 8) & 0xff));
+            idat.insert(idat.end(), raw.begin() + offset, raw.begin() + offset + block_size);
+            offset += block_size;
+        } while (offset < raw.size());
+        _push_u32(idat, _adler32(raw.data(), raw.size()));
+
+        std::vector<std::uint8_t> header = {};
+        _push_u32(header, static_cast<std::uint32_t>(width));
+        _push_u32(header, static_cast<std::uint32_t>(height));
+        header.insert(header.end(), {8, 6, 0, 0, 0}); // 8 bit depth, RGBA, no interlacing
+
+        std::vector<std::uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+        _push_chunk(png, "IHDR", header);
+        _push_chunk(png, "IDAT", idat);
+        _push_chunk(png, "IEND", {});
+
+        std::ofstream file = std::ofstream(filename, std::ios::binary);
+        if (!file.is_open())
+            return false;
+
+        file.write(reinterpret_cast<const char*>(png.data()), png.size());
+        return file.good();
+    }
+
+  private:
+    static void _push_u32(std::vector<std::uint8_t>& buffer, std::uint32_t value)
+    {
+        buffer.insert(
+            buffer.end(),
+            {static_cast<std::uint8_t>(value >> 24), static_cast<std::uint8_t>(value >> 16),
+             static_cast<std::uint8_t>(value >> 8), static_cast<std::uint8_t>(value)}
+        );
+    }
+
+    static void _push_chunk(
+        std::vector<std::uint8_t>& png, const char* type, const std::vector<std::uint8_t>& data
+    )
+    {
+        _push_u32(png, static_cast<std::uint32_t>(data.size()));
+        std::size_t type_offset = png.size();
+        png.insert(png.end(), type, type + 4);
+        png.insert(png.end(), data.begin(), data.end());
+        _push_u32(png, _crc32(png.data() + type_offset, data.size() + 4));
+    }
+
+    static std::uint32_t _crc32(const std::uint8_t* data, std::size_t size)
+    {
+        static const std::array<std::uint32_t, 256> table = []()
+        {
+            std::array<std::uint32_t, 256> result = {};
+            for (std::uint32_t i = 0; i < 256; i++)
+            {
+                std::uint32_t c = i;
+                for (int k = 0; k < 8; k++)
+                    c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                result[i] = c;
+            }
+            return result;
+        }();
+
+        std::uint32_t crc = 0xffffffffu;
+        for (std::size_t i = 0; i < size; i++)
+            crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+        return crc ^ 0xffffffffu;
+    }
+
+    static std::uint32_t _adler32(const std::uint8_t* data, std::size_t size)
+    {
+        std::uint32_t a = 1;
+        std::uint32_t b = 0;
+        for (std::size_t i = 0; i < size; i++)
+        {
+            a = (a + data[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        return (b << 16) | a;
+    }
+};
+
+#endif
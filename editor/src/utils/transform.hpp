@@ -0,0 +1,20 @@
+#ifndef __KRYOS_EDITOR_UTILS_TRANSFORM_HPP__
+#define __KRYOS_EDITOR_UTILS_TRANSFORM_HPP__
+
+#include <kryos/scene/components.hpp>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+struct TransformHelper
+{
+    static glm::mat4 model_matrix(const KCTransform& transform)
+    {
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), transform.position);
+        model = model * glm::mat4_cast(transform.rotation);
+        return glm::scale(model, transform.scale);
+    }
+};
+
+#endif